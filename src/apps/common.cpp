@@ -1,35 +1,191 @@
 #include "common.h"
 
 #include <dlfcn.h>
+#include <dependency_graph/metadata_register.h>
+#include <dependency_graph/static_initialisation.h>
 #include <possumwood_sdk/app.h>
+#include <possumwood_sdk/atomic_write.h>
 
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 
+#include <nlohmann/json.hpp>
+
 namespace fs = boost::filesystem;
 
-PluginsRAII::PluginsRAII() {
+namespace {
+
+fs::path pluginsDir() {
+	return possumwood::Filepath::fromString("$PLUGINS").toPath();
+}
+
+fs::path manifestPath() {
+	return pluginsDir() / "manifest.json";
+}
+
+std::set<std::string> registeredNodeTypes() {
+	std::set<std::string> result;
+	for(auto& m : dependency_graph::MetadataRegister::singleton())
+		result.insert(m.metadata().type());
+	return result;
+}
+
+}  // namespace
+
+PluginsRAII::PluginsRAII(Mode mode) {
 	// scan for plugins
-	for(fs::directory_iterator itr(possumwood::Filepath::fromString("$PLUGINS").toPath());
-	    itr != fs::directory_iterator(); ++itr) {
-		if(fs::is_regular_file(itr->status()) && itr->path().extension() == ".so") {
-			std::cout << "Loading plugin " << itr->path().string() << " ... " << std::flush;
-
-			void* ptr = dlopen(itr->path().string().c_str(), RTLD_NOW);
-			if(ptr) {
-				m_pluginHandles.push_back(std::make_pair(ptr, itr->path().string()));
-				std::cout << "done." << std::endl;
-			}
-			else
-				std::cout << dlerror() << std::endl;
-		}
+	std::vector<fs::path> paths;
+	for(fs::directory_iterator itr(pluginsDir()); itr != fs::directory_iterator(); ++itr)
+		if(fs::is_regular_file(itr->status()) && itr->path().extension() == ".so")
+			paths.push_back(itr->path());
+	std::sort(paths.begin(), paths.end());
+
+	// the manifest is rewritten only if it is missing or doesn't match the plugins
+	const bool upToDate = readManifest(paths);
+	if(mode == kLoadAll || !upToDate)
+		loadAll(paths);
+	if(!upToDate)
+		writeManifest();
+
+	// plugins not loaded yet are loaded when one of their node or data types is needed
+	if(mode == kOnDemand) {
+		dependency_graph::MetadataRegister::singleton().setLoader(
+		    [this](const std::string& nodeType) { loadType(m_nodeTypes, nodeType); });
+		dependency_graph::StaticInitialisation::setLoader(
+		    [this](const std::string& dataType) { loadType(m_dataTypes, dataType); });
 	}
 }
 
 PluginsRAII::~PluginsRAII() {
+	dependency_graph::MetadataRegister::singleton().setLoader(std::function<void(const std::string&)>());
+	dependency_graph::StaticInitialisation::setLoader(std::function<void(const std::string&)>());
+
 	// unload all plugins
 	while(!m_pluginHandles.empty()) {
 		dlclose(m_pluginHandles.back().first);
 		m_pluginHandles.pop_back();
 	}
 }
+
+bool PluginsRAII::load(Plugin& plugin, int flags) {
+	std::cout << "Loading plugin " << plugin.path.string() << " ... " << std::flush;
+
+	// marked as loaded even on error, to avoid repeated attempts
+	plugin.loaded = true;
+
+	void* ptr = dlopen(plugin.path.string().c_str(), flags);
+	if(ptr) {
+		m_pluginHandles.push_back(std::make_pair(ptr, plugin.path.string()));
+		std::cout << "done." << std::endl;
+		return true;
+	}
+
+	std::cout << dlerror() << std::endl;
+	return false;
+}
+
+void PluginsRAII::loadAll(const std::vector<fs::path>& paths) {
+	m_plugins.clear();
+
+	for(auto& path : paths) {
+		Plugin plugin{path, fs::last_write_time(path), fs::file_size(path), std::set<std::string>(),
+		              std::set<std::string>(), false};
+
+		// node and data types registered by the plugin's static initialisation
+		const std::set<std::string> nodesBefore = registeredNodeTypes();
+		const std::set<std::string> dataBefore = dependency_graph::StaticInitialisation::dataTypes();
+		if(load(plugin, RTLD_NOW)) {
+			for(auto& t : registeredNodeTypes())
+				if(nodesBefore.find(t) == nodesBefore.end())
+					plugin.nodeTypes.insert(t);
+			for(auto& t : dependency_graph::StaticInitialisation::dataTypes())
+				if(dataBefore.find(t) == dataBefore.end())
+					plugin.dataTypes.insert(t);
+		}
+
+		m_plugins.push_back(plugin);
+	}
+
+	indexTypes();
+}
+
+void PluginsRAII::indexTypes() {
+	m_nodeTypes.clear();
+	m_dataTypes.clear();
+	for(std::size_t pi = 0; pi < m_plugins.size(); ++pi) {
+		for(auto& t : m_plugins[pi].nodeTypes)
+			m_nodeTypes[t] = pi;
+		for(auto& t : m_plugins[pi].dataTypes)
+			m_dataTypes[t] = pi;
+	}
+}
+
+void PluginsRAII::loadType(const std::map<std::string, std::size_t>& index, const std::string& type) {
+	auto it = index.find(type);
+	if(it == index.end())
+		return;
+
+	// symbols are resolved lazily, to make the loading of a plugin as cheap as possible
+	Plugin& plugin = m_plugins[it->second];
+	if(!plugin.loaded)
+		load(plugin, RTLD_LAZY);
+}
+
+bool PluginsRAII::readManifest(const std::vector<fs::path>& paths) {
+	std::ifstream in(manifestPath().string());
+	if(!in.good())
+		return false;
+
+	std::vector<Plugin> plugins;
+	try {
+		nlohmann::json json;
+		in >> json;
+
+		for(auto& p : json.at("plugins"))
+			plugins.push_back(Plugin{pluginsDir() / p.at("filename").get<std::string>(),
+			                         p.at("modified").get<std::time_t>(), p.at("size").get<std::uintmax_t>(),
+			                         p.at("nodes").get<std::set<std::string>>(),
+			                         p.at("data").get<std::set<std::string>>(), false});
+	}
+	catch(const std::exception& err) {
+		std::cout << "Error reading plugin manifest " << manifestPath().string() << " - " << err.what()
+		          << std::endl;
+		return false;
+	}
+
+	// the manifest is valid only if it describes exactly the current set of plugins
+	if(plugins.size() != paths.size())
+		return false;
+
+	for(std::size_t pi = 0; pi < paths.size(); ++pi)
+		if(plugins[pi].path != paths[pi] || plugins[pi].modified != fs::last_write_time(paths[pi]) ||
+		   plugins[pi].size != fs::file_size(paths[pi]))
+			return false;
+
+	m_plugins = plugins;
+	indexTypes();
+
+	return true;
+}
+
+void PluginsRAII::writeManifest() const {
+	nlohmann::json json;
+	json["plugins"] = nlohmann::json::array();
+
+	for(auto& p : m_plugins) {
+		nlohmann::json plugin;
+		plugin["filename"] = p.path.filename().string();
+		plugin["modified"] = p.modified;
+		plugin["size"] = p.size;
+		plugin["nodes"] = p.nodeTypes;
+		plugin["data"] = p.dataTypes;
+
+		json["plugins"].push_back(plugin);
+	}
+
+	// the manifest is only an optimisation - a read-only plugin directory is not an error
+	possumwood::atomicWrite(manifestPath(), [&json](std::ostream& out) { out << std::setw(4) << json; });
+}
@@ -1,18 +1,55 @@
 #pragma once
 
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
+#include <boost/filesystem/path.hpp>
+
 /// A RAII class loading plugins (assumes an App instance already exists).
 /// Will unload plugins on destruction.
+///
+/// In the kOnDemand mode, only a manifest mapping node and data types to plugins is read on construction, and
+/// each plugin is loaded when one of its types is first requested (e.g., while loading a scene). The manifest
+/// is generated (by loading all plugins) if it doesn't exist, or if any of the plugins changed.
 class PluginsRAII {
   public:
-	PluginsRAII();
+	enum Mode { kLoadAll, kOnDemand };
+
+	PluginsRAII(Mode mode = kLoadAll);
 	~PluginsRAII();
 
   private:
 	PluginsRAII(const PluginsRAII&) = delete;
 	PluginsRAII& operator=(const PluginsRAII&) = delete;
 
+	struct Plugin {
+		boost::filesystem::path path;
+		std::time_t modified;
+		std::uintmax_t size;
+		std::set<std::string> nodeTypes;
+		std::set<std::string> dataTypes;
+		bool loaded;
+	};
+
+	/// loads all plugins, collecting the node and data types registered by each
+	void loadAll(const std::vector<boost::filesystem::path>& paths);
+	/// loads a single plugin, returns false on error
+	bool load(Plugin& plugin, int flags);
+	void indexTypes();
+	/// called by the metadata register and data factories for types not registered yet
+	void loadType(const std::map<std::string, std::size_t>& index, const std::string& type);
+
+	/// reads the manifest, returns false if it doesn't exist or doesn't match the plugins
+	bool readManifest(const std::vector<boost::filesystem::path>& paths);
+	void writeManifest() const;
+
 	std::vector<std::pair<void*, std::string>> m_pluginHandles;
+
+	std::vector<Plugin> m_plugins;
+	std::map<std::string, std::size_t> m_nodeTypes;  // node type -> index in m_plugins
+	std::map<std::string, std::size_t> m_dataTypes;  // data type -> index in m_plugins
 };
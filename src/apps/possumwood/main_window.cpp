@@ -210,8 +210,10 @@ MainWindow::MainWindow() : QMainWindow(), m_editor(nullptr) {
 	connect(m_viewport, SIGNAL(render(float)), this, SLOT(draw(float)));
 	possumwood::App::instance().graph().onDirty([this]() { m_viewport->update(); });
 
-	// drawable refresh callback
-	possumwood::Drawable::onRefreshQueued([this]() { m_viewport->update(); });
+	// drawable refresh callback - can be called from a background evaluation thread, so the
+	// update is always queued to the UI thread
+	possumwood::Drawable::onRefreshQueued(
+	    [this]() { QMetaObject::invokeMethod(m_viewport, "update", Qt::QueuedConnection); });
 
 	////////////////////
 	// window actions
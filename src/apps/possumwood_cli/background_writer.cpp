@@ -0,0 +1,89 @@
+#include "background_writer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+BackgroundWriter::BackgroundWriter(std::size_t threadCount, std::size_t maxTasks) : m_running(0), m_finished(false) {
+	threadCount = std::max(threadCount, std::size_t(1));
+	m_maxTasks = maxTasks > 0 ? maxTasks : threadCount * 2;
+
+	for(std::size_t i = 0; i < threadCount; ++i)
+		m_threads.push_back(std::thread([this]() { run(); }));
+}
+
+BackgroundWriter::~BackgroundWriter() {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_finished = true;
+	}
+	m_added.notify_all();
+
+	for(auto& t : m_threads)
+		t.join();
+
+	for(auto& e : m_errors)
+		std::cerr << "[error] " << e << std::endl;
+}
+
+void BackgroundWriter::add(const std::function<void()>& task) {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		// each finished task notifies m_done
+		m_done.wait(lock, [this]() { return m_tasks.size() + m_running < m_maxTasks; });
+
+		m_tasks.push_back(task);
+	}
+
+	m_added.notify_one();
+}
+
+void BackgroundWriter::flush() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this]() { return m_tasks.empty() && m_running == 0; });
+
+	if(!m_errors.empty()) {
+		std::stringstream ss;
+		for(auto& e : m_errors)
+			ss << e << std::endl;
+		m_errors.clear();
+
+		throw std::runtime_error(ss.str());
+	}
+}
+
+void BackgroundWriter::run() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while(true) {
+		m_added.wait(lock, [this]() { return !m_tasks.empty() || m_finished; });
+
+		// the remaining tasks are finished even if the writer is being destroyed
+		if(m_tasks.empty())
+			return;
+
+		std::function<void()> task = std::move(m_tasks.front());
+		m_tasks.pop_front();
+		++m_running;
+
+		lock.unlock();
+
+		std::string error;
+		try {
+			task();
+		}
+		catch(const std::exception& e) {
+			error = e.what();
+		}
+
+		lock.lock();
+
+		if(!error.empty())
+			m_errors.push_back(error);
+
+		--m_running;
+		m_done.notify_all();
+	}
+}
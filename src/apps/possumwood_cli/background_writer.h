@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// A simple queue of output-writing tasks (e.g., image encoding), executed by a set of background threads.
+/// Allows the evaluation or rendering of the next frame to continue while the previous results are being
+/// written to disk. Errors (exceptions thrown by tasks) are collected, and reported by flush().
+///
+/// The number of tasks in flight (queued or running) is limited - each holds its data (e.g., a rendered frame
+/// buffer) in memory, so if writing is slower than producing the data, add() blocks until a task finishes.
+class BackgroundWriter {
+  public:
+	/// maxTasks of 0 allows two tasks in flight per thread
+	explicit BackgroundWriter(std::size_t threadCount = 1, std::size_t maxTasks = 0);
+	/// waits for all queued tasks to finish (errors are only printed)
+	~BackgroundWriter();
+
+	/// queues a task, blocking while the maximum number of tasks is in flight
+	void add(const std::function<void()>& task);
+
+	/// waits for all queued tasks to finish; throws std::runtime_error if any of them failed
+	void flush();
+
+  private:
+	BackgroundWriter(const BackgroundWriter&) = delete;
+	BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+
+	void run();
+
+	std::mutex m_mutex;
+	std::condition_variable m_added, m_done;
+
+	std::deque<std::function<void()>> m_tasks;
+	std::size_t m_running;
+	std::size_t m_maxTasks;
+	bool m_finished;
+
+	std::vector<std::string> m_errors;
+	std::vector<std::thread> m_threads;
+};
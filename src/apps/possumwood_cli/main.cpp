@@ -1,15 +1,26 @@
 #include <GL/glew.h>
 #include <GL/glut.h>
 #include <OpenImageIO/imageio.h>
+#include <actions/io.h>
+#include <dependency_graph/io.h>
 #include <dependency_graph/static_initialisation.h>
 #include <possumwood_sdk/app.h>
+#include <possumwood_sdk/file_writer.h>
 #include <possumwood_sdk/viewport_state.h>
 
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <boost/format.hpp>
+#include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <thread>
 #include <possumwood_sdk/config.inl>
 
+#include "background_writer.h"
 #include "common.h"
 #include "expression.h"
 #include "options.h"
@@ -38,6 +49,13 @@ std::unique_ptr<possumwood::App> papp;
 std::size_t frame_step = 0;
 float cam_orbit = 0.0f;
 
+// parallel rendering - number of worker processes, and the index of the current one
+std::size_t jobs = 1;
+std::size_t worker = 0;
+
+// writing of rendered images and exported values, in background threads
+std::unique_ptr<BackgroundWriter> writer;
+
 // expression expansion
 int currentFrame() {
 	return std::round(possumwood::App::instance().time() *
@@ -63,9 +81,24 @@ void printHelp() {
 	std::cout << "  --cam_pos <x> <y> <z> - defines camera position in world space" << std::endl;
 	std::cout << "  --cam_target <x> <y> <z> - defines camera target (default 0,0,0)" << std::endl;
 	std::cout << "  --cam_orbit <orbit_count> - if present, makes the camera orbit the scene" << std::endl;
-	std::cout << "  --frame_step <step> - render multiple frames" << std::endl;
+	std::cout << "  --frame_step <step> - render or export multiple frames" << std::endl;
+	std::cout << "  --set <port> <value> - sets the value of an unconnected input port, addressed by its full name"
+	          << std::endl;
+	std::cout << "                         (e.g., network/node/port), with the value in JSON format" << std::endl;
+	std::cout << "  --export <port> <filename> - evaluates a port, and writes its value into a file without"
+	          << std::endl;
+	std::cout << "                               rendering (images and meshes use plugin-provided writers, based on"
+	          << std::endl;
+	std::cout << "                               the filename's extension; other values are written as JSON)"
+	          << std::endl;
+	std::cout << "  --jobs <count> - renders frames in parallel, using multiple processes (each process loads its"
+	          << std::endl;
+	std::cout << "                   own instance of the scene, and renders every <count>-th frame)" << std::endl;
+	std::cout << "  --lua_cache <directory> - persists compiled Lua scripts in a directory, to be reused by subsequent"
+	          << std::endl;
+	std::cout << "                            runs (needs to precede --scene)" << std::endl;
 	std::cout << std::endl;
-	std::cout << "The render filename parameter can contain the following 'variables':" << std::endl;
+	std::cout << "The render and export filename parameters can contain the following 'variables':" << std::endl;
 	std::cout << "  $T - time, with two decimal points" << std::endl;
 	std::cout << "  $F - frame, as an integer value" << std::endl;
 	std::cout << "  $2F - frame, as an integer value, padded with 0s to the width of 2" << std::endl;
@@ -82,6 +115,10 @@ void loadScene(const Options::Item& option) {
 	dependency_graph::State state = papp->loadFile(possumwood::Filepath::fromPath(option.parameters[0]));
 	std::cout << "done" << std::endl;
 
+	// rendering and exporting rely on synchronous evaluation - a scene saved with background evaluation
+	// enabled would otherwise render stale values
+	papp->sceneConfig()["background_evaluation"] = 0;
+
 	for(auto& msg : state) {
 		if(msg.first == dependency_graph::State::kInfo)
 			std::cout << "[info] ";
@@ -96,48 +133,174 @@ void loadScene(const Options::Item& option) {
 		throw std::runtime_error("Error loading scene file. Exiting.");
 }
 
+/// index of the last frame to be rendered or exported (frames are indexed from 0, in multiples of frame_step)
+std::size_t lastFrameParam() {
+	if(frame_step == 0)
+		return 0;
+
+	const possumwood::Config& cfg = possumwood::App::instance().sceneConfig();
+	return std::size_t(round((cfg["end_time"].as<float>() - cfg["start_time"].as<float>()) * cfg["fps"].as<float>())) /
+	       frame_step;
+}
+
+/// an action setting the scene time for a frame index
+Action setTime(std::size_t param) {
+	const possumwood::Config& cfg = possumwood::App::instance().sceneConfig();
+	const float t = (float)(param * frame_step) / cfg["fps"].as<float>() + cfg["start_time"].as<float>();
+
+	return Action([t]() {
+		possumwood::App::instance().setTime(t);
+		return std::vector<Action>();
+	});
+}
+
+/// finds a port using its full name (including the path of its node in the graph)
+dependency_graph::Port& findPort(const std::string& fullName) {
+	dependency_graph::Nodes& nodes = papp->graph().nodes();
+	for(auto it = nodes.begin(dependency_graph::Nodes::kRecursive); it != nodes.end(); ++it)
+		for(std::size_t pi = 0; pi < it->portCount(); ++pi)
+			if(it->port(pi).fullName() == fullName)
+				return it->port(pi);
+
+	throw std::runtime_error("Port " + fullName + " not found in the scene");
+}
+
+void setPort(const Options::Item& option) {
+	if(option.parameters.size() != 2)
+		throw std::runtime_error("--set option requires exactly two parameters - a port name and a value");
+
+	dependency_graph::Port& port = findPort(option.parameters[0]);
+
+	if(port.category() != dependency_graph::Attr::kInput || port.isConnected())
+		throw std::runtime_error("Only values of unconnected input ports can be set, " + port.fullName() +
+		                         " is not one of them");
+
+	dependency_graph::Data data = port.getData();
+	if(!dependency_graph::io::isSaveable(data))
+		throw std::runtime_error("Port " + port.fullName() + " of type " + data.type() +
+		                         " does not support setting a value");
+
+	// values are in JSON format, with a fallback to a plain string (to avoid the need for quoting strings)
+	nlohmann::json json;
+	try {
+		json = nlohmann::json::parse(option.parameters[1]);
+	}
+	catch(const nlohmann::json::exception&) {
+		json = option.parameters[1];
+	}
+
+	try {
+		possumwood::io::fromJson(json, data);
+	}
+	catch(const std::exception& err) {
+		throw std::runtime_error("Error setting value of " + port.fullName() + ": " + err.what());
+	}
+
+	port.setData(data);
+}
+
+/// writes a value into a file - using a file writer registered for its type, or as JSON as a fallback
+void writeValue(const std::string& filename, const dependency_graph::Data& data) {
+	if(possumwood::FileWriterBase::canWrite(data))
+		possumwood::FileWriterBase::write(filename, data);
+
+	else if(dependency_graph::io::isSaveable(data)) {
+		nlohmann::json json;
+		possumwood::io::toJson(json, data);
+
+		std::ofstream out(filename);
+		out << std::setw(4) << json;
+
+		if(!out.good())
+			throw std::runtime_error("Error writing " + filename);
+	}
+
+	else
+		throw std::runtime_error("Values of type " + data.type() + " cannot be exported (" + filename + ")");
+
+	std::cout << "Written " << filename << std::endl;
+}
+
+std::vector<Action> exportPort(const Options::Item& option) {
+	if(option.parameters.size() != 2)
+		throw std::runtime_error("--export option requires exactly two parameters - a port name and a filename");
+
+	// checked before the first frame is evaluated
+	findPort(option.parameters[0]);
+
+	std::vector<Action> result;
+
+	const std::size_t end_param = lastFrameParam();
+	for(std::size_t param = 0; param <= end_param; ++param) {
+		// with multiple worker processes, each exports an interleaved subset of frames
+		if(param % jobs != worker)
+			continue;
+
+		result.push_back(setTime(param));
+
+		result.push_back(Action([option]() {
+			const std::string filename = expr.expand(option.parameters[1]);
+			std::cout << "Exporting " << filename << "... " << std::endl;
+
+			// evaluated on the main thread; the data are shared, so the copy is cheap and stays valid
+			// while the next frame is evaluated
+			const dependency_graph::Data data = findPort(option.parameters[0]).getData();
+
+			// encoding (e.g., image compression) is done in the background thread pool
+			writer->add([filename, data]() { writeValue(filename, data); });
+
+			return std::vector<Action>();
+		}));
+	}
+
+	return result;
+}
+
 std::vector<Action> render(const Options::Item& option) {
 	if(option.parameters.size() != 1)
 		throw std::runtime_error("--render option allows only exactly one filename");
 
 	std::vector<Action> result;
 
-	std::size_t end_param = 0;
-	if(frame_step > 0) {
-		const possumwood::Config& cfg = possumwood::App::instance().sceneConfig();
-		end_param =
-		    std::size_t(round((cfg["end_time"].as<float>() - cfg["start_time"].as<float>()) * cfg["fps"].as<float>())) /
-		    frame_step;
-	}
-
+	const std::size_t end_param = lastFrameParam();
 	for(std::size_t param = 0; param <= end_param; ++param) {
-		const possumwood::Config& cfg = possumwood::App::instance().sceneConfig();
-		const float t = (float)(param * frame_step) / cfg["fps"].as<float>() + cfg["start_time"].as<float>();
+		// with multiple worker processes, each renders an interleaved subset of frames
+		if(param % jobs != worker)
+			continue;
 
-		std::function<void(std::vector<GLubyte>&)> callback = [option, t](const std::vector<GLubyte>& buffer) {
-			possumwood::App::instance().setTime(t);
+		// the time needs to be set before rendering (the previous frame rendered by this process might not
+		// be the previous frame of the sequence)
+		result.push_back(setTime(param));
 
+		std::function<void(std::vector<GLubyte>&)> callback = [option](const std::vector<GLubyte>& buffer) {
 			const std::string filename = expr.expand(option.parameters[0]);
-			std::cout << "Rendering " << filename << "... " << std::flush;
+			std::cout << "Rendering " << filename << "... " << std::endl;
 
-			std::unique_ptr<ImageOutput> out(ImageOutput::create(filename));
-			if(!out)
-				throw(std::runtime_error("Cannot write output image " + filename));
+			// the image is written in a background thread, while the next frame is being rendered
+			const int width = viewport.width();
+			const int height = viewport.height();
+			std::shared_ptr<const std::vector<GLubyte>> data(new std::vector<GLubyte>(buffer));
 
-			ImageSpec spec(viewport.width(), viewport.height(), 3, TypeDesc::UINT8);
-			if(out->open(filename, spec)) {
-				for(int y = viewport.height() - 1; y >= 0; --y) {
-					const GLubyte* ptr = &(buffer[y * viewport.width() * 3]);
+			writer->add([filename, width, height, data]() {
+				std::unique_ptr<ImageOutput> out(ImageOutput::create(filename));
+				if(!out)
+					throw(std::runtime_error("Cannot write output image " + filename));
 
-					out->write_scanline(y, 0, TypeDesc::UINT8, ptr);
-				}
+				ImageSpec spec(width, height, 3, TypeDesc::UINT8);
+				if(out->open(filename, spec)) {
+					for(int y = height - 1; y >= 0; --y) {
+						const GLubyte* ptr = &((*data)[y * width * 3]);
 
-				out->close();
-			}
-			else
-				throw std::runtime_error("Error opening output file " + filename);
+						out->write_scanline(y, 0, TypeDesc::UINT8, ptr);
+					}
 
-			std::cout << "done" << std::endl;
+					out->close();
+				}
+				else
+					throw std::runtime_error("Error opening output file " + filename);
+
+				std::cout << "Written " << filename << std::endl;
+			});
 		};
 
 		// orbitting camera
@@ -166,6 +329,12 @@ std::vector<Action> evaluateOption(const Options::const_iterator& current) {
 	else if(option.name == "--render")
 		return render(option);
 
+	else if(option.name == "--set")
+		setPort(option);
+
+	else if(option.name == "--export")
+		return exportPort(option);
+
 	else if(option.name == "--help")
 		printHelp();
 
@@ -176,6 +345,20 @@ std::vector<Action> evaluateOption(const Options::const_iterator& current) {
 		frame_step = atoi(option.parameters[0].c_str());
 	}
 
+	else if(option.name == "--jobs") {
+		// handled before the evaluation of the options (see forkWorkers())
+		if(option.parameters.size() != 1)
+			throw std::runtime_error("--jobs option allows only exactly one integer parameter");
+	}
+
+	else if(option.name == "--lua_cache") {
+		if(option.parameters.size() != 1)
+			throw std::runtime_error("--lua_cache option allows only exactly one directory parameter");
+
+		// read by the Lua plugin on its first script evaluation
+		setenv("POSSUMWOOD_LUA_CACHE", option.parameters[0].c_str(), 1);
+	}
+
 	else if(option.name == "--cam_pos") {
 		if(option.parameters.size() != 3)
 			throw std::runtime_error("--cam_pos option allows only exactly three floating-point parameter");
@@ -227,18 +410,53 @@ std::vector<Action> evaluateOptions(const Options& options) {
 	return result;
 }
 
+/// Forks the worker processes requested by the --jobs option. Needs to be called before any other initialisation
+/// (no threads can exist at the point of forking). Returns the process IDs of the child processes (empty in the
+/// child processes).
+std::vector<pid_t> forkWorkers(const Options& options) {
+	std::vector<pid_t> result;
+
+	for(auto& option : options)
+		if(option.name == "--jobs" && option.parameters.size() == 1)
+			jobs = std::max(atoi(option.parameters[0].c_str()), 1);
+
+	for(std::size_t w = 1; w < jobs; ++w) {
+		const pid_t pid = fork();
+
+		if(pid < 0)
+			throw std::runtime_error("Error creating a worker process.");
+
+		// the child process - continues with its own index, and no children of its own
+		if(pid == 0) {
+			worker = w;
+			return std::vector<pid_t>();
+		}
+
+		result.push_back(pid);
+	}
+
+	return result;
+}
+
 int main(int argc, char* argv[]) {
+	// parse the program options
+	Options options(argc, argv);
+
+	// create the worker processes, each evaluating its own instance of the scene
+	const std::vector<pid_t> children = forkWorkers(options);
+
 	// static initialiser for the dependency graph library
 	std::unique_ptr<dependency_graph::StaticInitialisation> initialiser(new dependency_graph::StaticInitialisation());
 
 	// create the possumwood application
 	papp = std::unique_ptr<possumwood::App>(new possumwood::App());
 
-	// load all plugins into an RAII container
-	PluginsRAII plugins;
+	// plugins are loaded on demand, when a node type they provide is first needed
+	PluginsRAII plugins(PluginsRAII::kOnDemand);
 
-	// parse the program options
-	Options options(argc, argv);
+	// background image writing and encoding - the cores are split between the worker processes
+	writer = std::unique_ptr<BackgroundWriter>(
+	    new BackgroundWriter(std::max(std::thread::hardware_concurrency() / jobs, std::size_t(1))));
 
 	// populate the initial action
 	Stack s;
@@ -265,11 +483,30 @@ int main(int argc, char* argv[]) {
 			s.step();
 	}
 
+	int result = 0;
+
+	// wait for all images to be written
+	try {
+		writer->flush();
+	}
+	catch(const std::runtime_error& err) {
+		std::cerr << "[error] " << err.what() << std::endl;
+		result = 1;
+	}
+	writer.reset();
+
 	// explicitly destroy the app object before exiting, to avoid initialisation order problems
 	papp.reset();
 
 	// and destroy the initialiser, to make sure the factories are removed before they can cause trouble
 	initialiser.reset();
 
-	return 0;
+	// wait for all worker processes to finish
+	for(auto& pid : children) {
+		int status = 0;
+		if(waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			result = 1;
+	}
+
+	return result;
 }
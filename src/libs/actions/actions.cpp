@@ -16,6 +16,7 @@
 #include "app.h"
 #include "clipboard.h"
 #include "detail/connections.h"
+#include "detail/construction.h"
 #include "detail/metadata.h"
 #include "detail/nodes.h"
 #include "detail/tools.h"
@@ -221,7 +222,7 @@ namespace {
 
 enum PasteFlags { kNone = 0, kRoot = 1 };
 
-dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
+dependency_graph::State pasteNetwork(detail::Construction& construction,
                                      const dependency_graph::UniqueId& targetIndex,
                                      const nlohmann::json& _source,
                                      PasteFlags flags,
@@ -253,6 +254,10 @@ dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
 		    ++ni) {
 			const nlohmann::json& n = ni.value();
 
+			// find the metadata instance (first, as finding it might load a plugin providing the
+			// blind data type)
+			auto metaIt = dependency_graph::MetadataRegister::singleton().find(n["type"].get<std::string>());
+
 			// extract the blind data via factory mechanism
 			dependency_graph::Data blindData;
 			if(n.find("blind_data") != n.end() && !n["blind_data"].is_null()) {
@@ -262,8 +267,6 @@ dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
 				io::fromJson(n["blind_data"]["value"], blindData);
 			}
 
-			// find the metadata instance
-			auto metaIt = dependency_graph::MetadataRegister::singleton().find(n["type"].get<std::string>());
 			if(metaIt == dependency_graph::MetadataRegister::singleton().end())
 				state.addError(
 				    "Unregistered node type '" + n["type"].get<std::string>() +
@@ -278,24 +281,23 @@ dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
 				if(ids)
 					ids->insert(nodeId);
 
-				// add the action to create the node itself
-				action.append(
-				    detail::createNodeAction(targetIndex, *metaIt, n["name"].get<std::string>(), blindData, nodeId));
+				// create the node itself
+				construction.createNode(targetIndex, *metaIt, n["name"].get<std::string>(), blindData, nodeId);
 
 				// recurse to add nested networks
 				//   -> this will also construct the internals of the network, and instantiate
 				//      its inputs and outputs
 				if(n["type"] == "network")
-					state.append(pasteNetwork(action, nodeId, n, kNone));
+					state.append(pasteNetwork(construction, nodeId, n, kNone));
 
 				// networks process ports during pasteNetwork() call; nodes don't have an explicit step, so let's do
 				// that here
 				else {
-					// and another action to set all port values based on the json content
+					// and set all port values based on the json content
 					//   -> as the node doesn't exist yet, we can't interpret the types
 					if(n.find("ports") != n.end())
 						for(nlohmann::json::const_iterator pi = n["ports"].begin(); pi != n["ports"].end(); ++pi)
-							action.append(detail::setValueAction(nodeId, pi.key(), pi.value()));
+							construction.setValue(nodeId, pi.key(), pi.value());
 				}
 			}
 		}
@@ -319,27 +321,27 @@ dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
 				               "' cannot be added!");
 
 			if(id1 != nodeIds.end() && id2 != nodeIds.end())
-				action.append(detail::connectAction(id1->second, port1, id2->second, port2));
+				construction.connect(id1->second, port1, id2->second, port2);
 		}
 	}
 
 	// and add the "source" if any, with a compressed filepath
 	if(_source.find("source") != _source.end() && !(flags & kRoot)) {
-		action.append(detail::setSourceAction(
-		    targetIndex, possumwood::Filepath::fromString(_source["source"].get<std::string>()).toString()));
+		construction.setSource(targetIndex,
+		                       possumwood::Filepath::fromString(_source["source"].get<std::string>()).toString());
 	}
 
-	// and another action to set all port values based on the json content
+	// and set all port values based on the json content
 	//   -> as the network doesn't exist yet, we can't interpret the types
 	if(source->find("ports") != source->end())
 		for(nlohmann::json::const_iterator pi = (*source)["ports"].begin(); pi != (*source)["ports"].end(); ++pi)
-			action.append(detail::setValueAction(targetIndex, pi.key(), pi.value()));
+			construction.setValue(targetIndex, pi.key(), pi.value());
 
 	// finally, overwrite any of the ports in the original source with new values that might be present in the
 	// referencing file
 	if(_source.find("ports") != _source.end())
 		for(nlohmann::json::const_iterator pi = _source["ports"].begin(); pi != _source["ports"].end(); ++pi)
-			action.append(detail::setValueAction(targetIndex, pi.key(), pi.value()));
+			construction.setValue(targetIndex, pi.key(), pi.value());
 
 	return state;
 }
@@ -378,15 +380,18 @@ dependency_graph::State fromJson(dependency_graph::Network& current,
                                  bool haltOnError) {
 	dependency_graph::State state;
 
-	possumwood::UndoStack::Action action;
+	detail::Construction construction;
 
 	std::set<dependency_graph::UniqueId> pastedNodeIds;
 
 	// paste the network extracted from the JSON
-	state.append(pasteNetwork(action, current.index(), json, kRoot, &pastedNodeIds));
+	state.append(pasteNetwork(construction, current.index(), json, kRoot, &pastedNodeIds));
 
-	// execute the action (will actually make the nodes and connections)
-	state.append(possumwood::AppCore::instance().undoStack().execute(action, haltOnError));
+	// execute the construction as a single action (will actually make the nodes and connections)
+	std::shared_ptr<dependency_graph::State> errors(new dependency_graph::State());
+	state.append(possumwood::AppCore::instance().undoStack().execute(construction.action(haltOnError, errors),
+	                                                                 haltOnError));
+	state.append(*errors);
 
 	// and make the selection based on added nodes
 	for(auto& n : pastedNodeIds)
@@ -438,7 +443,7 @@ dependency_graph::State importNetwork(dependency_graph::Network& current,
                                       const dependency_graph::Data& blindData) {
 	dependency_graph::State state;
 
-	possumwood::UndoStack::Action action;
+	detail::Construction construction;
 
 	nlohmann::json tmp;
 	tmp["source"] = filepath.toString();
@@ -447,14 +452,16 @@ dependency_graph::State importNetwork(dependency_graph::Network& current,
 
 	auto metaIt = dependency_graph::MetadataRegister::singleton().find("network");
 
-	action.append(detail::createNodeAction(current.index(), *metaIt, name, blindData, networkId));
+	construction.createNode(current.index(), *metaIt, name, blindData, networkId);
 
 	// paste the network extracted from the JSON
 	std::set<dependency_graph::UniqueId> pastedNodeIds;
-	state.append(pasteNetwork(action, networkId, tmp, kNone, &pastedNodeIds));
+	state.append(pasteNetwork(construction, networkId, tmp, kNone, &pastedNodeIds));
 
-	// execute the action (will actually make the nodes and connections)
-	state.append(possumwood::AppCore::instance().undoStack().execute(action, false));
+	// execute the construction as a single action (will actually make the nodes and connections)
+	std::shared_ptr<dependency_graph::State> errors(new dependency_graph::State());
+	state.append(possumwood::AppCore::instance().undoStack().execute(construction.action(false, errors), false));
+	state.append(*errors);
 
 	// and make the selection based on added nodes
 	selection.addNode(detail::findNode(networkId));
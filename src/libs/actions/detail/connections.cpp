@@ -73,6 +73,8 @@ void doConnectByIds(const dependency_graph::UniqueId& fromNode, std::size_t from
 	doConnectByRefs(from, fromPort, to, toPort);
 }
 
+}  // namespace
+
 void doConnectByNames(const dependency_graph::UniqueId& fromNode, const std::string& fromPort,
                       const dependency_graph::UniqueId& toNode, const std::string& toPort) {
 	dependency_graph::NodeBase& from = detail::findNode(fromNode);
@@ -102,6 +104,8 @@ void doConnectByNames(const dependency_graph::UniqueId& fromNode, const std::str
 	doConnectByRefs(from, fromPortId, to, toPortId);
 }
 
+namespace {
+
 void doDisconnectByRefs(dependency_graph::NodeBase& fromNode, std::size_t fromPort, dependency_graph::NodeBase& toNode,
                         std::size_t toPort) {
 	unlinkAll(fromNode.index(), toNode.index());
@@ -122,6 +126,8 @@ void doDisconnectByIds(const dependency_graph::UniqueId& fromNode, std::size_t f
 	doDisconnectByRefs(from, fromPort, to, toPort);
 }
 
+}  // namespace
+
 void doDisconnectByNames(const dependency_graph::UniqueId& fromNode, const std::string& fromPort,
                          const dependency_graph::UniqueId& toNode, const std::string& toPort) {
 	dependency_graph::NodeBase& from = detail::findNode(fromNode);
@@ -144,8 +150,6 @@ void doDisconnectByNames(const dependency_graph::UniqueId& fromNode, const std::
 	doDisconnectByRefs(from, fromPortId, to, toPortId);
 }
 
-}  // namespace
-
 possumwood::UndoStack::Action disconnectAction(const dependency_graph::UniqueId& fromNodeId, std::size_t fromPort,
                                                const dependency_graph::UniqueId& toNodeId, std::size_t toPort) {
 	possumwood::UndoStack::Action action;
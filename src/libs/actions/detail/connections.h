@@ -21,6 +21,12 @@ possumwood::UndoStack::Action disconnectAction(dependency_graph::Port& p1, depen
 possumwood::UndoStack::Action disconnectAction(const dependency_graph::UniqueId& fromNodeId, std::size_t fromPort,
                                                const dependency_graph::UniqueId& toNodeId, std::size_t toPort);
 
+// the implementation of the connection actions by port names (also used by Construction)
+void doConnectByNames(const dependency_graph::UniqueId& fromNode, const std::string& fromPort,
+                      const dependency_graph::UniqueId& toNode, const std::string& toPort);
+void doDisconnectByNames(const dependency_graph::UniqueId& fromNode, const std::string& fromPort,
+                         const dependency_graph::UniqueId& toNode, const std::string& toPort);
+
 }  // namespace detail
 }  // namespace actions
 }  // namespace possumwood
@@ -0,0 +1,242 @@
+#include "construction.h"
+
+#include <sstream>
+
+#include "../app.h"
+#include "connections.h"
+#include "nodes.h"
+#include "values.h"
+
+namespace possumwood {
+namespace actions {
+namespace detail {
+
+namespace {
+
+/// a graph batch, ended on destruction (i.e., even if an operation throws an exception)
+class Batch {
+  public:
+	Batch() {
+		AppCore::instance().graph().beginBatch();
+	}
+
+	~Batch() {
+		AppCore::instance().graph().endBatch();
+	}
+
+  private:
+	Batch(const Batch&) = delete;
+	Batch& operator=(const Batch&) = delete;
+};
+
+}  // namespace
+
+void Construction::createNode(const dependency_graph::UniqueId& networkId,
+                              const dependency_graph::MetadataHandle& meta,
+                              const std::string& name,
+                              const dependency_graph::Data& blindData,
+                              const dependency_graph::UniqueId& id) {
+	m_ops.push_back(Op{kCreateNode, m_nodes.size()});
+	m_nodes.push_back(NodeOp{networkId, id, meta, name, blindData});
+
+	m_createdIds.insert(id);
+}
+
+void Construction::setValue(const dependency_graph::UniqueId& nodeId,
+                            const std::string& portName,
+                            const nlohmann::json& value) {
+	m_ops.push_back(Op{kSetValue, m_values.size()});
+	m_values.push_back(ValueOp{nodeId, portName, value, nullptr});
+}
+
+void Construction::connect(const dependency_graph::UniqueId& fromNodeId,
+                           const std::string& fromPortName,
+                           const dependency_graph::UniqueId& toNodeId,
+                           const std::string& toPortName) {
+	m_ops.push_back(Op{kConnect, m_connections.size()});
+	m_connections.push_back(ConnectOp{fromNodeId, toNodeId, fromPortName, toPortName});
+}
+
+void Construction::setSource(const dependency_graph::UniqueId& networkId, const boost::filesystem::path& source) {
+	m_ops.push_back(Op{kSetSource, m_sources.size()});
+	m_sources.push_back(SourceOp{networkId, std::make_shared<boost::filesystem::path>(source),
+	                             std::make_shared<boost::filesystem::path>()});
+}
+
+std::size_t Construction::size() const {
+	return m_ops.size();
+}
+
+bool Construction::empty() const {
+	return m_ops.empty();
+}
+
+UndoStack::Action Construction::action(bool haltOnError,
+                                       const std::shared_ptr<dependency_graph::State>& errors) const {
+	UndoStack::Action action;
+
+	// an empty construction does not need to be on the undo stack
+	if(m_ops.empty())
+		return action;
+
+	// the copy keeps the values and sources replaced by the construction, to be able to undo it
+	std::shared_ptr<Construction> construction(new Construction(*this));
+
+	std::stringstream ss;
+	ss << "Constructing " << m_nodes.size() << " node(s) and " << m_connections.size() << " connection(s)";
+
+	action.addCommand(
+	    ss.str(),
+	    [construction, haltOnError, errors]() {
+		    dependency_graph::State state;
+		    construction->execute(haltOnError, state);
+
+		    if(errors)
+			    errors->append(state);
+	    },
+	    [construction]() { construction->undo(); });
+
+	return action;
+}
+
+void Construction::execute(bool haltOnError, dependency_graph::State& errors) {
+	Batch batch;
+
+	std::vector<Op> done;
+	done.reserve(m_ops.size());
+
+	for(auto& op : m_ops) {
+		std::string error;
+		try {
+			execute(op);
+
+			done.push_back(op);
+			continue;
+		}
+		catch(const std::exception& err) {
+			error = "Exception while running '" + describe(op) + "': " + err.what();
+		}
+		catch(...) {
+			error = "Unhandled exception while running '" + describe(op) + "'.";
+		}
+
+		if(haltOnError) {
+			// roll back all finished operations, and forward the error
+			for(auto it = done.rbegin(); it != done.rend(); ++it)
+				undo(*it);
+
+			throw std::runtime_error(error);
+		}
+
+		errors.addError(error);
+	}
+
+	// failing operations are skipped from now on (i.e., on redo)
+	m_ops = std::move(done);
+}
+
+void Construction::undo() {
+	Batch batch;
+
+	for(auto it = m_ops.rbegin(); it != m_ops.rend(); ++it)
+		undo(*it);
+}
+
+void Construction::execute(const Op& op) {
+	switch(op.type) {
+		case kCreateNode: {
+			const NodeOp& n = m_nodes[op.index];
+			doCreateNode(n.networkId, n.meta, n.name, n.id, n.blindData);
+			break;
+		}
+
+		case kSetValue: {
+			ValueOp& v = m_values[op.index];
+
+			// the original value is needed only if the node is not removed on undo
+			if(m_createdIds.find(v.nodeId) != m_createdIds.end())
+				doSetValueFromJson(v.nodeId, v.portName, v.value, std::make_shared<dependency_graph::Data>());
+
+			else {
+				if(v.original == nullptr)
+					v.original = std::make_shared<dependency_graph::Data>();
+				doSetValueFromJson(v.nodeId, v.portName, v.value, v.original);
+			}
+
+			break;
+		}
+
+		case kConnect: {
+			const ConnectOp& c = m_connections[op.index];
+			doConnectByNames(c.fromNodeId, c.fromPortName, c.toNodeId, c.toPortName);
+			break;
+		}
+
+		case kSetSource: {
+			const SourceOp& s = m_sources[op.index];
+			doSetSource(s.networkId, s.source, s.original);
+			break;
+		}
+	}
+}
+
+void Construction::undo(const Op& op) {
+	switch(op.type) {
+		case kCreateNode:
+			doRemoveNode(m_nodes[op.index].id);
+			break;
+
+		case kSetValue: {
+			const ValueOp& v = m_values[op.index];
+			if(v.original != nullptr)
+				doResetValueFromJson(v.nodeId, v.portName, v.original);
+			break;
+		}
+
+		case kConnect: {
+			const ConnectOp& c = m_connections[op.index];
+			doDisconnectByNames(c.fromNodeId, c.fromPortName, c.toNodeId, c.toPortName);
+			break;
+		}
+
+		case kSetSource: {
+			const SourceOp& s = m_sources[op.index];
+			if(m_createdIds.find(s.networkId) == m_createdIds.end())
+				doSetSource(s.networkId, s.original, s.source);
+			break;
+		}
+	}
+}
+
+std::string Construction::describe(const Op& op) const {
+	std::stringstream ss;
+
+	switch(op.type) {
+		case kCreateNode:
+			ss << "Creating node " << m_nodes[op.index].name << " of type " << m_nodes[op.index].meta->type();
+			break;
+
+		case kSetValue:
+			ss << "Setting value of " << m_values[op.index].nodeId << "/" << m_values[op.index].portName
+			   << " from JSON";
+			break;
+
+		case kConnect: {
+			const ConnectOp& c = m_connections[op.index];
+			ss << "Creating a connection between " << c.fromNodeId << "/" << c.fromPortName << " and " << c.toNodeId
+			   << "/" << c.toPortName;
+			break;
+		}
+
+		case kSetSource:
+			ss << "Setting network source of " << m_sources[op.index].networkId << " to "
+			   << *m_sources[op.index].source;
+			break;
+	}
+
+	return ss.str();
+}
+
+}  // namespace detail
+}  // namespace actions
+}  // namespace possumwood
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <dependency_graph/data.h>
+#include <dependency_graph/metadata.h>
+#include <dependency_graph/state.h>
+#include <dependency_graph/unique_id.h>
+
+#include <nlohmann/json.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "../undo_stack.h"
+
+namespace possumwood {
+namespace actions {
+namespace detail {
+
+/// A compact description of a bulk graph construction (loading, pasting or importing of a network) - an ordered
+/// list of node creations, value settings, connections and network sources. Unlike a sequence of individual actions,
+/// it is executed as a single undo stack command, inside a graph batch (i.e., with the dirtiness propagation
+/// deferred until all nodes and connections are in place). Values of the nodes created by the construction are not
+/// stored for undo, as undoing the construction removes these nodes.
+class Construction {
+  public:
+	void createNode(const dependency_graph::UniqueId& networkId, const dependency_graph::MetadataHandle& meta,
+	                const std::string& name, const dependency_graph::Data& blindData,
+	                const dependency_graph::UniqueId& id);
+	void setValue(const dependency_graph::UniqueId& nodeId, const std::string& portName, const nlohmann::json& value);
+	void connect(const dependency_graph::UniqueId& fromNodeId, const std::string& fromPortName,
+	             const dependency_graph::UniqueId& toNodeId, const std::string& toPortName);
+	void setSource(const dependency_graph::UniqueId& networkId, const boost::filesystem::path& source);
+
+	/// the number of operations in this construction
+	std::size_t size() const;
+	bool empty() const;
+
+	/// Creates an action with a single command executing the whole construction. With haltOnError=true, an error in
+	/// any operation rolls back all previous operations, and is forwarded to the undo stack as an exception.
+	/// Otherwise, failing operations are skipped (and not repeated on redo), and their errors are added to the errors
+	/// state.
+	UndoStack::Action action(bool haltOnError, const std::shared_ptr<dependency_graph::State>& errors) const;
+
+  private:
+	enum Type { kCreateNode, kSetValue, kConnect, kSetSource };
+
+	struct NodeOp {
+		dependency_graph::UniqueId networkId, id;
+		dependency_graph::MetadataHandle meta;
+		std::string name;
+		dependency_graph::Data blindData;
+	};
+
+	struct ValueOp {
+		dependency_graph::UniqueId nodeId;
+		std::string portName;
+		nlohmann::json value;
+
+		// the value before the construction, only for nodes not created by the construction
+		std::shared_ptr<dependency_graph::Data> original;
+	};
+
+	struct ConnectOp {
+		dependency_graph::UniqueId fromNodeId, toNodeId;
+		std::string fromPortName, toPortName;
+	};
+
+	struct SourceOp {
+		dependency_graph::UniqueId networkId;
+		std::shared_ptr<boost::filesystem::path> source, original;
+	};
+
+	struct Op {
+		Type type;
+		std::size_t index;
+	};
+
+	/// executes all operations in a batch; failing operations are removed if haltOnError is false
+	void execute(bool haltOnError, dependency_graph::State& errors);
+	/// undoes all operations in a batch, in reverse order
+	void undo();
+
+	void execute(const Op& op);
+	void undo(const Op& op);
+	std::string describe(const Op& op) const;
+
+	std::vector<Op> m_ops;
+
+	std::vector<NodeOp> m_nodes;
+	std::vector<ValueOp> m_values;
+	std::vector<ConnectOp> m_connections;
+	std::vector<SourceOp> m_sources;
+
+	// IDs of all nodes created by this construction
+	std::unordered_set<dependency_graph::UniqueId> m_createdIds;
+};
+
+}  // namespace detail
+}  // namespace actions
+}  // namespace possumwood
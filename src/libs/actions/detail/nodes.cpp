@@ -37,10 +37,12 @@ bool isCompatible(const dependency_graph::Metadata& m1, const dependency_graph::
 	return true;
 }
 
-dependency_graph::NodeBase& doCreateNode(
-    const dependency_graph::UniqueId& currentNetworkIndex, const dependency_graph::MetadataHandle& meta,
-    const std::string& name, const dependency_graph::UniqueId& id, const dependency_graph::Data& blindData,
-    boost::optional<const dependency_graph::Datablock> data = boost::optional<const dependency_graph::Datablock>()) {
+}  // namespace
+
+dependency_graph::NodeBase& doCreateNode(const dependency_graph::UniqueId& currentNetworkIndex,
+                                         const dependency_graph::MetadataHandle& meta, const std::string& name,
+                                         const dependency_graph::UniqueId& id, const dependency_graph::Data& blindData,
+                                         boost::optional<const dependency_graph::Datablock> data) {
 #ifndef NDEBUG
 	if(data) {
 		// assert(data->meta() == meta);
@@ -70,8 +72,7 @@ dependency_graph::NodeBase& doCreateNode(
 
 void doRemoveNode(const dependency_graph::UniqueId& id) {
 	auto& graph = possumwood::AppCore::instance().graph();
-	auto it = std::find_if(graph.nodes().begin(dependency_graph::Nodes::kRecursive), graph.nodes().end(),
-	                       [&](const dependency_graph::NodeBase& i) { return i.index() == id; });
+	auto it = graph.nodes().find(id, dependency_graph::Nodes::kRecursive);
 
 	assert(it != graph.nodes().end());
 
@@ -86,8 +87,6 @@ void doRemoveNode(const dependency_graph::UniqueId& id) {
 	it->network().nodes().erase(it);
 }
 
-}  // namespace
-
 possumwood::UndoStack::Action createNodeAction(const dependency_graph::UniqueId& currentNetworkId,
                                                const dependency_graph::MetadataHandle& meta, const std::string& name,
                                                const dependency_graph::Data& blindData,
@@ -190,8 +189,7 @@ namespace {
 void doRenameNode(const dependency_graph::UniqueId& id, std::shared_ptr<std::string> newName,
                   std::shared_ptr<std::string> originalName) {
 	auto& graph = possumwood::AppCore::instance().graph();
-	auto it = std::find_if(graph.nodes().begin(dependency_graph::Nodes::kRecursive), graph.nodes().end(),
-	                       [&](const dependency_graph::NodeBase& i) { return i.index() == id; });
+	auto it = graph.nodes().find(id, dependency_graph::Nodes::kRecursive);
 
 	assert(it != graph.nodes().end());
 
@@ -219,13 +217,10 @@ possumwood::UndoStack::Action renameNodeAction(const dependency_graph::UniqueId&
 	return action;
 }
 
-namespace {
-
 void doSetSource(const dependency_graph::UniqueId& nodeId, std::shared_ptr<boost::filesystem::path> newPath,
                  std::shared_ptr<boost::filesystem::path> originalPath) {
 	auto& graph = possumwood::AppCore::instance().graph();
-	auto it = std::find_if(graph.nodes().begin(dependency_graph::Nodes::kRecursive), graph.nodes().end(),
-	                       [&](const dependency_graph::NodeBase& i) { return i.index() == nodeId; });
+	auto it = graph.nodes().find(nodeId, dependency_graph::Nodes::kRecursive);
 
 	assert(it != graph.nodes().end());
 	assert(it->is<dependency_graph::Network>());
@@ -235,8 +230,6 @@ void doSetSource(const dependency_graph::UniqueId& nodeId, std::shared_ptr<boost
 	net.setSource(*newPath);
 }
 
-}  // namespace
-
 possumwood::UndoStack::Action setSourceAction(const dependency_graph::UniqueId& networkId,
                                               const boost::filesystem::path& path) {
 	possumwood::UndoStack::Action action;
@@ -31,6 +31,15 @@ possumwood::UndoStack::Action renameNodeAction(const dependency_graph::UniqueId&
 possumwood::UndoStack::Action setSourceAction(const dependency_graph::UniqueId& networkId,
                                               const boost::filesystem::path& source);
 
+// the implementation of the actions above (also used by Construction)
+dependency_graph::NodeBase& doCreateNode(
+    const dependency_graph::UniqueId& currentNetworkIndex, const dependency_graph::MetadataHandle& meta,
+    const std::string& name, const dependency_graph::UniqueId& id, const dependency_graph::Data& blindData,
+    boost::optional<const dependency_graph::Datablock> data = boost::optional<const dependency_graph::Datablock>());
+void doRemoveNode(const dependency_graph::UniqueId& id);
+void doSetSource(const dependency_graph::UniqueId& nodeId, std::shared_ptr<boost::filesystem::path> newPath,
+                 std::shared_ptr<boost::filesystem::path> originalPath);
+
 }  // namespace detail
 }  // namespace actions
 }  // namespace possumwood
@@ -8,8 +8,6 @@ namespace possumwood {
 namespace actions {
 namespace detail {
 
-namespace {
-
 void doSetValueFromJson(const dependency_graph::UniqueId& nodeId,
                         const std::string& portName,
                         const nlohmann::json& value,
@@ -55,6 +53,8 @@ void doSetValueFromJson(const dependency_graph::UniqueId& nodeId,
 		          << "' while loading a file. Ignoring its value." << std::endl;
 }
 
+namespace {
+
 void doSetValue(const dependency_graph::UniqueId& nodeId,
                 unsigned portId,
                 std::shared_ptr<const dependency_graph::Data> value,
@@ -105,6 +105,8 @@ void doResetValue(const dependency_graph::UniqueId& nodeId,
 	}
 }
 
+}  // namespace
+
 void doResetValueFromJson(const dependency_graph::UniqueId& nodeId,
                           const std::string& portName,
                           std::shared_ptr<dependency_graph::Data> value) {
@@ -141,8 +143,6 @@ void doResetValueFromJson(const dependency_graph::UniqueId& nodeId,
 	}
 }
 
-}  // namespace
-
 possumwood::UndoStack::Action setValueAction(dependency_graph::Port& port, const dependency_graph::Data& value) {
 	return setValueAction(port.node().index(), port.index(), value);
 }
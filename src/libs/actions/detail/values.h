@@ -20,6 +20,12 @@ possumwood::UndoStack::Action setValueAction(const dependency_graph::UniqueId& n
 possumwood::UndoStack::Action setValueAction(const dependency_graph::UniqueId& nodeId, const std::string& portName,
                                              const nlohmann::json& value);
 
+// the implementation of the JSON value action above (also used by Construction)
+void doSetValueFromJson(const dependency_graph::UniqueId& nodeId, const std::string& portName,
+                        const nlohmann::json& value, std::shared_ptr<dependency_graph::Data> original);
+void doResetValueFromJson(const dependency_graph::UniqueId& nodeId, const std::string& portName,
+                          std::shared_ptr<dependency_graph::Data> value);
+
 }  // namespace detail
 }  // namespace actions
 }  // namespace possumwood
@@ -3,7 +3,7 @@
 #include <boost/noncopyable.hpp>
 #include <cassert>
 #include <iostream>
-#include <sstream>
+#include <string>
 
 namespace possumwood {
 
@@ -12,16 +12,11 @@ void UndoStack::Action::addCommand(const std::string& name, const std::function<
 	assert(undo);
 	assert(redo);
 
-	m_undo.push_back(Data{name, undo});
-	m_redo.push_back(Data{name, redo});
+	m_commands.push_back(Command{name, redo, undo});
 }
 
 void UndoStack::Action::append(const Action& a) {
-	for(auto& c : a.m_undo)
-		m_undo.push_back(c);
-
-	for(auto& c : a.m_redo)
-		m_redo.push_back(c);
+	m_commands.insert(m_commands.end(), a.m_commands.begin(), a.m_commands.end());
 }
 
 //////////////////////////
@@ -34,14 +29,12 @@ UndoStack::UndoStack()
 }
 
 dependency_graph::State UndoStack::execute(const Action& input_action, bool haltOnError) {
-	// any action executed in this manner has to have m_undo and m_redo the same size
-	assert(input_action.m_redo.size() == input_action.m_undo.size());
-
 	dependency_graph::State state;
 	// construct an action to be pushed on the stack - when haltOnError is false, this action might not contain all
 	// undo/redo commands the input action does, as some parts might have errored and will now be skipped on next
 	// evaluation.
 	Action action;
+	action.m_commands.reserve(input_action.m_commands.size());
 
 #ifndef NDEBUG
 	assert(!m_executionInProgress);
@@ -49,75 +42,49 @@ dependency_graph::State UndoStack::execute(const Action& input_action, bool halt
 	m_executionInProgress = true;
 #endif
 
-	if(!input_action.m_undo.empty()) {
-		assert(input_action.m_undo.size() == input_action.m_redo.size());
-
-		// first, execute all commands in the undo part of the new action
-		for(std::size_t counter = 0; counter < input_action.m_redo.size(); ++counter) {
-			action.m_redo.push_back(input_action.m_redo[counter]);
-			action.m_undo.push_back(input_action.m_undo[counter]);
+	if(!input_action.m_commands.empty()) {
+		// first, execute all commands in the redo part of the new action
+		for(std::size_t counter = 0; counter < input_action.m_commands.size(); ++counter) {
+			const Action::Command& command = input_action.m_commands[counter];
 
+			std::string error;
 			try {
 				// just run the command
-				input_action.m_redo[counter].fn();
+				command.redo();
+
+				action.m_commands.push_back(command);
+				continue;
 			}
 			catch(const std::exception& err) {
-				std::stringstream ss;
-				ss << "Exception while running '" << input_action.m_redo[counter].name << "': " << err.what();
-
-				if(haltOnError) {
-					// an exception was caught during the last command - undo all previous commands
-					std::size_t rollback = counter;
-					while(rollback > 0) {
-						--rollback;
-
-						input_action.m_undo[rollback].fn();
-					}
-
-#ifndef NDEBUG
-					m_executionInProgress = false;
-#endif
-
-					// and rethrow the exception
-					throw std::runtime_error(ss.str());
-				}
-
-				else
-					state.addError(ss.str());
-
-				action.m_undo.pop_back();
-				action.m_redo.pop_back();
+				error = "Exception while running '" + command.name + "': " + err.what();
 			}
 			catch(...) {
-				std::stringstream ss;
-				ss << "Unhandled exception while running '" << input_action.m_redo[counter].name << "'.";
+				error = "Unhandled exception while running '" + command.name + "'.";
+			}
 
-				if(haltOnError) {
-					// an exception was caught during the last command - undo all previous commands
-					while(counter > 0) {
-						--counter;
+			if(haltOnError) {
+				// an exception was caught during the last command - undo all previous commands
+				std::size_t rollback = counter;
+				while(rollback > 0) {
+					--rollback;
 
-						input_action.m_undo[counter].fn();
-					}
+					input_action.m_commands[rollback].undo();
+				}
 
 #ifndef NDEBUG
-					m_executionInProgress = false;
+				m_executionInProgress = false;
 #endif
 
-					// and rethrow the exception
-					throw std::runtime_error(ss.str());
-				}
-
-				else
-					state.addError(ss.str());
-
-				action.m_undo.pop_back();
-				action.m_redo.pop_back();
+				// and rethrow the exception
+				throw std::runtime_error(error);
 			}
+
+			else
+				state.addError(error);
 		}
 
 		// if no exception was thrown during the execution, add this command to the undo stack
-		m_undoStack.push_back(action);
+		m_undoStack.push_back(std::move(action));
 		m_redoStack.clear();
 	}
 
@@ -137,12 +104,11 @@ void UndoStack::undo() {
 
 	// execute the last undo queue item
 	if(!m_undoStack.empty()) {
-		for(std::vector<UndoStack::Action::Data>::const_reverse_iterator it = m_undoStack.back().m_undo.rbegin();
-		    it != m_undoStack.back().m_undo.rend(); ++it)
-			it->fn();
+		for(auto it = m_undoStack.back().m_commands.rbegin(); it != m_undoStack.back().m_commands.rend(); ++it)
+			it->undo();
 
 		// and move it to the redo stack
-		m_redoStack.push_back(m_undoStack.back());
+		m_redoStack.push_back(std::move(m_undoStack.back()));
 		m_undoStack.pop_back();
 	}
 
@@ -160,12 +126,11 @@ void UndoStack::redo() {
 
 	// execute the last redo queue item
 	if(!m_redoStack.empty()) {
-		for(std::vector<Action::Data>::const_iterator it = m_redoStack.back().m_redo.begin();
-		    it != m_redoStack.back().m_redo.end(); ++it)
-			it->fn();
+		for(auto it = m_redoStack.back().m_commands.begin(); it != m_redoStack.back().m_commands.end(); ++it)
+			it->redo();
 
 		// and move it to the undo stack
-		m_undoStack.push_back(m_redoStack.back());
+		m_undoStack.push_back(std::move(m_redoStack.back()));
 		m_redoStack.pop_back();
 	}
 
@@ -192,7 +157,7 @@ void UndoStack::clear() {
 }
 
 std::ostream& operator<<(std::ostream& out, const UndoStack::Action& action) {
-	for(auto& a : action.m_undo)
+	for(auto& a : action.m_commands)
 		out << a.name << std::endl;
 
 	return out;
@@ -28,12 +28,12 @@ class UndoStack : public boost::noncopyable {
 		void append(const Action& a);
 
 	  private:
-		struct Data {
+		struct Command {
 			std::string name;
-			std::function<void()> fn;
+			std::function<void()> redo, undo;
 		};
 
-		std::vector<Data> m_redo, m_undo;
+		std::vector<Command> m_commands;
 
 		/// the actual implementation is handled in UndoStack code.
 		friend class UndoStack;
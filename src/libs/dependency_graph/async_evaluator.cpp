@@ -0,0 +1,523 @@
+#include "async_evaluator.h"
+
+#include <cassert>
+
+#include "datablock.h"
+#include "graph.h"
+#include "metadata.h"
+#include "network.h"
+#include "node_base.h"
+#include "port.h"
+#include "values.h"
+
+namespace dependency_graph {
+
+/// A single evaluation request - a snapshot of the values of all involved nodes, and a list of
+/// evaluation steps in dependency order
+struct AsyncEvaluator::Job {
+	struct Snapshot {
+		Snapshot(NodeBase& n) : node(&n), data(n.datablock()), computed(false) {
+		}
+
+		NodeBase* node;  // only dereferenced on the main thread
+		Datablock data;
+		// ports that need evaluation, and ports not evaluated yet
+		std::vector<bool> evaluate, dirty;
+
+		State state;
+		bool computed;
+	};
+
+	struct Step {
+		enum Type { kClean, kCopy, kCompute };
+
+		Type type;
+		std::size_t node, port;
+		// source of a kCopy step
+		std::size_t sourceNode, sourcePort;
+	};
+
+	Job(float scale) : cancellation(CancellationToken::create()), proxyScale(scale), failed(false) {
+	}
+
+	/// a full-resolution job replaces proxy values
+	bool refine() const {
+		return proxyScale >= 1.0f;
+	}
+
+	CancellationToken cancellation;
+	float proxyScale;
+
+	std::vector<Snapshot> nodes;
+	std::map<const NodeBase*, std::size_t> nodeIndex;
+
+	std::vector<Step> steps;
+	// result of planning of each visited port
+	std::map<const Port*, bool> visited;
+
+	bool failed;
+};
+
+AsyncEvaluator::AsyncEvaluator(Graph& graph, std::size_t threads)
+    : m_graph(&graph), m_proxyScale(1.0f), m_running(0), m_quit(false) {
+	// any change in the graph makes the in-flight snapshots out of date
+	m_connections.push_back(m_graph->onDirty([this]() { cancel(); }));
+	m_connections.push_back(m_graph->onValueChanged([this](Port&) { cancel(); }));
+	m_connections.push_back(m_graph->onAddNode([this](NodeBase&) { cancel(); }));
+	m_connections.push_back(m_graph->onRemoveNode([this](NodeBase& n) {
+		cancel();
+		removeProxies(n);
+	}));
+	m_connections.push_back(m_graph->onConnect([this](Port&, Port&) { cancel(); }));
+	m_connections.push_back(m_graph->onDisconnect([this](Port&, Port&) { cancel(); }));
+	m_connections.push_back(m_graph->onMetadataChanged([this](NodeBase& n) {
+		cancel();
+		removeProxies(n);
+	}));
+
+	for(std::size_t t = 0; t < std::max(threads, std::size_t(1)); ++t)
+		m_threads.push_back(std::thread([this]() { worker(); }));
+}
+
+AsyncEvaluator::~AsyncEvaluator() {
+	for(auto& c : m_connections)
+		c.disconnect();
+	for(auto& p : m_proxies)
+		p.second.dirtyConnection.disconnect();
+
+	cancel();
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_condition.notify_all();
+
+	for(auto& t : m_threads)
+		t.join();
+}
+
+std::size_t AsyncEvaluator::snapshot(Job& job, NodeBase& node) {
+	auto it = job.nodeIndex.find(&node);
+	if(it != job.nodeIndex.end())
+		return it->second;
+
+	job.nodes.push_back(Job::Snapshot(node));
+	job.nodeIndex.insert(std::make_pair(&node, job.nodes.size() - 1));
+
+	Job::Snapshot& snapshot = job.nodes.back();
+	for(std::size_t p = 0; p < node.portCount(); ++p) {
+		snapshot.evaluate.push_back(needsEvaluation(job, node.port(p)));
+
+		// proxy evaluation reads proxy values, even if already replaced by full-resolution ones
+		const Data* proxy = proxyValue(node.port(p));
+		if(!job.refine() && proxy != nullptr && !snapshot.evaluate.back())
+			snapshot.data.setData(p, *proxy);
+	}
+	snapshot.dirty = snapshot.evaluate;
+
+	return job.nodes.size() - 1;
+}
+
+bool AsyncEvaluator::needsEvaluation(const Job& job, const Port& port) const {
+	if(port.isDirty())
+		return true;
+
+	// full-resolution evaluation replaces the proxy values
+	if(job.refine())
+		return isProxy(port);
+
+	// proxy evaluation needs proxy values of everything upstream (apart from unconnected
+	// inputs, which are not affected by the scale)
+	if(port.category() == Attr::kInput && !port.isConnected() && !port.m_linkedFromPort)
+		return false;
+
+	return proxyValue(port) == nullptr;
+}
+
+bool AsyncEvaluator::plan(Job& job, Port& port) {
+	// follows the same rules as Port::getData(), returning true if the value of the port
+	// will be available after this job is evaluated
+
+	if(!needsEvaluation(job, port))
+		return true;
+
+	// already being evaluated by another job
+	if(m_planned.find(&port) != m_planned.end())
+		return false;
+
+	auto it = job.visited.find(&port);
+	if(it != job.visited.end())
+		return it->second;
+
+	const bool result = planDirty(job, port);
+	job.visited.insert(std::make_pair(&port, result));
+
+	return result;
+}
+
+bool AsyncEvaluator::planDirty(Job& job, Port& port) {
+	const std::size_t node = snapshot(job, port.node());
+
+	boost::optional<Port&> source;
+	if(port.category() == Attr::kInput && port.isConnected())
+		source = port.node().network().connections().connectedFrom(port);
+	else if(port.m_linkedFromPort)
+		source = *port.m_linkedFromPort;
+
+	// a value copied from another port
+	if(source) {
+		if(!plan(job, *source))
+			return false;
+
+		Job::Step step{Job::Step::kCopy, node, port.index(), snapshot(job, source->node()), source->index()};
+		job.steps.push_back(step);
+	}
+
+	// unconnected dirty input - just needs the flag to be reset
+	else if(port.category() == Attr::kInput) {
+		Job::Step step{Job::Step::kClean, node, port.index(), 0, 0};
+		job.steps.push_back(step);
+	}
+
+	// output computed by the node's compute() method
+	else {
+		// all dirty inputs are planned, even if some of them are not available, to get as much
+		// of the work done in the background as possible
+		bool available = true;
+		for(std::size_t i : port.node().metadata()->influencedBy(port.index()))
+			available &= plan(job, port.node().port(i));
+
+		const Metadata& meta = port.node().metadata();
+		if(!available || !meta.m_compute || !meta.m_backgroundCompute)
+			return false;
+
+		Job::Step step{Job::Step::kCompute, node, port.index(), 0, 0};
+		job.steps.push_back(step);
+	}
+
+	return true;
+}
+
+bool AsyncEvaluator::request(Port& port) {
+	if(!port.isDirty() && !isProxy(port))
+		return false;
+
+	// a proxy value can be used until its full-resolution evaluation finishes
+	if(m_planned.find(&port) != m_planned.end())
+		return port.isDirty();
+
+	std::shared_ptr<Job> job(new Job(port.isDirty() ? m_proxyScale : 1.0f));
+	plan(*job, port);
+
+	// planning stopped on ports being evaluated by other jobs - their results are needed first
+	bool pending = false;
+	for(auto& n : job->nodes)
+		for(std::size_t p = 0; p < n.node->portCount() && !pending; ++p)
+			pending = n.dirty[p] && m_planned.find(&n.node->port(p)) != m_planned.end();
+
+	// only worth running in the background if there is anything to compute (or proxy values to replace)
+	bool compute = false;
+	for(auto& s : job->steps)
+		compute |= (s.type == Job::Step::kCompute);
+
+	if(job->steps.empty() || (!compute && port.isDirty()))
+		return pending && port.isDirty();
+
+	schedule(job);
+
+	return port.isDirty();
+}
+
+void AsyncEvaluator::schedule(const std::shared_ptr<Job>& job) {
+	for(auto& s : job->steps)
+		m_planned.insert(std::make_pair(&job->nodes[s.node].node->port(s.port), job));
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_queue.push_back(job);
+	}
+	m_condition.notify_one();
+}
+
+void AsyncEvaluator::run(Job& job) const {
+	try {
+		for(auto& step : job.steps) {
+			if(job.cancellation.isCancelled())
+				return;
+
+			Job::Snapshot& target = job.nodes[step.node];
+
+			// computed already, as a side effect of computing another output of the same node
+			if(!target.dirty[step.port])
+				continue;
+
+			if(step.type == Job::Step::kCopy)
+				target.data.setData(step.port, job.nodes[step.sourceNode].data.data(step.sourcePort));
+
+			else if(step.type == Job::Step::kCompute) {
+				const Metadata& meta = target.data.meta().metadata();
+
+				State state;
+				try {
+					Values vals(*target.node, target.data, target.dirty, job.cancellation, job.proxyScale);
+					state = meta.m_compute(vals);
+				}
+				catch(std::exception& e) {
+					state.addError(e.what());
+				}
+
+				// errored - reset the output to default value (untyped ports keep their previous value)
+				if(state.errored() && meta.attr(step.port).type() != typeid(void))
+					target.data.reset(step.port);
+
+				target.state = state;
+				target.computed = true;
+			}
+
+			target.dirty[step.port] = false;
+		}
+	}
+	catch(std::exception&) {
+		// the snapshot is inconsistent - leave the evaluation to the main thread
+		job.failed = true;
+	}
+}
+
+bool AsyncEvaluator::apply(Job& job) {
+	bool changed = false;
+
+	std::vector<bool> applied(job.nodes.size(), false);
+	for(auto& step : job.steps) {
+		Job::Snapshot& snapshot = job.nodes[step.node];
+		NodeBase& node = *snapshot.node;
+
+		// all ports evaluated in the snapshot - outputs of a compute() are not evaluated one by one
+		std::vector<std::size_t> ports;
+		if(step.type != Job::Step::kCompute)
+			ports.push_back(step.port);
+		else if(!applied[step.node])
+			for(std::size_t p = 0; p < node.portCount(); ++p)
+				if(node.port(p).category() == Attr::kOutput)
+					ports.push_back(p);
+
+		for(std::size_t p : ports) {
+			Port& port = node.port(p);
+
+			// skips ports that were not evaluated, or that were evaluated on the main thread in the meantime
+			if(!snapshot.evaluate[p] || snapshot.dirty[p] || !needsEvaluation(job, port))
+				continue;
+
+			// proxy value of a port holding a full-resolution value - only kept for subsequent
+			// proxy evaluations
+			if(!job.refine() && !port.isDirty()) {
+				setProxy(port, snapshot.data.data(p), false);
+				continue;
+			}
+
+			// full-resolution value replacing a proxy - everything depending on it (and not
+			// evaluated by this job) needs to be evaluated again. This is not a change of the graph,
+			// and should not trigger its invalidation callbacks (cancelling all evaluations, clearing
+			// the frame cache).
+			if(job.refine() && !port.isDirty()) {
+				const Data proxy = m_proxies.at(&port).value;
+
+				node.datablock().setData(p, snapshot.data.data(p));
+				setProxy(port, proxy, false);
+				node.markAsDirty(p, true, false);
+			}
+
+			else {
+				if(step.type != Job::Step::kClean)
+					node.datablock().setData(p, snapshot.data.data(p));
+				port.setDirty(false);
+
+				if(!job.refine() && step.type != Job::Step::kClean)
+					setProxy(port, snapshot.data.data(p), true);
+			}
+
+			port.m_valueCallbacks();
+
+			changed = true;
+		}
+
+		if(step.type == Job::Step::kCompute && !applied[step.node]) {
+			applied[step.node] = true;
+
+			if(snapshot.computed && snapshot.state != node.m_state) {
+				node.m_state = snapshot.state;
+				m_graph->stateChanged(node);
+			}
+		}
+	}
+
+	return changed;
+}
+
+void AsyncEvaluator::release(const std::shared_ptr<Job>& job) {
+	auto it = m_planned.begin();
+	while(it != m_planned.end()) {
+		if(it->second == job)
+			it = m_planned.erase(it);
+		else
+			++it;
+	}
+}
+
+bool AsyncEvaluator::processResults() {
+	std::vector<std::shared_ptr<Job>> finished;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		finished.swap(m_finished);
+	}
+
+	bool changed = false;
+	for(auto& job : finished) {
+		// the ports of a failed job stay dirty, and are left to be pulled on the main thread
+		if(!job->cancellation.isCancelled() && !job->failed)
+			changed |= apply(*job);
+
+		release(job);
+	}
+
+	return changed;
+}
+
+void AsyncEvaluator::cancel() {
+	for(auto& p : m_planned)
+		p.second->cancellation.cancel();
+	m_planned.clear();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_queue.clear();
+}
+
+void AsyncEvaluator::setProxyScale(float scale) {
+	scale = std::max(std::min(scale, 1.0f), 0.01f);
+	if(scale == m_proxyScale)
+		return;
+
+	m_proxyScale = scale;
+
+	// proxy values of a different scale are not usable anymore - ports holding them need to be
+	// evaluated again (dirtying a port removes its proxy value)
+	std::vector<Port*> current;
+	for(auto it = m_proxies.begin(); it != m_proxies.end();) {
+		if(it->second.current) {
+			current.push_back(it->second.port);
+			++it;
+		}
+		else {
+			it->second.dirtyConnection.disconnect();
+			it = m_proxies.erase(it);
+		}
+	}
+
+	for(Port* p : current)
+		p->node().markAsDirty(p->index());
+}
+
+float AsyncEvaluator::proxyScale() const {
+	return m_proxyScale;
+}
+
+bool AsyncEvaluator::isProxy(const Port& port) const {
+	auto it = m_proxies.find(&port);
+	return it != m_proxies.end() && it->second.current;
+}
+
+void AsyncEvaluator::refine() {
+	// a single job - replacing a proxy value dirties everything downstream, which would otherwise
+	// be evaluated with proxy inputs again
+	std::shared_ptr<Job> job(new Job(1.0f));
+	for(auto& p : m_proxies)
+		if(p.second.current)
+			plan(*job, *p.second.port);
+
+	if(!job->steps.empty())
+		schedule(job);
+}
+
+const Data* AsyncEvaluator::proxyValue(const Port& port) const {
+	auto it = m_proxies.find(&port);
+	if(it == m_proxies.end())
+		return nullptr;
+	return &it->second.value;
+}
+
+void AsyncEvaluator::setProxy(Port& port, const Data& value, bool current) {
+	auto it = m_proxies.find(&port);
+	if(it == m_proxies.end()) {
+		Proxy proxy{&port, &port.node(), value, current, boost::signals2::connection()};
+
+		// a proxy value is valid only until the port becomes dirty
+		Port* p = &port;
+		proxy.dirtyConnection = port.flagsCallback([this, p]() {
+			if(p->isDirty()) {
+				auto it = m_proxies.find(p);
+				if(it != m_proxies.end()) {
+					it->second.dirtyConnection.disconnect();
+					m_proxies.erase(it);
+				}
+			}
+		});
+
+		m_proxies.insert(std::make_pair(&port, proxy));
+	}
+	else {
+		it->second.value = value;
+		it->second.current = current;
+	}
+}
+
+void AsyncEvaluator::removeProxies(const NodeBase& node) {
+	for(auto it = m_proxies.begin(); it != m_proxies.end();) {
+		if(it->second.node == &node) {
+			it->second.dirtyConnection.disconnect();
+			it = m_proxies.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+bool AsyncEvaluator::isBusy() const {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return !m_queue.empty() || m_running > 0 || !m_finished.empty();
+}
+
+boost::signals2::connection AsyncEvaluator::onFinished(std::function<void()> callback) {
+	return m_onFinished.connect(callback);
+}
+
+void AsyncEvaluator::worker() {
+	while(true) {
+		std::shared_ptr<Job> job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_quit || !m_queue.empty(); });
+
+			if(m_quit)
+				return;
+
+			job = m_queue.front();
+			m_queue.pop_front();
+
+			++m_running;
+		}
+
+		run(*job);
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_finished.push_back(job);
+
+			--m_running;
+		}
+
+		m_onFinished();
+	}
+}
+
+}  // namespace dependency_graph
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/noncopyable.hpp>
+#include <boost/signals2.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "data.h"
+
+namespace dependency_graph {
+
+class Graph;
+class NodeBase;
+class Port;
+
+/// Evaluates dirty ports in a pool of background threads, allowing the main thread (i.e., the UI)
+/// to keep using the last evaluated values until the new ones are ready.
+///
+/// A request collects the dirty ports that need evaluating, and takes a snapshot of the values
+/// of their nodes (Data instances are immutable and shared, so this is cheap). The snapshot is
+/// then evaluated in a worker thread via compute() methods of the nodes (which see "detached"
+/// Values instances), and the results are written back to the graph by processResults(), called
+/// from the main thread.
+///
+/// Any change of the graph cancels all in-flight evaluations - long-running nodes can test
+/// Values::isCancelled() to finish early. Nodes that don't allow background computation (see
+/// Metadata::setBackgroundCompute()) are left to be evaluated on the main thread.
+class AsyncEvaluator : public boost::noncopyable {
+  public:
+	AsyncEvaluator(Graph& graph, std::size_t threads = std::max(std::thread::hardware_concurrency() / 2, 1u));
+	~AsyncEvaluator();
+
+	/// Requests the evaluation of a port's value in the background. Returns true if an evaluation
+	/// is in progress (the port stays dirty until its results are applied), or false if there is
+	/// nothing to evaluate in the background (the port is not dirty, or the remaining work has to
+	/// be done on the main thread) and the value can be pulled directly.
+	bool request(Port& port);
+
+	/// Applies the results of all finished evaluations to the graph. Has to be called from the
+	/// thread owning the graph. Returns true if any value has changed.
+	bool processResults();
+
+	/// Called from a worker thread each time an evaluation finishes - the main thread should then
+	/// call processResults().
+	boost::signals2::connection onFinished(std::function<void()> callback);
+
+	/// Cancels all in-flight evaluations (called automatically on any change of the graph)
+	void cancel();
+
+	/// Enables progressive evaluation - each request is evaluated with a proxy scale first (see
+	/// Values::proxyScale()), providing a fast approximate result. A subsequent request of a port
+	/// holding a proxy value schedules its full-resolution evaluation, which replaces the proxy
+	/// values once finished. A scale of 1 (default) disables the proxy evaluation. Changing the
+	/// scale invalidates all proxy values.
+	void setProxyScale(float scale);
+	float proxyScale() const;
+
+	/// Returns true if the port holds a value from a proxy evaluation
+	bool isProxy(const Port& port) const;
+
+	/// Requests the full-resolution evaluation of all ports holding a proxy value (including the
+	/// ones not requested directly, e.g., inputs of nodes evaluated on the main thread)
+	void refine();
+
+	/// Returns true if any evaluation is in progress, or if there are results waiting to be applied
+	bool isBusy() const;
+
+  private:
+	struct Job;
+
+	/// proxy value of a port - kept while the port is not dirty, and used as an input of
+	/// proxy evaluations even after being replaced by the full-resolution value
+	struct Proxy {
+		Port* port;
+		const NodeBase* node;
+		Data value;
+		bool current;  // the port holds the proxy value
+		boost::signals2::connection dirtyConnection;
+	};
+
+	const Data* proxyValue(const Port& port) const;
+	void setProxy(Port& port, const Data& value, bool current);
+	void removeProxies(const NodeBase& node);
+
+	bool needsEvaluation(const Job& job, const Port& port) const;
+	bool plan(Job& job, Port& port);
+	bool planDirty(Job& job, Port& port);
+	std::size_t snapshot(Job& job, NodeBase& node);
+
+	void schedule(const std::shared_ptr<Job>& job);
+	void run(Job& job) const;
+	bool apply(Job& job);
+
+	void release(const std::shared_ptr<Job>& job);
+
+	void worker();
+
+	Graph* m_graph;
+
+	// ports being evaluated by in-flight jobs (main thread only)
+	std::map<const Port*, std::shared_ptr<Job>> m_planned;
+
+	float m_proxyScale;
+	std::map<const Port*, Proxy> m_proxies;  // main thread only
+
+	std::vector<std::thread> m_threads;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<std::shared_ptr<Job>> m_queue;
+	std::vector<std::shared_ptr<Job>> m_finished;
+	std::size_t m_running;
+	bool m_quit;
+
+	boost::signals2::signal<void()> m_onFinished;
+
+	std::vector<boost::signals2::connection> m_connections;
+};
+
+}  // namespace dependency_graph
@@ -0,0 +1,24 @@
+#include "cancellation_token.h"
+
+namespace dependency_graph {
+
+CancellationToken::CancellationToken() {
+}
+
+CancellationToken CancellationToken::create() {
+	CancellationToken result;
+	result.m_cancelled = std::make_shared<std::atomic<bool>>(false);
+
+	return result;
+}
+
+bool CancellationToken::isCancelled() const {
+	return m_cancelled != nullptr && m_cancelled->load();
+}
+
+void CancellationToken::cancel() {
+	if(m_cancelled != nullptr)
+		m_cancelled->store(true);
+}
+
+}  // namespace dependency_graph
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace dependency_graph {
+
+/// A cooperative cancellation flag, shared between the code requesting an evaluation and the
+/// code running it. Copies share the same flag. A default-constructed token is never cancelled.
+class CancellationToken {
+  public:
+	CancellationToken();
+
+	/// creates a new token, which can be cancelled
+	static CancellationToken create();
+
+	/// true if the evaluation this token belongs to was cancelled - the result will be thrown away
+	bool isCancelled() const;
+
+	/// cancels the evaluation (has no effect on a default-constructed token)
+	void cancel();
+
+  private:
+	std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+}  // namespace dependency_graph
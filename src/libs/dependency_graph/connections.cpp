@@ -1,5 +1,7 @@
 #include "connections.h"
 
+#include <algorithm>
+
 #include "graph.h"
 #include "port.h"
 
@@ -30,6 +32,9 @@ void Connections::add(Port& src, Port& dest) {
 	// make a new connection
 	m_connections.left.insert(std::make_pair(getId(src), getId(dest)));
 
+	src.m_connectedTo.push_back(&dest);
+	dest.m_connectedFrom = &src;
+
 	// and run the callback
 	m_parent->graph().connected(src, dest);
 }
@@ -51,33 +56,32 @@ void Connections::remove(Port& src, Port& dest) {
 
 	// and remove it
 	m_connections.right.erase(it);
+
+	src.m_connectedTo.erase(std::find(src.m_connectedTo.begin(), src.m_connectedTo.end(), &dest));
+	dest.m_connectedFrom = nullptr;
 }
 
 bool Connections::isConnected(const NodeBase& n) const {
-	for(auto& c : m_connections.left)
-		if(c.first.nodeIndex == n.index() || c.second.nodeIndex == n.index())
+	for(std::size_t p = 0; p < n.portCount(); ++p)
+		if(n.port(p).isConnected())
 			return true;
 	return false;
 }
 
-boost::optional<const Port&> Connections::connectedFrom(const Port& p) const {
-	auto it = m_connections.right.lower_bound(getId(p));
+// the adjacency stored in each port mirrors the content of m_connections, allowing
+// to traverse the connections without any lookups
 
-	if((it == m_connections.right.end()) || (it->first != getId(p)))
+boost::optional<const Port&> Connections::connectedFrom(const Port& p) const {
+	if(p.m_connectedFrom == nullptr)
 		return boost::optional<const Port&>();
-	else {
-		assert(m_connections.right.count(getId(p)) == 1);
-		return getPort(it->second);
-	}
+	return *p.m_connectedFrom;
 }
 
 std::vector<std::reference_wrapper<const Port>> Connections::connectedTo(const Port& p) const {
-	auto it1 = m_connections.left.lower_bound(getId(p));
-	auto it2 = m_connections.left.upper_bound(getId(p));
-
 	std::vector<std::reference_wrapper<const Port>> result;
-	for(auto it = it1; it != it2; ++it)
-		result.push_back(std::cref(getPort(it->second)));
+	result.reserve(p.m_connectedTo.size());
+	for(const Port* i : p.m_connectedTo)
+		result.push_back(std::cref(*i));
 	return result;
 }
 
@@ -85,26 +89,19 @@ boost::optional<Port&> Connections::connectedFrom(Port& p) {
 	if(p.category() != Attr::kInput)
 		throw std::runtime_error("Connected From request can be only run on input ports.");
 
-	auto it = m_connections.right.lower_bound(getId(p));
-
-	if((it == m_connections.right.end()) || (it->first != getId(p)))
+	if(p.m_connectedFrom == nullptr)
 		return boost::optional<Port&>();
-	else {
-		assert(m_connections.right.count(getId(p)) == 1);
-		return getPort(it->second);
-	}
+	return *p.m_connectedFrom;
 }
 
 std::vector<std::reference_wrapper<Port>> Connections::connectedTo(Port& p) {
 	if(p.category() != Attr::kOutput)
 		throw std::runtime_error("Connected To request can be only run on output ports.");
 
-	auto it1 = m_connections.left.lower_bound(getId(p));
-	auto it2 = m_connections.left.upper_bound(getId(p));
-
 	std::vector<std::reference_wrapper<Port>> result;
-	for(auto it = it1; it != it2; ++it)
-		result.push_back(std::ref(getPort(it->second)));
+	result.reserve(p.m_connectedTo.size());
+	for(Port* i : p.m_connectedTo)
+		result.push_back(std::ref(*i));
 	return result;
 }
 
@@ -17,7 +17,8 @@ class Network;
 
 /// A simple container class for all connections. It stores connections as pointers to related
 /// ports and does *not* ensure that these are valid in any way. An external mechanism needs
-/// to call appropriate functions when needed.
+/// to call appropriate functions when needed. Each connection is also mirrored in the adjacency
+/// of both its ports, making per-port queries independent of the size of the graph.
 class Connections : public boost::noncopyable {
   private:
 	struct PortId {
@@ -0,0 +1,173 @@
+#include "frame_cache.h"
+
+#include <algorithm>
+#include <set>
+
+#include "graph.h"
+#include "port.h"
+
+namespace dependency_graph {
+
+FrameCache::FrameCache(Graph& graph, std::size_t capacity)
+    : m_graph(&graph), m_capacity(capacity), m_coneValid(false), m_switching(false) {
+	m_connections.push_back(m_graph->onAddNode([this](NodeBase&) { invalidate(); }));
+	m_connections.push_back(m_graph->onRemoveNode([this](NodeBase&) { invalidate(); }));
+	m_connections.push_back(m_graph->onConnect([this](Port&, Port&) { invalidate(); }));
+	m_connections.push_back(m_graph->onDisconnect([this](Port&, Port&) { invalidate(); }));
+	m_connections.push_back(m_graph->onMetadataChanged([this](NodeBase&) { invalidate(); }));
+
+	m_connections.push_back(m_graph->onDirty([this]() {
+		if(!m_switching)
+			clear();
+	}));
+	m_connections.push_back(m_graph->onValueChanged([this](Port&) {
+		if(!m_switching)
+			clear();
+	}));
+}
+
+FrameCache::~FrameCache() {
+	for(auto& c : m_connections)
+		c.disconnect();
+}
+
+void FrameCache::setCapacity(std::size_t frames) {
+	m_capacity = frames;
+
+	while(m_order.size() > m_capacity) {
+		m_frames.erase(m_order.front());
+		m_order.pop_front();
+	}
+}
+
+std::size_t FrameCache::capacity() const {
+	return m_capacity;
+}
+
+void FrameCache::setFilter(const std::function<bool(const Port&)>& filter) {
+	m_filter = filter;
+}
+
+bool FrameCache::contains(float frame) const {
+	return m_frames.find(frame) != m_frames.end();
+}
+
+std::size_t FrameCache::size() const {
+	return m_frames.size();
+}
+
+void FrameCache::clear() {
+	m_frames.clear();
+	m_order.clear();
+}
+
+void FrameCache::invalidate() {
+	clear();
+
+	m_cone.clear();
+	m_coneValid = false;
+}
+
+void FrameCache::buildCone(const std::vector<std::reference_wrapper<Port>>& sources) {
+	m_cone.clear();
+
+	std::set<Port*> visited;
+	std::vector<Port*> stack;
+	for(auto& s : sources)
+		stack.push_back(&s.get());
+
+	// follows the same rules as NodeBase::markAsDirty()
+	while(!stack.empty()) {
+		Port* p = stack.back();
+		stack.pop_back();
+
+		if(visited.insert(p).second) {
+			m_cone.push_back(p);
+
+			if(p->category() == Attr::kInput) {
+				for(std::size_t i : p->node().metadata()->influences(p->index()))
+					stack.push_back(&p->node().port(i));
+			}
+			else
+				stack.insert(stack.end(), p->m_connectedTo.begin(), p->m_connectedTo.end());
+
+			if(p->isLinked())
+				stack.push_back(&p->linkedTo());
+		}
+	}
+
+	m_coneValid = true;
+}
+
+void FrameCache::store(float frame) {
+	std::vector<Data> values(m_cone.size());
+
+	// only evaluated values are stored - the set of non-dirty ports is always "closed" upstream,
+	// which means that restoring it keeps the dirtiness of the graph consistent (filtered ports
+	// are expected to be closed downstream, i.e., proxy values depend only on other proxy values)
+	bool empty = true;
+	for(std::size_t i = 0; i < m_cone.size(); ++i) {
+		const Port& p = *m_cone[i];
+		if(!p.isDirty() && !p.node().datablock().isNull(p.index()) && (!m_filter || m_filter(p))) {
+			values[i] = p.node().datablock().data(p.index());
+			empty = false;
+		}
+	}
+
+	if(empty)
+		return;
+
+	auto it = m_frames.find(frame);
+	if(it != m_frames.end())
+		it->second = std::move(values);
+	else {
+		m_frames.insert(std::make_pair(frame, std::move(values)));
+		m_order.push_back(frame);
+
+		setCapacity(m_capacity);
+	}
+}
+
+void FrameCache::restore(float frame) {
+	auto it = m_frames.find(frame);
+	if(it == m_frames.end())
+		return;
+
+	assert(it->second.size() == m_cone.size());
+	for(std::size_t i = 0; i < m_cone.size(); ++i)
+		if(!it->second[i].empty()) {
+			Port& p = *m_cone[i];
+
+			p.node().datablock().setData(p.index(), it->second[i]);
+			p.setDirty(false);
+
+			p.m_valueCallbacks();
+		}
+}
+
+void FrameCache::switchFrame(float current,
+                             float target,
+                             const std::vector<std::reference_wrapper<Port>>& sources,
+                             const std::function<void()>& setSources) {
+	if(m_capacity > 0) {
+		if(!m_coneValid)
+			buildCone(sources);
+
+		store(current);
+	}
+
+	m_switching = true;
+	try {
+		setSources();
+	}
+	catch(...) {
+		m_switching = false;
+		throw;
+	}
+	m_switching = false;
+
+	if(m_capacity > 0)
+		restore(target);
+}
+
+}  // namespace dependency_graph
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <boost/signals2.hpp>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "data.h"
+
+namespace dependency_graph {
+
+class Graph;
+class Port;
+
+/// A per-frame cache of evaluated values of all ports that depend on a set of "source" ports (i.e.,
+/// ports outputting time). When switching between frames, values of all ports that were already
+/// evaluated for the target frame are restored directly, without any recomputation.
+///
+/// The cache is cleared on any change that does not come from the sources - any topology change,
+/// or any explicit value change.
+class FrameCache : public boost::noncopyable {
+  public:
+	FrameCache(Graph& graph, std::size_t capacity = 24);
+	~FrameCache();
+
+	/// Maximum number of frames stored in the cache (0 disables caching). Evicts oldest frames if needed.
+	/// Each frame holds the values of all dependent ports, and their size is not known to the cache - the
+	/// default is kept small, and needs to be raised with care for scenes with large values (e.g., images).
+	void setCapacity(std::size_t frames);
+	std::size_t capacity() const;
+
+	/// Switches between two frames. Stores all evaluated values under the `current` frame, calls
+	/// `setSources` to change the source ports' values (which dirties all dependent ports), and
+	/// restores the values previously evaluated for the `target` frame, if any.
+	void switchFrame(float current,
+	                 float target,
+	                 const std::vector<std::reference_wrapper<Port>>& sources,
+	                 const std::function<void()>& setSources);
+
+	/// Values of ports for which the filter returns false are not stored (e.g., proxy values from a progressive
+	/// evaluation, see AsyncEvaluator::isProxy(), which would be restored as full-resolution results). Such ports
+	/// are evaluated again after switching to a cached frame.
+	void setFilter(const std::function<bool(const Port&)>& filter);
+
+	/// returns true if the cache holds values evaluated for a particular frame
+	bool contains(float frame) const;
+	/// number of frames currently cached
+	std::size_t size() const;
+
+	void clear();
+
+  private:
+	void buildCone(const std::vector<std::reference_wrapper<Port>>& sources);
+	void store(float frame);
+	void restore(float frame);
+
+	void invalidate();
+
+	Graph* m_graph;
+	std::size_t m_capacity;
+
+	// all ports depending on the sources, collected following the dirty propagation rules
+	std::vector<Port*> m_cone;
+	bool m_coneValid;
+
+	// values of the cone ports, in the same order as m_cone (empty Data for not-evaluated ports)
+	std::map<float, std::vector<Data>> m_frames;
+	// frames in order of insertion, for eviction
+	std::deque<float> m_order;
+
+	std::function<bool(const Port&)> m_filter;
+
+	// changes caused by switching frames don't invalidate the cache
+	bool m_switching;
+
+	std::vector<boost::signals2::connection> m_connections;
+};
+
+}  // namespace dependency_graph
@@ -12,9 +12,15 @@ struct Graph::Signals {
 	boost::signals2::signal<void(Port&, Port&)> m_onConnect, m_onDisconnect;
 	boost::signals2::signal<void()> m_onDirty;
 	boost::signals2::signal<void(const NodeBase&)> m_onStateChanged;
+	boost::signals2::signal<void(Port&)> m_onValueChanged;
 };
 
-Graph::Graph() : Network("network", UniqueId(), Network::defaultMetadata(), nullptr), m_signals(new Signals) {
+Graph::Graph()
+    : Network("network", UniqueId(), Network::defaultMetadata(), nullptr),
+      m_signals(new Signals),
+      m_batchDepth(0),
+      m_batchDirty(false),
+      m_flushingBatch(false) {
 }
 
 Graph::~Graph() {
@@ -53,6 +59,10 @@ boost::signals2::connection Graph::onStateChanged(std::function<void(const NodeB
 	return m_signals->m_onStateChanged.connect(callback);
 }
 
+boost::signals2::connection Graph::onValueChanged(std::function<void(Port&)> callback) {
+	return m_signals->m_onValueChanged.connect(callback);
+}
+
 boost::signals2::connection Graph::onMetadataChanged(std::function<void(NodeBase&)> callback) {
 	return m_signals->m_onMetadataChanged.connect(callback);
 }
@@ -78,7 +88,49 @@ void Graph::metadataChanged(NodeBase& node) {
 }
 
 void Graph::dirtyChanged() {
-	m_signals->m_onDirty();
+	if(m_batchDepth > 0 || m_flushingBatch)
+		m_batchDirty = true;
+	else
+		m_signals->m_onDirty();
+}
+
+void Graph::beginBatch() {
+	++m_batchDepth;
+}
+
+void Graph::endBatch() {
+	assert(m_batchDepth > 0);
+	--m_batchDepth;
+
+	if(m_batchDepth > 0)
+		return;
+
+	// propagate the deferred dirtiness (with the notifications still collected) - nodes removed within the
+	// batch are skipped
+	std::vector<PendingDirty> pending;
+	pending.swap(m_pendingDirty);
+
+	m_flushingBatch = true;
+	for(auto& p : pending) {
+		NodeBase* node = this;
+		if(p.node != index()) {
+			auto it = m_nodeIndex.find(p.node);
+			node = it != m_nodeIndex.end() ? it->second : nullptr;
+		}
+
+		if(node != nullptr && p.port < node->portCount())
+			node->markDependantsAsDirty(p.port, p.dependantsOnly, p.notify);
+	}
+	m_flushingBatch = false;
+
+	if(m_batchDirty) {
+		m_batchDirty = false;
+		m_signals->m_onDirty();
+	}
+}
+
+void Graph::valueChanged(Port& port) {
+	m_signals->m_onValueChanged(port);
 }
 
 void Graph::nodeAdded(NodeBase& node) {
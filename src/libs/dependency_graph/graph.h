@@ -3,6 +3,7 @@
 #include <boost/noncopyable.hpp>
 #include <boost/signals2.hpp>
 #include <functional>
+#include <unordered_map>
 #include <vector>
 
 #include "connections.h"
@@ -31,14 +32,26 @@ class Graph : public Network {
 	boost::signals2::connection onDirty(std::function<void()> callback);
 	/// per-node state change callback
 	boost::signals2::connection onStateChanged(std::function<void(const NodeBase&)> callback);
+	/// value change callback - called when a value is explicitly set on a port that did not require
+	/// evaluation (i.e., on any value change that is not a result of pulling on a dirty port)
+	boost::signals2::connection onValueChanged(std::function<void(Port&)> callback);
 
 	boost::signals2::connection onMetadataChanged(std::function<void(NodeBase&)> callback);
 
+	/// Starts a batch of bulk changes (e.g., scene loading or pasting of a large number of nodes).
+	/// The propagation of dirtiness to dependant ports is deferred until the matching endBatch() call,
+	/// where each change is propagated once, and the dirtiness callbacks (see onDirty()) are then called
+	/// only once. Ports downstream of a change are not dirty within a batch, so their values should not
+	/// be pulled before it ends. Batches can be nested.
+	void beginBatch();
+	void endBatch();
+
   private:
 	void nameChanged(NodeBase& node);
 	void stateChanged(NodeBase& node);
 	void metadataChanged(NodeBase& node);
 	void dirtyChanged();
+	void valueChanged(Port& port);
 	void nodeAdded(NodeBase& node);
 	void nodeRemoved(NodeBase& node);
 	void blindDataChanged(NodeBase& node);
@@ -49,11 +62,28 @@ class Graph : public Network {
 	struct Signals;
 	std::unique_ptr<Signals> m_signals;
 
+	// all nodes of this graph, including nodes in nested networks (maintained by Nodes instances)
+	std::unordered_map<UniqueId, NodeBase*> m_nodeIndex;
+
+	unsigned m_batchDepth;
+	bool m_batchDirty, m_flushingBatch;
+
+	// dirtiness propagation requests deferred by a batch (see NodeBase::markAsDirty())
+	struct PendingDirty {
+		UniqueId node;
+		std::size_t port;
+		bool dependantsOnly;
+		bool notify;
+	};
+	std::vector<PendingDirty> m_pendingDirty;
+
 	friend class NodeBase;
 	friend class Node;
 	friend class Nodes;
 	friend class Connections;
 	friend class Network;
+	friend class Port;
+	friend class AsyncEvaluator;
 };
 
 }  // namespace dependency_graph
@@ -8,7 +8,7 @@
 
 namespace dependency_graph {
 
-Metadata::Metadata(const std::string& nodeType) : m_type(nodeType) {
+Metadata::Metadata(const std::string& nodeType) : m_type(nodeType), m_backgroundCompute(false) {
 }
 
 Metadata::~Metadata() {
@@ -26,6 +26,14 @@ void Metadata::setCompute(std::function<State(Values&)> compute) {
 	m_compute = compute;
 }
 
+void Metadata::setBackgroundCompute(bool enabled) {
+	m_backgroundCompute = enabled;
+}
+
+bool Metadata::backgroundCompute() const {
+	return m_backgroundCompute;
+}
+
 size_t Metadata::attributeCount() const {
 	return m_attrs.size();
 }
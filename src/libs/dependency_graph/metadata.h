@@ -70,6 +70,12 @@ class Metadata : public boost::noncopyable, public std::enable_shared_from_this<
 	/// compute method of this node
 	void setCompute(std::function<State(Values&)> compute);
 
+	/// allows running the compute method outside of the main thread (see AsyncEvaluator; disabled
+	/// by default). Only nodes whose compute is known to be thread-safe (i.e., no OpenGL objects, no
+	/// global state such as redirected std::cout) should enable it.
+	void setBackgroundCompute(bool enabled);
+	bool backgroundCompute() const;
+
 	/// returns the number of attributes currently present
 	size_t attributeCount() const;
 
@@ -100,12 +106,15 @@ class Metadata : public boost::noncopyable, public std::enable_shared_from_this<
 	std::string m_type;
 	std::vector<Attr> m_attrs;
 	std::function<State(Values&)> m_compute;
+	bool m_backgroundCompute;
 
 	boost::bimap<boost::bimaps::multiset_of<unsigned>, boost::bimaps::multiset_of<unsigned>> m_influences;
 
 	friend class Node;
 	friend class NodeBase;
 	friend class Port;
+	friend class FrameCache;
+	friend class AsyncEvaluator;
 
 	/// allow actions to access untemplated doAddAttribute
 	friend struct detail::MetadataAccess;
@@ -46,7 +46,19 @@ void MetadataRegister::remove(const MetadataHandle& handle) {
 }
 
 MetadataRegister::const_iterator MetadataRegister::find(const std::string& nodeName) const {
-	return m_handles.find(nodeName);
+	auto it = m_handles.find(nodeName);
+
+	// the loader registers the type via add() - the register is only "logically" const here
+	if(it == m_handles.end() && m_loader) {
+		m_loader(nodeName);
+		it = m_handles.find(nodeName);
+	}
+
+	return it;
+}
+
+void MetadataRegister::setLoader(std::function<void(const std::string& nodeName)> loader) {
+	m_loader = loader;
 }
 
 MetadataRegister::const_iterator MetadataRegister::begin() const {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include "metadata.h"
 
 namespace dependency_graph {
@@ -16,6 +18,7 @@ class MetadataRegister {
 	};
 
 	std::set<MetadataHandle, Compare> m_handles;
+	std::function<void(const std::string&)> m_loader;
 
   public:
 	static MetadataRegister& singleton();
@@ -27,8 +30,14 @@ class MetadataRegister {
 	const_iterator begin() const;
 	const_iterator end() const;
 
+	/// Finds a node type. If the type is not registered and a loader is set, the loader is called first,
+	/// allowing it to register the type on demand (e.g., by loading a plugin).
 	const_iterator find(const std::string& nodeName) const;
 
+	/// Sets a function called when an unregistered node type is requested by find(). Pass an empty function
+	/// to remove the loader.
+	void setLoader(std::function<void(const std::string& nodeName)> loader);
+
   private:
 	MetadataRegister();
 };
@@ -24,15 +24,12 @@ NodeBase::~NodeBase() {
 }
 
 void NodeBase::disconnectAll() {
-	if(hasParentNetwork()) {
-		auto it = network().connections().begin();
-		while(it != network().connections().end())
-			if(&it->first.node() == this || &it->second.node() == this) {
-				it->first.disconnect(it->second);
-				it = network().connections().begin();  // inefficient!
-			}
-			else
-				++it;
+	for(auto& p : m_ports) {
+		if(p.m_connectedFrom)
+			p.m_connectedFrom->disconnect(p);
+
+		while(!p.m_connectedTo.empty())
+			p.disconnect(*p.m_connectedTo.back());
 	}
 }
 
@@ -81,7 +78,7 @@ UniqueId NodeBase::index() const {
 	return m_index;
 }
 
-void NodeBase::markAsDirty(size_t portIndex, bool dependantsOnly) {
+void NodeBase::markAsDirty(size_t portIndex, bool dependantsOnly, bool notify) {
 	Port& p = port(portIndex);
 
 	// mark the port itself as dirty
@@ -89,25 +86,37 @@ void NodeBase::markAsDirty(size_t portIndex, bool dependantsOnly) {
 		if(!dependantsOnly) {
 			p.setDirty(true);
 
-			graph().dirtyChanged();
+			if(notify)
+				graph().dirtyChanged();
 		}
 
-		// recurse + handle each port type slightly differently
-		if(p.category() == Attr::kInput) {
-			// all outputs influenced by this input are marked dirty
-			for(std::size_t i : metadata()->influences(p.index()))
-				markAsDirty(i);
-		}
-		else if(hasParentNetwork()) {
-			// all inputs connected to this output are marked dirty
-			for(Port& o : network().connections().connectedTo(port(portIndex)))
-				o.node().markAsDirty(o.index());
-		}
+		// within a batch, the propagation is deferred and done only once at its end (see Graph::beginBatch())
+		Graph& g = graph();
+		if(g.m_batchDepth > 0)
+			g.m_pendingDirty.push_back(Graph::PendingDirty{index(), portIndex, dependantsOnly, notify});
+		else
+			markDependantsAsDirty(portIndex, dependantsOnly, notify);
+	}
+}
 
-		// propagate to linked ports
-		if(p.isLinked())
-			p.linkedTo().node().markAsDirty(p.linkedTo().m_id, dependantsOnly);
+void NodeBase::markDependantsAsDirty(size_t portIndex, bool dependantsOnly, bool notify) {
+	Port& p = port(portIndex);
+
+	// recurse + handle each port type slightly differently
+	if(p.category() == Attr::kInput) {
+		// all outputs influenced by this input are marked dirty
+		for(std::size_t i : metadata()->influences(p.index()))
+			markAsDirty(i, false, notify);
+	}
+	else {
+		// all inputs connected to this output are marked dirty
+		for(Port* o : p.m_connectedTo)
+			o->node().markAsDirty(o->index(), false, notify);
 	}
+
+	// propagate to linked ports
+	if(p.isLinked())
+		p.linkedTo().node().markAsDirty(p.linkedTo().m_id, dependantsOnly, notify);
 }
 
 const MetadataHandle& NodeBase::metadata() const {
@@ -192,7 +201,7 @@ void NodeBase::computeInput(size_t index) {
 	assert(port(index).isConnected() && "input has to be connected to be computed");
 
 	// pull on the single connected output if needed
-	boost::optional<Port&> out = network().connections().connectedFrom(port(index));
+	Port* out = port(index).m_connectedFrom;
 	assert(out);
 	if(out->isDirty()) {
 		out->getData();  // throw away (bad)
@@ -98,8 +98,10 @@ class NodeBase {
 	// used by Port instances
 	void set(size_t index, const Data& value);
 
-	// used by Port instances
-	void markAsDirty(size_t portIndex, bool dependantsOnly = false);
+	// used by Port instances; notify = false skips the dirtiness callbacks of the graph (see Graph::onDirty())
+	void markAsDirty(size_t portIndex, bool dependantsOnly = false, bool notify = true);
+	// propagates the dirtiness of a port to its dependants (deferred by markAsDirty() during a graph batch)
+	void markDependantsAsDirty(size_t portIndex, bool dependantsOnly, bool notify);
 
 	// used during destruction
 	void disconnectAll();
@@ -118,8 +120,11 @@ class NodeBase {
 
 	// blind data access
 	// friend struct io::adl_serializer<NodeBase>;
+	friend class Graph;
 	friend class Nodes;
 	friend class Port;
+	friend class FrameCache;
+	friend class AsyncEvaluator;
 };
 
 }  // namespace dependency_graph
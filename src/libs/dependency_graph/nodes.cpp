@@ -49,6 +49,7 @@ NodeBase& Nodes::add(const MetadataHandle& type,
 	}
 
 	auto it = m_nodes.insert(std::move(node)).first;
+	m_parent->graph().m_nodeIndex.insert(std::make_pair((*it)->index(), it->get()));
 
 	m_parent->graph().nodeAdded(**it);
 	m_parent->graph().dirtyChanged();
@@ -68,6 +69,8 @@ Nodes::iterator Nodes::erase(const iterator& i) {
 	m_parent->graph().nodeRemoved(*i);
 	m_parent->graph().dirtyChanged();
 
+	m_parent->graph().m_nodeIndex.erase(i->index());
+
 	auto it = m_nodes.erase(i.base());
 	return Nodes::iterator(it, m_nodes.end(), false);
 }
@@ -97,13 +100,23 @@ Nodes::const_iterator Nodes::find(const UniqueId& id, const SearchType& st) cons
 	if(st == kThisNetwork)
 		return const_iterator(m_nodes.find(id), m_nodes.end(), false);
 
-	// linear search, for now
-	else {
-		auto it = begin(kRecursive);
-		while(it != end() && it->index() != id)
-			++it;
-		return it;
+	// the node is looked up in the graph-wide index, and the iterator is built by descending
+	// through its parent networks
+	auto it = m_parent->graph().m_nodeIndex.find(id);
+	if(it == m_parent->graph().m_nodeIndex.end())
+		return end();
+
+	std::vector<NodeBase*> path = networkPath(*it->second);
+	if(path.empty())
+		return end();
+
+	const_iterator result(m_nodes.find(path.back()->index()), m_nodes.end(), true);
+	for(auto n = path.rbegin() + 1; n != path.rend(); ++n) {
+		const Nodes& nodes = (*(n - 1))->as<Network>().nodes();
+		result.descend(nodes.m_nodes.find((*n)->index()), nodes.m_nodes.end());
 	}
+
+	return result;
 }
 
 Nodes::iterator Nodes::begin(const SearchType& st) {
@@ -118,13 +131,38 @@ Nodes::iterator Nodes::find(const UniqueId& id, const SearchType& st) {
 	if(st == kThisNetwork)
 		return Nodes::iterator(m_nodes.find(id), m_nodes.end(), false);
 
-	// linear search, for now
-	else {
-		auto it = begin(kRecursive);
-		while(it != end() && it->index() != id)
-			++it;
-		return it;
+	auto it = m_parent->graph().m_nodeIndex.find(id);
+	if(it == m_parent->graph().m_nodeIndex.end())
+		return end();
+
+	std::vector<NodeBase*> path = networkPath(*it->second);
+	if(path.empty())
+		return end();
+
+	iterator result(m_nodes.find(path.back()->index()), m_nodes.end(), true);
+	for(auto n = path.rbegin() + 1; n != path.rend(); ++n) {
+		Nodes& nodes = (*(n - 1))->as<Network>().nodes();
+		result.descend(nodes.m_nodes.find((*n)->index()), nodes.m_nodes.end());
+	}
+
+	return result;
+}
+
+std::vector<NodeBase*> Nodes::networkPath(NodeBase& node) const {
+	std::vector<NodeBase*> result;
+
+	NodeBase* current = &node;
+	while(current->hasParentNetwork()) {
+		result.push_back(current);
+
+		if(&current->network() == m_parent)
+			return result;
+
+		current = &current->network();
 	}
+
+	// not nested in this network
+	return std::vector<NodeBase*>();
 }
 
 NodeBase& Nodes::operator[](const dependency_graph::UniqueId& index) {
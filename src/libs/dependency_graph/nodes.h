@@ -5,6 +5,7 @@
 #include <boost/optional.hpp>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include "data.h"
 #include "node.h"
@@ -73,6 +74,9 @@ class Nodes : public boost::noncopyable {
   private:
 	Nodes(Network* parent);
 
+	/// returns the node and its parent networks nested in this network (empty if the node is not nested in it)
+	std::vector<NodeBase*> networkPath(NodeBase& node) const;
+
 	Network* m_parent;
 
 	// stored in a pointer container, to keep parent pointers
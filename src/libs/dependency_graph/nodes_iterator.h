@@ -33,7 +33,11 @@ class NodesIterator
 	std::stack<Item> m_its;
 	bool m_recursive;
 
+	// continues the iteration in a nested network (used to construct an iterator pointing to a nested node)
+	void descend(ITERATOR i, ITERATOR end);
+
 	friend class boost::iterator_core_access;
+	friend class Nodes;
 
 	void increment();
 	bool equal(const NodesIterator<ITERATOR>& other) const;
@@ -30,6 +30,12 @@ bool NodesIterator<ITERATOR>::NodesIterator::Item::operator!=(const Item& i) con
 	return current != i.current || end != i.end;
 }
 
+template <typename ITERATOR>
+void NodesIterator<ITERATOR>::descend(ITERATOR i, ITERATOR end) {
+	assert(m_recursive);
+	m_its.push(Item{i, end});
+}
+
 template <typename ITERATOR>
 void NodesIterator<ITERATOR>::increment() {
 	assert(!m_its.empty());
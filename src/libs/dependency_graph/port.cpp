@@ -1,5 +1,7 @@
 #include "port.inl"
 
+#include <algorithm>
+
 #include "graph.h"
 #include "io.h"
 #include "rtti.h"
@@ -11,11 +13,26 @@ Port::Port(unsigned id, NodeBase* parent)
       m_id(id),
       m_dirty(parent->metadata()->attr(id).category() == Attr::kOutput),
       m_linkedToPort(nullptr),
-      m_linkedFromPort(nullptr) {
+      m_linkedFromPort(nullptr),
+      m_connectedFrom(nullptr) {
 }
 
 Port::Port(Port&& p)
-    : m_parent(p.m_parent), m_id(p.m_id), m_dirty(p.m_dirty), m_linkedToPort(nullptr), m_linkedFromPort(nullptr) {
+    : m_parent(p.m_parent),
+      m_id(p.m_id),
+      m_dirty(p.m_dirty),
+      m_linkedToPort(nullptr),
+      m_linkedFromPort(nullptr),
+      m_connectedFrom(p.m_connectedFrom),
+      m_connectedTo(std::move(p.m_connectedTo)) {
+	// connected ports point to this port now
+	if(m_connectedFrom)
+		std::replace(m_connectedFrom->m_connectedTo.begin(), m_connectedFrom->m_connectedTo.end(), &p, this);
+	for(Port* i : m_connectedTo)
+		i->m_connectedFrom = this;
+	p.m_connectedFrom = nullptr;
+	p.m_connectedTo.clear();
+
 	if(p.m_linkedFromPort)
 		p.m_linkedFromPort->unlink();
 	if(p.m_linkedToPort)
@@ -69,14 +86,12 @@ std::type_index Port::type() const {
 	// void port "type" can be determined by any connected other ports
 	if(t == typeid(void)) {
 		if(category() == Attr::kInput) {
-			auto out = node().network().connections().connectedFrom(*this);
-			if(out)
-				t = out->type();
+			if(m_connectedFrom)
+				t = m_connectedFrom->type();
 		}
 		else if(category() == Attr::kOutput) {
-			auto in = node().network().connections().connectedTo(*this);
-			if(!in.empty())
-				t = in[0].get().type();
+			if(!m_connectedTo.empty())
+				t = m_connectedTo[0]->type();
 		}
 	}
 
@@ -130,6 +145,7 @@ void Port::setData(const Data& val) {
 
 	// set the value in the data block
 	const bool valueWasSet = (m_parent->get(m_id).type() != val.type()) || (m_parent->get(m_id) != val);
+	const bool wasDirty = isDirty();
 	m_parent->set(m_id, val);
 
 	// explicitly setting a value makes it not dirty, but makes everything that
@@ -142,6 +158,10 @@ void Port::setData(const Data& val) {
 	if(valueWasSet)
 		m_valueCallbacks();
 
+	// a change of a port that didn't need evaluation is an "external" change (not a result of a pull)
+	if(valueWasSet && !wasDirty)
+		m_parent->graph().valueChanged(*this);
+
 	// and make linked port dirty, to allow it to pull on next evaluation
 	if(isLinked())
 		m_linkedToPort->node().markAsDirty(m_linkedToPort->index());
@@ -182,10 +202,8 @@ void Port::connect(Port& p) {
 				if(current->category() == Attr::kInput)
 					for(std::size_t i : current->node().metadata()->influences(current->m_id))
 						newAddedPorts.insert(&current->node().port(i));
-				else {
-					for(Port& i : current->node().network().connections().connectedTo(*current))
-						newAddedPorts.insert(&i);
-				}
+				else
+					newAddedPorts.insert(current->m_connectedTo.begin(), current->m_connectedTo.end());
 			}
 
 			if(newAddedPorts.find(this) != newAddedPorts.end()) {
@@ -311,8 +329,7 @@ void Port::disconnect(Port& p) {
 
 bool Port::isConnected() const {
 	// return true if there are no connections leading to/from this input/output port
-	return m_parent->hasParentNetwork() && (static_cast<bool>(m_parent->network().connections().connectedFrom(*this)) ||
-	                                        not m_parent->network().connections().connectedTo(*this).empty());
+	return m_connectedFrom != nullptr || !m_connectedTo.empty();
 }
 
 void Port::linkTo(Port& targetPort) {
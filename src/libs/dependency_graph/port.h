@@ -4,6 +4,7 @@
 #include <boost/signals2.hpp>
 #include <string>
 #include <typeindex>
+#include <vector>
 
 #include "attr.h"
 
@@ -99,10 +100,17 @@ class Port : public boost::noncopyable {
 	Port* m_linkedToPort;
 	Port* m_linkedFromPort;
 
+	// adjacency of connections within the parent network, maintained by the Connections instance
+	Port* m_connectedFrom;
+	std::vector<Port*> m_connectedTo;
+
 	boost::signals2::signal<void()> m_valueCallbacks, m_flagsCallbacks;
 
 	friend class Node;
 	friend class NodeBase;
+	friend class Connections;
+	friend class FrameCache;
+	friend class AsyncEvaluator;
 };
 
 }  // namespace dependency_graph
@@ -20,6 +20,11 @@ Factories& factories() {
 	return *s_factories;
 };
 
+std::function<void(const std::string&)>& loader() {
+	static std::function<void(const std::string&)> s_loader;
+	return s_loader;
+}
+
 }  // namespace
 
 FactoryHandle StaticInitialisation::registerDataFactory(const std::string& type, std::function<Data()> fn) {
@@ -36,6 +41,12 @@ FactoryHandle StaticInitialisation::registerDataFactory(const std::string& type,
 Data StaticInitialisation::create(const std::string& type) {
 	auto it = factories().find(type);
 
+	// the loader registers the type via registerDataFactory()
+	if(it == factories().end() && loader()) {
+		loader()(type);
+		it = factories().find(type);
+	}
+
 	if(it == factories().end()) {
 		std::stringstream err;
 		err << "Error instantiating type '" << type << "' - no registered factory found (plugin not loaded?)";
@@ -46,4 +57,16 @@ Data StaticInitialisation::create(const std::string& type) {
 	return it->second.lock()->operator()();
 }
 
+std::set<std::string> StaticInitialisation::dataTypes() {
+	std::set<std::string> result;
+	for(auto& f : factories())
+		if(!f.second.expired())
+			result.insert(f.first);
+	return result;
+}
+
+void StaticInitialisation::setLoader(std::function<void(const std::string& type)> loader) {
+	dependency_graph::loader() = loader;
+}
+
 }  // namespace dependency_graph
@@ -3,6 +3,8 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
 
 #include "data.h"
 #include "factory_handle.h"
@@ -12,7 +14,16 @@ namespace dependency_graph {
 class StaticInitialisation {
   public:
 	static FactoryHandle registerDataFactory(const std::string& type, std::function<Data()> fn);
+	/// Creates an instance of a registered data type. If the type is not registered and a loader is set, the
+	/// loader is called first, allowing it to register the type on demand (e.g., by loading a plugin).
 	static Data create(const std::string& type);
+
+	/// Returns the names of all currently registered data types.
+	static std::set<std::string> dataTypes();
+
+	/// Sets a function called when an unregistered data type is requested by create(). Pass an empty function
+	/// to remove the loader.
+	static void setLoader(std::function<void(const std::string& type)> loader);
 };
 
 }  // namespace dependency_graph
@@ -2,28 +2,85 @@
 
 namespace dependency_graph {
 
-Values::Values(NodeBase& n) : m_node(&n) {
+Values::Values(NodeBase& n) : m_node(&n), m_data(nullptr), m_dirty(nullptr), m_proxyScale(1.0f), m_stale(false) {
 }
 
-Values::Values(Values&& vals) : m_node(vals.m_node) {
+Values::Values(NodeBase& n,
+               Datablock& data,
+               std::vector<bool>& dirty,
+               const CancellationToken& cancellation,
+               float proxyScale)
+    : m_node(&n),
+      m_data(&data),
+      m_dirty(&dirty),
+      m_cancellation(cancellation),
+      m_proxyScale(proxyScale),
+      m_stale(false) {
+}
+
+Values::Values(Values&& vals)
+    : m_node(vals.m_node),
+      m_data(vals.m_data),
+      m_dirty(vals.m_dirty),
+      m_cancellation(vals.m_cancellation),
+      m_proxyScale(vals.m_proxyScale),
+      m_stale(vals.m_stale) {
 }
 
 Values& Values::operator=(Values&& vals) {
 	m_node = vals.m_node;
+	m_data = vals.m_data;
+	m_dirty = vals.m_dirty;
+	m_cancellation = vals.m_cancellation;
+	m_proxyScale = vals.m_proxyScale;
+	m_stale = vals.m_stale;
 
 	return *this;
 }
 
 void Values::copy(const InAttr<void>& inAttr, const OutAttr<void>& outAttr) {
-	m_node->port(outAttr.offset()).setData(m_node->port(inAttr.offset()).getData());
+	setData(outAttr.offset(), data(inAttr.offset()));
 }
 
 const Data& Values::data(std::size_t index) const {
+	if(m_data)
+		return m_data->data(index);
+
+	if(m_stale) {
+		const NodeBase& node = *m_node;
+		return node.datablock().data(index);
+	}
+
 	return m_node->port(index).getData();
 }
 
 void Values::setData(std::size_t index, const Data& data) {
-	m_node->port(index).setData(data);
+	if(m_data) {
+		m_data->setData(index, data);
+		(*m_dirty)[index] = false;
+	}
+	else
+		m_node->port(index).setData(data);
+}
+
+bool Values::isCancelled() const {
+	return m_cancellation.isCancelled();
+}
+
+const CancellationToken& Values::cancellation() const {
+	return m_cancellation;
+}
+
+float Values::proxyScale() const {
+	return m_proxyScale;
+}
+
+void Values::setStale(bool stale) {
+	m_stale = stale;
+}
+
+bool Values::isStale() const {
+	return m_stale;
 }
 
 }  // namespace dependency_graph
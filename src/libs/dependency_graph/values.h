@@ -2,6 +2,7 @@
 
 #include <boost/noncopyable.hpp>
 
+#include "cancellation_token.h"
 #include "node.h"
 
 namespace dependency_graph {
@@ -52,8 +53,43 @@ class Values : public boost::noncopyable {
 	const Data& data(std::size_t index) const;
 	void setData(std::size_t index, const Data& data);
 
+	/// true if the current evaluation was cancelled (e.g., its inputs changed while it was running
+	/// in the background). A long-running compute() should test this periodically and return
+	/// early - the result of a cancelled evaluation is thrown away.
+	bool isCancelled() const;
+	const CancellationToken& cancellation() const;
+
+	/// Scale of images (or any other resolution-dependent data) produced by the current evaluation.
+	/// Lower than 1 in a fast approximate "proxy" evaluation (see AsyncEvaluator::setProxyScale()) -
+	/// source nodes should downscale their data, and nodes with size-dependent parameters (e.g.,
+	/// blur radius) should scale them accordingly. Always 1 for a normal evaluation.
+	float proxyScale() const;
+
+	/// In stale mode, get() returns the last evaluated values of ports without triggering any
+	/// evaluation (i.e., values of dirty ports might be out of date). Used for drawing while
+	/// the inputs are being evaluated in the background.
+	void setStale(bool stale);
+	bool isStale() const;
+
   private:
+	/// detached values - reads and writes go to a datablock instead of the node's ports, without
+	/// any evaluation or dirtiness propagation (used to run compute() outside of the main thread)
+	Values(NodeBase& n,
+	       Datablock& data,
+	       std::vector<bool>& dirty,
+	       const CancellationToken& cancellation,
+	       float proxyScale);
+
 	NodeBase* m_node;
+
+	Datablock* m_data;
+	std::vector<bool>* m_dirty;
+
+	CancellationToken m_cancellation;
+	float m_proxyScale;
+	bool m_stale;
+
+	friend class AsyncEvaluator;
 };
 
 }  // namespace dependency_graph
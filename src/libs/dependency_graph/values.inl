@@ -8,46 +8,52 @@ namespace dependency_graph {
 
 template <typename T>
 bool Values::isDirty(const OutAttr<T>& attr) const {
+	if(m_dirty)
+		return (*m_dirty)[attr.offset()];
+
 	return m_node->port(attr.offset()).isDirty();
 }
 
 template <typename T>
 const T& Values::get(const InAttr<T>& attr) const {
-	return m_node->port(attr.offset()).template get<T>();
+	return data(attr.offset()).template get<T>();
 }
 
 template <typename T>
 const T& Values::get(const OutAttr<T>& attr) const {
-	return m_node->port(attr.offset()).template get<T>();
+	return data(attr.offset()).template get<T>();
 }
 
 template <typename T>
 const T& Values::get(const InAttr<void>& attr) const {
-	return m_node->port(attr.offset()).template get<T>();
+	return data(attr.offset()).template get<T>();
 }
 
 template <typename T>
 void Values::set(const InAttr<T>& attr, const T& value) {
-	m_node->port(attr.offset()).set(value);
+	setData(attr.offset(), Data(value));
 }
 
 template <typename T>
 void Values::set(const OutAttr<T>& attr, const T& value) {
-	m_node->port(attr.offset()).set(value);
+	setData(attr.offset(), Data(value));
 }
 
 template <typename T>
 void Values::set(const OutAttr<T>& attr, T&& value) {
-	m_node->port(attr.offset()).set(std::move(value));
+	setData(attr.offset(), Data(std::move(value)));
 }
 
 template <typename T>
 void Values::set(const OutAttr<void>& attr, const T& value) {
-	m_node->port(attr.offset()).set(value);
+	setData(attr.offset(), Data(value));
 }
 
 template <typename T>
 bool Values::is(const TypedAttr<void>& attr) const {
+	if(m_data)
+		return !m_data->isNull(attr.offset()) && m_data->data(attr.offset()).typeinfo() == typeid(T);
+
 	return m_node->port(attr.offset()).type() == typeid(T);
 }
 
@@ -2,6 +2,9 @@
 
 #include <tbb/parallel_for.h>
 
+#include <array>
+#include <cassert>
+
 namespace lightfields {
 
 namespace {
@@ -85,75 +88,132 @@ Bayer::MozaicType Bayer::mozaic() const {
 	return m_mozaic;
 }
 
-cv::Mat Bayer::decode(const unsigned char* raw) const {
-	cv::Mat tmp(m_width, m_height, CV_16UC1);
+namespace {
+
+/// Unpacks a row of 12-bit big-endian packed values (two values in each 3 bytes). The row can start at an odd
+/// pixel index (if the width is odd), in which case the first value is the second half of a triplet.
+template <typename FN>
+void unpackRow(const unsigned char* raw, std::size_t begin, int width, FN&& fn) {
+	const unsigned char* src = raw + begin / 2 * 3;
+
+	int col = 0;
+	if(begin % 2 == 1) {
+		fn(col++, (uint16_t)(((src[1] & 0x0f) << 8) + src[2]));
+		src += 3;
+	}
 
-	tbb::parallel_for(0, m_width * m_height, [&](int i) {
-		const uint16_t c1 = raw[i / 2 * 3];
-		const uint16_t c2 = raw[i / 2 * 3 + 1];
-		const uint16_t c3 = raw[i / 2 * 3 + 2];
+	// main loop over whole triplets - no branching, allowing the compiler to vectorize it
+	for(; col + 1 < width; col += 2, src += 3) {
+		fn(col, (uint16_t)((src[0] << 4) + (src[1] >> 4)));
+		fn(col + 1, (uint16_t)(((src[1] & 0x0f) << 8) + src[2]));
+	}
 
-		uint16_t val;
-		if(i % 2 == 0)
-			val = (c1 << 4) + (c2 >> 4);
-		else
-			val = ((c2 & 0x0f) << 8) + c3;
+	if(col < width)
+		fn(col, (uint16_t)((src[0] << 4) + (src[1] >> 4)));
+}
+
+}  // namespace
 
-		tmp.at<uint16_t>(i / m_width, i % m_width) = val;
+cv::Mat Bayer::decode(const unsigned char* raw) const {
+	cv::Mat tmp(m_height, m_width, CV_16UC1);
+
+	tbb::parallel_for(tbb::blocked_range<int>(0, m_height), [&](const tbb::blocked_range<int>& range) {
+		for(int row = range.begin(); row != range.end(); ++row) {
+			uint16_t* target = tmp.ptr<uint16_t>(row);
+			unpackRow(raw, (std::size_t)row * m_width, m_width, [target](int col, uint16_t val) { target[col] = val; });
+		}
 	});
 
 	return tmp;
 }
 
+Bayer::Normalization Bayer::normalization(unsigned patternId, const Flags& f) const {
+	Normalization result;
+
+	// adjust based on normalized gain
+	// This is tricky - gain adjustment introduces "purple edges" in oversatureated
+	// regions. Needs more work.
+	result.gain = (f & kCorrectGain) ? m_gain[patternId] / m_gain.min : 1.0f;
+
+	result.black = m_black[patternId];
+	result.white = m_white[patternId];
+
+	return result;
+}
+
+float Bayer::Normalization::operator()(float fval) const {
+	fval *= gain;
+
+	// make sure the value is in black-white range to avoid negative values
+	if(fval < black)
+		fval = black;
+	if(fval > white)
+		fval = white;
+
+	// normalize to 0..1 for black..white
+	return (fval - black) / (white - black);
+}
+
+void Bayer::decodeRow(const unsigned char* raw, int row, const Flags& f, float* target) const {
+	assert(row >= 0 && row < m_height);
+
+	// the two normalization constants alternating in this row
+	const Normalization n[2] = {normalization(((row % 2) * 2 + (int)m_mozaic) % 4, f),
+	                            normalization((1 + (row % 2) * 2 + (int)m_mozaic) % 4, f)};
+
+	unpackRow(raw, (std::size_t)row * m_width, m_width,
+	          [target, &n](int col, uint16_t val) { target[col] = n[col % 2](val); });
+}
+
+cv::Mat Bayer::decode(const unsigned char* raw, const Flags& f) const {
+	cv::Mat result(m_height, m_width, CV_32FC1);
+
+	tbb::parallel_for(tbb::blocked_range<int>(0, m_height), [&](const tbb::blocked_range<int>& range) {
+		for(int row = range.begin(); row != range.end(); ++row)
+			decodeRow(raw, row, f, result.ptr<float>(row));
+	});
+
+	return result;
+}
+
+int Bayer::width() const {
+	return m_width;
+}
+
+int Bayer::height() const {
+	return m_height;
+}
+
 cv::Mat Bayer::uint16ToFloatMat(const cv::Mat& m, const Flags& f) const {
 	cv::Mat result = cv::Mat::zeros(m.rows, m.cols, CV_MAKETYPE(CV_32F, m.channels()));
 
-	tbb::parallel_for(tbb::blocked_range<int>(0, m_width * m_height),
-	                  [&result, &m, this, &f](const tbb::blocked_range<int>& range) {
-		                  for(int i = range.begin(); i != range.end(); ++i) {
-			                  const uint16_t* val = m.ptr<uint16_t>(i / m_width, i % m_width);
-
-			                  for(int chan = 0; chan < m.channels(); ++chan) {
-				                  float fval = val[chan];
-
-				                  // for 1-channel pics use bayer; 3-channel use the values directly
-				                  unsigned patternId;
-				                  if(m.channels() == 1)
-					                  patternId = ((i % m_width) % 2 + ((i / m_width) % 2) * 2 + (int)m_mozaic) % 4;
-				                  else {
-					                  switch(chan) {
-						                  case 0:
-							                  patternId = 0;  // blue
-							                  break;
-						                  case 1:
-							                  patternId = 1;  // green; assuming GB == GR
-							                  break;
-						                  case 2:
-							                  patternId = 3;  // red
-							                  break;
-					                  }
-				                  }
-
-				                  // adjust based on normalized gain
-				                  // This is tricky - gain adjustment introduces "purple edges" in oversatureated
-				                  // regions. Needs more work.
-				                  if(f & kCorrectGain)
-					                  fval *= m_gain[patternId] / m_gain.min;
-
-				                  // make sure the value is in black-white range to avoid negative values
-				                  if(fval < m_black[patternId])
-					                  fval = m_black[patternId];
-				                  if(fval > m_white[patternId])
-					                  fval = m_white[patternId];
-
-				                  // normalize to 0..1 for black..white
-				                  fval = (fval - m_black[patternId]) / (m_white[patternId] - m_black[patternId]);
-
-				                  // and set the output value
-				                  result.ptr<float>(i / m_width, i % m_width)[chan] = fval;
-			                  }
-		                  }
-	                  });
+	std::array<Normalization, 4> norm;
+	for(unsigned id = 0; id < 4; ++id)
+		norm[id] = normalization(id, f);
+
+	tbb::parallel_for(tbb::blocked_range<int>(0, m.rows), [&](const tbb::blocked_range<int>& range) {
+		for(int row = range.begin(); row != range.end(); ++row) {
+			const uint16_t* src = m.ptr<uint16_t>(row);
+			float* target = result.ptr<float>(row);
+
+			// for 1-channel pics use bayer; 3-channel use the values directly
+			if(m.channels() == 1) {
+				const Normalization n[2] = {norm[((row % 2) * 2 + (int)m_mozaic) % 4],
+				                            norm[(1 + (row % 2) * 2 + (int)m_mozaic) % 4]};
+
+				for(int col = 0; col < m.cols; ++col)
+					target[col] = n[col % 2](src[col]);
+			}
+			else {
+				// blue, green (assuming GB == GR) and red
+				const Normalization n[3] = {norm[0], norm[1], norm[3]};
+
+				for(int col = 0; col < m.cols; ++col)
+					for(int chan = 0; chan < 3; ++chan)
+						target[col * m.channels() + chan] = n[chan](src[col * m.channels() + chan]);
+			}
+		}
+	});
 
 	return result;
 }
@@ -14,12 +14,31 @@ class Bayer {
 	enum MozaicType { kBG = 0, kGB = 1, kGR = 2, kRG = 3 };
 	MozaicType mozaic() const;
 
+	/// Unpacks the 12-bit packed raw data into a CV_16UC1 matrix (rows are decoded in parallel)
 	cv::Mat decode(const unsigned char* raw) const;
 
 	enum Flags { kNone = 0, kCorrectGain = 1 };
 	cv::Mat uint16ToFloatMat(const cv::Mat& m, const Flags& f) const;
 
+	/// Fused decode - unpacks the raw data directly into a normalized CV_32FC1 matrix, without the intermediate
+	/// 16-bit image. Equivalent to uint16ToFloatMat(decode(raw), f).
+	cv::Mat decode(const unsigned char* raw, const Flags& f) const;
+	/// Fused decode of a single row of the image into a normalized float buffer of width() values
+	void decodeRow(const unsigned char* raw, int row, const Flags& f, float* target) const;
+
+	int width() const;
+	int height() const;
+
   private:
+	/// gain and black/white level normalization of a single pattern component
+	struct Normalization {
+		float gain, black, white;
+
+		float operator()(float value) const;
+	};
+
+	Normalization normalization(unsigned patternId, const Flags& f) const;
+
 	template <typename T>
 	struct Value {
 		Value();
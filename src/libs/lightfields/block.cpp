@@ -1,11 +1,15 @@
 #include "block.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace lightfields {
 
 std::istream& operator>>(std::istream& in, Block& block) {
 	// read the header
 	block.id = '\0';
 	block.name.clear();
+	block.size = 0;
 
 	unsigned char header[8];
 	in.read((char*)header, 8);
@@ -39,6 +43,7 @@ std::istream& operator>>(std::istream& in, Block& block) {
 		block.data = std::unique_ptr<unsigned char[]>(new unsigned char[length + 1]);
 		in.read((char*)block.data.get(), length);
 		block.data[length] = '\0';
+		block.size = length;
 
 		// handle any padding
 		while(in.tellg() % 16 != 0)
@@ -48,4 +53,43 @@ std::istream& operator>>(std::istream& in, Block& block) {
 	return in;
 }
 
+std::size_t read(const unsigned char* file, std::size_t fileSize, std::size_t offset, BlockView& block) {
+	block = BlockView();
+
+	if(offset + 16 > fileSize)
+		return fileSize;
+
+	const unsigned char* header = file + offset;
+	if(header[0] != 0x89 || header[1] != 'L' || header[2] != 'F')
+		throw std::runtime_error("Lytro file magic sequence not matching - wrong file type?");
+
+	block.id = header[3];
+
+	// skip the version, and read the big endian length
+	std::size_t length = 0;
+	for(std::size_t a = 12; a < 16; ++a)
+		length = (length << 8) + header[a];
+	offset += 16;
+
+	if(block.id != 'P') {
+		if(offset + 80 + length > fileSize)
+			throw std::runtime_error("Truncated Lytro file - block '" + std::string(1, block.id) +
+			                         "' extends past the end of the file.");
+
+		// the name is zero-padded to 80 bytes
+		const char* name = (const char*)file + offset;
+		block.name = std::string(name, std::find(name, name + 80, '\0'));
+		offset += 80;
+
+		block.data = file + offset;
+		block.size = length;
+		offset += length;
+
+		// handle any padding
+		offset = std::min((offset + 15) / 16 * 16, fileSize);
+	}
+
+	return offset;
+}
+
 }  // namespace lightfields
@@ -11,8 +11,21 @@ struct Block {
 	char id = '\0';
 	std::string name;
 	std::unique_ptr<unsigned char[]> data;
+	std::size_t size = 0;
 };
 
 std::istream& operator>>(std::istream& in, Block& block);
 
+/// A non-owning view of a block of data in a memory-mapped lightfields raw file
+struct BlockView {
+	char id = '\0';
+	std::string name;
+	const unsigned char* data = nullptr;
+	std::size_t size = 0;
+};
+
+/// Reads the header of a block at an offset of a memory-mapped file, without copying its data. Returns the offset
+/// of the next block (i.e., past the data and its padding), or the file size if there are no more blocks.
+std::size_t read(const unsigned char* file, std::size_t fileSize, std::size_t offset, BlockView& block);
+
 }  // namespace lightfields
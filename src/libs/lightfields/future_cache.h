@@ -0,0 +1,91 @@
+#pragma once
+
+#include <tbb/task_arena.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace lightfields {
+
+/// A small in-memory cache of expensive shared values, keeping a number of recently used entries (keys are
+/// compared using operator==, so the cache is intended for a handful of entries only).
+///
+/// A missing value is built outside of the cache lock, and concurrent requests for the same key wait for its
+/// future instead, without blocking requests for other keys. Failed builds are not cached, but all current
+/// waiters receive the exception.
+template <typename KEY, typename VALUE>
+class FutureCache : public boost::noncopyable {
+  public:
+	explicit FutureCache(std::size_t size) : m_size(size) {
+	}
+
+	/// returns a cached value (moving it to the front), or creates it using the create functor
+	template <typename FN>
+	std::shared_ptr<const VALUE> get(const KEY& key, FN create) {
+		std::shared_ptr<Entry> entry;
+		std::promise<std::shared_ptr<const VALUE>> promise;
+		bool build = false;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			auto it = std::find_if(m_entries.begin(), m_entries.end(),
+			                       [&key](const std::shared_ptr<Entry>& e) { return e->key == key; });
+
+			if(it != m_entries.end()) {
+				m_entries.splice(m_entries.begin(), m_entries, it);
+				entry = m_entries.front();
+			}
+			else {
+				entry = std::make_shared<Entry>(Entry{key, promise.get_future().share()});
+				build = true;
+
+				m_entries.push_front(entry);
+				while(m_entries.size() > m_size)
+					m_entries.pop_back();
+			}
+		}
+
+		// waiting for a value built by another thread happens outside the lock
+		if(!build)
+			return entry->value.get();
+
+		try {
+			// isolated - while waiting inside a parallel_for of the construction, this thread can't pick up an
+			// outer task requesting the same key (which would wait for this entry forever)
+			std::shared_ptr<const VALUE> value;
+			tbb::this_task_arena::isolate([&]() { value = create(); });
+
+			promise.set_value(value);
+		}
+		catch(...) {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_entries.remove(entry);
+			}
+
+			promise.set_exception(std::current_exception());
+		}
+
+		return entry->value.get();
+	}
+
+  private:
+	struct Entry {
+		KEY key;
+		std::shared_future<std::shared_ptr<const VALUE>> value;
+	};
+
+	std::size_t m_size;
+
+	std::mutex m_mutex;
+	std::list<std::shared_ptr<Entry>> m_entries;
+};
+
+}  // namespace lightfields
@@ -1,9 +1,11 @@
 #include "mrf.h"
 
-#include <tbb/blocked_range2d.h>
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 #include <time.h>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <limits>
@@ -42,14 +44,14 @@ MRF::Value& MRF::operator[](const V2i& index) {
 	assert(index.x >= 0 && index.x < m_size.x);
 	assert(index.y >= 0 && index.y < m_size.y);
 
-	return m_nodes[index.x + index.y * m_size.y];
+	return m_nodes[index.x + index.y * m_size.x];
 }
 
 const MRF::Value& MRF::operator[](const V2i& index) const {
 	assert(index.x >= 0 && index.x < m_size.x);
 	assert(index.y >= 0 && index.y < m_size.y);
 
-	return m_nodes[index.x + index.y * m_size.y];
+	return m_nodes[index.x + index.y * m_size.x];
 }
 
 const V2i& MRF::size() const {
@@ -69,38 +71,89 @@ std::pair<int, int> MRF::range() const {
 
 namespace {
 
-float evalICM(const MRF& source,
-              const cv::Mat& state,
-              const V2i& pos,
-              float inputsWeight,
-              float flatnessWeight,
-              float smoothnessWeight,
-              const Neighbours& neighbours) {
+/// A neighbourhood of a grid, evaluated using a compile-time Stencil
+template <typename STENCIL, bool CHECKED>
+struct Neighbourhood {
+	template <typename FN>
+	void operator()(const V2i& pos, FN&& fn) const {
+		STENCIL::template eval<CHECKED>(pos, size, fn);
+	}
+
+	V2i size;
+};
+
+/// Evaluates fn(pos, neighbourhood) for each pixel of a grid, in parallel over blocks of rows. Only the pixels on the
+/// border of the grid use a bounds-checked neighbourhood - the interior of each row is evaluated without any tests.
+template <typename STENCIL, typename FN>
+void forEachPixel(const V2i& size, const FN& fn) {
+	const Neighbourhood<STENCIL, true> border{size};
+	const Neighbourhood<STENCIL, false> interior{size};
+
+	tbb::parallel_for(tbb::blocked_range<int>(0, size.y), [&](const tbb::blocked_range<int>& range) {
+		for(int y = range.begin(); y != range.end(); ++y) {
+			if(y == 0 || y == size.y - 1 || size.x < 3)
+				for(int x = 0; x < size.x; ++x)
+					fn(V2i(x, y), border);
+
+			else {
+				fn(V2i(0, y), border);
+				for(int x = 1; x < size.x - 1; ++x)
+					fn(V2i(x, y), interior);
+				fn(V2i(size.x - 1, y), border);
+			}
+		}
+	});
+}
+
+template <typename STENCIL, typename NEIGHBOURHOOD>
+unsigned char evalICM(const MRF& source,
+                      const cv::Mat& state,
+                      const V2i& pos,
+                      float inputsWeight,
+                      float flatnessWeight,
+                      float smoothnessWeight,
+                      const NEIGHBOURHOOD& neighbourhood) {
+	const int current = state.ptr<unsigned char>(pos.y)[pos.x];
+
+	// collect the neighbourhood values only once
+	std::array<int, STENCIL::count> values;
+	std::array<float, STENCIL::count> weights;
+	unsigned count = 0;
+	neighbourhood(pos, [&](const V2i& n, float weight) {
+		values[count] = state.ptr<unsigned char>(n.y)[n.x];
+		weights[count] = weight;
+		++count;
+	});
+
 	// first find the min and max candidates
 	MinMax minmax(source[pos].value);
-	minmax.add(state.at<unsigned char>(pos.y, pos.x));
-	neighbours.eval(pos, [&](const V2i& pos, float weight) { minmax.add(state.at<unsigned char>(pos.y, pos.x)); });
+	minmax.add(current);
+	for(unsigned n = 0; n < count; ++n)
+		minmax.add(values[n]);
+
+	// normalisation factors don't depend on the candidate value
+	float e_flat_norm = 0, e_smooth_norm = 0;
+	for(unsigned n = 0; n < count; ++n) {
+		e_flat_norm += weights[n];
+		e_smooth_norm += 1.0f + weights[n];
+	}
 
 	// get the min energy value
 	float energy = std::numeric_limits<float>::max();
-	int label = state.at<unsigned char>(pos.y, pos.x);
+	int label = current;
 	for(int val = minmax.min; val <= minmax.max; ++val) {
 		// inputs term
 		const int e_inputs = std::abs(source[pos].value - val);
 
 		// flatness term
-		float e_flat = 0, e_flat_norm = 0;
-		neighbours.eval(pos, [&](const V2i& pos, float weight) {
-			e_flat += std::abs(val - state.at<unsigned char>(pos.y, pos.x)) * weight;
-			e_flat_norm += weight;
-		});
+		float e_flat = 0;
+		for(unsigned n = 0; n < count; ++n)
+			e_flat += std::abs(val - values[n]) * weights[n];
 
 		// smoothness term (laplacian)
-		float e_smooth = 0, e_smooth_norm = 0;
-		neighbours.eval(pos, [&](const V2i& pos, float weight) {
-			e_smooth += (val - state.at<unsigned char>(pos.y, pos.x)) * weight;
-			++e_smooth_norm += weight;
-		});
+		float e_smooth = 0;
+		for(unsigned n = 0; n < count; ++n)
+			e_smooth += (val - values[n]) * weights[n];
 
 		// putting them all together
 		const float e =
@@ -119,14 +172,12 @@ float evalICM(const MRF& source,
 	return label;
 }
 
-}  // namespace
-
-cv::Mat MRF::solveICM(const MRF& source,
-                      float inputsWeight,
-                      float flatnessWeight,
-                      float smoothnessWeight,
-                      std::size_t iterationLimit,
-                      const Neighbours& neighbourhood) {
+template <typename STENCIL>
+cv::Mat solveICM(const MRF& source,
+                 float inputsWeight,
+                 float flatnessWeight,
+                 float smoothnessWeight,
+                 std::size_t iterationLimit) {
 	cv::Mat state = cv::Mat::zeros(source.size().y, source.size().x, CV_8UC1);
 
 	cv::Mat result = cv::Mat::zeros(source.size().y, source.size().x, CV_8UC1);
@@ -137,27 +188,39 @@ cv::Mat MRF::solveICM(const MRF& source,
 	for(std::size_t it = 0; it < iterationLimit; ++it) {
 		cv::swap(result, state);
 
-		tbb::parallel_for(tbb::blocked_range2d<int>(0, source.size().y, 0, source.size().x),
-		                  [&](const tbb::blocked_range2d<int>& range) {
-			                  for(int y = range.rows().begin(); y != range.rows().end(); ++y)
-				                  for(int x = range.cols().begin(); x != range.cols().end(); ++x)
-					                  result.at<unsigned char>(y, x) =
-					                      evalICM(source, state, V2i(x, y), inputsWeight, flatnessWeight,
-					                              smoothnessWeight, neighbourhood);
-		                  });
+		forEachPixel<STENCIL>(source.size(), [&](const V2i& pos, const auto& neighbourhood) {
+			result.ptr<unsigned char>(pos.y)[pos.x] = evalICM<STENCIL>(source, state, pos, inputsWeight,
+			                                                           flatnessWeight, smoothnessWeight, neighbourhood);
+		});
 	}
 
 	return result;
 }
 
+}  // namespace
+
+cv::Mat MRF::solveICM(const MRF& source,
+                      float inputsWeight,
+                      float flatnessWeight,
+                      float smoothnessWeight,
+                      std::size_t iterationLimit,
+                      const Neighbours& neighbourhood) {
+	return dispatch(neighbourhood.type(), [&](auto stencil) {
+		return lightfields::solveICM<decltype(stencil)>(source, inputsWeight, flatnessWeight, smoothnessWeight,
+		                                                iterationLimit);
+	});
+}
+
 ///////////////////////
 
-cv::Mat MRF::solvePropagation(const MRF& source,
-                              float inputsWeight,
-                              float flatnessWeight,
-                              float smoothnessWeight,
-                              std::size_t iterationLimit,
-                              const Neighbours& neighbourhood) {
+namespace {
+
+template <typename STENCIL>
+cv::Mat solvePropagation(const MRF& source,
+                         float inputsWeight,
+                         float flatnessWeight,
+                         float smoothnessWeight,
+                         std::size_t iterationLimit) {
 	// find the range of values
 	const std::pair<int, int> minmax = source.range();
 
@@ -174,31 +237,24 @@ cv::Mat MRF::solvePropagation(const MRF& source,
 	for(std::size_t it = 0; it < iterationLimit; ++it) {
 		grid.swap(state);
 
-		tbb::parallel_for(tbb::blocked_range2d<unsigned>(0u, grid.rows(), 0u, grid.cols()),
-		                  [&](const tbb::blocked_range2d<unsigned>& range) {
-			                  for(unsigned y = range.rows().begin(); y != range.rows().end(); ++y)
-				                  for(unsigned x = range.cols().begin(); x != range.cols().end(); ++x) {
-					                  PMF current = PMF::fromConfidence(source[V2i(x, y)].confidence,
-					                                                    source[V2i(x, y)].value, minmax.second + 1);
+		forEachPixel<STENCIL>(source.size(), [&](const V2i& pos, const auto& neighbourhood) {
+			PMF current = PMF::fromConfidence(source[pos].confidence, source[pos].value, minmax.second + 1);
 
-					                  // PMF flatness = PMF(minmax.second+1);
-					                  // float norm = 0.0f;
+			// PMF flatness = PMF(minmax.second+1);
+			// float norm = 0.0f;
 
-					                  // neighbourhood.eval(V2i(x, y), [&](const V2i& pos, float weight) {
-					                  // 	flatness = PMF::combine(flatness, norm, state(pos.y, pos.x), weight);
-					                  // 	norm += weight;
-					                  // });
+			// neighbourhood(pos, [&](const V2i& n, float weight) {
+			// 	flatness = PMF::combine(flatness, norm, state(n.y, n.x), weight);
+			// 	norm += weight;
+			// });
 
-					                  PMF flatness = PMF(minmax.second + 1);
-					                  neighbourhood.eval(V2i(x, y), [&](const V2i& pos, float weight) {
-						                  flatness = flatness * state(pos.y, pos.x);
-					                  });
+			PMF flatness = PMF(minmax.second + 1);
+			neighbourhood(pos, [&](const V2i& n, float weight) { flatness = flatness * state(n.y, n.x); });
 
-					                  current = PMF::combine(current, inputsWeight, flatness, flatnessWeight);
+			current = PMF::combine(current, inputsWeight, flatness, flatnessWeight);
 
-					                  grid(y, x) = current;
-				                  }
-		                  });
+			grid(pos.y, pos.x) = current;
+		});
 	}
 
 	// convert the result to a cv::Mat by picking the highest probability for each pixel
@@ -209,6 +265,20 @@ cv::Mat MRF::solvePropagation(const MRF& source,
 	return result;
 }
 
+}  // namespace
+
+cv::Mat MRF::solvePropagation(const MRF& source,
+                              float inputsWeight,
+                              float flatnessWeight,
+                              float smoothnessWeight,
+                              std::size_t iterationLimit,
+                              const Neighbours& neighbourhood) {
+	return dispatch(neighbourhood.type(), [&](auto stencil) {
+		return lightfields::solvePropagation<decltype(stencil)>(source, inputsWeight, flatnessWeight,
+		                                                        smoothnessWeight, iterationLimit);
+	});
+}
+
 namespace {
 
 // A thread safe function generating random offsets required for the diffusion to work correctly
@@ -222,94 +292,66 @@ int randomOffset(int max) {
 	return distribution(*s_generator);
 }
 
-}  // namespace
-
-cv::Mat MRF::solvePDF(const MRF& source,
-                      float inputsWeight,
-                      float flatnessWeight,
-                      float smoothnessWeight,
-                      std::size_t iterationLimit,
-                      const Neighbours& neighbourhood) {
+template <typename STENCIL>
+cv::Mat solvePDF(const MRF& source,
+                 float inputsWeight,
+                 float flatnessWeight,
+                 float smoothnessWeight,
+                 std::size_t iterationLimit) {
 	const float totalWeight = inputsWeight + flatnessWeight + smoothnessWeight;
 	if(totalWeight > 1.0f)
 		throw std::runtime_error("Weights should sum to less than 1.0");
 
-	// find the range of values
-	const std::pair<int, int> minmax = source.range();
-
 	// build a grid of probability mass functions
 	Grid<PDFGaussian> grid(source.size().y, source.size().x, PDFGaussian(0, 0));
 	for(int y = 0; y < source.size().y; ++y)
 		for(int x = 0; x < source.size().x; ++x)
 			grid(y, x) = PDFGaussian::fromConfidence(source[V2i(x, y)].value, source[V2i(x, y)].confidence);
 
-	// todo: the main algorithm
-	const JointPMF diff = JointPMF::difference(minmax.second + 1);
-
 	Grid<PDFGaussian> state = grid;
 	for(std::size_t it = 0; it < iterationLimit; ++it) {
 		grid.swap(state);
 
-		tbb::parallel_for(
-		    tbb::blocked_range2d<unsigned>(0u, grid.rows(), 0u, grid.cols()),
-		    [&](const tbb::blocked_range2d<unsigned>& range) {
-			    for(unsigned y = range.rows().begin(); y != range.rows().end(); ++y)
-				    for(unsigned x = range.cols().begin(); x != range.cols().end(); ++x) {
-					    float weightSum = 0.0f, weightMax = 0.0f;
-					    neighbourhood.eval(V2i(x, y), [&](const V2i& pos, float weight) {
-						    weightSum += weight;
-						    weightMax = std::max(weightMax, weight);
-					    });
-
-					    // stick to the original value
-					    const PDFGaussian constness =
-					        PDFGaussian::fromConfidence(source[V2i(x, y)].value, source[V2i(x, y)].confidence);
-
-					    PDFGaussian flatness = PDFGaussian::fromConfidence(0, 0);
-					    if(flatnessWeight > 0.0f) {
-						    // need to permutate the order of evaluation - otherwise I'll end up with directional bias
-						    // (whole image "shifting") (yes, this will introduce some randomness to the result, but at
-						    // least it will look correct)
-						    std::array<std::pair<V2i, float>, 8> arr;
-						    unsigned ctr = 0;
-						    neighbourhood.eval(V2i(x, y), [&](const V2i& pos, float weight) {
-							    assert(ctr < 8);
-							    arr[ctr] = std::make_pair(pos, weight);
-
-							    ++ctr;
-						    });
-
-						    std::random_shuffle(arr.begin(), arr.begin() + ctr, randomOffset);
-
-						    // float weight = 1.0f;
-						    for(unsigned a = 0; a < ctr; ++a) {
-							    // find the nearest
-							    const PDFGaussian& tmp = state(arr[a].first.y, arr[a].first.x);
-							    if(flatness.sigma() > tmp.sigma()) {
-								    flatness = tmp;
-								    // weight = arr[a].second;
-							    }
-						    }
-						    // flatness =
-						    //     flatness /* * PDFGaussian::fromConfidence(0, weight / weightMax) */;  // THIS DOESN"T
-						    // WORK!!!!
-					    }
-
-					    PDFGaussian smoothness = PDFGaussian::fromConfidence(0, 0);
-					    neighbourhood.eval(V2i(x, y), [&](const V2i& pos, float weight) {
-						    // average the neighbourhood
-						    smoothness = smoothness +
-						                 state(pos.y, pos.x) /* * PDFGaussian::fromConfidence(0, weight / weightSum) */
-						        ;                            // this doesn't EAT OUT the low probabilities!
-					    });
-
-					    // combine them all
-					    grid(y, x) = state(y, x) * PDFGaussian::fromConfidence(0, 1.0f - totalWeight) +
-					                 constness * PDFGaussian::fromConfidence(0, inputsWeight) +
-					                 flatness * PDFGaussian::fromConfidence(0, flatnessWeight) +
-					                 smoothness * PDFGaussian::fromConfidence(0, smoothnessWeight);
-				    }
-		    });
+		forEachPixel<STENCIL>(source.size(), [&](const V2i& pos, const auto& neighbourhood) {
+			// stick to the original value
+			const PDFGaussian constness = PDFGaussian::fromConfidence(source[pos].value, source[pos].confidence);
+
+			PDFGaussian flatness = PDFGaussian::fromConfidence(0, 0);
+			if(flatnessWeight > 0.0f) {
+				// need to permutate the order of evaluation - otherwise I'll end up with directional bias
+				// (whole image "shifting") (yes, this will introduce some randomness to the result, but at
+				// least it will look correct)
+				std::array<std::pair<V2i, float>, STENCIL::count> arr;
+				unsigned ctr = 0;
+				neighbourhood(pos, [&](const V2i& n, float weight) {
+					assert(ctr < STENCIL::count);
+					arr[ctr] = std::make_pair(n, weight);
+
+					++ctr;
+				});
+
+				std::random_shuffle(arr.begin(), arr.begin() + ctr, randomOffset);
+
+				for(unsigned a = 0; a < ctr; ++a) {
+					// find the nearest
+					const PDFGaussian& tmp = state(arr[a].first.y, arr[a].first.x);
+					if(flatness.sigma() > tmp.sigma())
+						flatness = tmp;
+				}
+			}
+
+			PDFGaussian smoothness = PDFGaussian::fromConfidence(0, 0);
+			neighbourhood(pos, [&](const V2i& n, float weight) {
+				// average the neighbourhood
+				smoothness = smoothness + state(n.y, n.x);  // this doesn't EAT OUT the low probabilities!
+			});
+
+			// combine them all
+			grid(pos.y, pos.x) = state(pos.y, pos.x) * PDFGaussian::fromConfidence(0, 1.0f - totalWeight) +
+			                     constness * PDFGaussian::fromConfidence(0, inputsWeight) +
+			                     flatness * PDFGaussian::fromConfidence(0, flatnessWeight) +
+			                     smoothness * PDFGaussian::fromConfidence(0, smoothnessWeight);
+		});
 	}
 
 	// convert the result to a cv::Mat by picking the highest probability for each pixel
@@ -320,4 +362,426 @@ cv::Mat MRF::solvePDF(const MRF& source,
 	return result;
 }
 
+}  // namespace
+
+cv::Mat MRF::solvePDF(const MRF& source,
+                      float inputsWeight,
+                      float flatnessWeight,
+                      float smoothnessWeight,
+                      std::size_t iterationLimit,
+                      const Neighbours& neighbourhood) {
+	return dispatch(neighbourhood.type(), [&](auto stencil) {
+		return lightfields::solvePDF<decltype(stencil)>(source, inputsWeight, flatnessWeight, smoothnessWeight,
+		                                                iterationLimit);
+	});
+}
+
+///////////////////////
+
+namespace {
+
+// direction of the sender of a message, relative to the receiving pixel
+enum Direction { kLeft = 0, kRight = 1, kUp = 2, kDown = 3 };
+
+const std::array<V2i, 4> s_offsets{{V2i(-1, 0), V2i(1, 0), V2i(0, -1), V2i(0, 1)}};
+const std::array<Direction, 4> s_opposite{{kRight, kLeft, kDown, kUp}};
+
+struct BPParams {
+	float inputsWeight, smoothnessWeight, truncation;
+	MRF::Distance distance;
+	unsigned labels;
+};
+
+/// per-thread temporary buffers of the belief propagation
+struct BPScratch {
+	BPScratch(unsigned labels) : h(labels * 4), line(labels), envelope(labels), z(labels + 1), v(labels) {
+	}
+
+	std::vector<float> h, line, envelope, z;
+	std::vector<int> v;
+};
+
+/// size of a grid at given pyramid level (each level halves the resolution, rounding up)
+int levelSize(int size, unsigned level) {
+	return (size + (1 << level) - 1) >> level;
+}
+
+/// A rectangular window of one level of the pyramid, holding data costs and incoming messages for each pixel.
+/// Coordinates are in the pixel space of the level.
+class BPLevel {
+  public:
+	BPLevel(unsigned level, const V2i& begin, const V2i& end, unsigned labels)
+	    : m_level(level),
+	      m_begin(begin),
+	      m_end(end),
+	      m_labels(labels),
+	      m_data((end.x - begin.x) * (end.y - begin.y) * labels),
+	      m_messages((end.x - begin.x) * (end.y - begin.y) * labels * 4, 0.0f) {
+	}
+
+	unsigned level() const {
+		return m_level;
+	}
+
+	const V2i& begin() const {
+		return m_begin;
+	}
+
+	const V2i& end() const {
+		return m_end;
+	}
+
+	bool contains(const V2i& p) const {
+		return p.x >= m_begin.x && p.x < m_end.x && p.y >= m_begin.y && p.y < m_end.y;
+	}
+
+	float* data(const V2i& p) {
+		return &m_data[index(p) * m_labels];
+	}
+
+	const float* data(const V2i& p) const {
+		return &m_data[index(p) * m_labels];
+	}
+
+	float* message(const V2i& p, Direction d) {
+		return &m_messages[(index(p) * 4 + d) * m_labels];
+	}
+
+	const float* message(const V2i& p, Direction d) const {
+		return &m_messages[(index(p) * 4 + d) * m_labels];
+	}
+
+  private:
+	std::size_t index(const V2i& p) const {
+		assert(contains(p));
+		return (std::size_t)(p.x - m_begin.x) + (std::size_t)(p.y - m_begin.y) * (std::size_t)(m_end.x - m_begin.x);
+	}
+
+	unsigned m_level;
+	V2i m_begin, m_end;
+	unsigned m_labels;
+	std::vector<float> m_data, m_messages;
+};
+
+/// Data cost of a pixel of a pyramid level - a sum of data costs of all source pixels it covers. Uses a confidence
+/// histogram, making the cost linear in the number of labels irrespective of the level.
+void dataCost(const MRF& source,
+              const BPParams& params,
+              unsigned level,
+              const V2i& pos,
+              float* cost,
+              float* histogram) {
+	std::fill(histogram, histogram + params.labels, 0.0f);
+
+	const int max_x = std::min((pos.x + 1) << level, source.size().x);
+	const int max_y = std::min((pos.y + 1) << level, source.size().y);
+	for(int y = pos.y << level; y < max_y; ++y)
+		for(int x = pos.x << level; x < max_x; ++x) {
+			const MRF::Value& val = source[V2i(x, y)];
+			histogram[val.value] += params.inputsWeight * val.confidence;
+		}
+
+	// cost(l) = sum_v histogram[v] * |l - v|, evaluated in two passes
+	float weight = 0.0f, sum = 0.0f;
+	for(unsigned l = 0; l < params.labels; ++l) {
+		sum += weight;
+		cost[l] = sum;
+		weight += histogram[l];
+	}
+
+	weight = 0.0f;
+	sum = 0.0f;
+	for(int l = params.labels - 1; l >= 0; --l) {
+		sum += weight;
+		cost[l] += sum;
+		weight += histogram[l];
+	}
+}
+
+/// Min-convolution of a function with a truncated quadratic distance, computed in linear time as a lower envelope of
+/// parabolas rooted at (l, h(l)). Parabolas rooted above the truncation limit can't contribute to the result, and
+/// are skipped.
+void lowerEnvelope(const float* h, float* result, float weight, float limit, unsigned labels, BPScratch& scratch) {
+	int* v = scratch.v.data();
+	float* z = scratch.z.data();
+
+	int k = -1;
+	for(int q = 0; q < (int)labels; ++q)
+		if(h[q] < limit) {
+			if(k < 0) {
+				k = 0;
+				v[0] = q;
+				z[0] = -std::numeric_limits<float>::infinity();
+				z[1] = std::numeric_limits<float>::infinity();
+			}
+
+			else {
+				float s = ((h[q] + weight * q * q) - (h[v[k]] + weight * v[k] * v[k])) / (2.0f * weight * (q - v[k]));
+				while(s <= z[k]) {
+					--k;
+					s = ((h[q] + weight * q * q) - (h[v[k]] + weight * v[k] * v[k])) / (2.0f * weight * (q - v[k]));
+				}
+
+				++k;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = std::numeric_limits<float>::infinity();
+			}
+		}
+
+	if(k < 0)
+		std::fill(result, result + labels, limit);
+
+	else {
+		k = 0;
+		for(int l = 0; l < (int)labels; ++l) {
+			while(z[k + 1] < l)
+				++k;
+			result[l] = weight * (l - v[k]) * (l - v[k]) + h[v[k]];
+		}
+	}
+}
+
+/// Computes messages to all 4 neighbours via a min-convolution of their h functions with the truncated distance
+/// function, in linear time. The h functions are interleaved (4 values per label), allowing the 4 distance transforms
+/// to run in lockstep. Targets outside of the level window are passed as nullptr. Messages are normalised to a
+/// minimum of 0.
+void minConvolution(const BPParams& params, BPScratch& scratch, float* const result[4]) {
+	float* h = scratch.h.data();
+	const int labels = params.labels;
+	const float weight = params.smoothnessWeight;
+
+	float minH[4] = {h[0], h[1], h[2], h[3]};
+
+	if(params.distance == MRF::kTruncatedLinear || weight <= 0.0f) {
+		const float w = std::max(weight, 0.0f);
+
+		// two passes of a 1D distance transform, in-place
+		for(int l = 1; l < labels; ++l)
+			for(int d = 0; d < 4; ++d) {
+				minH[d] = std::min(minH[d], h[l * 4 + d]);
+				h[l * 4 + d] = std::min(h[l * 4 + d], h[(l - 1) * 4 + d] + w);
+			}
+		for(int l = labels - 2; l >= 0; --l)
+			for(int d = 0; d < 4; ++d)
+				h[l * 4 + d] = std::min(h[l * 4 + d], h[(l + 1) * 4 + d] + w);
+	}
+
+	else {
+		float* line = scratch.line.data();
+		float* envelope = scratch.envelope.data();
+
+		for(int d = 0; d < 4; ++d)
+			if(result[d]) {
+				for(int l = 0; l < labels; ++l) {
+					line[l] = h[l * 4 + d];
+					minH[d] = std::min(minH[d], line[l]);
+				}
+
+				lowerEnvelope(line, envelope, weight, minH[d] + params.truncation, labels, scratch);
+
+				for(int l = 0; l < labels; ++l)
+					h[l * 4 + d] = envelope[l];
+			}
+	}
+
+	// truncation and normalisation
+	for(int d = 0; d < 4; ++d)
+		if(result[d]) {
+			const float limit = minH[d] + params.truncation;
+			for(int l = 0; l < labels; ++l)
+				result[d][l] = std::min(h[l * 4 + d], limit) - minH[d];
+		}
+}
+
+/// Sends messages from a pixel to all its neighbours inside the level window
+void sendMessages(BPLevel& level, const V2i& pos, const BPParams& params, BPScratch& scratch) {
+	const float* data = level.data(pos);
+	const float* in[4] = {level.message(pos, kLeft), level.message(pos, kRight), level.message(pos, kUp),
+	                      level.message(pos, kDown)};
+
+	// h functions for each target, excluding the message received from it
+	float* h = scratch.h.data();
+	for(unsigned l = 0; l < params.labels; ++l) {
+		const float base = data[l] + in[0][l] + in[1][l] + in[2][l] + in[3][l];
+		for(unsigned d = 0; d < 4; ++d)
+			h[l * 4 + d] = base - in[d][l];
+	}
+
+	float* result[4];
+	for(unsigned d = 0; d < 4; ++d) {
+		const V2i target = pos + s_offsets[d];
+		result[d] = level.contains(target) ? level.message(target, s_opposite[d]) : nullptr;
+	}
+
+	minConvolution(params, scratch, result);
+}
+
+/// Returns the label with the lowest belief
+unsigned char bestLabel(const BPLevel& level, const V2i& pos, const BPParams& params) {
+	const float* data = level.data(pos);
+	const float* in[4] = {level.message(pos, kLeft), level.message(pos, kRight), level.message(pos, kUp),
+	                      level.message(pos, kDown)};
+
+	unsigned result = 0;
+	float best = std::numeric_limits<float>::max();
+	for(unsigned l = 0; l < params.labels; ++l) {
+		const float belief = data[l] + in[0][l] + in[1][l] + in[2][l] + in[3][l];
+		if(belief < best) {
+			best = belief;
+			result = l;
+		}
+	}
+
+	return result;
+}
+
+/// Evaluates a function for each row of a level, either in parallel (for whole-grid levels) or serially (for tiles,
+/// which are already processed in parallel)
+template <typename FN>
+void forEachRow(const BPLevel& level, bool parallel, const BPParams& params, const FN& fn) {
+	if(parallel)
+		tbb::parallel_for(tbb::blocked_range<int>(level.begin().y, level.end().y),
+		                  [&](const tbb::blocked_range<int>& range) {
+			                  BPScratch scratch(params.labels);
+			                  for(int y = range.begin(); y != range.end(); ++y)
+				                  fn(y, scratch);
+		                  });
+	else {
+		BPScratch scratch(params.labels);
+		for(int y = level.begin().y; y != level.end().y; ++y)
+			fn(y, scratch);
+	}
+}
+
+/// Creates a level window, computes its data costs and initialises its messages from the parent level (if any)
+std::unique_ptr<BPLevel> makeLevel(const MRF& source,
+                                   const BPParams& params,
+                                   unsigned level,
+                                   const V2i& begin,
+                                   const V2i& end,
+                                   const BPLevel* parent,
+                                   bool parallel) {
+	std::unique_ptr<BPLevel> result(new BPLevel(level, begin, end, params.labels));
+
+	forEachRow(*result, parallel, params, [&](int y, BPScratch& scratch) {
+		for(int x = begin.x; x < end.x; ++x) {
+			const V2i pos(x, y);
+			dataCost(source, params, level, pos, result->data(pos), scratch.h.data());
+
+			if(parent)
+				for(unsigned d = 0; d < 4; ++d) {
+					const float* msg = parent->message(V2i(x / 2, y / 2), Direction(d));
+					std::copy(msg, msg + params.labels, result->message(pos, Direction(d)));
+				}
+		}
+	});
+
+	return result;
+}
+
+/// Iterates the message passing on a level, using a checkerboard schedule - pixels of one colour only receive
+/// messages from pixels of the other colour, allowing to update all pixels of one colour concurrently and in-place
+void iterate(BPLevel& level, const BPParams& params, std::size_t iterationLimit, bool parallel) {
+	for(std::size_t it = 0; it < iterationLimit; ++it)
+		for(int colour = 0; colour < 2; ++colour)
+			forEachRow(level, parallel, params, [&](int y, BPScratch& scratch) {
+				int x = level.begin().x;
+				if(((x + y) & 1) != colour)
+					++x;
+
+				for(; x < level.end().x; x += 2)
+					sendMessages(level, V2i(x, y), params, scratch);
+			});
+}
+
+// memory limit of a level solved as a whole
+const std::size_t s_levelMemoryLimit = 256 * 1024 * 1024;
+// number of pyramid levels, limited by the size of the coarsest level
+const unsigned s_maxLevels = 6;
+const int s_minLevelSize = 8;
+// size of the interior of tiles, and of their overlap
+const int s_tileSize = 64;
+const int s_tileMargin = 8;
+
+}  // namespace
+
+cv::Mat MRF::solveBP(const MRF& source,
+                     float inputsWeight,
+                     float smoothnessWeight,
+                     float truncation,
+                     std::size_t iterationLimit,
+                     Distance distance) {
+	BPParams params;
+	params.inputsWeight = inputsWeight;
+	params.smoothnessWeight = smoothnessWeight;
+	params.truncation = truncation;
+	params.distance = distance;
+	params.labels = source.range().second + 1;
+
+	if(source.range().first < 0 || params.labels > 256)
+		throw std::runtime_error("Belief propagation requires values in the range 0..255");
+
+	const V2i& size = source.size();
+	const auto levelSize2 = [&](unsigned level) { return V2i(levelSize(size.x, level), levelSize(size.y, level)); };
+
+	// pyramid depth
+	unsigned coarsest = 0;
+	while(coarsest + 1 < s_maxLevels && std::min(levelSize(size.x, coarsest + 1), levelSize(size.y, coarsest + 1)) >=
+	                                        s_minLevelSize)
+		++coarsest;
+
+	// the finest level that can be solved as a whole
+	unsigned global = 0;
+	while(global < coarsest && (std::size_t)levelSize2(global).x * (std::size_t)levelSize2(global).y * params.labels *
+	                                   5 * sizeof(float) >
+	                               s_levelMemoryLimit)
+		++global;
+
+	// coarse-to-fine solution of the whole grid
+	std::unique_ptr<BPLevel> parent;
+	for(int level = coarsest; level >= (int)global; --level) {
+		parent = makeLevel(source, params, level, V2i(0, 0), levelSize2(level), parent.get(), true);
+		iterate(*parent, params, iterationLimit, true);
+	}
+
+	cv::Mat result = cv::Mat::zeros(size.y, size.x, CV_8UC1);
+
+	if(global == 0)
+		tbb::parallel_for(0, size.y, [&](int y) {
+			for(int x = 0; x < size.x; ++x)
+				result.at<unsigned char>(y, x) = bestLabel(*parent, V2i(x, y), params);
+		});
+
+	// finer levels processed in overlapping tiles, each initialised from the last global level
+	else {
+		std::vector<V2i> tiles;
+		for(int y = 0; y < size.y; y += s_tileSize)
+			for(int x = 0; x < size.x; x += s_tileSize)
+				tiles.push_back(V2i(x, y));
+
+		tbb::parallel_for(std::size_t(0), tiles.size(), [&](std::size_t t) {
+			const V2i tileBegin = tiles[t];
+			const V2i tileEnd(std::min(tileBegin.x + s_tileSize, size.x), std::min(tileBegin.y + s_tileSize, size.y));
+
+			const V2i begin(std::max(tileBegin.x - s_tileMargin, 0), std::max(tileBegin.y - s_tileMargin, 0));
+			const V2i end(std::min(tileEnd.x + s_tileMargin, size.x), std::min(tileEnd.y + s_tileMargin, size.y));
+
+			std::unique_ptr<BPLevel> tile;
+			for(int level = global - 1; level >= 0; --level) {
+				const BPLevel* init = tile ? tile.get() : parent.get();
+				tile = makeLevel(source, params, level, V2i(begin.x >> level, begin.y >> level),
+				                 V2i(levelSize(end.x, level), levelSize(end.y, level)), init, false);
+				iterate(*tile, params, iterationLimit, false);
+			}
+
+			for(int y = tileBegin.y; y < tileEnd.y; ++y)
+				for(int x = tileBegin.x; x < tileEnd.x; ++x)
+					result.at<unsigned char>(y, x) = bestLabel(*tile, V2i(x, y), params);
+		});
+	}
+
+	return result;
+}
+
 }  // namespace lightfields
@@ -34,6 +34,18 @@ class MRF {
 	static cv::Mat solvePDF(const MRF& source, float inputsWeight, float flatnessWeight, float smoothnessWeight,
 	                        std::size_t iterationLimit, const Neighbours& neighbourhood);
 
+	/// Pairwise label distance functions of the belief propagation solver
+	enum Distance { kTruncatedLinear, kTruncatedQuadratic };
+
+	/// Min-sum loopy belief propagation on a 4-neighbourhood, with linear-time message computation, checkerboard
+	/// update schedule and coarse-to-fine initialisation. Based on Felzenszwalb, Pedro F., and Daniel P. Huttenlocher.
+	/// "Efficient belief propagation for early vision." International journal of computer vision 70.1 (2006): 41-54.
+	/// Minimizes the sum of data terms (inputsWeight * confidence * |label - value|) and pairwise terms
+	/// min(smoothnessWeight * distance(label_p - label_q), truncation). Grids too large to hold all messages in
+	/// memory are solved in overlapping tiles, initialised from a coarser level solved globally.
+	static cv::Mat solveBP(const MRF& source, float inputsWeight, float smoothnessWeight, float truncation,
+	                       std::size_t iterationLimit, Distance distance);
+
   private:
 	V2i m_size;
 	std::vector<Value> m_nodes;
@@ -6,12 +6,16 @@
 
 namespace lightfields {
 
-Neighbours::Neighbours(const V2i& size) : m_size(size) {
+Neighbours::Neighbours(Type t, const V2i& size) : m_type(t), m_size(size) {
 }
 
 Neighbours::~Neighbours() {
 }
 
+Neighbours::Type Neighbours::type() const {
+	return m_type;
+}
+
 const V2i& Neighbours::size() const {
 	return m_size;
 }
@@ -28,65 +32,30 @@ const std::vector<std::pair<std::string, Neighbours::Type>>& Neighbours::types()
 
 ////////////////////
 
-struct Neighbours_4 : public Neighbours {
-	Neighbours_4(const V2i& size) : Neighbours(size) {
-	}
-
-	virtual void eval(const V2i& pos, const std::function<void(const V2i&, float)>& fn) const override {
-		if(pos.x > 0)
-			fn(V2i(pos.x - 1, pos.y), 1);
-		if(pos.x < size().x - 1)
-			fn(V2i(pos.x + 1, pos.y), 1);
-		if(pos.y > 0)
-			fn(V2i(pos.x, pos.y - 1), 1);
-		if(pos.y < size().y - 1)
-			fn(V2i(pos.x, pos.y + 1), 1);
-	}
-};
+namespace {
 
-struct Neighbours_8 : public Neighbours {
-	Neighbours_8(const V2i& size) : Neighbours(size) {
+/// runtime-polymorphic wrapper of a compile-time Stencil
+template <Neighbours::Type TYPE>
+struct NeighboursImpl : public Neighbours {
+	NeighboursImpl(const V2i& size) : Neighbours(TYPE, size) {
 	}
 
 	virtual void eval(const V2i& pos, const std::function<void(const V2i&, float)>& fn) const override {
-		int min_x = std::max(0, pos.x - 1);
-		int min_y = std::max(0, pos.y - 1);
-		int max_x = std::min(pos.x + 1, size().x - 1);
-		int max_y = std::min(pos.y + 1, size().y - 1);
-
-		for(int y = min_y; y <= max_y; ++y)
-			for(int x = min_x; x <= max_x; ++x)
-				if(x != pos.x || y != pos.y)
-					fn(V2i(x, y), 1);
+		Stencil<TYPE>::template eval<true>(pos, size(), fn);
 	}
 };
 
-struct Neighbours_8_Weighted : public Neighbours {
-	Neighbours_8_Weighted(const V2i& size) : Neighbours(size) {
-	}
-
-	virtual void eval(const V2i& pos, const std::function<void(const V2i&, float)>& fn) const {
-		int min_x = std::max(0, pos.x - 1);
-		int min_y = std::max(0, pos.y - 1);
-		int max_x = std::min(pos.x + 1, size().x - 1);
-		int max_y = std::min(pos.y + 1, size().y - 1);
-
-		for(int y = min_y; y <= max_y; ++y)
-			for(int x = min_x; x <= max_x; ++x)
-				if(x != pos.x || y != pos.y)
-					fn(V2i(x, y), 1 + (x == pos.x || y == pos.y));
-	}
-};
+}  // namespace
 
 ///////////////
 
 std::unique_ptr<Neighbours> Neighbours::create(Type t, const V2i& size) {
 	if(t == k4)
-		return std::unique_ptr<Neighbours>(new Neighbours_4(size));
+		return std::unique_ptr<Neighbours>(new NeighboursImpl<k4>(size));
 	else if(t == k8)
-		return std::unique_ptr<Neighbours>(new Neighbours_8(size));
+		return std::unique_ptr<Neighbours>(new NeighboursImpl<k8>(size));
 	else if(t == k8Weighted)
-		return std::unique_ptr<Neighbours>(new Neighbours_8_Weighted(size));
+		return std::unique_ptr<Neighbours>(new NeighboursImpl<k8Weighted>(size));
 	else {
 		assert(false && "Unknown neighbourhood type");
 		throw std::runtime_error("Unknown neighbourhood type specified.");
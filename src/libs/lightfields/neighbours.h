@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "vec2.h"
@@ -13,11 +16,14 @@ class Neighbours {
   public:
 	enum Type { k4, k8, k8Weighted };
 
-	Neighbours(const V2i& size);
+	Neighbours(Type t, const V2i& size);
 	virtual ~Neighbours();
 
 	virtual void eval(const V2i& pos, const std::function<void(const V2i&, float)>& fn) const = 0;
 
+	/// The type of this neighbourhood, allowing to dispatch to a compile-time Stencil (see dispatch() below)
+	Type type() const;
+
 	/// Factory enumerator
 	static const std::vector<std::pair<std::string, Type>>& types();
 
@@ -28,7 +34,82 @@ class Neighbours {
 	const V2i& size() const;
 
   private:
+	Type m_type;
 	V2i m_size;
 };
 
+/// Compile-time neighbourhood stencils, to be inlined in the inner loops of grid algorithms instead of calling
+/// Neighbours::eval() for each pixel. Bounds checking against the grid size is only needed for the pixels
+/// on the border of the grid, and can be disabled using the CHECKED template parameter.
+template <Neighbours::Type TYPE>
+struct Stencil;
+
+template <>
+struct Stencil<Neighbours::k4> {
+	static constexpr unsigned count = 4;
+
+	template <bool CHECKED, typename FN>
+	static void eval(const V2i& pos, const V2i& size, FN&& fn) {
+		if(!CHECKED || pos.x > 0)
+			fn(V2i(pos.x - 1, pos.y), 1.0f);
+		if(!CHECKED || pos.x < size.x - 1)
+			fn(V2i(pos.x + 1, pos.y), 1.0f);
+		if(!CHECKED || pos.y > 0)
+			fn(V2i(pos.x, pos.y - 1), 1.0f);
+		if(!CHECKED || pos.y < size.y - 1)
+			fn(V2i(pos.x, pos.y + 1), 1.0f);
+	}
+};
+
+template <>
+struct Stencil<Neighbours::k8> {
+	static constexpr unsigned count = 8;
+
+	template <bool CHECKED, typename FN>
+	static void eval(const V2i& pos, const V2i& size, FN&& fn) {
+		const int min_x = CHECKED ? std::max(0, pos.x - 1) : pos.x - 1;
+		const int min_y = CHECKED ? std::max(0, pos.y - 1) : pos.y - 1;
+		const int max_x = CHECKED ? std::min(pos.x + 1, size.x - 1) : pos.x + 1;
+		const int max_y = CHECKED ? std::min(pos.y + 1, size.y - 1) : pos.y + 1;
+
+		for(int y = min_y; y <= max_y; ++y)
+			for(int x = min_x; x <= max_x; ++x)
+				if(x != pos.x || y != pos.y)
+					fn(V2i(x, y), 1.0f);
+	}
+};
+
+template <>
+struct Stencil<Neighbours::k8Weighted> {
+	static constexpr unsigned count = 8;
+
+	template <bool CHECKED, typename FN>
+	static void eval(const V2i& pos, const V2i& size, FN&& fn) {
+		const int min_x = CHECKED ? std::max(0, pos.x - 1) : pos.x - 1;
+		const int min_y = CHECKED ? std::max(0, pos.y - 1) : pos.y - 1;
+		const int max_x = CHECKED ? std::min(pos.x + 1, size.x - 1) : pos.x + 1;
+		const int max_y = CHECKED ? std::min(pos.y + 1, size.y - 1) : pos.y + 1;
+
+		// direct neighbours have twice the weight of the diagonal ones
+		for(int y = min_y; y <= max_y; ++y)
+			for(int x = min_x; x <= max_x; ++x)
+				if(x != pos.x || y != pos.y)
+					fn(V2i(x, y), (x == pos.x || y == pos.y) ? 2.0f : 1.0f);
+	}
+};
+
+/// Calls fn with a default-constructed Stencil instance matching the runtime neighbourhood type. Allows to
+/// dispatch once at the entry of an algorithm, with the rest of the code templated on the stencil type.
+template <typename FN>
+auto dispatch(Neighbours::Type t, FN&& fn) -> decltype(fn(Stencil<Neighbours::k4>())) {
+	if(t == Neighbours::k4)
+		return fn(Stencil<Neighbours::k4>());
+	else if(t == Neighbours::k8)
+		return fn(Stencil<Neighbours::k8>());
+	else if(t == Neighbours::k8Weighted)
+		return fn(Stencil<Neighbours::k8Weighted>());
+
+	throw std::runtime_error("Unknown neighbourhood type specified.");
+}
+
 }  // namespace lightfields
@@ -65,9 +65,11 @@ float Pattern::lensPitch() const {
 	return m_lensPitch;
 }
 
-Pattern::Sample Pattern::sample(const Imath::V2i& pixelPos) const {
-	Sample result;
+const Imath::M33f& Pattern::transform() const {
+	return m_tr;
+}
 
+Imath::V2i Pattern::lens(const Imath::V2i& pixelPos) const {
 	// convert the pixel position to lens space
 	const Imath::V3f pixpos = Imath::V3f(pixelPos[0], pixelPos[1], 1.0);
 	const Imath::V3f pos = pixpos * m_tr;
@@ -90,26 +92,29 @@ Pattern::Sample Pattern::sample(const Imath::V2i& pixelPos) const {
 	const float dist3 = std::pow(pixpos[0] - lens3[0], 2) + std::pow(pixpos[1] - lens3[1], 2);
 	const float dist4 = std::pow(pixpos[0] - lens4[0], 2) + std::pow(pixpos[1] - lens4[1], 2);
 
-	Imath::V3f lens = lens1;
 	Imath::V3f pos0 = pos1;
-	if(dist2 < dist1 && dist2 < dist3 && dist2 < dist4) {
-		lens = lens2;
+	if(dist2 < dist1 && dist2 < dist3 && dist2 < dist4)
 		pos0 = pos2;
-	}
-	else if(dist3 < dist1 && dist3 < dist2 && dist3 < dist4) {
-		lens = lens3;
+	else if(dist3 < dist1 && dist3 < dist2 && dist3 < dist4)
 		pos0 = pos3;
-	}
-	else if(dist4 < dist1 && dist4 < dist2 && dist4 < dist3) {
-		lens = lens4;
+	else if(dist4 < dist1 && dist4 < dist2 && dist4 < dist3)
 		pos0 = pos4;
-	}
 
-	result.lensCenter[0] = lens[0];
-	result.lensCenter[1] = lens[1];
+	return Imath::V2i(pos0[0], pos0[1]);
+}
+
+Imath::V2f Pattern::lensCenter(const Imath::V2i& lens) const {
+	const Imath::V3f center = Imath::V3f(lens[0], lens[1], 1.0) * m_trInv;
+	return Imath::V2f(center[0], center[1]);
+}
+
+Pattern::Sample Pattern::sample(const Imath::V2i& pixelPos) const {
+	Sample result;
+
+	result.lensCenter = lensCenter(lens(pixelPos));
 
-	result.offset[0] = (pixelPos[0] - lens[0]) / m_lensPitch * 2.0;
-	result.offset[1] = (pixelPos[1] - lens[1]) / m_lensPitch * 2.0;
+	result.offset[0] = (pixelPos[0] - result.lensCenter[0]) / m_lensPitch * 2.0;
+	result.offset[1] = (pixelPos[1] - result.lensCenter[1]) / m_lensPitch * 2.0;
 
 	return result;
 }
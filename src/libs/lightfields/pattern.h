@@ -29,6 +29,14 @@ class Pattern {
 	const Imath::V2i& sensorResolution() const;
 	float lensPitch() const;
 
+	/// integer lens-space coordinates of the lens nearest to a pixel
+	Imath::V2i lens(const Imath::V2i& pixelPos) const;
+	/// pixel-space position of a lens center, from its integer lens-space coordinates
+	Imath::V2f lensCenter(const Imath::V2i& lens) const;
+
+	/// pixel-to-lens space transformation matrix
+	const Imath::M33f& transform() const;
+
 	bool operator==(const Pattern& p) const;
 	bool operator!=(const Pattern& p) const;
 
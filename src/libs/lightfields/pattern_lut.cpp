@@ -0,0 +1,211 @@
+#include "pattern_lut.h"
+
+#include <tbb/parallel_for.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "future_cache.h"
+
+namespace lightfields {
+
+namespace {
+
+// number of LUTs kept in memory - one per camera and scale compensation value
+const std::size_t s_cacheSize = 4;
+
+const char s_magic[8] = {'L', 'F', 'P', 'L', 'U', 'T', '0', '1'};
+
+template <typename T>
+void write(std::ostream& out, const T& value) {
+	out.write((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+bool read(std::istream& in, T& value) {
+	in.read((char*)&value, sizeof(T));
+	return in.good();
+}
+
+template <typename T>
+void writeVector(std::ostream& out, const std::vector<T>& values) {
+	write(out, (uint64_t)values.size());
+	out.write((const char*)values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+bool readVector(std::istream& in, std::vector<T>& values, uint64_t maxSize) {
+	uint64_t size;
+	if(!read(in, size) || size > maxSize)
+		return false;
+
+	values.resize(size);
+	in.read((char*)values.data(), size * sizeof(T));
+	return in.good();
+}
+
+/// writes the values defining a pattern, used to validate a loaded LUT
+void writePattern(std::ostream& out, const Pattern& pattern) {
+	write(out, pattern.sensorResolution()[0]);
+	write(out, pattern.sensorResolution()[1]);
+	write(out, pattern.lensPitch());
+	for(int a = 0; a < 3; ++a)
+		for(int b = 0; b < 3; ++b)
+			write(out, pattern.transform()[a][b]);
+}
+
+}  // namespace
+
+PatternLUT::PatternLUT(const Pattern& pattern)
+    : m_pattern(pattern), m_lensPitch(pattern.lensPitch()), m_size(pattern.sensorResolution()) {
+	if(m_size[0] <= 0 || m_size[1] <= 0)
+		return;
+
+	// the lens-space coordinates are an affine transformation of the pixel coordinates - the range of lenses
+	// covering the sensor is determined by its corners (the nearest lens is at most one lens away from the rounded
+	// lens-space position)
+	Imath::V2i lensMin(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+	Imath::V2i lensMax(std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+	for(auto& corner : {Imath::V2i(0, 0), Imath::V2i(m_size[0] - 1, 0), Imath::V2i(0, m_size[1] - 1),
+	                    Imath::V2i(m_size[0] - 1, m_size[1] - 1)}) {
+		const Imath::V2i lens = pattern.lens(corner);
+		for(int a = 0; a < 2; ++a) {
+			lensMin[a] = std::min(lensMin[a], lens[a] - 1);
+			lensMax[a] = std::max(lensMax[a], lens[a] + 1);
+		}
+	}
+	const int lensRowSize = lensMax[0] - lensMin[0] + 1;
+
+	// table of lens centers, computed in the same way as in Pattern::sample()
+	m_lensCenters.resize((std::size_t)lensRowSize * (lensMax[1] - lensMin[1] + 1));
+	for(int y = lensMin[1]; y <= lensMax[1]; ++y)
+		for(int x = lensMin[0]; x <= lensMax[0]; ++x)
+			m_lensCenters[(y - lensMin[1]) * lensRowSize + (x - lensMin[0])] = pattern.lensCenter(Imath::V2i(x, y));
+
+	// and the per-pixel lens indices
+	m_indices.resize((std::size_t)m_size[0] * m_size[1]);
+	tbb::parallel_for(0, m_size[1], [&](int y) {
+		uint32_t* row = &m_indices[(std::size_t)y * m_size[0]];
+		for(int x = 0; x < m_size[0]; ++x) {
+			const Imath::V2i lens = pattern.lens(Imath::V2i(x, y));
+			assert(lens[0] >= lensMin[0] && lens[0] <= lensMax[0] && lens[1] >= lensMin[1] && lens[1] <= lensMax[1]);
+
+			row[x] = (lens[1] - lensMin[1]) * lensRowSize + (lens[0] - lensMin[0]);
+		}
+	});
+}
+
+const Pattern& PatternLUT::pattern() const {
+	return m_pattern;
+}
+
+std::size_t PatternLUT::lensCount() const {
+	return m_lensCenters.size();
+}
+
+void PatternLUT::save(std::ostream& out) const {
+	out.write(s_magic, sizeof(s_magic));
+	writePattern(out, m_pattern);
+
+	writeVector(out, m_lensCenters);
+	writeVector(out, m_indices);
+}
+
+std::unique_ptr<PatternLUT> PatternLUT::load(std::istream& in, const Pattern& pattern) {
+	// the header has to match the pattern exactly
+	std::stringstream expected;
+	expected.write(s_magic, sizeof(s_magic));
+	writePattern(expected, pattern);
+
+	const std::string header = expected.str();
+	std::string loaded(header.size(), '\0');
+	in.read(&loaded[0], loaded.size());
+	if(!in.good() || loaded != header)
+		return std::unique_ptr<PatternLUT>();
+
+	std::unique_ptr<PatternLUT> result(new PatternLUT());
+	result->m_pattern = pattern;
+	result->m_lensPitch = pattern.lensPitch();
+	result->m_size = pattern.sensorResolution();
+
+	// the lens table covers the sensor with a margin, and can't have more lenses than a small multiple of pixels
+	const uint64_t pixelCount = (uint64_t)result->m_size[0] * result->m_size[1];
+	const uint64_t maxLensCount = (uint64_t)(result->m_size[0] + 3) * (result->m_size[1] + 3) * 4;
+
+	if(!readVector(in, result->m_lensCenters, maxLensCount) || !readVector(in, result->m_indices, pixelCount) ||
+	   result->m_indices.size() != pixelCount)
+		return std::unique_ptr<PatternLUT>();
+
+	// make sure all indices are valid
+	for(auto& i : result->m_indices)
+		if(i >= result->m_lensCenters.size())
+			return std::unique_ptr<PatternLUT>();
+
+	return result;
+}
+
+std::string PatternLUT::filename(const Pattern& pattern) {
+	std::stringstream data;
+	writePattern(data, pattern);
+
+	std::stringstream result;
+	result << "pattern_" << std::hex << std::setw(16) << std::setfill('0') << boost::hash_value(data.str()) << ".lut";
+	return result.str();
+}
+
+/////////
+
+namespace {
+
+FutureCache<Pattern, PatternLUT> s_cache(s_cacheSize);
+
+}  // namespace
+
+std::shared_ptr<const PatternLUT> PatternLUT::get(const Pattern& pattern) {
+	return s_cache.get(pattern, [&pattern]() { return std::make_shared<const PatternLUT>(pattern); });
+}
+
+std::shared_ptr<const PatternLUT> PatternLUT::get(const Pattern& pattern, const boost::filesystem::path& cacheDir) {
+	return s_cache.get(pattern, [&pattern, &cacheDir]() {
+		const boost::filesystem::path path = cacheDir / filename(pattern);
+
+		std::shared_ptr<const PatternLUT> result;
+
+		// try to load the LUT from the cache directory
+		if(boost::filesystem::exists(path)) {
+			std::ifstream in(path.string(), std::ios::binary);
+			result = load(in, pattern);
+		}
+
+		// or create a new one, and store it - the cache is only an optimisation, so failures to write are ignored
+		if(!result) {
+			result = std::make_shared<const PatternLUT>(pattern);
+
+			boost::system::error_code ec;
+			boost::filesystem::create_directories(cacheDir, ec);
+
+			// write to a temporary file first, to avoid partial files being read by other processes
+			const boost::filesystem::path tmp =
+			    path.string() + boost::filesystem::unique_path(".%%%%%%%%").string();
+			{
+				std::ofstream out(tmp.string(), std::ios::binary);
+				if(out.good())
+					result->save(out);
+			}
+			boost::filesystem::rename(tmp, path, ec);
+			if(ec)
+				boost::filesystem::remove(tmp, ec);
+		}
+
+		return result;
+	});
+}
+
+}  // namespace lightfields
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "pattern.h"
+
+namespace lightfields {
+
+/// Precomputed per-pixel lookup of the nearest lens of a Pattern.
+///
+/// Each sensor pixel stores only a 32-bit index into a table of lens centers - the nearest-lens search
+/// (the expensive part of Pattern::sample()) is done once per pattern, and sampling becomes a simple gather.
+/// The UV offsets are recomputed from the lens center, making the results identical to Pattern::sample().
+///
+/// A pattern is fixed per camera, so LUT instances are cached (see get()), and can be persisted on disk.
+class PatternLUT {
+  public:
+	explicit PatternLUT(const Pattern& pattern);
+
+	/// returns a LUT for a pattern, shared with all other callers using the same pattern (a small number of
+	/// recently used patterns is kept in memory). Concurrent requests for a pattern being built wait for it,
+	/// without blocking requests for other patterns.
+	static std::shared_ptr<const PatternLUT> get(const Pattern& pattern);
+	/// returns a LUT for a pattern, loading it from (or storing it in) a cache directory if not found in memory
+	static std::shared_ptr<const PatternLUT> get(const Pattern& pattern, const boost::filesystem::path& cacheDir);
+
+	const Pattern& pattern() const;
+
+	/// equivalent to pattern().sample(Imath::V2i(x, y))
+	Pattern::Sample sample(int x, int y) const;
+
+	/// number of entries in the lens center table
+	std::size_t lensCount() const;
+
+	/// writes the LUT in a binary form
+	void save(std::ostream& out) const;
+	/// reads a LUT in a binary form, previously written by save(). Returns a null pointer if the data are not valid
+	/// or were created for a different pattern.
+	static std::unique_ptr<PatternLUT> load(std::istream& in, const Pattern& pattern);
+
+	/// name of the file used to persist the LUT of a pattern in a cache directory
+	static std::string filename(const Pattern& pattern);
+
+  private:
+	PatternLUT() = default;
+
+	Pattern m_pattern;
+	float m_lensPitch;
+	Imath::V2i m_size;
+
+	std::vector<Imath::V2f> m_lensCenters;
+	std::vector<uint32_t> m_indices;
+};
+
+inline Pattern::Sample PatternLUT::sample(int x, int y) const {
+	Pattern::Sample result;
+
+	result.lensCenter = m_lensCenters[m_indices[y * m_size[0] + x]];
+
+	result.offset[0] = (x - result.lensCenter[0]) / m_lensPitch * 2.0;
+	result.offset[1] = (y - result.lensCenter[1]) / m_lensPitch * 2.0;
+
+	return result;
+}
+
+}  // namespace lightfields
@@ -1,7 +1,7 @@
 #include "raw.h"
 
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <cassert>
-#include <sstream>
 
 #include <nlohmann/json.hpp>
 
@@ -32,7 +32,101 @@ void checkThrow(const T& value, const T& expected, const std::string& error) {
 
 struct Raw::Pimpl {
 	Metadata meta;
+
+	// image data - either owned (read from a stream) or pointing to a memory-mapped file
 	std::unique_ptr<unsigned char[]> data;
+	boost::iostreams::mapped_file_source file;
+	const unsigned char* image = nullptr;
+	std::size_t imageSize = 0;
+};
+
+/// Interprets the blocks of a raw file, irrespective of how they were read
+struct Raw::Reader {
+	Reader(Pimpl& p) : impl(p) {
+	}
+
+	static void parse(const unsigned char* data, std::size_t size, nlohmann::json& result) {
+		// blocks are zero-terminated or padded
+		while(size > 0 && data[size - 1] == '\0')
+			--size;
+
+		result = nlohmann::json::parse(data, data + size);
+	}
+
+	/// returns true if the block holds the image data
+	bool read(char id, const std::string& name, const unsigned char* data, std::size_t size) {
+		if(id == 'M') {
+			parse(data, size, Raw::header(impl));
+
+			if(impl.meta.header()["frames"].size() != 1)
+				throw std::runtime_error("Only single-frame raw images supported at the moment.");
+
+			metadataRef = impl.meta.header()["frames"][0]["frame"]["metadataRef"].get<std::string>();
+			privateMetadataRef = impl.meta.header()["frames"][0]["frame"]["privateMetadataRef"].get<std::string>();
+			imageRef = impl.meta.header()["frames"][0]["frame"]["imageRef"].get<std::string>();
+		}
+
+		else if(name == metadataRef) {
+			parse(data, size, Raw::meta(impl));
+			checkMetadata(Raw::meta(impl));
+		}
+
+		else if(name == privateMetadataRef)
+			parse(data, size, Raw::privateMeta(impl));
+
+		else if(name == imageRef)
+			return true;
+
+		return false;
+	}
+
+	static void checkMetadata(nlohmann::json& meta) {
+		checkThrow(meta["image"]["width"].is_number_integer(), true, "width");
+		checkThrow(meta["image"]["height"].is_number_integer(), true, "height");
+
+		checkThrow(meta["image"]["orientation"].get<int>(), 1, "orientation");
+		checkThrow(meta["image"]["representation"].get<std::string>(), std::string("rawPacked"), "representation");
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["rightShift"].get<int>(), 0, "rightShift");
+
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["black"].size(), std::size_t(4), "black size");
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["white"].size(), std::size_t(4), "white size");
+
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["black"]["b"].is_number_integer(), true, "[black][b]");
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["black"]["gb"].is_number_integer(), true, "[black][gb]");
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["black"]["gr"].is_number_integer(), true, "[black][gr]");
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["black"]["r"].is_number_integer(), true, "[black][r]");
+
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["white"]["b"].is_number_integer(), true, "[white][b]");
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["white"]["gb"].is_number_integer(), true, "[white][gb]");
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["white"]["gr"].is_number_integer(), true, "[white][gr]");
+		checkThrow(meta["image"]["rawDetails"]["pixelFormat"]["white"]["r"].is_number_integer(), true, "[white][r]");
+
+		checkThrow(meta["image"]["rawDetails"]["pixelPacking"]["endianness"].get<std::string>(), std::string("big"),
+		           "endianness");
+		checkThrow(meta["image"]["rawDetails"]["pixelPacking"]["bitsPerPixel"].get<int>(), 12, "bitsPerPixel");
+
+		checkThrow(meta["image"]["rawDetails"]["mosaic"]["tile"].get<std::string>(), std::string("r,gr:gb,b"),
+		           "mosaic/tile");
+		checkThrow(meta["image"]["rawDetails"]["mosaic"]["upperLeftPixel"].get<std::string>(), std::string("b"),
+		           "mosaic/upperLeftPixel");
+	}
+
+	/// the image block has to be large enough to hold the packed 12-bit data
+	void checkImageSize() const {
+		if(impl.image == nullptr)
+			throw std::runtime_error("No image data found in the raw file.");
+
+		const nlohmann::json& meta = impl.meta.metadata();
+		if(meta.find("image") != meta.end()) {
+			const std::size_t pixels =
+			    meta["image"]["width"].get<std::size_t>() * meta["image"]["height"].get<std::size_t>();
+			if(impl.imageSize < (pixels * 3 + 1) / 2)
+				throw std::runtime_error("Image data block too small for the image resolution in the metadata.");
+		}
+	}
+
+	Pimpl& impl;
+	std::string metadataRef, privateMetadataRef, imageRef;
 };
 
 Raw::Raw() : m_pimpl(new Pimpl()) {
@@ -41,6 +135,42 @@ Raw::Raw() : m_pimpl(new Pimpl()) {
 Raw::~Raw() {
 }
 
+Raw Raw::fromFile(const std::string& filename) {
+	std::unique_ptr<Raw::Pimpl> impl(new Raw::Pimpl());
+
+	try {
+		impl->file.open(filename);
+	}
+	catch(std::exception& e) {
+		throw std::runtime_error("Error opening raw file '" + filename + "': " + e.what());
+	}
+
+	const unsigned char* file = (const unsigned char*)impl->file.data();
+	const std::size_t fileSize = impl->file.size();
+
+	Reader reader(*impl);
+	BlockView block;
+
+	// the initial block
+	std::size_t offset = read(file, fileSize, 0, block);
+	checkThrow(block.id, 'P', "Initial P block of a lytro raw file not found.");
+
+	while(offset < fileSize) {
+		offset = read(file, fileSize, offset, block);
+
+		if(block.id != '\0' && reader.read(block.id, block.name, block.data, block.size)) {
+			impl->image = block.data;
+			impl->imageSize = block.size;
+		}
+	}
+
+	reader.checkImageSize();
+
+	Raw result;
+	result.m_pimpl = std::shared_ptr<const Raw::Pimpl>(impl.release());
+	return result;
+}
+
 const Metadata& Raw::metadata() const {
 	return m_pimpl->meta;
 }
@@ -56,14 +186,17 @@ nlohmann::json& Raw::privateMeta(Pimpl& p) {
 }
 
 const unsigned char* Raw::image() const {
-	return m_pimpl->data.get();
+	return m_pimpl->image;
+}
+
+std::size_t Raw::imageSize() const {
+	return m_pimpl->imageSize;
 }
 
 std::istream& operator>>(std::istream& in, Raw& data) {
 	std::unique_ptr<Raw::Pimpl> impl(new Raw::Pimpl());
 
-	std::string metadataRef, privateMetadataRef, imageRef;
-
+	Raw::Reader reader(*impl);
 	lightfields::Block block;
 
 	// skip the initial block
@@ -73,79 +206,13 @@ std::istream& operator>>(std::istream& in, Raw& data) {
 	while(block.id != '\0') {
 		in >> block;
 
-		if(block.id == 'M') {
-			std::stringstream ss((const char*)block.data.get());
-			ss >> Raw::header(*impl);
-
-			if(impl->meta.header()["frames"].size() != 1)
-				throw std::runtime_error("Only single-frame raw images supported at the moment.");
-
-			metadataRef = impl->meta.header()["frames"][0]["frame"]["metadataRef"].get<std::string>();
-			privateMetadataRef = impl->meta.header()["frames"][0]["frame"]["privateMetadataRef"].get<std::string>();
-			imageRef = impl->meta.header()["frames"][0]["frame"]["imageRef"].get<std::string>();
-		}
-
-		else if(block.name == metadataRef) {
-			std::stringstream ss((const char*)block.data.get());
-			ss >> Raw::meta(*impl);
-
-			checkThrow(impl->meta.metadata()["image"]["width"].is_number_integer(), true, "width");
-			checkThrow(impl->meta.metadata()["image"]["height"].is_number_integer(), true, "height");
-
-			checkThrow(impl->meta.metadata()["image"]["orientation"].get<int>(), 1, "orientation");
-			checkThrow(impl->meta.metadata()["image"]["representation"].get<std::string>(), std::string("rawPacked"),
-			           "representation");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["rightShift"].get<int>(), 0,
-			           "rightShift");
-
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["black"].size(), std::size_t(4),
-			           "black size");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["white"].size(), std::size_t(4),
-			           "white size");
-
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["black"]["b"].is_number_integer(),
-			           true, "[black][b]");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["black"]["gb"].is_number_integer(),
-			           true, "[black][gb]");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["black"]["gr"].is_number_integer(),
-			           true, "[black][gr]");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["black"]["r"].is_number_integer(),
-			           true, "[black][r]");
-
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["white"]["b"].is_number_integer(),
-			           true, "[white][b]");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["white"]["gb"].is_number_integer(),
-			           true, "[white][gb]");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["white"]["gr"].is_number_integer(),
-			           true, "[white][gr]");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelFormat"]["white"]["r"].is_number_integer(),
-			           true, "[white][r]");
-
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelPacking"]["endianness"].get<std::string>(),
-			           std::string("big"), "endianness");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["pixelPacking"]["bitsPerPixel"].get<int>(), 12,
-			           "bitsPerPixel");
-
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["mosaic"]["tile"].get<std::string>(),
-			           std::string("r,gr:gb,b"), "mosaic/tile");
-			checkThrow(impl->meta.metadata()["image"]["rawDetails"]["mosaic"]["upperLeftPixel"].get<std::string>(),
-			           std::string("b"), "mosaic/upperLeftPixel");
-		}
-
-		else if(block.name == privateMetadataRef) {
-			std::stringstream ss((const char*)block.data.get());
-			ss >> Raw::privateMeta(*impl);
-		}
-
-		// just copy the image data
-		else if(block.name == imageRef) {
+		// just move the image data
+		if(block.id != '\0' && reader.read(block.id, block.name, block.data.get(), block.size)) {
 			assert(block.data != nullptr);
+			impl->imageSize = block.size;
 			impl->data = std::move(block.data);
+			impl->image = impl->data.get();
 		}
-
-		// temporary - printouts of headers
-		// if((block.data.size() > 1) && (block.data[0] == '{'))
-		// 	std::cout << block.data.data() << std::endl;
 	}
 
 	data.m_pimpl = std::shared_ptr<const Raw::Pimpl>(impl.release());
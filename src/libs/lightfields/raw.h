@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace lightfields {
@@ -15,12 +16,18 @@ class Raw {
 	Raw();
 	~Raw();
 
+	/// Reads a raw file via memory mapping - blocks are indexed in place, and the image data are not copied (the
+	/// file stays mapped for the lifetime of the returned instance and its copies)
+	static Raw fromFile(const std::string& filename);
+
 	const Metadata& metadata() const;
 
 	const unsigned char* image() const;
+	std::size_t imageSize() const;
 
   private:
 	struct Pimpl;
+	struct Reader;
 
 	// only used for file reading
 	static nlohmann::json& header(Pimpl& p);
@@ -2,8 +2,12 @@
 
 #include <tbb/parallel_for.h>
 
+#include <algorithm>
 #include <cassert>
 
+#include "metadata.h"
+#include "raw.h"
+
 namespace lightfields {
 
 Samples::Samples() {
@@ -109,7 +113,7 @@ struct AssignSample<CV_32FC3> {
 };
 
 template <int CV_TYPE>
-std::vector<Samples::Sample> makeSamples(const Pattern& pattern, const cv::Mat& m) {
+std::vector<Samples::Sample> makeSamples(const PatternLUT& lut, const cv::Mat& m) {
 	std::vector<Samples::Sample> result;
 	result.resize(m.rows * m.cols);
 
@@ -118,7 +122,7 @@ std::vector<Samples::Sample> makeSamples(const Pattern& pattern, const cv::Mat&
 		for(int x = 0; x < m.cols; ++x) {
 			auto& sample = result[y * m.cols + x];
 
-			const Pattern::Sample coords = pattern.sample(Imath::V2i(x, y));
+			const Pattern::Sample coords = lut.sample(x, y);
 
 			// and UV coordinates, -1..1
 			sample.uv = coords.offset;
@@ -137,6 +141,11 @@ std::vector<Samples::Sample> makeSamples(const Pattern& pattern, const cv::Mat&
 }  // namespace
 
 Samples Samples::fromPattern(const Pattern& pattern, const cv::Mat& m) {
+	return fromPattern(*PatternLUT::get(pattern), m);
+}
+
+Samples Samples::fromPattern(const PatternLUT& lut, const cv::Mat& m) {
+	const Pattern& pattern = lut.pattern();
 	assert(m.rows == pattern.sensorResolution().y && m.cols == pattern.sensorResolution().x);
 	assert(m.type() == CV_32FC1 || m.type() == CV_32FC3);
 
@@ -149,17 +158,95 @@ Samples Samples::fromPattern(const Pattern& pattern, const cv::Mat& m) {
 
 	switch(m.type()) {
 		case CV_32FC1:
-			result.m_samples = makeSamples<CV_32FC1>(pattern, m);
+			result.m_samples = makeSamples<CV_32FC1>(lut, m);
 			break;
 
 		case CV_32FC3:
-			result.m_samples = makeSamples<CV_32FC3>(pattern, m);
+			result.m_samples = makeSamples<CV_32FC3>(lut, m);
 			break;
 	}
 
 	return result;
 }
 
+Samples Samples::fromRaw(const Raw& raw,
+                         const PatternLUT& lut,
+                         const Bayer::Flags& flags,
+                         const cv::Mat& vignetting,
+                         const Filter& filter) {
+	const Bayer bayer(raw.metadata().metadata());
+	const Imath::V2i size = lut.pattern().sensorResolution();
+
+	if(bayer.width() != size[0] || bayer.height() != size[1])
+		throw std::runtime_error("Raw image and pattern resolutions don't match!");
+	if(!vignetting.empty() &&
+	   (vignetting.type() != CV_32FC1 || vignetting.rows != size[1] || vignetting.cols != size[0]))
+		throw std::runtime_error("Vignetting image has to be a single-channel float image of the sensor resolution.");
+	if(raw.imageSize() < ((std::size_t)size[0] * size[1] * 3 + 1) / 2)
+		throw std::runtime_error("Raw image data too small for the sensor resolution.");
+
+	Samples result;
+	result.m_size = size;
+
+	// the same operations as in offset(), scale(), threshold() and filterInvalid()
+	const Imath::V2f center(size[0] / 2, size[1] / 2);
+	const float uvThreshold = filter.uvThreshold * filter.uvThreshold;
+	const float widthf = size[0];
+	const float heightf = size[1];
+
+	// each tile of rows is processed independently, and the results are concatenated in order
+	const int tileSize = 16;
+	std::vector<std::vector<Sample>> tiles((size[1] + tileSize - 1) / tileSize);
+
+	tbb::parallel_for(std::size_t(0), tiles.size(), [&](std::size_t tile) {
+		std::vector<float> values(size[0]);
+		std::vector<Sample>& samples = tiles[tile];
+
+		const int end = std::min((int)(tile + 1) * tileSize, size[1]);
+		for(int y = tile * tileSize; y < end; ++y) {
+			bayer.decodeRow(raw.image(), y, flags, values.data());
+
+			const float* vign = vignetting.empty() ? nullptr : vignetting.ptr<float>(y);
+
+			for(int x = 0; x < size[0]; ++x) {
+				if(vign != nullptr && !(vign[x] > 0.0f))
+					continue;
+
+				const Pattern::Sample coords = lut.sample(x, y);
+				if(!(coords.offset.length2() < uvThreshold))
+					continue;
+
+				Sample sample;
+				sample.uv = coords.offset;
+				sample.xy = coords.lensCenter;
+				sample.xy += sample.uv * filter.uvOffset;
+				sample.xy = (sample.xy - center) * filter.xyScale + center;
+
+				if(sample.xy[0] >= 0.0f && sample.xy[1] >= 0.0f && sample.xy[0] < widthf && sample.xy[1] < heightf) {
+					// hardcoded bayer pattern, same as in fromPattern()
+					sample.color = Samples::Color((x % 2) + (y % 2));
+					sample.value = Imath::V3f(0, 0, 0);
+					sample.value[sample.color] = vign == nullptr ? values[x] : values[x] / vign[x];
+
+					samples.push_back(sample);
+				}
+			}
+		}
+	});
+
+	// concatenate the tiles
+	std::vector<std::size_t> offsets(tiles.size() + 1, 0);
+	for(std::size_t t = 0; t < tiles.size(); ++t)
+		offsets[t + 1] = offsets[t] + tiles[t].size();
+
+	result.m_samples.resize(offsets.back());
+	tbb::parallel_for(std::size_t(0), tiles.size(), [&](std::size_t tile) {
+		std::copy(tiles[tile].begin(), tiles[tile].end(), result.m_samples.begin() + offsets[tile]);
+	});
+
+	return result;
+}
+
 /////////
 
 std::ostream& operator<<(std::ostream& out, const Samples& f) {
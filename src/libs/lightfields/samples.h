@@ -7,10 +7,14 @@
 
 #include <opencv2/opencv.hpp>
 
+#include "bayer.h"
 #include "pattern.h"
+#include "pattern_lut.h"
 
 namespace lightfields {
 
+class Raw;
+
 /// Creates 2D samples for lightfield refocusing (i.e., sampling a 2D plane in 4D space with constant U and V).
 class Samples {
   public:
@@ -47,7 +51,26 @@ class Samples {
 	void scale(float xy_scale);
 	void filterInvalid();
 
+	/// creates samples from a pattern and an image, using a cached PatternLUT of the pattern
 	static Samples fromPattern(const Pattern& p, const cv::Mat& data);
+	static Samples fromPattern(const PatternLUT& lut, const cv::Mat& data);
+
+	/// parameters of the sample filtering - see offset(), scale() and threshold()
+	struct Filter {
+		float uvOffset = 0.0f;
+		float xyScale = 1.0f;
+		float uvThreshold = 1.0f;
+	};
+
+	/// Fused conversion of a raw image into filtered samples, in a single tile-parallel pass without intermediate
+	/// full-resolution buffers. Decodes and normalizes the Bayer data (see Bayer::decode()), corrects vignetting by
+	/// dividing each value by an optional CV_32FC1 image of the sensor's relative transmittance (pixels with zero
+	/// transmittance are discarded), and applies offset(), scale(), threshold() and filterInvalid() in this order.
+	static Samples fromRaw(const Raw& raw,
+	                       const PatternLUT& lut,
+	                       const Bayer::Flags& flags,
+	                       const cv::Mat& vignetting,
+	                       const Filter& filter);
 
   private:
 	std::vector<Sample> m_samples;
@@ -1,8 +1,11 @@
 #include "slic_superpixels.h"
 
-#include <tbb/blocked_range2d.h>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
 
+#include <cstdint>
+
 #include "bitfield.h"
 
 namespace lightfields {
@@ -41,6 +44,33 @@ SlicSuperpixels::Center& SlicSuperpixels::Center::operator/=(int div) {
 
 ////////////
 
+SlicSuperpixels::Image::Image(const cv::Mat& in) : m_rows(in.rows), m_cols(in.cols), m_data(in.rows * in.cols * 3) {
+	if(in.type() != CV_8UC3)
+		throw std::runtime_error("Only CV_8UC3 images are supported.");
+
+	tbb::parallel_for(0, m_rows, [&](int row) {
+		const unsigned char* src = in.ptr<unsigned char>(row);
+
+		float* ch[3];
+		for(int a = 0; a < 3; ++a)
+			ch[a] = &m_data[((std::size_t)a * m_rows + row) * m_cols];
+
+		for(int col = 0; col < m_cols; ++col)
+			for(int a = 0; a < 3; ++a)
+				ch[a][col] = src[col * 3 + a];
+	});
+}
+
+int SlicSuperpixels::Image::rows() const {
+	return m_rows;
+}
+
+int SlicSuperpixels::Image::cols() const {
+	return m_cols;
+}
+
+////////////
+
 SlicSuperpixels::Metric::Metric(int S, float m) : m_S(S), m_SS(S * S), m_mm(m * m) {
 }
 
@@ -88,57 +118,158 @@ lightfields::Grid<lightfields::SlicSuperpixels::Center> SlicSuperpixels::initPix
 }
 
 namespace {
-void labelRange(const tbb::blocked_range2d<int>& range, const cv::Mat& in, Grid<SlicSuperpixels::Label>& labels,
-                const Grid<SlicSuperpixels::Center>& centers, const SlicSuperpixels::Metric& metric) {
+
+/// labels all pixels of a block of rows - each centre is evaluated only on the rows of its window within the block
+void labelRows(const tbb::blocked_range<int>& range, const SlicSuperpixels::Image& in,
+               Grid<SlicSuperpixels::Label>& labels, const Grid<SlicSuperpixels::Center>& centers,
+               const SlicSuperpixels::Metric& metric) {
+	for(int y = range.begin(); y != range.end(); ++y) {
+		SlicSuperpixels::Label* row = &labels(y, 0);
+		std::fill(row, row + in.cols(), SlicSuperpixels::Label());
+	}
+
+	// metric values of a row span of a window
+	std::vector<float> dist(2 * metric.S() + 1);
+
 	for(std::size_t center_id = 0; center_id < centers.container().size(); ++center_id) {
 		const lightfields::SlicSuperpixels::Center& center = centers.container()[center_id];
 
-		for(int y = std::max(range.rows().begin(), center.row - metric.S());
-		    y < std::min(range.rows().end(), center.row + metric.S() + 1); ++y)
-			for(int x = std::max(range.cols().begin(), center.col - metric.S());
-			    x < std::min(range.cols().end(), center.col + metric.S() + 1); ++x) {
-				const float dist = metric(center, in, y, x);
-				SlicSuperpixels::Label& current = labels(y, x);
+		const int min_y = std::max(range.begin(), center.row - metric.S());
+		const int max_y = std::min(range.end(), center.row + metric.S() + 1);
+		const int min_x = std::max(0, center.col - metric.S());
+		const int max_x = std::min(in.cols(), center.col + metric.S() + 1);
 
-				if(current.metric > dist)
-					current = SlicSuperpixels::Label(center_id, dist);
-			}
+		for(int y = min_y; y < max_y; ++y) {
+			metric.eval(center, in, y, min_x, max_x, dist.data());
+
+			SlicSuperpixels::Label* row = &labels(y, 0);
+			for(int x = min_x; x < max_x; ++x)
+				if(row[x].metric > dist[x - min_x])
+					row[x] = SlicSuperpixels::Label(center_id, dist[x - min_x]);
+		}
 	}
 }
+
+/// sums of positions and colours of pixels with one label
+struct CenterSum {
+	CenterSum() : row(0), col(0), color{{0, 0, 0}}, count(0) {
+	}
+
+	CenterSum& operator+=(const CenterSum& s) {
+		row += s.row;
+		col += s.col;
+		for(int a = 0; a < 3; ++a)
+			color[a] += s.color[a];
+		count += s.count;
+
+		return *this;
+	}
+
+	std::int64_t row, col;
+	std::array<std::int64_t, 3> color;
+	std::int64_t count;
+};
+
+typedef tbb::enumerable_thread_specific<std::vector<CenterSum>> CenterSums;
+
+/// accumulates the pixels of a block of rows into per-thread sums
+void accumulateRows(const tbb::blocked_range<int>& range, const SlicSuperpixels::Image& in,
+                    const Grid<SlicSuperpixels::Label>& labels, CenterSums& sums, std::size_t centerCount) {
+	std::vector<CenterSum>& sum = sums.local();
+	if(sum.empty())
+		sum.resize(centerCount);
+
+	for(int y = range.begin(); y != range.end(); ++y) {
+		const SlicSuperpixels::Label* row = &labels(y, 0);
+		const float* ch[3] = {in.ptr(0, y), in.ptr(1, y), in.ptr(2, y)};
+
+		for(int x = 0; x < in.cols(); ++x) {
+			assert(row[x].id >= 0 && row[x].id < (int)centerCount);
+			CenterSum& s = sum[row[x].id];
+
+			s.row += y;
+			s.col += x;
+			for(int a = 0; a < 3; ++a)
+				s.color[a] += (std::int64_t)ch[a][x];
+			++s.count;
+		}
+	}
+}
+
+/// combines the per-thread sums into new centres, and returns the average movement of the centres (the residual
+/// error from the paper)
+float updateCenters(CenterSums& sums, Grid<SlicSuperpixels::Center>& centers) {
+	std::vector<CenterSum> total(centers.container().size());
+	for(auto& s : sums)
+		if(!s.empty())
+			for(std::size_t a = 0; a < total.size(); ++a)
+				total[a] += s[a];
+
+	float movement = 0.0f;
+	for(std::size_t a = 0; a < total.size(); ++a)
+		if(total[a].count > 0) {
+			SlicSuperpixels::Center& center = centers.container()[a];
+
+			const int row = total[a].row / total[a].count;
+			const int col = total[a].col / total[a].count;
+			movement +=
+			    std::sqrt(float((row - center.row) * (row - center.row) + (col - center.col) * (col - center.col)));
+
+			center.row = row;
+			center.col = col;
+			for(int c = 0; c < 3; ++c)
+				center.color[c] = total[a].color[c] / total[a].count;
+		}
+
+	return total.empty() ? 0.0f : movement / (float)total.size();
+}
+
 }  // namespace
 
 void SlicSuperpixels::label(const cv::Mat& in, lightfields::Grid<Label>& labels,
                             const lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers,
                             const Metric& metric) {
-	assert(in.rows == (int)labels.rows() && in.cols == (int)labels.cols());
+	label(Image(in), labels, centers, metric);
+}
 
-	// clear all labels
-	tbb::parallel_for(0, int(labels.container().size()), [&](int a) { labels.container()[a] = Label(); });
+void SlicSuperpixels::label(const Image& in, lightfields::Grid<Label>& labels,
+                            const lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers,
+                            const Metric& metric) {
+	assert(in.rows() == (int)labels.rows() && in.cols() == (int)labels.cols());
 
-	// using the metric instance, label all pixels
-	tbb::parallel_for(tbb::blocked_range2d<int>(0, in.rows, 0, in.cols),
-	                  [&](const tbb::blocked_range2d<int>& range) { labelRange(range, in, labels, centers, metric); });
+	tbb::parallel_for(tbb::blocked_range<int>(0, in.rows()),
+	                  [&](const tbb::blocked_range<int>& range) { labelRows(range, in, labels, centers, metric); });
 }
 
 void SlicSuperpixels::findCenters(const cv::Mat& in, const lightfields::Grid<Label>& labels,
                                   lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers) {
-	std::vector<lightfields::SlicSuperpixels::Center> sum(centers.container().size());
-	std::vector<int> count(centers.container().size(), 0);
+	findCenters(Image(in), labels, centers);
+}
 
-	for(int row = 0; row < in.rows; ++row)
-		for(int col = 0; col < in.cols; ++col) {
-			const int label = labels(row, col).id;
-			assert(label >= 0 && label < (int)sum.size());
+float SlicSuperpixels::findCenters(const Image& in, const lightfields::Grid<Label>& labels,
+                                   lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers) {
+	assert(in.rows() == (int)labels.rows() && in.cols() == (int)labels.cols());
 
-			sum[label] += lightfields::SlicSuperpixels::Center(in, row, col);
-			count[label]++;
-		}
+	CenterSums sums;
+	tbb::parallel_for(tbb::blocked_range<int>(0, in.rows()), [&](const tbb::blocked_range<int>& range) {
+		accumulateRows(range, in, labels, sums, centers.container().size());
+	});
 
-	for(std::size_t a = 0; a < sum.size(); ++a)
-		if(count[a] > 0) {
-			sum[a] /= count[a];
-			centers.container()[a] = sum[a];
-		}
+	return updateCenters(sums, centers);
+}
+
+float SlicSuperpixels::iterate(const Image& in, lightfields::Grid<Label>& labels,
+                               lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers, const Metric& metric) {
+	assert(in.rows() == (int)labels.rows() && in.cols() == (int)labels.cols());
+
+	// labelling of a block only reads the centres, which are updated after all blocks are processed
+	CenterSums sums;
+	tbb::parallel_for(tbb::blocked_range<int>(0, in.rows()), [&](const tbb::blocked_range<int>& range) {
+		labelRows(range, in, labels, centers, metric);
+		accumulateRows(range, in, labels, sums, centers.container().size());
+	});
+
+	return updateCenters(sums, centers);
 }
 
 void SlicSuperpixels::connectedComponents(lightfields::Grid<Label>& labels,
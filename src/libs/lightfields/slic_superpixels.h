@@ -1,7 +1,9 @@
 #pragma once
 
 #include <array>
+#include <cmath>
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 #include "grid.h"
 
@@ -32,6 +34,24 @@ struct SlicSuperpixels {
 		float metric;
 	};
 
+	/// Planar single-precision copy of a 3-channel 8-bit image (e.g., in Lab colour space), precomputed once for all
+	/// iterations. Rows of each channel are contiguous, allowing the metric to be evaluated over row spans.
+	class Image {
+	  public:
+		explicit Image(const cv::Mat& in);
+
+		int rows() const;
+		int cols() const;
+
+		const float* ptr(int channel, int row) const {
+			return &m_data[((std::size_t)channel * m_rows + row) * m_cols];
+		}
+
+	  private:
+		int m_rows, m_cols;
+		std::vector<float> m_data;
+	};
+
 	/// Implementation of the distance metric from the paper
 	class Metric {
 	  public:
@@ -42,6 +62,28 @@ struct SlicSuperpixels {
 		float operator()(const lightfields::SlicSuperpixels::Center& c, const cv::Mat& m, const int row,
 		                 const int col) const;
 
+		/// evaluates the metric for a span of columns [beginCol, endCol) of a row, writing the results to
+		/// result[0 .. endCol - beginCol)
+		void eval(const Center& c, const Image& m, int row, int beginCol, int endCol, float* result) const {
+			const float* ch[3] = {m.ptr(0, row), m.ptr(1, row), m.ptr(2, row)};
+			const float color[3] = {float(c.color[0]), float(c.color[1]), float(c.color[2])};
+			const float d_row = float(c.row - row) * float(c.row - row);
+
+			for(int col = beginCol; col < endCol; ++col) {
+				float d_c = 0.0f;
+				for(int a = 0; a < 3; ++a) {
+					float elem = color[a] - ch[a][col];
+					elem *= elem;
+
+					d_c += elem;
+				}
+
+				const float d_s = d_row + float(c.col - col) * float(c.col - col);
+
+				result[col - beginCol] = std::sqrt(d_c + d_s / m_SS * m_mm);
+			}
+		}
+
 		int S() const;
 
 	  private:
@@ -58,10 +100,24 @@ struct SlicSuperpixels {
 	/// label all pixels based on the closest distance to centers
 	static void label(const cv::Mat& in, lightfields::Grid<Label>& labels,
 	                  const lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers, const Metric& metric);
+	/// label all pixels based on the closest distance to centers, in parallel over blocks of rows. Each centre
+	/// is evaluated only on the rows of each block within its 2S x 2S window.
+	static void label(const Image& in, lightfields::Grid<Label>& labels,
+	                  const lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers, const Metric& metric);
 
 	/// recompute the centres based on labels
 	static void findCenters(const cv::Mat& in, const lightfields::Grid<Label>& labels,
 	                        lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers);
+	/// recompute the centres based on labels, using per-thread accumulators. Returns the average movement
+	/// of the centres (in pixels).
+	static float findCenters(const Image& in, const lightfields::Grid<Label>& labels,
+	                         lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers);
+
+	/// A single fused iteration of the algorithm - labels all pixels and recomputes the centres in one parallel
+	/// pass over blocks of rows. Returns the average movement of the centres (in pixels), allowing to stop
+	/// iterating once the centres converge.
+	static float iterate(const Image& in, lightfields::Grid<Label>& labels,
+	                     lightfields::Grid<lightfields::SlicSuperpixels::Center>& centers, const Metric& metric);
 
 	/// connect labels using connected components.
 	/// First find the largest continuous labelled region for each label, then relabel and connect all the smaller ones
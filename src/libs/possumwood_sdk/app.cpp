@@ -7,6 +7,7 @@
 
 #include <QApplication>
 #include <QMainWindow>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <cassert>
 #include <dependency_graph/node_base.inl>
@@ -51,14 +52,48 @@ boost::filesystem::path expandEnvvars(const boost::filesystem::path& p) {
 	return result;
 }
 
+bool isTimeSource(const dependency_graph::NodeBase& node) {
+	return node.metadata()->type() == "time" || node.metadata()->type() == "frame";
+}
+
 }  // namespace
 
 App* App::s_instance = NULL;
 
-App::App(std::shared_ptr<IFilesystem> filesystem) : AppCore(filesystem), m_mainWindow(NULL), m_time(0.0f) {
+App::App(std::shared_ptr<IFilesystem> filesystem)
+    : AppCore(filesystem),
+      m_mainWindow(NULL),
+      m_time(0.0f),
+      m_frameCache(new dependency_graph::FrameCache(graph())),
+      m_evaluator(new dependency_graph::AsyncEvaluator(graph())) {
 	assert(s_instance == nullptr);
 	s_instance = this;
 
+	// finished background evaluation needs to be applied to the graph on the next draw
+	m_evaluator->onFinished([]() { Drawable::refresh(); });
+
+	// proxy values are not full-resolution results, and should not be restored from the frame cache
+	m_frameCache->setFilter([this](const dependency_graph::Port& p) { return !m_evaluator->isProxy(p); });
+
+	////////////////////////
+	// time-dependent nodes index
+
+	m_nodeAddedConnection = graph().onAddNode([this](dependency_graph::NodeBase& node) {
+		if(isTimeSource(node))
+			m_timeSources.insert(&node);
+	});
+
+	m_nodeRemovedConnection =
+	    graph().onRemoveNode([this](dependency_graph::NodeBase& node) { m_timeSources.erase(&node); });
+
+	// NodeBase::setMetadata() can change the type of a node
+	m_metadataChangedConnection = graph().onMetadataChanged([this](dependency_graph::NodeBase& node) {
+		if(isTimeSource(node))
+			m_timeSources.insert(&node);
+		else
+			m_timeSources.erase(&node);
+	});
+
 	////////////////////////
 	// scene configuration
 
@@ -70,11 +105,37 @@ App::App(std::shared_ptr<IFilesystem> filesystem) : AppCore(filesystem), m_mainW
 
 	m_sceneConfig.addItem(
 	    Config::Item("fps", "timeline", 24.0f, Config::Item::kNoFlags, "Scene's frames-per-second value"));
+
+	m_sceneConfig.addItem(Config::Item("frame_cache", "timeline", 24, Config::Item::kNoFlags,
+	                                   "Maximum number of evaluated frames kept for playback (0 to disable; each "
+	                                   "frame holds all time-dependent values, including images)"));
+
+	// opt-in - with background evaluation, draw() can show stale values (not suitable for headless rendering)
+	m_sceneConfig.addItem(Config::Item("background_evaluation", "evaluation", 0, Config::Item::kNoFlags,
+	                                   "Evaluate inputs of drawn nodes in background threads (1 to enable)"));
+
+	m_sceneConfig.addItem(Config::Item("proxy_scale", "evaluation", 1.0f, Config::Item::kNoFlags,
+	                                   "Resolution of the fast preview evaluated before the full-resolution "
+	                                   "result (1 to disable)"));
+
+	// the frame cache is keyed by time - a change of fps changes the values of all "frame" nodes
+	m_fpsChangedConnection = m_sceneConfig["fps"].onChanged([this](Config::Item& fps) {
+		m_frameCache->clear();
+
+		for(auto& n : m_timeSources)
+			if(n->metadata()->type() == "frame")
+				n->port(0).set<unsigned>(m_time * fps.as<float>());
+	});
 }
 
 App::~App() {
 	m_timeChanged.disconnect_all_slots();
 
+	m_nodeAddedConnection.disconnect();
+	m_nodeRemovedConnection.disconnect();
+	m_metadataChangedConnection.disconnect();
+	m_fpsChangedConnection.disconnect();
+
 	assert(s_instance == this);
 	s_instance = nullptr;
 }
@@ -219,6 +280,12 @@ void App::draw(const possumwood::ViewportState& viewport,
                std::function<void(const dependency_graph::NodeBase&)> stateChangedCallback) {
 	GL_CHECK_ERR;
 
+	m_evaluator->processResults();
+	const bool background = m_sceneConfig["background_evaluation"].as<int>() != 0;
+	m_evaluator->setProxyScale(background ? m_sceneConfig["proxy_scale"].as<float>() : 1.0f);
+
+	bool anyPending = false;
+
 	for(auto it = graph().nodes().begin(dependency_graph::Nodes::kRecursive); it != graph().nodes().end(); ++it) {
 		GL_CHECK_ERR;
 
@@ -226,8 +293,17 @@ void App::draw(const possumwood::ViewportState& viewport,
 		if(drawable) {
 			const auto currentDrawState = drawable->drawState();
 
+			// dirty inputs are evaluated in the background - until then, the node is drawn using stale values
+			// (requests of inputs holding proxy values schedule their full-resolution evaluation)
+			bool pending = false;
+			if(background)
+				for(std::size_t p = 0; p < it->portCount(); ++p)
+					if(it->port(p).category() == dependency_graph::Attr::kInput)
+						pending |= m_evaluator->request(it->port(p));
+			anyPending |= pending;
+
 			GL_CHECK_ERR;
-			drawable->doDraw(viewport);
+			drawable->doDraw(viewport, pending);
 			GL_CHECK_ERR;
 
 			if(drawable->drawState() != currentDrawState && stateChangedCallback)
@@ -237,22 +313,35 @@ void App::draw(const possumwood::ViewportState& viewport,
 		GL_CHECK_ERR;
 	}
 
+	// the preview is complete - the rest of the proxy values can be replaced in the background
+	if(background && !anyPending)
+		m_evaluator->refine();
+
 	GL_CHECK_ERR;
 }
 
 void App::setTime(float time) {
 	if(m_time != time) {
+		const float previousTime = m_time;
 		m_time = time;
-		m_timeChanged(time);
 
-		// TERRIBLE HACK - a special node type that outputs time is handled here
-		for(dependency_graph::Nodes::iterator i = graph().nodes().begin(dependency_graph::Nodes::kRecursive);
-		    i != graph().nodes().end(); ++i) {
-			if(i->metadata()->type() == "time")
-				i->port(0).set<float>(time);
-			if(i->metadata()->type() == "frame")
-				i->port(0).set<unsigned>(time * possumwood::App::instance().sceneConfig()["fps"].as<float>());
-		}
+		std::vector<std::reference_wrapper<dependency_graph::Port>> sources;
+		for(auto& n : m_timeSources)
+			sources.push_back(n->port(0));
+
+		m_frameCache->setCapacity(std::max(m_sceneConfig["frame_cache"].as<int>(), 0));
+
+		// a special node type that outputs time is handled here
+		m_frameCache->switchFrame(previousTime, time, sources, [&]() {
+			for(auto& n : m_timeSources) {
+				if(n->metadata()->type() == "time")
+					n->port(0).set<float>(time);
+				else
+					n->port(0).set<unsigned>(time * m_sceneConfig["fps"].as<float>());
+			}
+		});
+
+		m_timeChanged(time);
 	}
 }
 
@@ -264,6 +353,14 @@ boost::signals2::connection App::onTimeChanged(std::function<void(float)> fn) {
 	return m_timeChanged.connect(fn);
 }
 
+dependency_graph::FrameCache& App::frameCache() {
+	return *m_frameCache;
+}
+
+dependency_graph::AsyncEvaluator& App::evaluator() {
+	return *m_evaluator;
+}
+
 Config& App::sceneConfig() {
 	return m_sceneConfig;
 }
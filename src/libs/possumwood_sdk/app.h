@@ -1,5 +1,7 @@
 #pragma once
 
+#include <dependency_graph/async_evaluator.h>
+#include <dependency_graph/frame_cache.h>
 #include <dependency_graph/graph.h>
 
 #include <boost/filesystem/path.hpp>
@@ -39,15 +41,25 @@ class App : public AppCore {
 	QMainWindow* mainWindow() const;
 	void setMainWindow(QMainWindow* win);
 
-	/// run OpenGL drawing, by iterating over all Node instances and calling any existing Drawable::doDraw()
+	/// run OpenGL drawing, by iterating over all Node instances and calling any existing Drawable::doDraw().
+	/// With background evaluation enabled, dirty inputs of drawable nodes are evaluated by the
+	/// evaluator(), and drawn with their last evaluated values until the evaluation finishes.
 	void draw(const possumwood::ViewportState& viewport,
 	          std::function<void(const dependency_graph::NodeBase&)> stateChangedCallback =
 	              std::function<void(const dependency_graph::NodeBase&)>());
 
+	/// Sets the current time, and updates all time-dependent nodes. Values evaluated previously
+	/// for the same time are restored from the frame cache, if available.
 	void setTime(float time);
 	float time() const;
 	boost::signals2::connection onTimeChanged(std::function<void(float)> fn);
 
+	/// cache of evaluated values of time-dependent nodes
+	dependency_graph::FrameCache& frameCache();
+
+	/// background evaluation of values required for drawing
+	dependency_graph::AsyncEvaluator& evaluator();
+
 	Config& sceneConfig();
 	Description& sceneDescription();
 
@@ -64,6 +76,16 @@ class App : public AppCore {
 	float m_time;
 	boost::signals2::signal<void(float)> m_timeChanged;
 
+	// index of "time" and "frame" nodes, maintained on node addition and removal
+	std::set<dependency_graph::NodeBase*> m_timeSources;
+	boost::signals2::connection m_nodeAddedConnection, m_nodeRemovedConnection, m_metadataChangedConnection;
+
+	std::unique_ptr<dependency_graph::FrameCache> m_frameCache;
+	std::unique_ptr<dependency_graph::AsyncEvaluator> m_evaluator;
+
+	// frame values depend on the fps - cached frames need to be dropped on its change
+	boost::signals2::connection m_fpsChangedConnection;
+
 	Config m_sceneConfig;
 	Description m_sceneDescription;
 };
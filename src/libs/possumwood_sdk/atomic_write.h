@@ -0,0 +1,41 @@
+#pragma once
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <functional>
+
+namespace possumwood {
+
+/// Writes a file atomically - the content is written to a temporary file in the target directory first (creating
+/// the directory if needed), which then replaces the target file. Other processes never see a partially written
+/// file. Returns false if the file couldn't be written, without throwing (all current uses are optional caches,
+/// and a read-only location is not an error).
+inline bool atomicWrite(const boost::filesystem::path& path, const std::function<void(std::ostream&)>& write) {
+	boost::system::error_code ec;
+	if(path.has_parent_path())
+		boost::filesystem::create_directories(path.parent_path(), ec);
+
+	const boost::filesystem::path tmp = path.string() + boost::filesystem::unique_path(".%%%%%%%%").string();
+	{
+		std::ofstream out(tmp.string(), std::ios::binary);
+		if(out.good())
+			write(out);
+
+		if(!out.good()) {
+			out.close();
+			boost::filesystem::remove(tmp, ec);
+			return false;
+		}
+	}
+
+	boost::filesystem::rename(tmp, path, ec);
+	if(ec) {
+		boost::filesystem::remove(tmp, ec);
+		return false;
+	}
+
+	return true;
+}
+
+}  // namespace possumwood
@@ -34,7 +34,9 @@ const dependency_graph::State& Drawable::drawState() const {
 	return m_drawState;
 }
 
-void Drawable::doDraw(const ViewportState& viewport) {
+void Drawable::doDraw(const ViewportState& viewport, bool stale) {
+	m_vals.setStale(stale);
+
 	try {
 		m_viewport = viewport;
 
@@ -46,6 +48,8 @@ void Drawable::doDraw(const ViewportState& viewport) {
 		state.addError(err.what());
 		m_drawState = state;
 	}
+
+	m_vals.setStale(false);
 }
 
 //////////
@@ -14,8 +14,10 @@ class Drawable : public boost::noncopyable {
 	Drawable(dependency_graph::Values&& vals);
 	virtual ~Drawable();
 
-	/// calls draw() method, and processes the return state
-	void doDraw(const ViewportState& viewport);
+	/// calls draw() method, and processes the return state. If stale is set to true, the values are
+	/// drawn as they are, without evaluating any dirty ports (used while they are being evaluated
+	/// in the background)
+	void doDraw(const ViewportState& viewport, bool stale = false);
 
 	/// returns current drawing state
 	const dependency_graph::State& drawState() const;
@@ -23,7 +25,8 @@ class Drawable : public boost::noncopyable {
 	/// a static signal for queuing a refresh - used by the Qt UI to actually do the queuing
 	static boost::signals2::connection onRefreshQueued(std::function<void()> fn);
 
-	/// queues a refresh (does not refresh immediately, but on next Qt paint event)
+	/// queues a refresh (does not refresh immediately, but on next Qt paint event). Can be called
+	/// from any thread.
 	static void refresh();
 
   protected:
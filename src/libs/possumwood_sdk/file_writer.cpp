@@ -0,0 +1,59 @@
+#include "file_writer.h"
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace possumwood {
+
+namespace {
+
+std::map<std::type_index, FileWriterBase::write_fn>& s_writers() {
+	static std::map<std::type_index, FileWriterBase::write_fn> s_map;
+	return s_map;
+}
+
+/// the registry is modified on plugin load/unload, while exports look writers up from background threads
+std::mutex& s_writersMutex() {
+	static std::mutex s_mutex;
+	return s_mutex;
+}
+
+}  // namespace
+
+FileWriterBase::FileWriterBase(const std::type_index& type, write_fn fn) : m_type(type) {
+	std::lock_guard<std::mutex> lock(s_writersMutex());
+	s_writers()[type] = fn;
+}
+
+FileWriterBase::~FileWriterBase() {
+	std::lock_guard<std::mutex> lock(s_writersMutex());
+
+	auto it = s_writers().find(m_type);
+	if(it != s_writers().end())
+		s_writers().erase(it);
+}
+
+bool FileWriterBase::canWrite(const dependency_graph::Data& data) {
+	std::lock_guard<std::mutex> lock(s_writersMutex());
+	return s_writers().find(data.typeinfo()) != s_writers().end();
+}
+
+void FileWriterBase::write(const boost::filesystem::path& path, const dependency_graph::Data& data) {
+	write_fn fn;
+
+	{
+		std::lock_guard<std::mutex> lock(s_writersMutex());
+
+		auto it = s_writers().find(data.typeinfo());
+		if(it == s_writers().end())
+			throw std::runtime_error("No file writer registered for type " + data.type());
+
+		fn = it->second;
+	}
+
+	// the writer itself runs outside of the lock, allowing concurrent writes
+	fn(path, data);
+}
+
+}  // namespace possumwood
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+#include <typeindex>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <dependency_graph/data.inl>
+
+namespace possumwood {
+
+/// FileWriter base class, registering all existing FileWriter instances. Allows writing the values of arbitrary
+/// ports into files (e.g., images or meshes), without a type-specific "save" node - used by possumwood_cli to
+/// export the results of a graph evaluation. Similar to IO, instances are static objects in plugins, and are
+/// registered for the lifetime of the plugin.
+class FileWriterBase : public boost::noncopyable {
+  public:
+	typedef std::function<void(const boost::filesystem::path&, const dependency_graph::Data&)> write_fn;
+
+	FileWriterBase(const std::type_index& type, write_fn fn);
+	virtual ~FileWriterBase();
+
+	/// returns true if a writer is registered for the type of the data
+	static bool canWrite(const dependency_graph::Data& data);
+
+	/// writes the data into a file using a registered writer (throws std::runtime_error if no writer exists).
+	/// The registry lookup is guarded by a mutex (writers are registered and removed on plugin load/unload), and
+	/// the writer is called outside of it - writers can be called from multiple threads concurrently.
+	static void write(const boost::filesystem::path& path, const dependency_graph::Data& data);
+
+  private:
+	std::type_index m_type;
+};
+
+template <typename T>
+class FileWriter : public FileWriterBase {
+  public:
+	typedef std::function<void(const boost::filesystem::path&, const T&)> write_fn;
+
+	FileWriter(write_fn fn)
+	    : FileWriterBase(typeid(T), [fn](const boost::filesystem::path& path, const dependency_graph::Data& data) {
+		      fn(path, data.get<T>());
+	      }) {
+	}
+};
+
+}  // namespace possumwood
@@ -0,0 +1,395 @@
+#include "animation_cache.h"
+
+#include <possumwood_sdk/atomic_write.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+namespace anim {
+namespace cache {
+
+namespace {
+
+const char s_magic[8] = {'P', 'W', 'A', 'N', 'I', 'M', '0', '1'};
+
+struct Header {
+	char magic[8];
+	uint64_t sourceSize;
+	int64_t sourceModified;
+	uint64_t context;
+	uint64_t checksum;
+	uint64_t payloadSize;
+};
+
+enum AttributeType : uint8_t { kString = 0, kStringVector = 1, kOther = 2 };
+
+/// FNV-1a hash, processing 8 bytes at a time (the cache files can be large)
+uint64_t checksum(const char* data, std::size_t size) {
+	uint64_t result = 14695981039346656037ull;
+
+	const std::size_t words = size / sizeof(uint64_t);
+	for(std::size_t i = 0; i < words; ++i) {
+		uint64_t word;
+		memcpy(&word, data + i * sizeof(uint64_t), sizeof(uint64_t));
+		result = (result ^ word) * 1099511628211ull;
+	}
+
+	for(std::size_t i = words * sizeof(uint64_t); i < size; ++i)
+		result = (result ^ (unsigned char)data[i]) * 1099511628211ull;
+
+	return result;
+}
+
+/////
+
+template <typename T>
+void put(std::string& out, const T& value) {
+	out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void putString(std::string& out, const std::string& value) {
+	put<uint32_t>(out, value.size());
+	out.append(value);
+}
+
+void putTransform(std::string& out, const Transform& tr) {
+	const float values[7] = {tr.translation.x, tr.translation.y, tr.translation.z, tr.rotation.r,
+	                         tr.rotation.v.x,  tr.rotation.v.y,  tr.rotation.v.z};
+	out.append(reinterpret_cast<const char*>(values), sizeof(values));
+}
+
+/// Serialises attributes of std::string and std::vector<std::string> types. Other types are either refused
+/// (strict mode, returns false), or serialised via their string representation (only usable for hashing).
+bool putAttributes(std::string& out, const Attributes& attrs, bool strict) {
+	uint32_t count = 0;
+	for(auto& a : attrs)
+		if(!a.second.empty())
+			++count;
+	put<uint32_t>(out, count);
+
+	for(auto& a : attrs) {
+		if(a.second.empty())
+			continue;
+
+		putString(out, a.first);
+
+		if(a.second.is<std::string>()) {
+			put<uint8_t>(out, kString);
+			putString(out, a.second.as<std::string>());
+		}
+		else if(a.second.is<std::vector<std::string>>()) {
+			put<uint8_t>(out, kStringVector);
+
+			const std::vector<std::string>& values = a.second.as<std::vector<std::string>>();
+			put<uint32_t>(out, values.size());
+			for(auto& v : values)
+				putString(out, v);
+		}
+		else if(!strict) {
+			put<uint8_t>(out, kOther);
+			putString(out, a.second.type());
+			putString(out, a.second.toString());
+		}
+		else
+			return false;
+	}
+
+	return true;
+}
+
+/// serialises the skeleton's hierarchy, rest pose and attributes
+bool putSkeleton(std::string& out, const Skeleton& skeleton, bool strict) {
+	if(!putAttributes(out, skeleton.attributes(), strict))
+		return false;
+
+	put<uint32_t>(out, skeleton.size());
+	for(auto& j : skeleton) {
+		put<int32_t>(out, j.hasParent() ? (int32_t)j.parent().index() : -1);
+		putString(out, j.name());
+		putTransform(out, j.tr());
+
+		if(!putAttributes(out, j.attributes(), strict))
+			return false;
+	}
+
+	return true;
+}
+
+/////
+
+/// Reads values directly from the mapped data, throwing on reads past the end (e.g., truncated files)
+class Reader {
+  public:
+	Reader(const char* begin, const char* end) : m_current(begin), m_end(end) {
+	}
+
+	template <typename T>
+	T get() {
+		check(sizeof(T));
+
+		T result;
+		memcpy(&result, m_current, sizeof(T));
+		m_current += sizeof(T);
+
+		return result;
+	}
+
+	std::string getString() {
+		const uint32_t size = get<uint32_t>();
+		check(size);
+
+		std::string result(m_current, size);
+		m_current += size;
+
+		return result;
+	}
+
+	Transform getTransform() {
+		float values[7];
+		check(sizeof(values));
+
+		memcpy(values, m_current, sizeof(values));
+		m_current += sizeof(values);
+
+		// assigned directly, to avoid re-normalization of the stored values
+		Transform result;
+		result.translation = Imath::V3f(values[0], values[1], values[2]);
+		result.rotation = Imath::Quatf(values[3], values[4], values[5], values[6]);
+
+		return result;
+	}
+
+	void getAttributes(Attributes& attrs) {
+		const uint32_t count = get<uint32_t>();
+		for(uint32_t a = 0; a < count; ++a) {
+			const std::string key = getString();
+
+			const uint8_t type = get<uint8_t>();
+			if(type == kString)
+				attrs[key] = getString();
+
+			else if(type == kStringVector) {
+				std::vector<std::string> values(get<uint32_t>());
+				for(auto& v : values)
+					v = getString();
+
+				attrs[key] = values;
+			}
+
+			else
+				throw std::runtime_error("unsupported attribute type in cache");
+		}
+	}
+
+	void check(uint64_t size) const {
+		if((uint64_t)(m_end - m_current) < size)
+			throw std::runtime_error("truncated cache");
+	}
+
+	bool eof() const {
+		return m_current == m_end;
+	}
+
+  private:
+	const char* m_current;
+	const char* m_end;
+};
+
+}  // namespace
+
+namespace {
+
+/// the cache directory - the POSSUMWOOD_ANIM_CACHE variable, or a subdirectory of the user's cache directory
+boost::filesystem::path directory() {
+	const char* dir = getenv("POSSUMWOOD_ANIM_CACHE");
+	if(dir != nullptr)
+		return dir;
+
+	const char* xdgCache = getenv("XDG_CACHE_HOME");
+	if(xdgCache != nullptr && *xdgCache != '\0')
+		return boost::filesystem::path(xdgCache) / "possumwood" / "anim";
+
+	const char* home = getenv("HOME");
+	if(home != nullptr && *home != '\0')
+		return boost::filesystem::path(home) / ".cache" / "possumwood" / "anim";
+
+	return boost::filesystem::path();
+}
+
+}  // namespace
+
+boost::filesystem::path path(const boost::filesystem::path& source) {
+	const boost::filesystem::path dir = directory();
+	if(dir.empty())
+		return boost::filesystem::path();
+
+	// a flat cache directory - the absolute path of the source is hashed to avoid name clashes
+	const std::string fullPath = boost::filesystem::absolute(source).string();
+
+	std::stringstream filename;
+	filename << std::hex << std::setw(16) << std::setfill('0') << checksum(fullPath.c_str(), fullPath.size())
+	         << "_" << source.filename().string() << ".pwanim";
+
+	return dir / filename.str();
+}
+
+namespace {
+
+/// Reads the cache of a source file. The frames are filled in directly as copies of the target skeleton (if not
+/// null), or of the cached skeleton otherwise.
+bool readCache(const boost::filesystem::path& source, uint64_t context, const Skeleton* target,
+               Skeleton& skeleton, Animation& anim) {
+	const boost::filesystem::path cachePath = path(source);
+
+	boost::system::error_code ec;
+	if(cachePath.empty() || !boost::filesystem::exists(cachePath, ec))
+		return false;
+
+	const uint64_t sourceSize = boost::filesystem::file_size(source, ec);
+	const int64_t sourceModified = boost::filesystem::last_write_time(source, ec);
+	if(ec)
+		return false;
+
+	try {
+		boost::iostreams::mapped_file_source file(cachePath.string());
+		if(file.size() < sizeof(Header))
+			return false;
+
+		// the cache has to match the source and the context
+		Header header;
+		memcpy(&header, file.data(), sizeof(Header));
+		if(memcmp(header.magic, s_magic, sizeof(s_magic)) != 0 || header.sourceSize != sourceSize ||
+		   header.sourceModified != sourceModified || header.context != context ||
+		   header.payloadSize != file.size() - sizeof(Header))
+			return false;
+
+		const char* payload = file.data() + sizeof(Header);
+		if(checksum(payload, header.payloadSize) != header.checksum)
+			return false;
+
+		Reader reader(payload, payload + header.payloadSize);
+
+		// the hierarchy - joints are stored in index order, with parents always preceding their children
+		Skeleton skel;
+		reader.getAttributes(skel.attributes());
+
+		const uint32_t jointCount = reader.get<uint32_t>();
+		for(uint32_t j = 0; j < jointCount; ++j) {
+			const int32_t parent = reader.get<int32_t>();
+			const std::string name = reader.getString();
+			const Transform tr = reader.getTransform();
+
+			std::size_t index = 0;
+			if(j == 0 && parent == -1)
+				skel.addRoot(name, tr);
+			else if(j > 0 && parent >= 0 && parent < (int32_t)j)
+				index = skel.addChild(skel[parent], tr, name);
+			else
+				return false;
+
+			// rebuilding the hierarchy has to keep the original joint order
+			if(index != j)
+				return false;
+
+			reader.getAttributes(skel[j].attributes());
+		}
+
+		if(target != nullptr && target->size() != jointCount)
+			return false;
+
+		// the frames block
+		const float fps = reader.get<float>();
+		const uint32_t frameCount = reader.get<uint32_t>();
+		reader.check((uint64_t)frameCount * jointCount * 7 * sizeof(float));
+
+		Animation result(fps);
+
+		Skeleton frame = target != nullptr ? *target : skel;
+		for(uint32_t f = 0; f < frameCount; ++f) {
+			for(uint32_t j = 0; j < jointCount; ++j)
+				frame[j].tr() = reader.getTransform();
+
+			result.addFrame(frame);
+		}
+
+		if(!reader.eof())
+			return false;
+
+		skeleton = std::move(skel);
+		anim = std::move(result);
+	}
+	catch(const std::exception&) {
+		return false;
+	}
+
+	return true;
+}
+
+}  // namespace
+
+bool read(const boost::filesystem::path& source, uint64_t context, Skeleton& skeleton, Animation& anim) {
+	return readCache(source, context, nullptr, skeleton, anim);
+}
+
+bool readFrames(const boost::filesystem::path& source, uint64_t context, const Skeleton& skeleton,
+                Animation& anim) {
+	Skeleton cached;
+	return readCache(source, context, &skeleton, cached, anim);
+}
+
+void write(const boost::filesystem::path& source, uint64_t context, const Skeleton& skeleton,
+           const Animation& anim) {
+	const boost::filesystem::path cachePath = path(source);
+	if(cachePath.empty())
+		return;
+
+	std::string payload;
+	if(!putSkeleton(payload, skeleton, true))
+		return;
+
+	put<float>(payload, anim.fps());
+	put<uint32_t>(payload, anim.size());
+
+	payload.reserve(payload.size() + anim.size() * skeleton.size() * 7 * sizeof(float));
+	for(auto& frame : anim) {
+		if(frame.size() != skeleton.size())
+			return;
+
+		for(auto& j : frame)
+			putTransform(payload, j.tr());
+	}
+
+	Header header;
+	memcpy(header.magic, s_magic, sizeof(s_magic));
+	header.context = context;
+	header.checksum = checksum(payload.c_str(), payload.size());
+	header.payloadSize = payload.size();
+
+	boost::system::error_code ec;
+	header.sourceSize = boost::filesystem::file_size(source, ec);
+	header.sourceModified = boost::filesystem::last_write_time(source, ec);
+	if(ec)
+		return;
+
+	possumwood::atomicWrite(cachePath, [&](std::ostream& out) {
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		out.write(payload.c_str(), payload.size());
+	});
+}
+
+uint64_t hash(const Skeleton& skeleton) {
+	std::string data;
+	putSkeleton(data, skeleton, false);
+
+	return checksum(data.c_str(), data.size());
+}
+
+}  // namespace cache
+}  // namespace anim
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
+
+#include "datatypes/animation.h"
+#include "datatypes/skeleton.h"
+
+namespace anim {
+
+/// A compact binary cache of loaded animation data, allowing loaders to skip parsing of unchanged text files.
+///
+/// The cache file contains the hierarchy (with joint names, rest transformations and attributes) once, followed
+/// by a contiguous block of frames x joints transformations. A cache file is valid only for the modification time
+/// and size of its source file, and for a "context" hash of any other inputs that influence the loaded result
+/// (e.g., the skeleton an AMC file is applied to). The content is protected by a checksum.
+///
+/// Cache files are stored in the directory specified by the POSSUMWOOD_ANIM_CACHE environment variable (set it to
+/// an empty string to disable caching), or in possumwood/anim of the user's cache directory ($XDG_CACHE_HOME or
+/// ~/.cache) by default. Failures to write a cache file (e.g., in a read-only directory) are silently ignored, as
+/// the cache is only an optimisation.
+namespace cache {
+
+/// returns the path of the cache file for a source file (empty if caching is disabled)
+boost::filesystem::path path(const boost::filesystem::path& source);
+
+/// Reads the cached skeleton and animation of a source file. Returns false if no valid cache exists.
+bool read(const boost::filesystem::path& source, uint64_t context, Skeleton& skeleton, Animation& anim);
+
+/// Reads the cached frames of a source file directly as poses of an existing skeleton (with the same joint count
+/// as the cached one), sharing its hierarchy and attributes. Returns false if no valid cache exists.
+bool readFrames(const boost::filesystem::path& source, uint64_t context, const Skeleton& skeleton,
+                Animation& anim);
+
+/// Writes the cache for a source file. Skeletons with attributes of types other than std::string and
+/// std::vector<std::string> are not cached.
+void write(const boost::filesystem::path& source, uint64_t context, const Skeleton& skeleton,
+           const Animation& anim);
+
+/// a hash of the hierarchy, rest pose and attributes of a skeleton (to be used as a cache context)
+uint64_t hash(const Skeleton& skeleton);
+
+}  // namespace cache
+}  // namespace anim
@@ -0,0 +1,117 @@
+#include "packed_skinned_mesh.h"
+
+#include <limits>
+#include <stdexcept>
+
+#include "skinned_mesh.h"
+
+namespace anim {
+
+PackedSkinnedMesh::PackedSkinnedMesh() : m_maxInfluences(4) {
+}
+
+PackedSkinnedMesh::PackedSkinnedMesh(const SkinnedMesh& mesh, unsigned maxInfluences)
+    : m_name(mesh.name()), m_maxInfluences(maxInfluences) {
+	if(maxInfluences != 4 && maxInfluences != 8)
+		throw std::runtime_error("Packed skinned mesh supports only 4 or 8 influences per vertex, " +
+		                         std::to_string(maxInfluences) + " requested.");
+
+	const SkinnedVertices& vertices = mesh.vertices();
+	if(vertices.size() > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("Mesh " + mesh.name() + " has too many vertices to be packed.");
+
+	m_positions.reserve(vertices.size());
+	m_bones.resize(vertices.size() * maxInfluences, 0);
+	m_weights.resize(vertices.size() * maxInfluences, 0.0f);
+
+	for(std::size_t v = 0; v < vertices.size(); ++v) {
+		m_positions.push_back(vertices[v].pos());
+
+		// drops the smallest weights, and normalizes the rest
+		Skinning skin = vertices[v].skinning();
+		if(!skin.empty())
+			skin.limitInfluenceCount(maxInfluences);
+
+		std::size_t slot = v * maxInfluences;
+		for(auto& w : skin) {
+			if(w.bone > std::numeric_limits<uint16_t>::max())
+				throw std::runtime_error("Bone index " + std::to_string(w.bone) + " of mesh " + mesh.name() +
+				                         " cannot be packed.");
+
+			m_bones[slot] = w.bone;
+			m_weights[slot] = w.weight;
+			++slot;
+		}
+	}
+
+	m_normals = mesh.normals();
+
+	m_indices.reserve(mesh.polygons().size() * 3);
+	for(auto& p : mesh.polygons())
+		for(auto& i : p) {
+			if(i >= vertices.size())
+				throw std::runtime_error("Polygon vertex index " + std::to_string(i) + " of mesh " + mesh.name() +
+				                         " is out of range.");
+
+			m_indices.push_back(i);
+		}
+}
+
+SkinnedMesh PackedSkinnedMesh::unpack() const {
+	SkinnedMesh result;
+	result.setName(m_name);
+
+	for(std::size_t v = 0; v < m_positions.size(); ++v) {
+		Skinning skin;
+		for(std::size_t slot = v * m_maxInfluences; slot < (v + 1) * m_maxInfluences; ++slot)
+			if(m_weights[slot] != 0.0f)
+				skin.addWeight(m_bones[slot], m_weights[slot]);
+
+		result.vertices().add(m_positions[v], skin);
+	}
+
+	result.normals() = m_normals;
+
+	for(std::size_t p = 0; p < m_indices.size(); p += 3)
+		result.polygons().add(m_indices[p], m_indices[p + 1], m_indices[p + 2]);
+
+	return result;
+}
+
+const std::string& PackedSkinnedMesh::name() const {
+	return m_name;
+}
+
+std::size_t PackedSkinnedMesh::vertexCount() const {
+	return m_positions.size();
+}
+
+std::size_t PackedSkinnedMesh::polygonCount() const {
+	return m_indices.size() / 3;
+}
+
+unsigned PackedSkinnedMesh::maxInfluences() const {
+	return m_maxInfluences;
+}
+
+const std::vector<Imath::V3f>& PackedSkinnedMesh::positions() const {
+	return m_positions;
+}
+
+const std::vector<Imath::V3f>& PackedSkinnedMesh::normals() const {
+	return m_normals;
+}
+
+const std::vector<uint32_t>& PackedSkinnedMesh::indices() const {
+	return m_indices;
+}
+
+const std::vector<uint16_t>& PackedSkinnedMesh::bones() const {
+	return m_bones;
+}
+
+const std::vector<float>& PackedSkinnedMesh::weights() const {
+	return m_weights;
+}
+
+}  // namespace anim
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <OpenEXR/ImathVec.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace anim {
+
+class SkinnedMesh;
+
+/// A compact representation of a SkinnedMesh, using flat arrays without any per-vertex allocations - 32-bit
+/// triangle indices, and a fixed number of influences per vertex (4 or 8), each with a 16-bit bone ID and a
+/// normalized weight. Considerably cheaper to store and copy than SkinnedMesh for large skinned assets.
+class PackedSkinnedMesh {
+  public:
+	PackedSkinnedMesh();
+
+	/// Converts a SkinnedMesh, limiting the number of influences of each vertex (via
+	/// Skinning::limitInfluenceCount()). Throws std::runtime_error if the mesh doesn't fit the packed format.
+	explicit PackedSkinnedMesh(const SkinnedMesh& mesh, unsigned maxInfluences = 4);
+
+	/// converts back to a SkinnedMesh (unused influence slots are omitted)
+	SkinnedMesh unpack() const;
+
+	const std::string& name() const;
+
+	std::size_t vertexCount() const;
+	std::size_t polygonCount() const;
+	unsigned maxInfluences() const;
+
+	const std::vector<Imath::V3f>& positions() const;
+	const std::vector<Imath::V3f>& normals() const;
+
+	/// vertex indices, 3 per triangle
+	const std::vector<uint32_t>& indices() const;
+
+	/// bones and weights, maxInfluences() per vertex; unused slots have zero weight
+	const std::vector<uint16_t>& bones() const;
+	const std::vector<float>& weights() const;
+
+  private:
+	std::string m_name;
+	unsigned m_maxInfluences;
+
+	std::vector<Imath::V3f> m_positions;
+	std::vector<Imath::V3f> m_normals;
+	std::vector<uint32_t> m_indices;
+
+	std::vector<uint16_t> m_bones;
+	std::vector<float> m_weights;
+};
+
+}  // namespace anim
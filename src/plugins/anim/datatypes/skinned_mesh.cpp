@@ -1,10 +1,33 @@
 #include "skinned_mesh.h"
 
+#include "skinning_weights.h"
+
 namespace anim {
 
+namespace {
+
+const Polygons s_noPolygons;
+
+}
+
 SkinnedMesh::SkinnedMesh() {
 }
 
+SkinnedMesh::SkinnedMesh(const SkinnedMesh& m)
+    : m_name(m.m_name), m_vertices(m.m_vertices), m_normals(m.m_normals), m_polygons(m.m_polygons),
+      m_skinningWeights(std::atomic_load(&m.m_skinningWeights)) {
+}
+
+SkinnedMesh& SkinnedMesh::operator=(const SkinnedMesh& m) {
+	m_name = m.m_name;
+	m_vertices = m.m_vertices;
+	m_normals = m.m_normals;
+	m_polygons = m.m_polygons;
+	m_skinningWeights = std::atomic_load(&m.m_skinningWeights);
+
+	return *this;
+}
+
 const std::string& SkinnedMesh::name() const {
 	return m_name;
 }
@@ -14,6 +37,9 @@ void SkinnedMesh::setName(const std::string& name) {
 }
 
 SkinnedVertices& SkinnedMesh::vertices() {
+	// the caller can change the mesh - the skinning data cache is no longer valid
+	m_skinningWeights.reset();
+
 	return m_vertices;
 }
 
@@ -22,6 +48,8 @@ const SkinnedVertices& SkinnedMesh::vertices() const {
 }
 
 std::vector<Imath::V3f>& SkinnedMesh::normals() {
+	m_skinningWeights.reset();
+
 	return m_normals;
 }
 
@@ -30,11 +58,30 @@ const std::vector<Imath::V3f>& SkinnedMesh::normals() const {
 }
 
 Polygons& SkinnedMesh::polygons() {
-	return m_polygons;
+	m_skinningWeights.reset();
+
+	if(!m_polygons)
+		m_polygons = std::make_shared<Polygons>();
+	else if(m_polygons.use_count() > 1)
+		m_polygons = std::make_shared<Polygons>(*m_polygons);
+
+	return *m_polygons;
 }
 
 const Polygons& SkinnedMesh::polygons() const {
-	return m_polygons;
+	return m_polygons ? *m_polygons : s_noPolygons;
+}
+
+std::shared_ptr<const SkinningWeights> SkinnedMesh::skinningWeights() const {
+	std::shared_ptr<const SkinningWeights> result = std::atomic_load(&m_skinningWeights);
+
+	// concurrent first use might build the data twice, but the result is the same
+	if(!result) {
+		result = std::make_shared<const SkinningWeights>(*this);
+		std::atomic_store(&m_skinningWeights, result);
+	}
+
+	return result;
 }
 
 }  // namespace anim
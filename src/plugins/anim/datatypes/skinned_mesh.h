@@ -10,11 +10,19 @@
 
 namespace anim {
 
+class SkinningWeights;
+
 /// A slightly sloppy version of skinned mesh data representation
 class SkinnedMesh {
   public:
 	SkinnedMesh();
 
+	SkinnedMesh(const SkinnedMesh& m);
+	SkinnedMesh& operator=(const SkinnedMesh& m);
+
+	SkinnedMesh(SkinnedMesh&& m) = default;
+	SkinnedMesh& operator=(SkinnedMesh&& m) = default;
+
 	const std::string& name() const;
 	void setName(const std::string& name);
 
@@ -24,15 +32,22 @@ class SkinnedMesh {
 	std::vector<Imath::V3f>& normals();
 	const std::vector<Imath::V3f>& normals() const;
 
+	/// the polygons are shared between copies of the mesh, until modified
 	Polygons& polygons();
 	const Polygons& polygons() const;
 
+	/// Returns a flat representation of the skinning data, used for deformation. Built on first use and cached,
+	/// until the mesh is accessed via any of the non-const accessors.
+	std::shared_ptr<const SkinningWeights> skinningWeights() const;
+
   protected:
   private:
 	std::string m_name;
 	SkinnedVertices m_vertices;
 	std::vector<Imath::V3f> m_normals;
-	Polygons m_polygons;
+	std::shared_ptr<Polygons> m_polygons;  // copy-on-write, null for no polygons
+
+	mutable std::shared_ptr<const SkinningWeights> m_skinningWeights;
 };
 }  // namespace anim
 
@@ -4,60 +4,92 @@
 
 namespace anim {
 
+namespace {
+
+const std::vector<Skinning::Weight> s_noWeights;
+
+}
+
+void Skinning::detach() {
+	if(!m_weights)
+		m_weights = std::make_shared<std::vector<Weight>>();
+	// a single owner means no other instance can access the weights (and copy them concurrently)
+	else if(m_weights.use_count() > 1)
+		m_weights = std::make_shared<std::vector<Weight>>(*m_weights);
+}
+
 void Skinning::addWeight(std::size_t bone, float weight) {
-	m_weights.push_back(Weight(bone, weight));
+	detach();
+
+	m_weights->push_back(Weight(bone, weight));
 }
 
 void Skinning::normalize() {
+	if(empty())
+		return;
+
+	detach();
+
 	float total = 0.0f;
-	for(auto& w : m_weights)
+	for(auto& w : *m_weights)
 		total += w.weight;
 
 	if(total > 0.0f)
-		for(auto& w : m_weights)
+		for(auto& w : *m_weights)
 			w.weight /= total;
 }
 
 void Skinning::limitInfluenceCount(std::size_t count) {
 	assert(count > 0);
 
-	while(count < m_weights.size()) {
-		float minVal = 0.0f;
+	if(empty())
+		return;
+
+	detach();
+
+	std::vector<Weight>& weights = *m_weights;
+
+	while(count < weights.size()) {
+		float minVal = weights[0].weight;
 		std::size_t minIndex = 0;
 
-		for(std::size_t i = 0; i < m_weights.size(); ++i)
-			if(minVal > m_weights[i].weight) {
-				minVal = m_weights[i].weight;
+		for(std::size_t i = 1; i < weights.size(); ++i)
+			if(minVal > weights[i].weight) {
+				minVal = weights[i].weight;
 				minIndex = i;
 			}
 
-		m_weights.erase(m_weights.begin() + minIndex);
+		weights.erase(weights.begin() + minIndex);
 	}
 
 	normalize();
 }
 
 bool Skinning::empty() const {
-	return m_weights.empty();
+	return !m_weights || m_weights->empty();
 }
 
 std::size_t Skinning::size() const {
-	return m_weights.size();
+	return m_weights ? m_weights->size() : 0;
 }
 
 Skinning::const_iterator Skinning::begin() const {
-	return m_weights.begin();
+	return m_weights ? m_weights->cbegin() : s_noWeights.begin();
 }
 
 Skinning::const_iterator Skinning::end() const {
-	return m_weights.end();
+	return m_weights ? m_weights->cend() : s_noWeights.end();
 }
 
 Skinning::iterator Skinning::begin() {
-	return m_weights.begin();
+	detach();
+
+	return m_weights->begin();
 }
 
 Skinning::iterator Skinning::end() {
-	return m_weights.end();
+	detach();
+
+	return m_weights->end();
 }
 }  // namespace anim
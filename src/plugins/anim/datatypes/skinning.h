@@ -1,9 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 namespace anim {
 
+/// Skinning weights of a single vertex. The weights are shared between copies (copy-on-write), making a copy of
+/// a skinned mesh (e.g., to hold its posed vertex positions) cheap.
 class Skinning {
   public:
 	struct Weight {
@@ -31,6 +34,10 @@ class Skinning {
 	iterator end();
 
   private:
-	std::vector<Weight> m_weights;
+	/// makes sure the weights are not shared with any other instance before they are modified
+	void detach();
+
+	// null for no weights
+	std::shared_ptr<std::vector<Weight>> m_weights;
 };
 }  // namespace anim
@@ -0,0 +1,299 @@
+#include "skinning_weights.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <sstream>
+
+#include "packed_skinned_mesh.h"
+#include "skinned_mesh.h"
+
+namespace anim {
+
+namespace {
+
+const uint32_t s_noVertex = std::numeric_limits<uint32_t>::max();
+
+typedef tbb::blocked_range<std::size_t> Range;
+
+/// A rigid transformation as a row-major 3x4 matrix, computed from a unit quaternion and a translation
+void toMatrix(float w, float x, float y, float z, float tx, float ty, float tz, float* m) {
+	m[0] = 1.0f - 2.0f * (y * y + z * z);
+	m[1] = 2.0f * (x * y - w * z);
+	m[2] = 2.0f * (x * z + w * y);
+	m[3] = tx;
+
+	m[4] = 2.0f * (x * y + w * z);
+	m[5] = 1.0f - 2.0f * (x * x + z * z);
+	m[6] = 2.0f * (y * z - w * x);
+	m[7] = ty;
+
+	m[8] = 2.0f * (x * z - w * y);
+	m[9] = 2.0f * (y * z + w * x);
+	m[10] = 1.0f - 2.0f * (x * x + y * y);
+	m[11] = tz;
+}
+
+/// Converts a (non-normalized) dual quaternion, stored as {real.wxyz, dual.wxyz}, to a row-major 3x4 matrix
+void dualQuatToMatrix(const float* dq, float* m) {
+	const float length = std::sqrt(dq[0] * dq[0] + dq[1] * dq[1] + dq[2] * dq[2] + dq[3] * dq[3]);
+	const float norm = length > 0.0f ? 1.0f / length : 0.0f;
+
+	const float w = dq[0] * norm, x = dq[1] * norm, y = dq[2] * norm, z = dq[3] * norm;
+	const float dw = dq[4] * norm, dx = dq[5] * norm, dy = dq[6] * norm, dz = dq[7] * norm;
+
+	// translation = 2 * dual * conjugate(real)
+	const float tx = 2.0f * (-dw * x + dx * w - dy * z + dz * y);
+	const float ty = 2.0f * (-dw * y + dy * w - dz * x + dx * z);
+	const float tz = 2.0f * (-dw * z + dz * w - dx * y + dy * x);
+
+	toMatrix(w, x, y, z, tx, ty, tz, m);
+}
+
+}  // namespace
+
+SkinningWeights::SkinningWeights(const SkinnedMesh& mesh) : m_boneCount(0) {
+	const SkinnedVertices& vertices = mesh.vertices();
+
+	m_offsets.reserve(vertices.size() + 1);
+	m_offsets.push_back(0);
+
+	m_x.reserve(vertices.size());
+	m_y.reserve(vertices.size());
+	m_z.reserve(vertices.size());
+
+	for(auto& v : vertices) {
+		m_x.push_back(v.pos().x);
+		m_y.push_back(v.pos().y);
+		m_z.push_back(v.pos().z);
+
+		// weights are normalized once here, instead of for each evaluation
+		float sum = 0.0f;
+		for(auto& w : v.skinning())
+			sum += w.weight;
+
+		if(sum > 0.0f)
+			for(auto& w : v.skinning())
+				if(w.weight != 0.0f) {
+					m_bones.push_back(w.bone);
+					m_weights.push_back(w.weight / sum);
+
+					m_boneCount = std::max(m_boneCount, w.bone + 1);
+				}
+
+		m_offsets.push_back(m_bones.size());
+	}
+
+	const std::vector<Imath::V3f>& normals = mesh.normals();
+
+	m_nx.reserve(normals.size());
+	m_ny.reserve(normals.size());
+	m_nz.reserve(normals.size());
+	m_normalVertices.reserve(normals.size());
+
+	for(std::size_t n = 0; n < normals.size(); ++n) {
+		m_nx.push_back(normals[n].x);
+		m_ny.push_back(normals[n].y);
+		m_nz.push_back(normals[n].z);
+
+		uint32_t vertex = s_noVertex;
+		if(n / 3 < mesh.polygons().size() && mesh.polygons()[n / 3][n % 3] < vertices.size())
+			vertex = mesh.polygons()[n / 3][n % 3];
+		m_normalVertices.push_back(vertex);
+	}
+}
+
+SkinningWeights::SkinningWeights(const PackedSkinnedMesh& mesh) : m_boneCount(0) {
+	const std::size_t influences = mesh.maxInfluences();
+	const std::vector<uint16_t>& bones = mesh.bones();
+	const std::vector<float>& weights = mesh.weights();
+
+	m_offsets.reserve(mesh.vertexCount() + 1);
+	m_offsets.push_back(0);
+
+	m_x.reserve(mesh.vertexCount());
+	m_y.reserve(mesh.vertexCount());
+	m_z.reserve(mesh.vertexCount());
+
+	for(std::size_t v = 0; v < mesh.vertexCount(); ++v) {
+		const Imath::V3f& pos = mesh.positions()[v];
+		m_x.push_back(pos.x);
+		m_y.push_back(pos.y);
+		m_z.push_back(pos.z);
+
+		// the packed weights are already normalized; unused slots have zero weight
+		for(std::size_t slot = v * influences; slot < (v + 1) * influences; ++slot)
+			if(weights[slot] != 0.0f) {
+				m_bones.push_back(bones[slot]);
+				m_weights.push_back(weights[slot]);
+
+				m_boneCount = std::max(m_boneCount, std::size_t(bones[slot]) + 1);
+			}
+
+		m_offsets.push_back(m_bones.size());
+	}
+
+	const std::vector<Imath::V3f>& normals = mesh.normals();
+	const std::vector<uint32_t>& indices = mesh.indices();
+
+	m_nx.reserve(normals.size());
+	m_ny.reserve(normals.size());
+	m_nz.reserve(normals.size());
+	m_normalVertices.reserve(normals.size());
+
+	// normals are stored per polygon corner, i.e., in the same order as the indices
+	for(std::size_t n = 0; n < normals.size(); ++n) {
+		m_nx.push_back(normals[n].x);
+		m_ny.push_back(normals[n].y);
+		m_nz.push_back(normals[n].z);
+
+		m_normalVertices.push_back(n < indices.size() ? indices[n] : s_noVertex);
+	}
+}
+
+std::size_t SkinningWeights::vertexCount() const {
+	return m_x.size();
+}
+
+std::size_t SkinningWeights::normalCount() const {
+	return m_nx.size();
+}
+
+std::size_t SkinningWeights::boneCount() const {
+	return m_boneCount;
+}
+
+void SkinningWeights::apply(const std::vector<Transform>& transforms, Method method, SkinnedMesh& target) const {
+	if(m_boneCount > transforms.size()) {
+		std::set<uint32_t> missingBones;
+		for(auto& b : m_bones)
+			if(b >= transforms.size())
+				missingBones.insert(b);
+
+		std::stringstream err;
+		err << "Skinning uses a bone that is not included in the skeleton! Missing bone IDs:";
+
+		for(auto& b : missingBones)
+			err << b << " ";
+
+		throw std::runtime_error(err.str());
+	}
+
+	if(target.vertices().size() != vertexCount() || target.normals().size() != normalCount())
+		throw std::runtime_error("Skinning target mesh topology doesn't match the source mesh.");
+
+	// per-bone transformations, as 3x4 matrices (for linear blending) or dual quaternions
+	std::vector<float> bones(transforms.size() * (method == kLinear ? 12 : 8));
+	for(std::size_t b = 0; b < transforms.size(); ++b) {
+		const Imath::Quatf& q = transforms[b].rotation;
+		const Imath::V3f& t = transforms[b].translation;
+
+		if(method == kLinear)
+			toMatrix(q.r, q.v.x, q.v.y, q.v.z, t.x, t.y, t.z, &bones[b * 12]);
+
+		else {
+			float* dq = &bones[b * 8];
+
+			dq[0] = q.r;
+			dq[1] = q.v.x;
+			dq[2] = q.v.y;
+			dq[3] = q.v.z;
+
+			// dual = 0.5 * translation * real
+			dq[4] = -0.5f * (t.x * q.v.x + t.y * q.v.y + t.z * q.v.z);
+			dq[5] = 0.5f * (t.x * q.r + t.y * q.v.z - t.z * q.v.y);
+			dq[6] = 0.5f * (t.y * q.r + t.z * q.v.x - t.x * q.v.z);
+			dq[7] = 0.5f * (t.z * q.r + t.x * q.v.y - t.y * q.v.x);
+		}
+	}
+
+	SkinnedVertices& vertices = target.vertices();
+
+	// the blended rotation of each vertex, reused for the normals
+	std::vector<float> rotations(vertexCount() * 9);
+
+	tbb::parallel_for(Range(0, vertexCount()), [&](const Range& range) {
+		for(std::size_t v = range.begin(); v != range.end(); ++v) {
+			const uint32_t begin = m_offsets[v];
+			const uint32_t end = m_offsets[v + 1];
+
+			float m[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+
+			if(begin != end) {
+				if(method == kLinear) {
+					// blending the matrices first makes the transformation a single matrix-vector product
+					std::fill(m, m + 12, 0.0f);
+
+					for(uint32_t i = begin; i < end; ++i) {
+						const float w = m_weights[i];
+						const float* b = &bones[m_bones[i] * 12];
+
+						for(unsigned k = 0; k < 12; ++k)
+							m[k] += w * b[k];
+					}
+				}
+
+				else {
+					float dq[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+					// all quaternions need to be in the same hemisphere as the first one
+					const float* pivot = &bones[m_bones[begin] * 8];
+
+					for(uint32_t i = begin; i < end; ++i) {
+						const float* b = &bones[m_bones[i] * 8];
+
+						const float dot = pivot[0] * b[0] + pivot[1] * b[1] + pivot[2] * b[2] + pivot[3] * b[3];
+						const float w = dot < 0.0f ? -m_weights[i] : m_weights[i];
+
+						for(unsigned k = 0; k < 8; ++k)
+							dq[k] += w * b[k];
+					}
+
+					dualQuatToMatrix(dq, m);
+				}
+			}
+
+			const float x = m_x[v], y = m_y[v], z = m_z[v];
+			vertices[v].setPos(Imath::V3f(m[0] * x + m[1] * y + m[2] * z + m[3],
+			                              m[4] * x + m[5] * y + m[6] * z + m[7],
+			                              m[8] * x + m[9] * y + m[10] * z + m[11]));
+
+			float* rot = &rotations[v * 9];
+			rot[0] = m[0];
+			rot[1] = m[1];
+			rot[2] = m[2];
+			rot[3] = m[4];
+			rot[4] = m[5];
+			rot[5] = m[6];
+			rot[6] = m[8];
+			rot[7] = m[9];
+			rot[8] = m[10];
+		}
+	});
+
+	std::vector<Imath::V3f>& normals = target.normals();
+
+	tbb::parallel_for(Range(0, normalCount()), [&](const Range& range) {
+		for(std::size_t n = range.begin(); n != range.end(); ++n) {
+			const float x = m_nx[n], y = m_ny[n], z = m_nz[n];
+
+			Imath::V3f norm(x, y, z);
+			if(m_normalVertices[n] != s_noVertex) {
+				const float* r = &rotations[m_normalVertices[n] * 9];
+				norm = Imath::V3f(r[0] * x + r[1] * y + r[2] * z, r[3] * x + r[4] * y + r[5] * z,
+				                  r[6] * x + r[7] * y + r[8] * z);
+			}
+
+			if(norm.length2() > 0.0f)
+				normals[n] = norm.normalized();
+			else
+				normals[n] = Imath::V3f(x, y, z);
+		}
+	});
+}
+
+}  // namespace anim
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "transform.h"
+
+namespace anim {
+
+class SkinnedMesh;
+class PackedSkinnedMesh;
+
+/// A flat, compressed-sparse-row representation of the skinning weights of a SkinnedMesh, together with its
+/// rest positions and normals in structure-of-arrays layout. Built once per mesh (see
+/// SkinnedMesh::skinningWeights()) and used to deform the mesh for each skeleton pose.
+class SkinningWeights {
+  public:
+	enum Method { kLinear, kDualQuaternion };
+
+	/// builds the weights from all influences of each vertex
+	explicit SkinningWeights(const SkinnedMesh& mesh);
+	/// builds the weights from the packed form of a mesh (i.e., limited to its maxInfluences() per vertex)
+	explicit SkinningWeights(const PackedSkinnedMesh& mesh);
+
+	std::size_t vertexCount() const;
+	std::size_t normalCount() const;
+
+	/// the number of bones required by the skinning (i.e., the highest bone index + 1)
+	std::size_t boneCount() const;
+
+	/// Deforms the mesh by per-bone world-space skinning transformations (posed * inverse(base)), writing the
+	/// resulting positions and normals to the target mesh (which needs to have the same topology as the source).
+	/// Throws std::runtime_error if a bone used by the skinning is missing from the transformations.
+	void apply(const std::vector<Transform>& transforms, Method method, SkinnedMesh& target) const;
+
+  private:
+	// CSR weights - the influences of vertex v are in [m_offsets[v], m_offsets[v+1]), with normalized weights
+	std::vector<uint32_t> m_offsets;
+	std::vector<uint32_t> m_bones;
+	std::vector<float> m_weights;
+
+	// rest positions and normals
+	std::vector<float> m_x, m_y, m_z;
+	std::vector<float> m_nx, m_ny, m_nz;
+
+	// vertex of each normal (normals are stored per polygon corner)
+	std::vector<uint32_t> m_normalVertices;
+
+	std::size_t m_boneCount;
+};
+
+}  // namespace anim
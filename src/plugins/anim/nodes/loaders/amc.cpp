@@ -3,12 +3,17 @@
 #include <possumwood_sdk/datatypes/filename.h>
 #include <possumwood_sdk/node_implementation.h>
 
+#include <tbb/parallel_for.h>
+
 #include <boost/filesystem.hpp>
-#include <boost/lexical_cast.hpp>
-#include <fstream>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/stream.hpp>
 #include <unordered_map>
 
+#include "animation_cache.h"
 #include "datatypes/animation.h"
+#include "scanner.h"
 #include "tokenizer.h"
 
 namespace {
@@ -125,77 +130,129 @@ Imath::Quatf makeRotation(float value, const std::string& key) {
 	return q;
 }
 
-void readFrame(anim::Tokenizer& tokenizer, anim::Skeleton& skel,
-               const std::unordered_map<std::string, unsigned>& jointIds) {
-	const anim::Skeleton orig = skel;
+bool isFrameNumber(const boost::string_view& token) {
+	for(char c : token)
+		if(c < '0' || c > '9')
+			return false;
+	return !token.empty();
+}
 
+/// reads the lines of a single frame - the first line is the frame number, each following line contains the
+/// values of a single joint
+void readFrame(const boost::string_view* begin, const boost::string_view* end, const anim::Skeleton& skel,
+               anim::Skeleton& frame, const std::unordered_map<std::string, unsigned>& jointIds,
+               const std::vector<std::vector<std::string>>& dofs) {
 	// reset all base transforms to identity first
-	for(auto& j : skel)
+	for(auto& j : frame)
 		j.tr() = anim::Transform();
 
-	auto it = jointIds.find(tokenizer.next().value);
-	while(it != jointIds.end()) {
+	for(const boost::string_view* line = begin + 1; line != end; ++line) {
+		anim::Scanner scanner(*line);
+
+		const boost::string_view name = scanner.next();
+		auto it = jointIds.find(std::string(name.begin(), name.end()));
+		if(it == jointIds.end())
+			throw std::runtime_error("unknown joint " + std::string(name.begin(), name.end()));
+
 		// read values for the joint
 		Imath::V3f tr(0, 0, 0);
 		Imath::Quatf rot(1, 0, 0, 0);
-		for(const std::string& dof : skel[it->second].attributes()["dof"].as<std::vector<std::string>>())
+		for(const std::string& dof : dofs[it->second])
 			if(dof[0] == 't')
-				tr = makeTranslation(boost::lexical_cast<float>(tokenizer.next().value), dof) + tr;
+				tr = makeTranslation(scanner.nextFloat(), dof) + tr;
 			else
-				rot = makeRotation(boost::lexical_cast<float>(tokenizer.next().value), dof) * rot;
+				rot = makeRotation(scanner.nextFloat(), dof) * rot;
 
-		// assign the value
-		skel[it->second].tr() = orig[it->second].tr() * anim::Transform(rot, tr);
+		if(!scanner.eof())
+			throw std::runtime_error("more values than degrees of freedom found for joint " + it->first);
 
-		// and process next bone
-		it = jointIds.find(tokenizer.next().value);
+		// assign the value
+		frame[it->second].tr() = skel[it->second].tr() * anim::Transform(rot, tr);
 	}
 }
 
 // adapted from http://research.cs.wisc.edu/graphics/Courses/cs-838-1999/Jeff/ASF-AMC.html
 std::unique_ptr<anim::Animation> doLoad(const boost::filesystem::path& filename, const anim::Skeleton& skel) {
-	// open the file and instantiate the tokenizer
-	std::ifstream in(filename.string());
+	// memory-map the file, and instantiate the tokenizer for the header on top of the mapped data
+	boost::iostreams::mapped_file_source file(filename.string());
+	boost::iostreams::stream<boost::iostreams::array_source> in(file.data(), file.size());
 	AmcTokenizer tokenizer(in);
 
 	// assuming the CMU database at 120 FPS
 	std::unique_ptr<anim::Animation> result(new anim::Animation(120));
 
-	unsigned frameNo = 1;
-
-	// std::cout << "READING START " << filename << std::endl;
-	// while(!tokenizer.eof())
-	// 	std::cout << "  - " << tokenizer.next().value << std::endl;
-	// std::cout << "READING END" << std::endl;
-
 	// read the hashbang
 	std::string asfFilename;
 	tokenizer >> "#!OML:ASF" >> asfFilename;
 
 	// build an index on top of the skeleton, to make bone lookup faster
 	std::unordered_map<std::string, unsigned> jointIds;
-	for(unsigned a = 0; a < skel.size(); ++a)
+	std::vector<std::vector<std::string>> dofs(skel.size());
+	for(unsigned a = 0; a < skel.size(); ++a) {
 		jointIds[skel[a].name()] = a;
+
+		// degrees of freedom of each joint, read only once for all frames
+		for(auto& attr : skel[a].attributes())
+			if(attr.first == "dof")
+				dofs[a] = attr.second.as<std::vector<std::string>>();
+	}
 	assert(skel.size() == jointIds.size());
 
 	tokenizer >> ":FULLY-SPECIFIED";
 	tokenizer >> ":DEGREES";
-	tokenizer.next();
 
-	while(!tokenizer.eof()) {
-		// read the frame number, which has to match the counter
-		const unsigned currentFrame = boost::lexical_cast<unsigned>(tokenizer.current().value);
-		if(currentFrame != frameNo)
-			throw std::runtime_error("expecting frame #" + boost::lexical_cast<std::string>(frameNo) + " but found #" +
-			                         tokenizer.current().value);
+	// the rest of the file is frame data, read directly from the mapped file (the tokenizer doesn't read ahead
+	// past a whitespace)
+	in.clear();
+	const std::streamoff offset = in.tellg();
+	assert(offset >= 0);
+
+	const std::vector<boost::string_view> lines =
+	    anim::Scanner::lines(file.data() + offset, file.data() + file.size(), '#');
+
+	// index the frames - each starts with a line containing just the frame number, which has to match the counter
+	std::vector<std::size_t> frameStarts;
+	for(std::size_t l = 0; l < lines.size(); ++l) {
+		anim::Scanner scanner(lines[l]);
+		const boost::string_view token = scanner.next();
+
+		if(isFrameNumber(token) && scanner.eof()) {
+			if(anim::parseUnsigned(token) != frameStarts.size() + 1)
+				throw std::runtime_error("expecting frame #" + std::to_string(frameStarts.size() + 1) +
+				                         " but found #" + std::string(token.begin(), token.end()));
+
+			frameStarts.push_back(l);
+		}
+		else if(frameStarts.empty())
+			throw std::runtime_error("expecting frame #1 but found " + std::string(token.begin(), token.end()));
+	}
+	frameStarts.push_back(lines.size());
+
+	// and read all frames in parallel
+	const std::size_t frameCount = frameStarts.size() - 1;
+	std::vector<anim::Skeleton> frames(frameCount, skel);
+	tbb::parallel_for(std::size_t(0), frameCount, [&](std::size_t f) {
+		try {
+			readFrame(&lines[frameStarts[f]], &lines[0] + frameStarts[f + 1], skel, frames[f], jointIds, dofs);
+		}
+		catch(const std::exception& err) {
+			throw std::runtime_error("Error reading frame #" + std::to_string(f + 1) + " - " + err.what());
+		}
+	});
+
+	for(auto& f : frames)
+		result->addFrame(f);
 
-		// add a frame and read it
-		anim::Skeleton frame = skel;
-		readFrame(tokenizer, frame, jointIds);
-		result->addFrame(frame);
+	return result;
+}
 
-		++frameNo;
-	}
+/// reads the animation from the binary cache, applied to the input skeleton (returns null if not cached)
+std::unique_ptr<anim::Animation> loadCached(const boost::filesystem::path& filename, const anim::Skeleton& skel,
+                                            uint64_t context) {
+	// the frames are read directly as poses of the input skeleton, to share its hierarchy and attributes
+	std::unique_ptr<anim::Animation> result(new anim::Animation());
+	if(!anim::cache::readFrames(filename, context, skel, *result))
+		return std::unique_ptr<anim::Animation>();
 
 	return result;
 }
@@ -213,7 +270,15 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	const anim::Skeleton skel = data.get(a_skel);
 
 	if(!filename.filename().empty() && boost::filesystem::exists(filename.filename()) && !skel.empty()) {
-		std::unique_ptr<anim::Animation> ptr(doLoad(filename.filename(), skel).release());
+		// the cache is only valid for the skeleton it was loaded with
+		const uint64_t context = anim::cache::hash(skel);
+
+		std::unique_ptr<anim::Animation> ptr = loadCached(filename.filename(), skel, context);
+		if(!ptr) {
+			ptr = doLoad(filename.filename(), skel);
+			anim::cache::write(filename.filename(), context, skel, *ptr);
+		}
+
 		data.set(a_anim, *ptr);
 	}
 	else {
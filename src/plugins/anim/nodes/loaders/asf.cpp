@@ -14,6 +14,7 @@
 #include "datatypes/attributes.h"
 #include "datatypes/skeleton.h"
 #include "datatypes/transform.h"
+#include "scanner.h"
 #include "tokenizer.h"
 
 using std::cout;
@@ -115,9 +116,9 @@ void readDocumentation(anim::Tokenizer& tokenizer) {
 
 Imath::V3f readVec3(anim::Tokenizer& tokenizer) {
 	// has to be written on separate lines to prevent the compiler from reordering the next() calls
-	const float x = boost::lexical_cast<float>(tokenizer.next().value);
-	const float y = boost::lexical_cast<float>(tokenizer.next().value);
-	const float z = boost::lexical_cast<float>(tokenizer.next().value);
+	const float x = anim::parseFloat(tokenizer.next().value);
+	const float y = anim::parseFloat(tokenizer.next().value);
+	const float z = anim::parseFloat(tokenizer.next().value);
 
 	return Imath::V3f(x, y, z);
 }
@@ -200,7 +201,7 @@ std::pair<Joint, unsigned> readJoint(anim::Tokenizer& tokenizer) {
 			break;
 
 		else if(tokenizer.current().value == "id") {
-			result.second = boost::lexical_cast<unsigned>(tokenizer.next().value);
+			result.second = anim::parseUnsigned(tokenizer.next().value);
 			tokenizer.next();
 		}
 
@@ -215,7 +216,7 @@ std::pair<Joint, unsigned> readJoint(anim::Tokenizer& tokenizer) {
 		}
 
 		else if(tokenizer.current().value == "length") {
-			result.first.position *= boost::lexical_cast<float>(tokenizer.next().value);
+			result.first.position *= anim::parseFloat(tokenizer.next().value);
 			tokenizer.next();
 		}
 
@@ -3,11 +3,16 @@
 #include <possumwood_sdk/datatypes/filename.h>
 #include <possumwood_sdk/node_implementation.h>
 
+#include <tbb/parallel_for.h>
+
 #include <boost/filesystem.hpp>
-#include <boost/lexical_cast.hpp>
-#include <fstream>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/stream.hpp>
 
+#include "animation_cache.h"
 #include "datatypes/animation.h"
+#include "scanner.h"
 #include "tokenizer.h"
 
 namespace {
@@ -112,9 +117,9 @@ struct Joint {
 
 Imath::V3f readOffset(anim::Tokenizer& tokenizer) {
 	// has to be written on separate lines to prevent the compiler from reordering the next() calls
-	const float x = boost::lexical_cast<float>(tokenizer.next().value);
-	const float y = boost::lexical_cast<float>(tokenizer.next().value);
-	const float z = boost::lexical_cast<float>(tokenizer.next().value);
+	const float x = anim::parseFloat(tokenizer.next().value);
+	const float y = anim::parseFloat(tokenizer.next().value);
+	const float z = anim::parseFloat(tokenizer.next().value);
 
 	tokenizer.next();
 
@@ -124,7 +129,7 @@ Imath::V3f readOffset(anim::Tokenizer& tokenizer) {
 Channels readChannels(anim::Tokenizer& tokenizer) {
 	Channels result;
 
-	unsigned count = boost::lexical_cast<unsigned>(tokenizer.next().value);
+	unsigned count = anim::parseUnsigned(tokenizer.next().value);
 	for(unsigned a = 0; a < count; ++a) {
 		const std::string str = tokenizer.next().value;
 		Channel tmp = strToChannel(str);
@@ -221,15 +226,42 @@ anim::Transform makeTransform(float val, Channel c) {
 	}
 }
 
-void readMotion(anim::Tokenizer& tokenizer, anim::Animation& anim, const std::vector<Joint>& joints,
-                const anim::Skeleton& skeleton) {
+/// reads one line of frame data (one value per channel of each joint)
+void readFrame(const boost::string_view& line, anim::Skeleton& frame, const std::vector<Joint>& joints,
+               const anim::Skeleton& skeleton) {
+	anim::Scanner scanner(line);
+
+	for(auto& joint : joints) {
+		anim::Transform tr;
+
+		for(auto& ch : joint.channels)
+			tr *= makeTransform(scanner.nextFloat(), ch);
+
+		const unsigned targetId = joint.targetId;
+
+		// use translation if set explicitly, otherwise use base
+		if(joint.channels.contains(kXposition) || joint.channels.contains(kYposition) ||
+		   joint.channels.contains(kZposition))
+			frame[targetId].tr() = tr;
+		else
+			frame[targetId].tr() = skeleton[targetId].tr() * tr;
+	}
+
+	if(!scanner.eof())
+		throw std::runtime_error("more values than channels found");
+}
+
+/// Reads the MOTION section, which is the rest of the file. The header is read using the tokenizer, while the
+/// frame data (one frame per line) are parsed directly from the (memory-mapped) file, in parallel.
+void readMotion(anim::Tokenizer& tokenizer, std::istream& in, const boost::iostreams::mapped_file_source& file,
+                anim::Animation& anim, const std::vector<Joint>& joints, const anim::Skeleton& skeleton) {
 	assert(skeleton.size() == joints.size());
 
 	// number of frames
 	if(tokenizer.next().value != "Frames:")
 		throw std::runtime_error("MOTION section should start with Frames: keyword, " + tokenizer.current().value +
 		                         " found instead.");
-	const unsigned frameCount = boost::lexical_cast<unsigned>(tokenizer.next().value);
+	const unsigned frameCount = anim::parseUnsigned(tokenizer.next().value);
 
 	// frame time
 	if(tokenizer.next().value != "Frame")
@@ -238,42 +270,40 @@ void readMotion(anim::Tokenizer& tokenizer, anim::Animation& anim, const std::ve
 	if(tokenizer.next().value != "Time:")
 		throw std::runtime_error("MOTION section should contain with Frame Time: keyword, " +
 		                         tokenizer.current().value + " found instead.");
-	anim.setFps(1.0f / boost::lexical_cast<float>(tokenizer.next().value));
-
-	// read the frame data
-	for(unsigned f = 0; f < frameCount; ++f) {
-		// make a new frame
-		anim::Skeleton frame = skeleton;
-
-		// reset it to identity
-		for(auto& j : frame)
-			j.tr() = anim::Transform();
-
-		// and process all joints
-		unsigned ji = 0;
-		for(auto& joint : joints) {
-			anim::Transform tr;
-
-			for(auto& ch : joint.channels)
-				tr *= makeTransform(boost::lexical_cast<float>(tokenizer.next().value), ch);
-
-			const unsigned targetId = joints[ji].targetId;
-
-			// use translation if set explicitly, otherwise use base
-			if(joint.channels.contains(kXposition) || joint.channels.contains(kYposition) ||
-			   joint.channels.contains(kZposition))
-				frame[targetId].tr() = tr;
-			else
-				frame[targetId].tr() = skeleton[targetId].tr() * tr;
-
-			++ji;
+	anim.setFps(1.0f / anim::parseFloat(tokenizer.next().value));
+
+	// the frame data start right after the last token read by the tokenizer (the tokenizer doesn't read ahead
+	// past a whitespace)
+	in.clear();
+	const std::streamoff offset = in.tellg();
+	assert(offset >= 0);
+
+	const std::vector<boost::string_view> lines =
+	    anim::Scanner::lines(file.data() + offset, file.data() + file.size());
+	if(lines.size() < frameCount)
+		throw std::runtime_error("MOTION section should contain " + std::to_string(frameCount) + " frames, only " +
+		                         std::to_string(lines.size()) + " found.");
+	if(lines.size() > frameCount)
+		throw std::runtime_error("unexpected data after the last frame of the MOTION section");
+
+	// the frame template, reset to identity
+	anim::Skeleton identity = skeleton;
+	for(auto& j : identity)
+		j.tr() = anim::Transform();
+
+	// frames are independent of each other
+	std::vector<anim::Skeleton> frames(frameCount, identity);
+	tbb::parallel_for(0u, frameCount, [&](unsigned f) {
+		try {
+			readFrame(lines[f], frames[f], joints, skeleton);
 		}
+		catch(const std::exception& err) {
+			throw std::runtime_error("Error reading frame #" + std::to_string(f + 1) + " - " + err.what());
+		}
+	});
 
-		// and add it to the animation
-		anim.addFrame(frame);
-	}
-
-	tokenizer.next();
+	for(auto& f : frames)
+		anim.addFrame(f);
 }
 
 anim::Skeleton convertHierarchy(std::vector<Joint>& joints) {
@@ -309,29 +339,43 @@ dependency_graph::InAttr<possumwood::Filename> a_filename;
 dependency_graph::OutAttr<anim::Skeleton> a_skel;
 dependency_graph::OutAttr<anim::Animation> a_anim;
 
+void load(const boost::filesystem::path& filename, anim::Skeleton& skeleton, anim::Animation& result) {
+	// the file is memory-mapped, and the (small) header is read via a stream on top of the mapped data
+	boost::iostreams::mapped_file_source file(filename.string());
+	boost::iostreams::stream<boost::iostreams::array_source> in(file.data(), file.size());
+
+	std::vector<Joint> joints;
+
+	BvhTokenizer tokenizer(in);
+
+	while(!tokenizer.eof()) {
+		if(tokenizer.current().value == "HIERARCHY") {
+			readHierarchy(tokenizer, joints);
+			skeleton = convertHierarchy(joints);
+		}
+		else if(tokenizer.current().value == "MOTION") {
+			// the motion section contains all the remaining data in the file
+			readMotion(tokenizer, in, file, result, joints, skeleton);
+			break;
+		}
+		else
+			throw std::runtime_error("unknown keyword " + tokenizer.current().value);
+	}
+}
+
 dependency_graph::State compute(dependency_graph::Values& data) {
 	dependency_graph::State out;
 
 	const possumwood::Filename filename = data.get(a_filename);
 
 	if(!filename.filename().empty() && boost::filesystem::exists(filename.filename())) {
-		std::ifstream in(filename.filename().string());
-
-		std::vector<Joint> joints;
 		anim::Animation result;
 		anim::Skeleton skeleton;
 
-		BvhTokenizer tokenizer(in);
-
-		while(!tokenizer.eof()) {
-			if(tokenizer.current().value == "HIERARCHY") {
-				readHierarchy(tokenizer, joints);
-				skeleton = convertHierarchy(joints);
-			}
-			else if(tokenizer.current().value == "MOTION")
-				readMotion(tokenizer, result, joints, skeleton);
-			else
-				throw std::runtime_error("unknown keyword " + tokenizer.current().value);
+		// parsing only if no valid binary cache of the file exists
+		if(!anim::cache::read(filename.filename(), 0, skeleton, result)) {
+			load(filename.filename(), skeleton, result);
+			anim::cache::write(filename.filename(), 0, skeleton, result);
 		}
 
 		data.set(a_skel, skeleton);
@@ -0,0 +1,215 @@
+#include "scanner.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace anim {
+
+namespace {
+
+bool isSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+/// exactly representable powers of 10
+const double s_powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/// mantissa * 10^exponent, with a single rounding for common values
+double scale(uint64_t mantissa, int exponent) {
+	if(exponent >= 0 && exponent <= 22)
+		return (double)mantissa * s_powers[exponent];
+	if(exponent < 0 && exponent >= -22)
+		return (double)mantissa / s_powers[-exponent];
+	return (double)mantissa * std::pow(10.0, exponent);
+}
+
+/// the slow path for anything not in simple decimal notation (nan, inf, hex floats)
+float parseFloatFallback(const boost::string_view& token) {
+	const std::string str(token.begin(), token.end());
+
+	std::size_t end = 0;
+	float result = 0.0f;
+	try {
+		result = std::stof(str, &end);
+	}
+	catch(const std::logic_error&) {
+		end = 0;
+	}
+
+	if(end == 0 || end != str.size())
+		throw std::runtime_error("Cannot parse '" + str + "' as a floating-point value");
+
+	return result;
+}
+
+}  // namespace
+
+float parseFloat(const boost::string_view& token) {
+	const char* c = token.begin();
+	const char* const end = token.end();
+
+	bool negative = false;
+	if(c != end && (*c == '-' || *c == '+')) {
+		negative = *c == '-';
+		++c;
+	}
+
+	// up to 19 significant digits fit into the mantissa, the rest only affects the exponent
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool valid = false;
+
+	for(; c != end && isDigit(*c); ++c) {
+		valid = true;
+		if(digits < 19) {
+			mantissa = mantissa * 10 + (*c - '0');
+			if(mantissa > 0)
+				++digits;
+		}
+		else
+			++exponent;
+	}
+
+	if(c != end && *c == '.') {
+		++c;
+
+		for(; c != end && isDigit(*c); ++c) {
+			valid = true;
+			if(digits < 19) {
+				mantissa = mantissa * 10 + (*c - '0');
+				if(mantissa > 0)
+					++digits;
+				--exponent;
+			}
+		}
+	}
+
+	if(valid && c != end && (*c == 'e' || *c == 'E')) {
+		++c;
+
+		bool negativeExponent = false;
+		if(c != end && (*c == '-' || *c == '+')) {
+			negativeExponent = *c == '-';
+			++c;
+		}
+
+		if(c == end || !isDigit(*c))
+			valid = false;
+
+		int value = 0;
+		for(; c != end && isDigit(*c); ++c)
+			if(value < 10000)
+				value = value * 10 + (*c - '0');
+
+		exponent += negativeExponent ? -value : value;
+	}
+
+	if(!valid || c != end)
+		return parseFloatFallback(token);
+
+	const double result = scale(mantissa, exponent);
+	return negative ? -(float)result : (float)result;
+}
+
+unsigned parseUnsigned(const boost::string_view& token) {
+	if(token.empty())
+		throw std::runtime_error("Cannot parse an empty string as an unsigned value");
+
+	uint64_t result = 0;
+	for(char c : token) {
+		if(!isDigit(c))
+			throw std::runtime_error("Cannot parse '" + std::string(token.begin(), token.end()) +
+			                         "' as an unsigned value");
+
+		result = result * 10 + (c - '0');
+		if(result > std::numeric_limits<unsigned>::max())
+			throw std::runtime_error("Value '" + std::string(token.begin(), token.end()) + "' is out of range");
+	}
+
+	return result;
+}
+
+/////
+
+Scanner::Scanner(const char* begin, const char* end) : m_current(begin), m_end(end) {
+}
+
+Scanner::Scanner(const boost::string_view& data) : m_current(data.begin()), m_end(data.end()) {
+}
+
+void Scanner::skipWhitespace() {
+	while(m_current != m_end && isSpace(*m_current))
+		++m_current;
+}
+
+bool Scanner::eof() {
+	skipWhitespace();
+	return m_current == m_end;
+}
+
+boost::string_view Scanner::next() {
+	skipWhitespace();
+
+	const char* begin = m_current;
+	while(m_current != m_end && !isSpace(*m_current))
+		++m_current;
+
+	return boost::string_view(begin, m_current - begin);
+}
+
+float Scanner::nextFloat() {
+	const boost::string_view token = next();
+	if(token.empty())
+		throw std::runtime_error("Unexpected end of data, expecting a floating-point value");
+
+	return parseFloat(token);
+}
+
+unsigned Scanner::nextUnsigned() {
+	const boost::string_view token = next();
+	if(token.empty())
+		throw std::runtime_error("Unexpected end of data, expecting an unsigned value");
+
+	return parseUnsigned(token);
+}
+
+std::vector<boost::string_view> Scanner::lines(const char* begin, const char* end, char comment) {
+	std::vector<boost::string_view> result;
+
+	while(begin != end) {
+		const char* lineEnd = static_cast<const char*>(memchr(begin, '\n', end - begin));
+		if(lineEnd == nullptr)
+			lineEnd = end;
+
+		// comments are not part of the line
+		const char* contentEnd = lineEnd;
+		if(comment != '\0') {
+			const char* commentStart = static_cast<const char*>(memchr(begin, comment, lineEnd - begin));
+			if(commentStart != nullptr)
+				contentEnd = commentStart;
+		}
+
+		// only lines with non-whitespace content are returned
+		for(const char* c = begin; c != contentEnd; ++c)
+			if(!isSpace(*c)) {
+				result.push_back(boost::string_view(begin, contentEnd - begin));
+				break;
+			}
+
+		begin = lineEnd == end ? end : lineEnd + 1;
+	}
+
+	return result;
+}
+
+}  // namespace anim
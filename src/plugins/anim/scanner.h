@@ -0,0 +1,42 @@
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+#include <vector>
+
+namespace anim {
+
+/// A zero-copy tokenizer of whitespace-separated values, reading directly from a memory range (e.g., a
+/// memory-mapped file). Returned tokens are views into the original data, and are valid only as long as the
+/// underlying buffer. Complements the state-machine based Tokenizer for bulk numerical data (i.e., the motion
+/// sections of mocap files), where per-character processing and string copies dominate the loading time.
+class Scanner {
+  public:
+	Scanner(const char* begin, const char* end);
+	explicit Scanner(const boost::string_view& data);
+
+	/// true if only whitespace remains to be read
+	bool eof();
+
+	/// returns the next whitespace-separated token (empty at the end of the data)
+	boost::string_view next();
+
+	/// reads and parses the next token (throws std::runtime_error on error or at the end of the data)
+	float nextFloat();
+	unsigned nextUnsigned();
+
+	/// splits a range into lines, truncated at the comment character (if non-zero), skipping empty lines
+	static std::vector<boost::string_view> lines(const char* begin, const char* end, char comment = '\0');
+
+  private:
+	void skipWhitespace();
+
+	const char* m_current;
+	const char* m_end;
+};
+
+/// parses a float value from a string, without a string copy or locale dependency (throws std::runtime_error)
+float parseFloat(const boost::string_view& token);
+/// parses an unsigned integer value from a string (throws std::runtime_error)
+unsigned parseUnsigned(const boost::string_view& token);
+
+}  // namespace anim
@@ -0,0 +1,119 @@
+#include "adjacency.h"
+
+#include <cassert>
+#include <unordered_map>
+
+namespace possumwood {
+
+MeshAdjacency::MeshAdjacency(const CGALPolyhedron& polyhedron) {
+	// vertex indexing and positions
+	std::unordered_map<const CGALPolyhedron::Vertex*, std::size_t> vertexIndices;
+	vertexIndices.reserve(polyhedron.size_of_vertices());
+	m_positions.reserve(polyhedron.size_of_vertices());
+
+	for(auto vit = polyhedron.vertices_begin(); vit != polyhedron.vertices_end(); ++vit) {
+		vertexIndices.insert(std::make_pair(&*vit, m_positions.size()));
+
+		const auto& p = vit->point();
+		m_positions.push_back(std::array<float, 3>{{p.x(), p.y(), p.z()}});
+	}
+
+	// face -> corner mapping
+	m_faceOffsets.reserve(polyhedron.size_of_facets() + 1);
+	m_cornerVertices.reserve(polyhedron.size_of_halfedges() / 2);
+	m_cornerFaces.reserve(polyhedron.size_of_halfedges() / 2);
+
+	m_faceOffsets.push_back(0);
+	for(auto fit = polyhedron.facets_begin(); fit != polyhedron.facets_end(); ++fit) {
+		auto hit = fit->facet_begin();
+		for(std::size_t i = 0; i < fit->facet_degree(); ++i) {
+			assert(vertexIndices.find(&*hit->vertex()) != vertexIndices.end());
+
+			m_cornerVertices.push_back(vertexIndices[&*hit->vertex()]);
+			m_cornerFaces.push_back(m_faceOffsets.size() - 1);
+
+			++hit;
+		}
+
+		m_faceOffsets.push_back(m_cornerVertices.size());
+	}
+
+	// vertex -> corner mapping, as a counting sort of corners by their vertex index
+	m_vertexOffsets.resize(m_positions.size() + 1, 0);
+	for(auto& v : m_cornerVertices)
+		++m_vertexOffsets[v + 1];
+	for(std::size_t v = 1; v < m_vertexOffsets.size(); ++v)
+		m_vertexOffsets[v] += m_vertexOffsets[v - 1];
+
+	m_vertexCorners.resize(m_cornerVertices.size());
+	std::vector<std::size_t> fill(m_vertexOffsets.begin(), m_vertexOffsets.end() - 1);
+	for(std::size_t c = 0; c < m_cornerVertices.size(); ++c)
+		m_vertexCorners[fill[m_cornerVertices[c]]++] = c;
+}
+
+std::size_t MeshAdjacency::vertexCount() const {
+	return m_positions.size();
+}
+
+std::size_t MeshAdjacency::faceCount() const {
+	return m_faceOffsets.size() - 1;
+}
+
+std::size_t MeshAdjacency::cornerCount() const {
+	return m_cornerVertices.size();
+}
+
+const std::vector<std::array<float, 3>>& MeshAdjacency::positions() const {
+	return m_positions;
+}
+
+std::size_t MeshAdjacency::faceBegin(std::size_t face) const {
+	assert(face < faceCount());
+	return m_faceOffsets[face];
+}
+
+std::size_t MeshAdjacency::faceEnd(std::size_t face) const {
+	assert(face < faceCount());
+	return m_faceOffsets[face + 1];
+}
+
+std::size_t MeshAdjacency::cornerVertex(std::size_t corner) const {
+	assert(corner < cornerCount());
+	return m_cornerVertices[corner];
+}
+
+std::size_t MeshAdjacency::cornerFace(std::size_t corner) const {
+	assert(corner < cornerCount());
+	return m_cornerFaces[corner];
+}
+
+std::size_t MeshAdjacency::cornerPrev(std::size_t corner) const {
+	const std::size_t face = cornerFace(corner);
+	if(corner == m_faceOffsets[face])
+		return m_faceOffsets[face + 1] - 1;
+	return corner - 1;
+}
+
+std::size_t MeshAdjacency::cornerNext(std::size_t corner) const {
+	const std::size_t face = cornerFace(corner);
+	if(corner + 1 == m_faceOffsets[face + 1])
+		return m_faceOffsets[face];
+	return corner + 1;
+}
+
+std::size_t MeshAdjacency::vertexBegin(std::size_t vertex) const {
+	assert(vertex < vertexCount());
+	return m_vertexOffsets[vertex];
+}
+
+std::size_t MeshAdjacency::vertexEnd(std::size_t vertex) const {
+	assert(vertex < vertexCount());
+	return m_vertexOffsets[vertex + 1];
+}
+
+std::size_t MeshAdjacency::vertexCorner(std::size_t index) const {
+	assert(index < m_vertexCorners.size());
+	return m_vertexCorners[index];
+}
+
+}  // namespace possumwood
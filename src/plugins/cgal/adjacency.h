@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "cgal.h"
+
+namespace possumwood {
+
+/// A flat (CSR) snapshot of the topology and vertex positions of a polyhedron, suitable for
+/// parallel processing over plain arrays. Vertices, faces and face corners (halfedges) are
+/// indexed in the polyhedron's iteration order (corners in facet_begin() circulator order).
+class MeshAdjacency {
+  public:
+	explicit MeshAdjacency(const CGALPolyhedron& polyhedron);
+
+	std::size_t vertexCount() const;
+	std::size_t faceCount() const;
+	std::size_t cornerCount() const;
+
+	/// vertex positions, indexed by vertex index
+	const std::vector<std::array<float, 3>>& positions() const;
+
+	/// face -> corners mapping; corners of face f are in the range [faceBegin(f), faceEnd(f))
+	std::size_t faceBegin(std::size_t face) const;
+	std::size_t faceEnd(std::size_t face) const;
+
+	/// vertex index of a corner
+	std::size_t cornerVertex(std::size_t corner) const;
+	/// face index of a corner
+	std::size_t cornerFace(std::size_t corner) const;
+	/// previous and next corners of the same face
+	std::size_t cornerPrev(std::size_t corner) const;
+	std::size_t cornerNext(std::size_t corner) const;
+
+	/// vertex -> incident corners mapping; corners of vertex v are at vertexCorner(i)
+	/// for i in range [vertexBegin(v), vertexEnd(v))
+	std::size_t vertexBegin(std::size_t vertex) const;
+	std::size_t vertexEnd(std::size_t vertex) const;
+	std::size_t vertexCorner(std::size_t index) const;
+
+  private:
+	std::vector<std::array<float, 3>> m_positions;
+
+	std::vector<std::size_t> m_faceOffsets;
+	std::vector<std::size_t> m_cornerVertices;
+	std::vector<std::size_t> m_cornerFaces;
+
+	std::vector<std::size_t> m_vertexOffsets;
+	std::vector<std::size_t> m_vertexCorners;
+};
+
+}  // namespace possumwood
@@ -0,0 +1,95 @@
+#include <possumwood_sdk/file_writer.h>
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <fstream>
+
+#include "adjacency.h"
+#include "meshes.h"
+
+namespace possumwood {
+
+namespace {
+
+// writes all meshes as separate objects of a single OBJ file (positions and faces only)
+void writeObj(std::ostream& out, const Meshes& meshes) {
+	std::size_t vertexOffset = 1;
+
+	for(auto& mesh : meshes) {
+		const std::shared_ptr<const MeshAdjacency> adj = mesh.adjacency();
+
+		out << "o " << mesh.name() << std::endl;
+
+		for(auto& p : adj->positions())
+			out << "v " << p[0] << " " << p[1] << " " << p[2] << std::endl;
+
+		for(std::size_t f = 0; f < adj->faceCount(); ++f) {
+			out << "f";
+			for(std::size_t c = adj->faceBegin(f); c != adj->faceEnd(f); ++c)
+				out << " " << adj->cornerVertex(c) + vertexOffset;
+			out << std::endl;
+		}
+
+		vertexOffset += adj->vertexCount();
+	}
+}
+
+// writes all meshes merged into a single ASCII PLY file (positions and faces only)
+void writePly(std::ostream& out, const Meshes& meshes) {
+	std::size_t vertexCount = 0, faceCount = 0;
+	for(auto& mesh : meshes) {
+		vertexCount += mesh.adjacency()->vertexCount();
+		faceCount += mesh.adjacency()->faceCount();
+	}
+
+	out << "ply" << std::endl;
+	out << "format ascii 1.0" << std::endl;
+	out << "element vertex " << vertexCount << std::endl;
+	out << "property float x" << std::endl;
+	out << "property float y" << std::endl;
+	out << "property float z" << std::endl;
+	out << "element face " << faceCount << std::endl;
+	out << "property list uchar int vertex_indices" << std::endl;
+	out << "end_header" << std::endl;
+
+	for(auto& mesh : meshes)
+		for(auto& p : mesh.adjacency()->positions())
+			out << p[0] << " " << p[1] << " " << p[2] << std::endl;
+
+	std::size_t vertexOffset = 0;
+	for(auto& mesh : meshes) {
+		const std::shared_ptr<const MeshAdjacency> adj = mesh.adjacency();
+
+		for(std::size_t f = 0; f < adj->faceCount(); ++f) {
+			out << adj->faceEnd(f) - adj->faceBegin(f);
+			for(std::size_t c = adj->faceBegin(f); c != adj->faceEnd(f); ++c)
+				out << " " << adj->cornerVertex(c) + vertexOffset;
+			out << std::endl;
+		}
+
+		vertexOffset += adj->vertexCount();
+	}
+}
+
+// the format is determined by the file extension
+FileWriter<Meshes> s_meshesWriter([](const boost::filesystem::path& path, const Meshes& meshes) {
+	const std::string ext = boost::algorithm::to_lower_copy(path.extension().string());
+	if(ext != ".obj" && ext != ".ply")
+		throw std::runtime_error("Unsupported mesh file format " + path.string() + " (only .obj and .ply supported)");
+
+	std::ofstream out(path.string());
+	if(!out.good())
+		throw std::runtime_error("Error opening " + path.string() + " for writing");
+
+	if(ext == ".obj")
+		writeObj(out, meshes);
+	else
+		writePly(out, meshes);
+
+	if(!out.good())
+		throw std::runtime_error("Error writing " + path.string());
+});
+
+}  // namespace
+
+}  // namespace possumwood
@@ -1,5 +1,7 @@
 #include "mesh.h"
 
+#include "adjacency.h"
+
 namespace possumwood {
 
 CGALPolyhedron& Mesh::MeshData::polyhedron() {
@@ -23,11 +25,15 @@ Properties& Mesh::MeshData::halfedgeProperties() {
 Mesh::Mesh(const std::string& name) : m_name(name), m_data(new MeshData()) {
 }
 
-Mesh::MeshData& Mesh::edit() {
-	// make sure this polyhedron is unique before changing it
+Mesh::MeshData& Mesh::edit(EditMode mode) {
+	// make sure this polyhedron is unique before changing it (a copy shares the cached adjacency index)
 	if(m_data.use_count() > 1)
 		m_data = std::shared_ptr<MeshData>(new MeshData(*m_data));
 
+	// the caller can change the topology - the adjacency cache is no longer valid
+	if(mode == kEditAll)
+		std::atomic_store(&m_data->m_adjacency, std::shared_ptr<const MeshAdjacency>());
+
 	return *m_data;
 }
 
@@ -55,6 +61,18 @@ const Properties& Mesh::halfedgeProperties() const {
 	return m_data->halfedgeProperties();
 }
 
+std::shared_ptr<const MeshAdjacency> Mesh::adjacency() const {
+	std::shared_ptr<const MeshAdjacency> result = std::atomic_load(&m_data->m_adjacency);
+
+	// concurrent first use might build the index twice, but the result is the same
+	if(!result) {
+		result = std::make_shared<const MeshAdjacency>(m_data->m_polyhedron);
+		std::atomic_store(&m_data->m_adjacency, result);
+	}
+
+	return result;
+}
+
 bool Mesh::operator==(const Mesh& i) const {
 	return m_name == i.m_name && m_data == i.m_data;
 }
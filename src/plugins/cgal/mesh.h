@@ -5,6 +5,8 @@
 
 namespace possumwood {
 
+class MeshAdjacency;
+
 /// A COW mesh data structure - calling edit() allows for mesh editing, but also makes sure that
 /// any underlying data are deduplicated. Otherwise, the copying of Mesh instances produces read-only
 /// shallow copies.
@@ -27,14 +29,24 @@ class Mesh {
 		CGALPolyhedron m_polyhedron;
 		Properties m_vertexProperties, m_faceProperties, m_halfedgeProperties;
 
+		// lazily built topology index, reset on each edit() that can change topology or positions
+		mutable std::shared_ptr<const MeshAdjacency> m_adjacency;
+
 		friend class Mesh;
 	};
 
 	Mesh(const std::string& name);
 
+	/// Parts of the mesh data an edit() caller is allowed to change
+	enum EditMode {
+		kEditAll,        ///< topology, vertex positions and properties
+		kEditProperties  ///< only property values (including property keys of the polyhedron items)
+	};
+
 	/// Returns a non-const reference to the underlying data, allowing them to be edited.
 	/// If this Mesh instance doesn't have a unique data instance, the underlying data will be duplicated wholesale.
-	MeshData& edit();
+	/// The cached adjacency index is kept only for kEditProperties edits.
+	MeshData& edit(EditMode mode = kEditAll);
 
 	const std::string& name() const;
 	void setName(const std::string& name);
@@ -44,6 +56,10 @@ class Mesh {
 	const Properties& faceProperties() const;
 	const Properties& halfedgeProperties() const;
 
+	/// Returns a flat adjacency index of the polyhedron. The index is built on first use and cached
+	/// with the (shared) mesh data, until the mesh's topology or positions are next edited.
+	std::shared_ptr<const MeshAdjacency> adjacency() const;
+
 	bool operator==(const Mesh& i) const;
 	bool operator!=(const Mesh& i) const;
 
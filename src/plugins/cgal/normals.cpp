@@ -0,0 +1,235 @@
+#include "normals.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace possumwood {
+namespace normals {
+
+namespace {
+
+inline Normal sub(const Normal& a, const Normal& b) {
+	return Normal{{a[0] - b[0], a[1] - b[1], a[2] - b[2]}};
+}
+
+inline float dot(const Normal& a, const Normal& b) {
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline void normalize(Normal& n) {
+	const float len = std::sqrt(dot(n, n));
+	if(len > 0.0f) {
+		n[0] /= len;
+		n[1] /= len;
+		n[2] /= len;
+	}
+}
+
+/// Per-face weights of face normals for each corner - constant, face area, or the corner angle
+std::vector<float> cornerWeights(const MeshAdjacency& adj,
+                                 const std::vector<Normal>& unnormalized,
+                                 Weighting weighting) {
+	if(weighting == kUniform)
+		return std::vector<float>(adj.cornerCount(), 1.0f);
+
+	if(weighting == kAngleWeighted)
+		return cornerAngles(adj);
+
+	std::vector<float> result(adj.cornerCount());
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, adj.cornerCount()),
+	                  [&](const tbb::blocked_range<std::size_t>& range) {
+		                  for(std::size_t c = range.begin(); c != range.end(); ++c) {
+			                  const Normal& n = unnormalized[adj.cornerFace(c)];
+			                  result[c] = std::sqrt(dot(n, n));
+		                  }
+	                  });
+
+	return result;
+}
+
+std::vector<Normal> normalized(const std::vector<Normal>& normals) {
+	std::vector<Normal> result = normals;
+	tbb::parallel_for(std::size_t(0), result.size(), [&](std::size_t f) { normalize(result[f]); });
+	return result;
+}
+
+/// Walks all keys of a set of polyhedron items, making sure each has an allocated item in the property
+template <typename ITERATOR>
+std::vector<std::size_t> collectIndices(Property<Normal>& prop, ITERATOR begin, ITERATOR end, std::size_t count) {
+	std::vector<std::size_t> result;
+	result.reserve(count);
+
+	for(ITERATOR it = begin; it != end; ++it) {
+		if(it->property_key().isDefault())
+			prop.set(it->property_key(), prop.defaultValue());
+		result.push_back(it->property_key().index());
+	}
+
+	return result;
+}
+
+/// Scatters the values into the property's storage, in parallel
+void scatter(Property<Normal>& prop, const std::vector<std::size_t>& indices, const std::vector<Normal>& values) {
+	assert(indices.size() == values.size());
+
+	PropertySpan<Normal> target = prop.values();
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, indices.size()),
+	                  [&](const tbb::blocked_range<std::size_t>& range) {
+		                  for(std::size_t i = range.begin(); i != range.end(); ++i)
+			                  target[indices[i]] = values[i];
+	                  });
+}
+
+}  // namespace
+
+std::vector<Normal> faceNormals(const MeshAdjacency& adj, bool normalizeResult) {
+	std::vector<Normal> result(adj.faceCount());
+
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, adj.faceCount()),
+	                  [&](const tbb::blocked_range<std::size_t>& range) {
+		                  for(std::size_t f = range.begin(); f != range.end(); ++f) {
+			                  Normal n{{0, 0, 0}};
+
+			                  // Newell's method
+			                  for(std::size_t c = adj.faceBegin(f); c != adj.faceEnd(f); ++c) {
+				                  const Normal& p1 = adj.positions()[adj.cornerVertex(c)];
+				                  const Normal& p2 = adj.positions()[adj.cornerVertex(adj.cornerNext(c))];
+
+				                  n[0] += (p1[1] - p2[1]) * (p1[2] + p2[2]);
+				                  n[1] += (p1[2] - p2[2]) * (p1[0] + p2[0]);
+				                  n[2] += (p1[0] - p2[0]) * (p1[1] + p2[1]);
+			                  }
+
+			                  if(normalizeResult)
+				                  normalize(n);
+
+			                  result[f] = n;
+		                  }
+	                  });
+
+	return result;
+}
+
+std::vector<float> cornerAngles(const MeshAdjacency& adj) {
+	std::vector<float> result(adj.cornerCount());
+
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, adj.cornerCount()),
+	                  [&](const tbb::blocked_range<std::size_t>& range) {
+		                  for(std::size_t c = range.begin(); c != range.end(); ++c) {
+			                  const Normal& p = adj.positions()[adj.cornerVertex(c)];
+			                  Normal e1 = sub(adj.positions()[adj.cornerVertex(adj.cornerPrev(c))], p);
+			                  Normal e2 = sub(adj.positions()[adj.cornerVertex(adj.cornerNext(c))], p);
+
+			                  normalize(e1);
+			                  normalize(e2);
+
+			                  result[c] = std::acos(std::max(-1.0f, std::min(1.0f, dot(e1, e2))));
+		                  }
+	                  });
+
+	return result;
+}
+
+std::vector<Normal> vertexNormals(const MeshAdjacency& adj, Weighting weighting) {
+	const std::vector<Normal> unnormalized = faceNormals(adj, false);
+	const std::vector<float> weights = cornerWeights(adj, unnormalized, weighting);
+	const std::vector<Normal> fn = normalized(unnormalized);
+
+	std::vector<Normal> result(adj.vertexCount());
+
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, adj.vertexCount()),
+	                  [&](const tbb::blocked_range<std::size_t>& range) {
+		                  for(std::size_t v = range.begin(); v != range.end(); ++v) {
+			                  Normal n{{0, 0, 0}};
+
+			                  for(std::size_t i = adj.vertexBegin(v); i != adj.vertexEnd(v); ++i) {
+				                  const std::size_t c = adj.vertexCorner(i);
+
+				                  const Normal& f = fn[adj.cornerFace(c)];
+
+				                  for(unsigned a = 0; a < 3; ++a)
+					                  n[a] += f[a] * weights[c];
+			                  }
+
+			                  normalize(n);
+			                  result[v] = n;
+		                  }
+	                  });
+
+	return result;
+}
+
+std::vector<Normal> halfedgeNormals(const MeshAdjacency& adj, Weighting weighting, float creaseAngle) {
+	const std::vector<Normal> unnormalized = faceNormals(adj, false);
+	const std::vector<float> weights = cornerWeights(adj, unnormalized, weighting);
+	const std::vector<Normal> fn = normalized(unnormalized);
+
+	const float creaseCos = std::cos(creaseAngle);
+
+	std::vector<Normal> result(adj.cornerCount());
+
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, adj.cornerCount()),
+	                  [&](const tbb::blocked_range<std::size_t>& range) {
+		                  for(std::size_t c = range.begin(); c != range.end(); ++c) {
+			                  const Normal& current = fn[adj.cornerFace(c)];
+			                  const std::size_t v = adj.cornerVertex(c);
+
+			                  Normal n{{0, 0, 0}};
+			                  for(std::size_t i = adj.vertexBegin(v); i != adj.vertexEnd(v); ++i) {
+				                  const std::size_t c2 = adj.vertexCorner(i);
+				                  const Normal& f = fn[adj.cornerFace(c2)];
+
+				                  // the corner's own face is always included
+				                  if(c2 == c || dot(current, f) >= creaseCos)
+					                  for(unsigned a = 0; a < 3; ++a)
+						                  n[a] += f[a] * weights[c2];
+			                  }
+
+			                  normalize(n);
+			                  result[c] = n;
+		                  }
+	                  });
+
+	return result;
+}
+
+void writeVertexProperty(Mesh::MeshData& mesh, Property<Normal>& prop, const std::vector<Normal>& values) {
+	assert(mesh.polyhedron().size_of_vertices() == values.size());
+
+	const std::vector<std::size_t> indices = collectIndices(prop, mesh.polyhedron().vertices_begin(),
+	                                                        mesh.polyhedron().vertices_end(), values.size());
+	scatter(prop, indices, values);
+}
+
+void writeFaceProperty(Mesh::MeshData& mesh, Property<Normal>& prop, const std::vector<Normal>& values) {
+	assert(mesh.polyhedron().size_of_facets() == values.size());
+
+	const std::vector<std::size_t> indices =
+	    collectIndices(prop, mesh.polyhedron().facets_begin(), mesh.polyhedron().facets_end(), values.size());
+	scatter(prop, indices, values);
+}
+
+void writeHalfedgeProperty(Mesh::MeshData& mesh, Property<Normal>& prop, const std::vector<Normal>& values) {
+	std::vector<std::size_t> indices;
+	indices.reserve(values.size());
+
+	for(auto fit = mesh.polyhedron().facets_begin(); fit != mesh.polyhedron().facets_end(); ++fit) {
+		auto hit = fit->facet_begin();
+		for(std::size_t i = 0; i < fit->facet_degree(); ++i) {
+			if(hit->property_key().isDefault())
+				prop.set(hit->property_key(), prop.defaultValue());
+			indices.push_back(hit->property_key().index());
+
+			++hit;
+		}
+	}
+
+	scatter(prop, indices, values);
+}
+
+}  // namespace normals
+}  // namespace possumwood
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "adjacency.h"
+#include "mesh.h"
+
+namespace possumwood {
+namespace normals {
+
+/// Weighting of incident face normals - kUniform sums unit face normals (the weighting of CGAL's
+/// compute_vertex_normals(), used by the original normals generator)
+enum Weighting { kUniform, kAreaWeighted, kAngleWeighted };
+
+typedef std::array<float, 3> Normal;
+
+/// Computes per-face normals using Newell's method (valid for non-planar polygons as well).
+/// Unnormalized face normals have a length of twice the face area.
+std::vector<Normal> faceNormals(const MeshAdjacency& adj, bool normalize = true);
+
+/// Computes per-corner angles, indexed by corner index
+std::vector<float> cornerAngles(const MeshAdjacency& adj);
+
+/// Computes per-vertex normals as a weighted sum of normals of incident faces
+std::vector<Normal> vertexNormals(const MeshAdjacency& adj, Weighting weighting);
+
+/// Computes per-corner (halfedge) normals, averaging only the normals of incident faces that are within
+/// creaseAngle (in radians) of the corner's face. Edges sharper than creaseAngle are rendered as hard edges.
+std::vector<Normal> halfedgeNormals(const MeshAdjacency& adj, Weighting weighting, float creaseAngle);
+
+/// Writes a per-vertex array (in vertex iteration order) into a vertex property
+void writeVertexProperty(Mesh::MeshData& mesh, Property<Normal>& prop, const std::vector<Normal>& values);
+/// Writes a per-face array (in face iteration order) into a face property
+void writeFaceProperty(Mesh::MeshData& mesh, Property<Normal>& prop, const std::vector<Normal>& values);
+/// Writes a per-corner array (in face iteration order, then facet circulator order) into a halfedge property
+void writeHalfedgeProperty(Mesh::MeshData& mesh, Property<Normal>& prop, const std::vector<Normal>& values);
+
+}  // namespace normals
+}  // namespace possumwood
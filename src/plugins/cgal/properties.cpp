@@ -1,15 +1,28 @@
 #include "properties.h"
 
+#include <tbb/parallel_for.h>
+
 namespace possumwood {
 
-Properties::Properties() {
+Properties::Properties() : m_itemCount(0) {
 }
 
-Properties::Properties(const Properties& p) {
-	for(auto& prop : p.m_properties) {
-		std::unique_ptr<PropertyBase> property = prop->clone();
-		m_properties.push_back(std::move(property));
-	}
+Properties::Properties(const Properties& p) : m_itemCount(0) {
+	cloneFrom(p);
+}
+
+void Properties::cloneFrom(const Properties& p) {
+	m_properties.clear();
+	m_properties.resize(p.m_properties.size());
+
+	// each property is an independent column - copy them in parallel (mesh COW duplication
+	// can copy large blocks of data)
+	tbb::parallel_for(std::size_t(0), p.m_properties.size(), [&](std::size_t i) {
+		m_properties[i] = p.m_properties[i]->clone();
+		m_properties[i]->m_parent = this;
+	});
+
+	m_itemCount = p.m_itemCount;
 }
 
 Properties::const_iterator Properties::begin() const {
@@ -20,20 +33,29 @@ Properties::const_iterator Properties::end() const {
 	return boost::make_indirect_iterator(m_properties.end());
 }
 
+std::vector<std::unique_ptr<PropertyBase>>::iterator Properties::lowerBound(const std::string& name) {
+	return std::lower_bound(
+	    m_properties.begin(), m_properties.end(), name,
+	    [](const std::unique_ptr<PropertyBase>& val, const std::string& n) { return val->name() < n; });
+}
+
+std::vector<std::unique_ptr<PropertyBase>>::const_iterator Properties::lowerBound(const std::string& name) const {
+	return std::lower_bound(
+	    m_properties.begin(), m_properties.end(), name,
+	    [](const std::unique_ptr<PropertyBase>& val, const std::string& n) { return val->name() < n; });
+}
+
 Properties::const_iterator Properties::find(const std::string& name) const {
-	auto it = std::find_if(m_properties.begin(), m_properties.end(),
-	                       [name](const std::unique_ptr<PropertyBase>& val) { return val->name() == name; });
+	auto it = lowerBound(name);
+	if(it != m_properties.end() && (*it)->name() != name)
+		it = m_properties.end();
 
 	return boost::make_indirect_iterator(it);
 }
 
 Properties& Properties::operator=(const Properties& p) {
-	m_properties.clear();
-
-	for(auto& prop : p.m_properties) {
-		std::unique_ptr<PropertyBase> property = prop->clone();
-		m_properties.push_back(std::move(property));
-	}
+	if(&p != this)
+		cloneFrom(p);
 
 	return *this;
 }
@@ -43,6 +65,17 @@ bool Properties::hasProperty(const std::string& name) const {
 	return it != end();
 }
 
+std::size_t Properties::itemCount() const {
+	return m_itemCount;
+}
+
+std::size_t Properties::addSingleItem() {
+	for(auto& p : m_properties)
+		p->resize(m_itemCount + 1);
+
+	return m_itemCount++;
+}
+
 bool Properties::operator==(const Properties& p) const {
 	if(m_properties.size() != p.m_properties.size())
 		return false;
@@ -80,8 +113,9 @@ bool Properties::operator!=(const Properties& p) const {
 }
 
 void Properties::removeProperty(const std::string& name) {
-	auto it = std::find_if(m_properties.begin(), m_properties.end(),
-	                       [name](const std::unique_ptr<PropertyBase>& val) { return val->name() == name; });
+	auto it = lowerBound(name);
+	assert(it != m_properties.end() && (*it)->name() == name);
+
 	m_properties.erase(it);
 }
 
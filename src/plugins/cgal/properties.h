@@ -18,6 +18,8 @@ template <typename T>
 class Property;
 
 /// A simple container class designed to hold properties of items of a polyhedron.
+/// Properties are stored column-wise (one std::vector per property), sorted by name, and all
+/// columns share the same item indexing (stored as PropertyKey instances on the polyhedron items).
 class Properties {
   public:
 	Properties();
@@ -41,6 +43,17 @@ class Properties {
 	template <typename T>
 	const Property<T>& property(const std::string& name) const;
 
+	/// Returns a typed handle to a property, or nullptr if the property doesn't exist or is of a different type.
+	/// The handle stays valid until the property is removed or this container is assigned to.
+	template <typename T>
+	Property<T>* handle(const std::string& name);
+
+	template <typename T>
+	const Property<T>* handle(const std::string& name) const;
+
+	/// Number of items allocated in each property column
+	std::size_t itemCount() const;
+
 	bool operator==(const Properties& p) const;
 	bool operator!=(const Properties& p) const;
 
@@ -48,42 +61,64 @@ class Properties {
   private:
 	std::size_t addSingleItem();
 
+	void cloneFrom(const Properties& p);
+
+	std::vector<std::unique_ptr<PropertyBase>>::iterator lowerBound(const std::string& name);
+	std::vector<std::unique_ptr<PropertyBase>>::const_iterator lowerBound(const std::string& name) const;
+
 	std::vector<std::unique_ptr<PropertyBase>> m_properties;
+	std::size_t m_itemCount;
 
-	template <typename T>
-	friend class Property;
+	friend class PropertyBase;
 };
 
 template <typename T>
 Property<T>& Properties::addProperty(const std::string& name, const T& defaultValue) {
 	assert(find(name) == end() && "property naming has to be unique");
 
-	// add a new Property instance
-	std::unique_ptr<PropertyBase> ptr(new Property<T>(name, defaultValue));
-	m_properties.push_back(std::move(ptr));
+	// add a new Property instance, keeping the properties sorted by name
+	std::unique_ptr<Property<T>> ptr(new Property<T>(name, defaultValue));
+	ptr->m_parent = this;
+	ptr->resize(m_itemCount);
 
-	std::sort(m_properties.begin(), m_properties.end(),
-	          [](const std::unique_ptr<PropertyBase>& v1, const std::unique_ptr<PropertyBase>& v2) {
-		          return v1->name() < v2->name();
-	          });
+	Property<T>& result = *ptr;
+	m_properties.insert(lowerBound(name), std::move(ptr));
 
-	return property<T>(name);
+	return result;
 }
 
 template <typename T>
 Property<T>& Properties::property(const std::string& name) {
-	auto it = find(name);
-	assert(it != end());
+	Property<T>* result = handle<T>(name);
+	assert(result != nullptr);
 
-	return dynamic_cast<Property<T>&>(*it);
+	return *result;
 }
 
 template <typename T>
 const Property<T>& Properties::property(const std::string& name) const {
-	auto it = find(name);
-	assert(it != end());
+	const Property<T>* result = handle<T>(name);
+	assert(result != nullptr);
+
+	return *result;
+}
+
+template <typename T>
+Property<T>* Properties::handle(const std::string& name) {
+	auto it = lowerBound(name);
+	if(it == m_properties.end() || (*it)->name() != name || (*it)->type() != typeid(T))
+		return nullptr;
+
+	return static_cast<Property<T>*>(it->get());
+}
+
+template <typename T>
+const Property<T>* Properties::handle(const std::string& name) const {
+	auto it = lowerBound(name);
+	if(it == m_properties.end() || (*it)->name() != name || (*it)->type() != typeid(T))
+		return nullptr;
 
-	return dynamic_cast<const Property<T>&>(*it);
+	return static_cast<const Property<T>*>(it->get());
 }
 
 }  // namespace possumwood
@@ -1,8 +1,13 @@
 #include "property.h"
 
+#include <cassert>
+
+#include "properties.h"
+
 namespace possumwood {
 
-PropertyBase::PropertyBase(const std::string& name, const std::type_index type) : m_name(name), m_type(type) {
+PropertyBase::PropertyBase(const std::string& name, const std::type_index type)
+    : m_name(name), m_type(type), m_parent(nullptr) {
 }
 
 PropertyBase::~PropertyBase() {
@@ -16,6 +21,11 @@ const std::type_index& PropertyBase::type() const {
 	return m_type;
 }
 
+int PropertyBase::addItem() {
+	assert(m_parent != nullptr);
+	return (int)m_parent->addSingleItem();
+}
+
 bool PropertyBase::operator==(const PropertyBase& p) const {
 	return isEqual(p);
 }
@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <typeindex>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 
@@ -29,16 +30,64 @@ class PropertyBase {
 
 	virtual bool isEqual(const PropertyBase& p) const = 0;
 
+	/// Resizes the underlying column to hold the given number of items (new items are initialised to the default
+	/// value)
+	virtual void resize(std::size_t itemCount) = 0;
+
 	PropertyBase(const PropertyBase&) = default;
 	PropertyBase& operator=(const PropertyBase&) = default;
 
+	/// Allocates a new item in all properties of the parent container, and returns its index
+	int addItem();
+
   private:
 	std::string m_name;
 	std::type_index m_type;
 
+	Properties* m_parent;
+
 	friend class Properties;
 };
 
+/// A lightweight non-owning view of a contiguous block of property values, allowing
+/// whole-mesh loops to bypass the per-element PropertyKey indirection.
+template <typename T>
+class PropertySpan {
+  public:
+	PropertySpan(T* data, std::size_t size) : m_data(data), m_size(size) {
+	}
+
+	T* begin() const {
+		return m_data;
+	}
+
+	T* end() const {
+		return m_data + m_size;
+	}
+
+	T* data() const {
+		return m_data;
+	}
+
+	std::size_t size() const {
+		return m_size;
+	}
+
+	bool empty() const {
+		return m_size == 0;
+	}
+
+	T& operator[](std::size_t index) const {
+		return m_data[index];
+	}
+
+  private:
+	T* m_data;
+	std::size_t m_size;
+};
+
+/// A single column of typed values, indexed by PropertyKey instances stored on mesh items.
+/// All properties inside one Properties container share the same item indexing.
 template <typename T>
 class Property : public PropertyBase {
   public:
@@ -50,6 +99,18 @@ class Property : public PropertyBase {
 	iterator begin();
 	iterator end();
 
+	typedef typename std::vector<T>::const_iterator const_iterator;
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	/// Bulk access to the underlying values, indexed by PropertyKey::index()
+	PropertySpan<T> values();
+	PropertySpan<const T> values() const;
+
+	std::size_t size() const;
+
+	const T& defaultValue() const;
+
   protected:
 	Property(const std::string& name, const T& defaultValue);
 
@@ -60,6 +121,8 @@ class Property : public PropertyBase {
 
 	virtual bool isEqual(const PropertyBase& p) const override;
 
+	virtual void resize(std::size_t itemCount) override;
+
   private:
 	T m_defaultValue;
 	std::vector<T> m_data;
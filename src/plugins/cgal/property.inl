@@ -16,9 +16,10 @@ const T& Property<T>::get(const PropertyKey& key) const {
 template <typename T>
 void Property<T>::set(PropertyKey& key, const T& value) {
 	if(key.isDefault())
-		key.m_index = m_data.size();
+		key.m_index = addItem();
 
-	m_data.push_back(value);
+	assert(key.m_index < (int)m_data.size());
+	m_data[key.m_index] = value;
 }
 
 template <typename T>
@@ -46,7 +47,7 @@ bool Property<T>::isEqual(const PropertyBase& p) const {
 	if(name() != p.name() || type() != p.type())
 		return false;
 
-	const Property<T>& prop = dynamic_cast<const Property<T>&>(p);
+	const Property<T>& prop = static_cast<const Property<T>&>(p);
 	if(m_defaultValue != prop.m_defaultValue || m_data.size() != prop.m_data.size())
 		return false;
 
@@ -60,6 +61,11 @@ bool Property<T>::isEqual(const PropertyBase& p) const {
 	return true;
 }
 
+template <typename T>
+void Property<T>::resize(std::size_t itemCount) {
+	m_data.resize(itemCount, m_defaultValue);
+}
+
 template <typename T>
 typename Property<T>::iterator Property<T>::begin() {
 	return m_data.begin();
@@ -70,4 +76,34 @@ typename Property<T>::iterator Property<T>::end() {
 	return m_data.end();
 }
 
+template <typename T>
+typename Property<T>::const_iterator Property<T>::begin() const {
+	return m_data.begin();
+}
+
+template <typename T>
+typename Property<T>::const_iterator Property<T>::end() const {
+	return m_data.end();
+}
+
+template <typename T>
+PropertySpan<T> Property<T>::values() {
+	return PropertySpan<T>(m_data.data(), m_data.size());
+}
+
+template <typename T>
+PropertySpan<const T> Property<T>::values() const {
+	return PropertySpan<const T>(m_data.data(), m_data.size());
+}
+
+template <typename T>
+std::size_t Property<T>::size() const {
+	return m_data.size();
+}
+
+template <typename T>
+const T& Property<T>::defaultValue() const {
+	return m_defaultValue;
+}
+
 }  // namespace possumwood
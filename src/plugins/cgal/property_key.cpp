@@ -1,5 +1,7 @@
 #include "property_key.h"
 
+#include <cassert>
+
 namespace possumwood {
 
 PropertyKey::PropertyKey() : m_index(-1) {
@@ -9,6 +11,11 @@ bool PropertyKey::isDefault() const {
 	return m_index < 0;
 }
 
+std::size_t PropertyKey::index() const {
+	assert(!isDefault());
+	return m_index;
+}
+
 std::ostream& operator<<(std::ostream& out, const PropertyKey& prop) {
 	out << prop.m_index;
 	return out;
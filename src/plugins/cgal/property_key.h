@@ -13,6 +13,9 @@ class PropertyKey {
 
 	bool isDefault() const;
 
+	/// Index of the item this key refers to in bulk property views (only valid for non-default keys)
+	std::size_t index() const;
+
   private:
 	int m_index;
 
@@ -1,5 +1,7 @@
 #include "module.h"
 
+#include <luabind/operator.hpp>
+
 #include "opencv_image.h"
 
 namespace possumwood {
@@ -19,7 +21,28 @@ void Module::init(possumwood::lua::State& state) {
 	                                  .def("setPixel", &OpencvMatWrapper::setPixel)
 	                                  .def("pixel", &OpencvMatWrapper::pixel)
 	                                  .def("width", &OpencvMatWrapper::width)
-	                                  .def("height", &OpencvMatWrapper::height)];
+	                                  .def("height", &OpencvMatWrapper::height)
+	                                  .def("channels", &OpencvMatWrapper::channels)
+
+	                                  // bulk access, without creating a table per pixel
+	                                  .def("map", &OpencvMatWrapper::map)
+	                                  .def("mapRows", &OpencvMatWrapper::mapRows)
+	                                  .def("row", &OpencvMatWrapper::row)
+	                                  .def("convert", &OpencvMatWrapper::convert)
+
+	                                  .def(const_self + const_self)
+	                                  .def(const_self - const_self)
+	                                  .def(const_self * const_self)
+	                                  .def(const_self / const_self)
+	                                  .def(const_self + other<float>())
+	                                  .def(const_self - other<float>())
+	                                  .def(const_self * other<float>())
+	                                  .def(const_self / other<float>()),
+
+	                              class_<OpencvRowView>("row")
+	                                  .def("get", &OpencvRowView::get)
+	                                  .def("set", &OpencvRowView::set)
+	                                  .def("size", &OpencvRowView::size)];
 }
 
 }  // namespace images
@@ -0,0 +1,207 @@
+#include "opencv_image.h"
+
+#include <lua/datatypes/state.h>
+
+#include <sstream>
+
+namespace possumwood {
+namespace images {
+
+namespace {
+
+void checkDepth(int depth) {
+	if(depth != CV_8U && depth != CV_32F)
+		throw std::runtime_error("Only CV_8U or CV_32F types supported at the moment");
+}
+
+OpencvMatWrapper wrap(const cv::Mat& m) {
+	OpencvMatWrapper result;
+	result = m;
+	return result;
+}
+
+/// calls a Lua function already on the stack at fnIndex, with the values of a single pixel, and writes the
+/// returned values back
+template <typename T>
+void mapPixel(lua_State* L, int fnIndex, std::size_t x, std::size_t y, T* values, int channels) {
+	lua_pushvalue(L, fnIndex);
+	lua_pushinteger(L, x);
+	lua_pushinteger(L, y);
+	for(int c = 0; c < channels; ++c)
+		lua_pushnumber(L, values[c]);
+
+	if(lua_pcall(L, channels + 2, channels, 0) != 0) {
+		const std::string error = possumwood::lua::errorMessage(L);
+		lua_settop(L, fnIndex - 1);
+		throw std::runtime_error(error);
+	}
+
+	for(int c = 0; c < channels; ++c)
+		if(!lua_isnil(L, c - channels))
+			values[c] = cv::saturate_cast<T>(lua_tonumber(L, c - channels));
+
+	lua_pop(L, channels);
+}
+
+template <typename T>
+void mapPixels(lua_State* L, int fnIndex, cv::Mat& mat) {
+	const int channels = mat.channels();
+
+	for(int y = 0; y < mat.rows; ++y) {
+		T* row = mat.ptr<T>(y);
+		for(int x = 0; x < mat.cols; ++x)
+			mapPixel(L, fnIndex, x, y, row + x * channels, channels);
+	}
+}
+
+}  // namespace
+
+OpencvRowView::OpencvRowView(const std::shared_ptr<cv::Mat>& mat, std::size_t row) : m_mat(mat), m_row(row) {
+	checkDepth(mat->depth());
+}
+
+void OpencvRowView::checkIndex(std::size_t index) const {
+	if(index >= size()) {
+		std::stringstream ss;
+		ss << "Index " << index << " out of bounds of image row with " << size() << " values.";
+		throw std::runtime_error(ss.str().c_str());
+	}
+}
+
+float OpencvRowView::get(std::size_t index) const {
+	checkIndex(index);
+
+	if(m_mat->depth() == CV_8U)
+		return m_mat->ptr<unsigned char>(m_row)[index];
+	return m_mat->ptr<float>(m_row)[index];
+}
+
+void OpencvRowView::set(std::size_t index, float value) {
+	checkIndex(index);
+
+	if(m_mat->depth() == CV_8U)
+		m_mat->ptr<unsigned char>(m_row)[index] = cv::saturate_cast<unsigned char>(value);
+	else
+		m_mat->ptr<float>(m_row)[index] = value;
+}
+
+std::size_t OpencvRowView::size() const {
+	return m_mat->cols * m_mat->channels();
+}
+
+/////
+
+void OpencvMatWrapper::map(const luabind::object& fn, lua_State* L) {
+	if(luabind::type(fn) != LUA_TFUNCTION)
+		throw std::runtime_error("Argument of map() has to be a function!");
+
+	checkDepth(m_constMat->depth());
+	makeWritable();
+
+	// the function stays on the stack for the whole loop, avoiding a registry lookup per pixel
+	fn.push(L);
+	const int fnIndex = lua_gettop(L);
+
+	if(m_mat->depth() == CV_8U)
+		mapPixels<unsigned char>(L, fnIndex, *m_mat);
+	else
+		mapPixels<float>(L, fnIndex, *m_mat);
+
+	lua_pop(L, 1);
+}
+
+void OpencvMatWrapper::mapRows(const luabind::object& fn, lua_State* L) {
+	if(luabind::type(fn) != LUA_TFUNCTION)
+		throw std::runtime_error("Argument of mapRows() has to be a function!");
+
+	checkDepth(m_constMat->depth());
+	makeWritable();
+
+	for(int y = 0; y < m_mat->rows; ++y)
+		luabind::call_function<void>(fn, y, OpencvRowView(m_mat, y));
+}
+
+OpencvRowView OpencvMatWrapper::row(std::size_t y) {
+	if(y >= height()) {
+		std::stringstream ss;
+		ss << "Row " << y << " out of bounds of image with height " << height() << ".";
+		throw std::runtime_error(ss.str().c_str());
+	}
+
+	makeWritable();
+
+	return OpencvRowView(m_mat, y);
+}
+
+OpencvMatWrapper OpencvMatWrapper::convert(int type, float scale) const {
+	checkDepth(type);
+
+	cv::Mat result;
+	m_constMat->convertTo(result, CV_MAKETYPE(type, m_constMat->channels()), scale);
+
+	return wrap(result);
+}
+
+void OpencvMatWrapper::checkSameSize(const OpencvMatWrapper& other) const {
+	if(m_constMat->size() != other.m_constMat->size() || m_constMat->type() != other.m_constMat->type())
+		throw std::runtime_error("Image arithmetic requires images of the same size and type.");
+}
+
+OpencvMatWrapper OpencvMatWrapper::operator+(const OpencvMatWrapper& other) const {
+	checkSameSize(other);
+
+	cv::Mat result;
+	cv::add(*m_constMat, *other.m_constMat, result);
+	return wrap(result);
+}
+
+OpencvMatWrapper OpencvMatWrapper::operator-(const OpencvMatWrapper& other) const {
+	checkSameSize(other);
+
+	cv::Mat result;
+	cv::subtract(*m_constMat, *other.m_constMat, result);
+	return wrap(result);
+}
+
+OpencvMatWrapper OpencvMatWrapper::operator*(const OpencvMatWrapper& other) const {
+	checkSameSize(other);
+
+	cv::Mat result;
+	cv::multiply(*m_constMat, *other.m_constMat, result);
+	return wrap(result);
+}
+
+OpencvMatWrapper OpencvMatWrapper::operator/(const OpencvMatWrapper& other) const {
+	checkSameSize(other);
+
+	cv::Mat result;
+	cv::divide(*m_constMat, *other.m_constMat, result);
+	return wrap(result);
+}
+
+OpencvMatWrapper OpencvMatWrapper::operator+(float other) const {
+	cv::Mat result;
+	cv::add(*m_constMat, cv::Scalar::all(other), result);
+	return wrap(result);
+}
+
+OpencvMatWrapper OpencvMatWrapper::operator-(float other) const {
+	cv::Mat result;
+	cv::subtract(*m_constMat, cv::Scalar::all(other), result);
+	return wrap(result);
+}
+
+OpencvMatWrapper OpencvMatWrapper::operator*(float other) const {
+	cv::Mat result;
+	m_constMat->convertTo(result, m_constMat->type(), other);
+	return wrap(result);
+}
+
+OpencvMatWrapper OpencvMatWrapper::operator/(float other) const {
+	cv::Mat result;
+	m_constMat->convertTo(result, m_constMat->type(), 1.0 / other);
+	return wrap(result);
+}
+
+}  // namespace images
+}  // namespace possumwood
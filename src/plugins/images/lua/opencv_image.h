@@ -2,6 +2,7 @@
 
 #include <iomanip>
 #include <iostream>
+#include <luabind/luabind.hpp>
 #include <opencv2/opencv.hpp>
 
 #include "opencv/frame.h"
@@ -9,6 +10,26 @@
 namespace possumwood {
 namespace images {
 
+/// A typed view of a single row of an image, allowing to access its values as numbers from Lua without
+/// creating a table per pixel. Values are indexed from 0, with channels interleaved (i.e., index of a
+/// value is x * channels + channel). Keeps the underlying image data alive.
+class OpencvRowView {
+  public:
+	OpencvRowView(const std::shared_ptr<cv::Mat>& mat, std::size_t row);
+
+	float get(std::size_t index) const;
+	void set(std::size_t index, float value);
+
+	/// number of values in the row (width * channels)
+	std::size_t size() const;
+
+  private:
+	void checkIndex(std::size_t index) const;
+
+	std::shared_ptr<cv::Mat> m_mat;
+	std::size_t m_row;
+};
+
 class OpencvMatWrapper {
   public:
 	OpencvMatWrapper() : m_constMat(new cv::Mat(1, 1, CV_8UC1)) {
@@ -20,19 +41,27 @@ class OpencvMatWrapper {
 		assert(type == CV_8U || type == CV_32F);
 	}
 
-	OpencvMatWrapper(const OpencvMatWrapper& i) : m_constMat(i.m_constMat) {
+	/// copies share the image data, including the writable image (luabind stores values by copy, and a copy of a
+	/// wrapped writable image has to keep writing to the same data)
+	OpencvMatWrapper(const OpencvMatWrapper& i) : m_constMat(i.m_constMat), m_mat(i.m_mat) {
 	}
 
 	OpencvMatWrapper(const opencv::Frame& f) : m_constMat(new cv::Mat(*f)) {
 	}
 
+	/// wraps an existing writable image - all writes go directly to its data (no copy on first write)
+	explicit OpencvMatWrapper(const std::shared_ptr<cv::Mat>& mat) : m_constMat(mat), m_mat(mat) {
+	}
+
 	OpencvMatWrapper& operator=(const OpencvMatWrapper& i) {
 		m_constMat = i.m_constMat;
+		m_mat = i.m_mat;
 		return *this;
 	}
 
 	OpencvMatWrapper& operator=(const cv::Mat& m) {
 		m_constMat = std::shared_ptr<const cv::Mat>(new cv::Mat(m));
+		m_mat.reset();
 		return *this;
 	}
 
@@ -50,12 +79,7 @@ class OpencvMatWrapper {
 		if(luabind::type(value) != LUA_TTABLE)
 			throw std::runtime_error("Pixel values have to be tables!");
 
-		// copy on first write - to be used in "injection" to allow to seamlessly
-		//   "overwrite" the original image, copying only when necessary
-		if(m_mat == nullptr) {
-			m_mat = std::shared_ptr<cv::Mat>(new cv::Mat(m_constMat->clone()));
-			m_constMat = m_mat;
-		}
+		makeWritable();
 
 		if(m_mat->depth() == CV_8U) {
 			unsigned char* val = m_mat->ptr<unsigned char>(y, x);
@@ -108,11 +132,52 @@ class OpencvMatWrapper {
 		return m_constMat->rows;
 	}
 
+	const cv::Mat& mat() const {
+		return *m_constMat;
+	}
+
+	std::size_t channels() const {
+		return m_constMat->channels();
+	}
+
+	/// calls fn(x, y, value1, value2, ...) for each pixel, replacing the pixel values with fn's return values
+	/// (a missing or nil return value keeps the original value of its channel)
+	void map(const luabind::object& fn, lua_State* L);
+	/// calls fn(y, row) for each row of the image, with row being a writable OpencvRowView
+	void mapRows(const luabind::object& fn, lua_State* L);
+	/// returns a writable view of a single row
+	OpencvRowView row(std::size_t y);
+
+	/// returns a copy of this image converted to a different type (uint8 or float32), with values multiplied by scale
+	OpencvMatWrapper convert(int type, float scale) const;
+
+	// per-element arithmetic on whole images, with the usual OpenCV saturation rules for uint8 images
+	OpencvMatWrapper operator+(const OpencvMatWrapper& other) const;
+	OpencvMatWrapper operator-(const OpencvMatWrapper& other) const;
+	OpencvMatWrapper operator*(const OpencvMatWrapper& other) const;
+	OpencvMatWrapper operator/(const OpencvMatWrapper& other) const;
+
+	OpencvMatWrapper operator+(float other) const;
+	OpencvMatWrapper operator-(float other) const;
+	OpencvMatWrapper operator*(float other) const;
+	OpencvMatWrapper operator/(float other) const;
+
 	bool operator==(const OpencvMatWrapper& p) const {
 		return m_constMat == p.m_constMat;
 	}
 
   private:
+	void makeWritable() {
+		// copy on first write - to be used in "injection" to allow to seamlessly
+		//   "overwrite" the original image, copying only when necessary
+		if(m_mat == nullptr) {
+			m_mat = std::shared_ptr<cv::Mat>(new cv::Mat(m_constMat->clone()));
+			m_constMat = m_mat;
+		}
+	}
+
+	void checkSameSize(const OpencvMatWrapper& other) const;
+
 	std::shared_ptr<const cv::Mat> m_constMat;
 	std::shared_ptr<cv::Mat> m_mat;
 };
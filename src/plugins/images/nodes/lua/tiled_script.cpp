@@ -0,0 +1,126 @@
+#include <lua/datatypes/chunk_cache.h>
+#include <lua/datatypes/context.h>
+#include <lua/datatypes/state.h>
+#include <lua/datatypes/state_pool.h>
+#include <possumwood_sdk/node_implementation.h>
+#include <possumwood_sdk/source_editor.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "lua/module.h"
+#include "lua/opencv_image.h"
+#include "opencv/frame.h"
+
+namespace {
+
+// Runs a Lua script on an image in parallel, split into tiles of rows. Each tile is evaluated on its own Lua
+// state (from the state pool), with these globals injected in addition to the variables of the context:
+//   in_image - the tile of the input image (read-only)
+//   out_image - the tile of the output image, initialised to the input values
+//   tile_x, tile_y - the position of the tile's origin in the full image
+// The script can modify out_image in-place, or assign a new image of the same size and type to it.
+
+dependency_graph::InAttr<std::string> a_src;
+dependency_graph::InAttr<possumwood::lua::Context> a_context;
+dependency_graph::InAttr<possumwood::opencv::Frame> a_inFrame;
+dependency_graph::InAttr<unsigned> a_tileSize;
+dependency_graph::OutAttr<possumwood::opencv::Frame> a_outFrame;
+
+class Editor : public possumwood::SourceEditor {
+  public:
+	Editor() : SourceEditor(a_src) {
+	}
+};
+
+void runTile(const std::string& src, const possumwood::lua::Context& context, const cv::Mat& input, cv::Mat& output,
+             const cv::Rect& tile) {
+	possumwood::lua::State state = possumwood::lua::StatePool::instance().acquire(context);
+
+	const std::shared_ptr<cv::Mat> outTile(new cv::Mat(output(tile)));
+	input(tile).copyTo(*outTile);
+
+	possumwood::images::OpencvMatWrapper inImage;
+	inImage = input(tile);
+
+	try {
+		luabind::object globals = state.globals();
+		globals["in_image"] = inImage;
+		const luabind::object outTileObject(state, possumwood::images::OpencvMatWrapper(outTile));
+		globals["out_image"] = outTileObject;
+		globals["tile_x"] = tile.x;
+		globals["tile_y"] = tile.y;
+
+		// compiled only once, shared by all tiles
+		possumwood::lua::ChunkCache::instance().run(state, src);
+
+		const luabind::object outObject = globals["out_image"];
+		const possumwood::images::OpencvMatWrapper outImage =
+		    luabind::object_cast<possumwood::images::OpencvMatWrapper>(outObject);
+		const cv::Mat& result = outImage.mat();
+
+		// the injected image writes directly to the output tile
+		if(outObject == outTileObject)
+			assert(result.data == outTile->data);
+
+		// the script replaced the output image with a new one - copy its data to the output tile
+		else {
+			if(result.size() != outTile->size() || result.type() != outTile->type())
+				throw std::runtime_error("The out_image has to keep the size and type of the tile.");
+
+			result.copyTo(*outTile);
+		}
+	}
+	catch(const luabind::error& err) {
+		throw std::runtime_error(possumwood::lua::errorMessage(err.state()));
+	}
+	catch(const luabind::cast_failed& err) {
+		throw std::runtime_error("The out_image global needs to be an image.");
+	}
+}
+
+dependency_graph::State compute(dependency_graph::Values& data) {
+	const std::string& src = data.get(a_src);
+	const cv::Mat& input = *data.get(a_inFrame);
+	const int tileSize = std::max(1u, data.get(a_tileSize));
+
+	// all tiles use the images module, for the tile image globals
+	possumwood::lua::Context context = data.get(a_context);
+	context.addModule(possumwood::images::Module::name(), possumwood::images::Module::init);
+
+	cv::Mat output(input.rows, input.cols, input.type());
+
+	// each tile is a task - no grain size needed, as a tile is already a large enough unit of work
+	const int tileCount = (input.rows + tileSize - 1) / tileSize;
+	tbb::parallel_for(tbb::blocked_range<int>(0, tileCount, 1), [&](const tbb::blocked_range<int>& range) {
+		for(int t = range.begin(); t != range.end(); ++t) {
+			const int y = t * tileSize;
+			runTile(src, context, input, output, cv::Rect(0, y, input.cols, std::min(tileSize, input.rows - y)));
+		}
+	});
+
+	data.set(a_outFrame, possumwood::opencv::Frame(output));
+
+	return dependency_graph::State();
+}
+
+void init(possumwood::Metadata& meta) {
+	meta.addAttribute(a_src, "source", std::string("-- modify out_image here\n"));
+	meta.addAttribute(a_context, "context", possumwood::lua::Context(), possumwood::AttrFlags::kVertical);
+	meta.addAttribute(a_inFrame, "in_frame", possumwood::opencv::Frame(), possumwood::AttrFlags::kVertical);
+	meta.addAttribute(a_tileSize, "tile_size", 64u);
+	meta.addAttribute(a_outFrame, "out_frame", possumwood::opencv::Frame(), possumwood::AttrFlags::kVertical);
+
+	meta.addInfluence(a_src, a_outFrame);
+	meta.addInfluence(a_context, a_outFrame);
+	meta.addInfluence(a_inFrame, a_outFrame);
+	meta.addInfluence(a_tileSize, a_outFrame);
+
+	meta.setCompute(&compute);
+	meta.setBackgroundCompute(true);
+	meta.setEditor<Editor>();
+}
+
+possumwood::NodeImplementation s_impl("lua/images/tiled_script", init);
+
+}  // namespace
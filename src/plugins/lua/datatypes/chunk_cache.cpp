@@ -0,0 +1,268 @@
+#include "chunk_cache.h"
+
+#include <possumwood_sdk/atomic_write.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+#include "state.h"
+
+namespace possumwood {
+namespace lua {
+
+namespace {
+
+// number of compiled chunks kept in memory
+const std::size_t s_cacheSize = 64;
+
+const char s_magic[8] = {'P', 'W', 'L', 'U', 'A', 'C', '0', '2'};
+
+// registry keys of the last chunk executed in a state, and its source
+const char* const s_chunkKey = "possumwood_chunk";
+const char* const s_chunkSourceKey = "possumwood_chunk_source";
+
+int writer(lua_State* state, const void* data, std::size_t size, void* userData) {
+	static_cast<std::string*>(userData)->append(static_cast<const char*>(data), size);
+	return 0;
+}
+
+/// compiles a source to bytecode, using a temporary state
+std::string compile(const std::string& src) {
+	lua_State* state = luaL_newstate();
+
+	// the source is used as the chunk name, to keep error messages consistent with luaL_dostring()
+	if(luaL_loadbuffer(state, src.c_str(), src.size(), src.c_str())) {
+		const std::string error = errorMessage(state);
+		lua_close(state);
+
+		throw std::runtime_error(error);
+	}
+
+	std::string result;
+#if LUA_VERSION_NUM >= 503
+	lua_dump(state, writer, &result, 0);
+#else
+	lua_dump(state, writer, &result);
+#endif
+
+	lua_close(state);
+
+	return result;
+}
+
+/// header of a cache file - bytecode is specific to the Lua version and the number and pointer sizes of the
+/// build, and is only valid for the exact same source
+std::string header(const std::string& src) {
+	std::string result(s_magic, sizeof(s_magic));
+
+	const int32_t format[3] = {LUA_VERSION_NUM, (int32_t)sizeof(lua_Number), (int32_t)sizeof(void*)};
+	result.append((const char*)format, sizeof(format));
+
+	const uint64_t size = src.size();
+	result.append((const char*)&size, sizeof(uint64_t));
+	result.append(src);
+
+	return result;
+}
+
+std::string filename(std::size_t hash) {
+	std::stringstream result;
+	result << "chunk_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".luac";
+	return result.str();
+}
+
+/// reads a compiled chunk from the on-disk cache, returns a null pointer if not found or not valid
+std::shared_ptr<const std::string> load(const boost::filesystem::path& dir, const std::string& src,
+                                        std::size_t hash) {
+	if(dir.empty())
+		return std::shared_ptr<const std::string>();
+
+	std::ifstream in((dir / filename(hash)).string(), std::ios::binary);
+	if(!in.good())
+		return std::shared_ptr<const std::string>();
+
+	// the header and the full source have to match
+	const std::string expected = header(src);
+
+	std::string data(expected.size(), '\0');
+	in.read(&data[0], data.size());
+
+	if(!in.good() || data != expected)
+		return std::shared_ptr<const std::string>();
+
+	// the rest of the file is the bytecode
+	std::stringstream bytecode;
+	bytecode << in.rdbuf();
+	if(bytecode.str().empty())
+		return std::shared_ptr<const std::string>();
+
+	return std::make_shared<const std::string>(bytecode.str());
+}
+
+/// writes a compiled chunk to the on-disk cache
+void save(const boost::filesystem::path& dir, const std::string& src, std::size_t hash, const std::string& bytecode) {
+	if(dir.empty())
+		return;
+
+	// the cache is only an optimisation, so failures to write are ignored
+	possumwood::atomicWrite(dir / filename(hash), [&](std::ostream& out) {
+		const std::string head = header(src);
+		out.write(head.c_str(), head.size());
+		out.write(bytecode.c_str(), bytecode.size());
+	});
+}
+
+}  // namespace
+
+ChunkCache& ChunkCache::instance() {
+	static ChunkCache s_cache;
+	return s_cache;
+}
+
+ChunkCache::ChunkCache() {
+	const char* dir = getenv("POSSUMWOOD_LUA_CACHE");
+	if(dir != nullptr)
+		m_directory = dir;
+}
+
+void ChunkCache::setDirectory(const boost::filesystem::path& dir) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_directory = dir;
+}
+
+boost::filesystem::path ChunkCache::directory() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_directory;
+}
+
+std::shared_ptr<const std::string> ChunkCache::bytecode(const std::string& src) {
+	const std::size_t hash = std::hash<std::string>()(src);
+
+	std::shared_future<std::shared_ptr<const std::string>> result;
+	std::promise<std::shared_ptr<const std::string>> promise;
+	boost::filesystem::path dir;
+	bool build = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// in-memory cache, moving the found item to the front
+		for(auto it = m_items.begin(); it != m_items.end(); ++it)
+			if(it->hash == hash && it->src == src) {
+				m_items.splice(m_items.begin(), m_items, it);
+				result = m_items.front().bytecode;
+				break;
+			}
+
+		if(!result.valid()) {
+			result = promise.get_future().share();
+			dir = m_directory;
+			build = true;
+
+			m_items.push_front(Item{hash, src, result});
+			while(m_items.size() > s_cacheSize)
+				m_items.pop_back();
+		}
+	}
+
+	// waiting for a chunk built by another state happens outside the lock
+	if(!build)
+		return result.get();
+
+	// on-disk cache, or compile the source - both outside the lock
+	try {
+		std::shared_ptr<const std::string> code = load(dir, src, hash);
+		if(!code) {
+			code = std::make_shared<const std::string>(compile(src));
+			save(dir, src, hash, *code);
+		}
+
+		promise.set_value(code);
+	}
+	catch(...) {
+		// syntax errors are not cached, but all current waiters receive the exception
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_items.remove_if([&](const Item& i) { return i.hash == hash && i.src == src; });
+		}
+
+		promise.set_exception(std::current_exception());
+	}
+
+	return result.get();
+}
+
+void ChunkCache::drop(const std::string& src) {
+	const std::size_t hash = std::hash<std::string>()(src);
+
+	boost::filesystem::path dir;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_items.remove_if([&](const Item& i) { return i.hash == hash && i.src == src; });
+		dir = m_directory;
+	}
+
+	if(!dir.empty()) {
+		boost::system::error_code ec;
+		boost::filesystem::remove(dir / filename(hash), ec);
+	}
+}
+
+void ChunkCache::push(lua_State* state, const std::string& src) {
+	// the function of the last chunk executed in this state
+	lua_getfield(state, LUA_REGISTRYINDEX, s_chunkSourceKey);
+	std::size_t size = 0;
+	const char* lastSrc = lua_tolstring(state, -1, &size);
+	const bool same = lastSrc != nullptr && size == src.size() && memcmp(lastSrc, src.c_str(), size) == 0;
+	lua_pop(state, 1);
+
+	if(same) {
+		lua_getfield(state, LUA_REGISTRYINDEX, s_chunkKey);
+		return;
+	}
+
+	// load the compiled bytecode (the chunk name is stored in the bytecode)
+	const std::shared_ptr<const std::string> code = bytecode(src);
+	if(luaL_loadbuffer(state, code->c_str(), code->size(), "chunk")) {
+		lua_pop(state, 1);
+
+		// the cached bytecode is not loadable (e.g., a corrupted cache file) - drop it, and load the source
+		// directly instead (the next evaluation compiles it again)
+		drop(src);
+
+		if(luaL_loadbuffer(state, src.c_str(), src.size(), src.c_str())) {
+			const std::string error = errorMessage(state);
+			lua_pop(state, 1);
+
+			throw std::runtime_error(error);
+		}
+	}
+
+	// and store it for the next evaluation in this state
+	lua_pushvalue(state, -1);
+	lua_setfield(state, LUA_REGISTRYINDEX, s_chunkKey);
+	lua_pushlstring(state, src.c_str(), src.size());
+	lua_setfield(state, LUA_REGISTRYINDEX, s_chunkSourceKey);
+}
+
+void ChunkCache::run(lua_State* state, const std::string& src) {
+	push(state, src);
+
+	if(lua_pcall(state, 0, LUA_MULTRET, 0)) {
+		const std::string error = errorMessage(state);
+		lua_pop(state, 1);
+
+		throw std::runtime_error(error);
+	}
+}
+
+}  // namespace lua
+}  // namespace possumwood
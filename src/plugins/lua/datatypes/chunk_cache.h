@@ -0,0 +1,65 @@
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <luabind/luabind.hpp>
+
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace possumwood {
+namespace lua {
+
+/// A cache of compiled Lua chunks, to avoid parsing the same script source on every evaluation.
+///
+/// Sources are compiled to bytecode once, and the bytecode is shared between all states. Each state also keeps
+/// the function of the last chunk it executed, so a pooled state (see StatePool) evaluating the same script again
+/// (e.g., on each frame of a playback, with only the injected variables changing) doesn't even need to load it.
+///
+/// Compiled chunks can be persisted in a directory (e.g., for batch runs of possumwood_cli), initialised from
+/// the POSSUMWOOD_LUA_CACHE environment variable. Files in this directory are validated against the full source,
+/// the Lua version and the number and pointer sizes on load, but the bytecode itself is loaded as-is - the
+/// directory needs to be trusted. Bytecode that fails to load is dropped from the cache, and the source is
+/// compiled again.
+///
+/// Compilation and disk access happen outside of the cache lock - states compiling different chunks don't wait
+/// for each other, and concurrent requests for the same chunk wait for the first one's result.
+class ChunkCache : public boost::noncopyable {
+  public:
+	static ChunkCache& instance();
+
+	/// pushes the compiled function of a source on the stack of a state. Throws std::runtime_error on a syntax
+	/// error.
+	void push(lua_State* state, const std::string& src);
+
+	/// compiles (or uses a cached compiled chunk) and runs a source in a state - equivalent of luaL_dostring().
+	/// Throws std::runtime_error on an error.
+	void run(lua_State* state, const std::string& src);
+
+	/// sets the directory to persist compiled chunks in (empty path disables the on-disk cache)
+	void setDirectory(const boost::filesystem::path& dir);
+	boost::filesystem::path directory() const;
+
+  private:
+	ChunkCache();
+
+	std::shared_ptr<const std::string> bytecode(const std::string& src);
+	/// removes a chunk from the in-memory and on-disk cache
+	void drop(const std::string& src);
+
+	struct Item {
+		std::size_t hash;
+		std::string src;
+		std::shared_future<std::shared_ptr<const std::string>> bytecode;
+	};
+
+	mutable std::mutex m_mutex;
+	std::list<Item> m_items;
+	boost::filesystem::path m_directory;
+};
+
+}  // namespace lua
+}  // namespace possumwood
@@ -43,6 +43,7 @@ class Context {
 	std::map<std::string, std::function<void(State&)>> m_modules;
 
 	friend class State;
+	friend class StatePool;
 
 	friend std::ostream& operator<<(std::ostream& out, const Context& st);
 };
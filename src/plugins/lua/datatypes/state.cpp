@@ -3,11 +3,12 @@
 #include <lualib.h>
 
 #include "context.h"
+#include "state_pool.h"
 
 namespace possumwood {
 namespace lua {
 
-State::State(const Context& con) {
+State::State(const Context& con) : m_pool(nullptr) {
 	// create a new raw state from Lua
 	m_state = luaL_newstate();
 
@@ -23,24 +24,46 @@ State::State(const Context& con) {
 		v.init(*this);
 }
 
-State::State() : m_state(nullptr) {
+State::State() : m_state(nullptr), m_pool(nullptr) {
 }
 
-State::State(State&& s) : m_state(s.m_state) {
+State::State(lua_State* state, StatePool* pool, const std::string& key)
+    : m_state(state), m_pool(pool), m_poolKey(key) {
+}
+
+State::State(State&& s) : m_state(s.m_state), m_pool(s.m_pool), m_poolKey(std::move(s.m_poolKey)) {
 	s.m_state = nullptr;
+	s.m_pool = nullptr;
 }
 
 State& State::operator=(State&& s) {
+	release();
+
 	m_state = s.m_state;
+	m_pool = s.m_pool;
+	m_poolKey = std::move(s.m_poolKey);
+
 	s.m_state = nullptr;
+	s.m_pool = nullptr;
 
 	return *this;
 }
 
 State::~State() {
-	// release the Lua state
-	if(m_state != nullptr)
-		lua_close(m_state);
+	release();
+}
+
+void State::release() {
+	// release the Lua state - either return it to its pool, or close it
+	if(m_state != nullptr) {
+		if(m_pool != nullptr)
+			m_pool->release(m_poolKey, m_state);
+		else
+			lua_close(m_state);
+	}
+
+	m_state = nullptr;
+	m_pool = nullptr;
 }
 
 luabind::object State::globals() const {
@@ -55,6 +78,11 @@ State::operator const lua_State*() const {
 	return m_state;
 }
 
+std::string errorMessage(lua_State* state) {
+	const char* msg = lua_tostring(state, -1);
+	return msg != nullptr ? msg : "Unknown Lua error (non-string error object)";
+}
+
 std::ostream& operator<<(std::ostream& out, const State& st) {
 	out << "(state)";
 
@@ -4,11 +4,13 @@
 
 #include <boost/noncopyable.hpp>
 #include <luabind/luabind.hpp>
+#include <string>
 
 namespace possumwood {
 namespace lua {
 
 class Context;
+class StatePool;
 
 class State final : public boost::noncopyable {
   public:
@@ -28,11 +30,25 @@ class State final : public boost::noncopyable {
 	operator const lua_State*() const;
 
   private:
+	/// a state owned by a pool - returned to the pool on destruction instead of being closed
+	State(lua_State* state, StatePool* pool, const std::string& key);
+
+	void release();
+
 	lua_State* m_state;
+
+	StatePool* m_pool;
+	std::string m_poolKey;
+
+	friend class StatePool;
 };
 
 std::ostream& operator<<(std::ostream& out, const State& st);
 
+/// returns the error message on top of the stack of a state (e.g., after a failed lua_pcall(), or in a handler
+/// of luabind::error) - a non-string error object (e.g., error({})) doesn't have a message
+std::string errorMessage(lua_State* state);
+
 }  // namespace lua
 
 template <>
@@ -0,0 +1,210 @@
+#include "state_pool.h"
+
+#include <lauxlib.h>
+#include <lualib.h>
+
+#include <luabind/class_info.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "context.h"
+
+namespace possumwood {
+namespace lua {
+
+namespace {
+
+// registry keys of the tables holding copies of all tables reachable from the globals of an initialised state,
+// and of their metatables (both indexed by the original table)
+const char* const s_tablesKey = "possumwood_pool_tables";
+const char* const s_metatablesKey = "possumwood_pool_metatables";
+
+/// maximum number of idle states kept per set of modules (enough for a tiled evaluation on all cores)
+std::size_t maxPoolSize() {
+	return std::max(4u, std::thread::hardware_concurrency() * 2);
+}
+
+/// recursively stores a shallow copy of a table and of all tables reachable from it (library tables,
+/// package.loaded, module namespaces...)
+void storeTable(const luabind::object& table, luabind::object& tables, luabind::object& metatables) {
+	// tables can be referenced repeatedly (e.g., _G._G or package.loaded.string)
+	if(luabind::type(tables[table]) != LUA_TNIL)
+		return;
+
+	luabind::object copy = luabind::newtable(table.interpreter());
+	tables[table] = copy;
+
+	for(luabind::raw_iterator i(table), end; i != end; ++i) {
+		const luabind::object value(*i);
+		copy[i.key()] = value;
+
+		if(luabind::type(value) == LUA_TTABLE)
+			storeTable(value, tables, metatables);
+	}
+
+	const luabind::object meta = luabind::getmetatable(table);
+	if(luabind::type(meta) == LUA_TTABLE) {
+		metatables[table] = meta;
+		storeTable(meta, tables, metatables);
+	}
+}
+
+/// stores copies of the global table and of all tables reachable from it in the registry
+void storeGlobals(lua_State* state) {
+	luabind::object tables = luabind::newtable(state);
+	luabind::object metatables = luabind::newtable(state);
+
+	storeTable(luabind::globals(state), tables, metatables);
+
+	luabind::registry(state)[s_tablesKey] = tables;
+	luabind::registry(state)[s_metatablesKey] = metatables;
+}
+
+/// resets the content of a single table to its stored copy
+void restoreTable(lua_State* state, const luabind::object& table, const luabind::object& copy) {
+	// collect the keys added since the snapshot (can't be removed during the iteration)
+	std::vector<luabind::object> added;
+	for(luabind::raw_iterator i(table), end; i != end; ++i)
+		if(luabind::type(copy[i.key()]) == LUA_TNIL)
+			added.push_back(i.key());
+
+	table.push(state);
+
+	for(auto& key : added) {
+		key.push(state);
+		lua_pushnil(state);
+		lua_rawset(state, -3);
+	}
+
+	// and reset all the original values
+	for(luabind::raw_iterator i(copy), end; i != end; ++i) {
+		i.key().push(state);
+		luabind::object(*i).push(state);
+		lua_rawset(state, -3);
+	}
+
+	lua_pop(state, 1);
+}
+
+/// resets the globals, and all tables reachable from them, to the copies stored by storeGlobals(). This removes
+/// globals created by scripts, changes made to library tables (e.g., a replaced string.format), modules loaded
+/// by require() (entries of package.loaded) and metatables set on any of these tables.
+void restoreGlobals(lua_State* state) {
+	const luabind::object tables = luabind::registry(state)[s_tablesKey];
+	const luabind::object metatables = luabind::registry(state)[s_metatablesKey];
+
+	for(luabind::raw_iterator i(tables), end; i != end; ++i) {
+		const luabind::object table = i.key();
+
+		restoreTable(state, table, *i);
+		luabind::setmetatable(table, luabind::object(metatables[table]));
+	}
+}
+
+}  // namespace
+
+StatePool& StatePool::instance() {
+	// intentionally never destroyed - states held by the graph can be released during static destruction
+	static StatePool* s_pool = new StatePool();
+	return *s_pool;
+}
+
+StatePool::StatePool() {
+}
+
+State StatePool::acquire(const Context& context) {
+	std::string key;
+	for(auto& m : context.m_modules)
+		key += m.first + "\n";
+
+	lua_State* raw = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_states.find(key);
+		if(it != m_states.end() && !it->second.empty()) {
+			raw = it->second.back();
+			it->second.pop_back();
+		}
+	}
+
+	// not owned by the pool until fully initialised - a failed initialisation just closes the state
+	State result(raw, nullptr, key);
+
+	// luabind errors refer to the state, which is closed before the error leaves this function - the message is
+	// read while it is still alive
+	try {
+		// no idle state available - create and initialise a new one
+		if(raw == nullptr) {
+			result.m_state = luaL_newstate();
+
+			// connect the state to luabind library
+			luabind::open(result);
+
+			// load all standard Lua libraries
+			luaL_openlibs(result);
+
+			// luabind class info function - allows introspection of luabind classes
+			luabind::bind_class_info(result);
+
+			// add all modules (libraries)
+			for(auto& m : context.m_modules)
+				m.second(result);
+
+			storeGlobals(result);
+		}
+
+		result.m_pool = this;
+
+		// add all variables from the context
+		for(auto& v : context.m_variables)
+			v.init(result);
+	}
+	catch(const luabind::error& err) {
+		throw std::runtime_error(errorMessage(err.state()));
+	}
+
+	return result;
+}
+
+void StatePool::release(const std::string& key, lua_State* state) {
+	// a state in an inconsistent state (e.g., after an error inside a module) is just closed
+	try {
+		lua_settop(state, 0);
+		restoreGlobals(state);
+
+		// release the memory held by the last evaluation
+		lua_gc(state, LUA_GCCOLLECT, 0);
+	}
+	catch(...) {
+		lua_close(state);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		std::vector<lua_State*>& states = m_states[key];
+		if(states.size() < maxPoolSize()) {
+			states.push_back(state);
+			return;
+		}
+	}
+
+	lua_close(state);
+}
+
+std::size_t StatePool::size() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::size_t result = 0;
+	for(auto& s : m_states)
+		result += s.second.size();
+
+	return result;
+}
+
+}  // namespace lua
+}  // namespace possumwood
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "state.h"
+
+namespace possumwood {
+namespace lua {
+
+class Context;
+
+/// A pool of pre-initialised Lua states, to avoid creating a new state (with all the standard libraries and
+/// modules) on each evaluation.
+///
+/// States are pooled by the set of modules of their Context - a state returned by acquire() has the standard
+/// Lua libraries, luabind class info and all modules of the context already loaded, and with the context's
+/// variables injected. When the State instance is destroyed, its globals and all
+/// tables reachable from them (library tables, package.loaded, module tables) are reset to their content just
+/// after the initialisation, removing all injected variables, globals created by scripts, modules loaded via
+/// require() and modifications of the libraries, and the state is returned to the pool.
+///
+/// Each state is used by only one thread at a time, but different states can be used concurrently (e.g., for
+/// tiled evaluation using TBB). math.random is the stock Lua generator - before Lua 5.4, it is the C library
+/// generator shared by all states, so its sequence is not deterministic between concurrently evaluated tiles.
+class StatePool : public boost::noncopyable {
+  public:
+	static StatePool& instance();
+
+	/// Returns an initialised state for a context, either from the pool or newly created. Throws
+	/// std::runtime_error if the initialisation fails.
+	State acquire(const Context& context);
+
+	/// number of idle states in the pool (for all contexts)
+	std::size_t size() const;
+
+  private:
+	StatePool();
+
+	void release(const std::string& key, lua_State* state);
+
+	mutable std::mutex m_mutex;
+	std::map<std::string, std::vector<lua_State*>> m_states;
+
+	friend class State;
+};
+
+}  // namespace lua
+}  // namespace possumwood
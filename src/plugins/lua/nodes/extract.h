@@ -28,7 +28,7 @@ struct Extract {
 			// and push it to the output
 			data.set(params.a_out, value);
 		} catch(const luabind::error& err) {
-			throw std::runtime_error(lua_tostring(err.state(), -1));
+			throw std::runtime_error(possumwood::lua::errorMessage(err.state()));
 		}
 
 		return dependency_graph::State();
@@ -1,16 +1,16 @@
-#include <lualib.h>
 #include <possumwood_sdk/node_implementation.h>
 #include <possumwood_sdk/source_editor.h>
 
 #include <QMenu>
 #include <QPainter>
 #include <QPushButton>
-#include <luabind/class_info.hpp>
 #include <luabind/luabind.hpp>
 #include <memory>
 
+#include "datatypes/chunk_cache.h"
 #include "datatypes/context.h"
 #include "datatypes/state.h"
+#include "datatypes/state_pool.h"
 
 namespace {
 
@@ -251,33 +251,32 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 
 	const std::string& src = data.get(a_src);
 
-	// Create a new lua state
-	possumwood::lua::State state(data.get(a_context));
+	// get an initialised lua state (with standard libraries, luabind class info and all context modules) - acquired
+	// outside of the try block, as a luabind::error refers to the state, which needs to stay alive until its
+	// message is read
+	possumwood::lua::State state = possumwood::lua::StatePool::instance().acquire(data.get(a_context));
 
+	// evaluate our script (parsed only once for each source, and reused on subsequent evaluations)
+	bool err = false;
+	std::string errstr;
 	try {
-		// load all standard Lua libraries
-		luaL_openlibs(state);
-
-		// luabind class info function - allows introspection of luabind classes
-		luabind::bind_class_info(state);
-
-		// evaluate our script
-		int err = luaL_dostring(state, src.c_str());
-
-		std::string errstr;
-		if(err)
-			errstr = lua_tostring(state, -1);
-
-		// and return the resulting state
-		data.set(a_state, std::move(state));
-
-		if(err)
-			throw std::runtime_error(errstr);
+		possumwood::lua::ChunkCache::instance().run(state, src);
+	}
+	catch(const std::runtime_error& e) {
+		err = true;
+		errstr = e.what();
 	}
-	catch(const luabind::error& err) {
-		throw std::runtime_error(lua_tostring(err.state(), -1));
+	catch(const luabind::error& e) {
+		err = true;
+		errstr = possumwood::lua::errorMessage(e.state());
 	}
 
+	// and return the resulting state
+	data.set(a_state, std::move(state));
+
+	if(err)
+		throw std::runtime_error(errstr);
+
 	return result;
 }
 
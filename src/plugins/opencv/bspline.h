@@ -13,15 +13,33 @@ class BSpline {
 	BSpline(unsigned subdiv, const std::array<double, DEGREE>& min = initArray(0.0),
 	        const std::array<double, DEGREE>& max = initArray(1.0));
 
+	/// adds a single sample - not thread-safe (use addSamples() for parallel fitting)
 	void addSample(const std::array<double, DEGREE>& coords, double value);
 	double sample(const std::array<double, DEGREE>& coords) const;
 
+	/// Adds a set of samples in parallel. The sample functor is called as fn(index, coords, value) for indices in
+	/// 0..count-1, filling in coords and value, and returning false if the sample should be skipped. Samples are
+	/// binned by tiles of control cells, and tiles that don't share any control points are accumulated
+	/// concurrently, avoiding any shared writes. The result does not depend on the number of threads.
+	template <typename FN>
+	void addSamples(std::size_t count, const FN& fn);
+
+	/// Evaluates a 2D spline on a regular grid spanning min..max in both dimensions (i.e., sample(x / (width-1),
+	/// y / (height-1)) for the default range), adding the result to a row-major array of width * height values.
+	/// Uses a separable tensor-product evaluation, with basis weights precomputed per row and per column.
+	void addGrid(std::size_t width, std::size_t height, double* result) const;
+
 	bool operator==(const BSpline& b) const;
 	bool operator!=(const BSpline& b) const;
 
   private:
 	static double B(double t, unsigned k);
 
+	/// computes the control cell offset and the local coordinates inside the cell (throws on out-of-range coords)
+	inline void locate(const std::array<double, DEGREE>& coords,
+	                   std::array<unsigned, DEGREE>& offset,
+	                   std::array<double, DEGREE>& local) const;
+
 	template <typename FN>
 	inline void visit(const std::array<double, DEGREE>& coords, const FN& fn) const;
 	static std::array<double, DEGREE> initArray(double val);
@@ -1,4 +1,8 @@
+#include <tbb/parallel_for.h>
+
+#include <limits>
 #include <opencv2/opencv.hpp>
+#include <sstream>
 
 #include "bspline.h"
 
@@ -50,10 +54,10 @@ BSpline<DEGREE>::BSpline(unsigned subdiv, const std::array<double, DEGREE>& min,
 }
 
 template <unsigned DEGREE>
-template <typename FN>
-void BSpline<DEGREE>::visit(const std::array<double, DEGREE>& _coords, const FN& fn) const {
-	std::array<double, DEGREE> coords = _coords;
-	std::array<unsigned, DEGREE> offset;
+void BSpline<DEGREE>::locate(const std::array<double, DEGREE>& _coords,
+                             std::array<unsigned, DEGREE>& offset,
+                             std::array<double, DEGREE>& coords) const {
+	coords = _coords;
 
 	for(unsigned d = 0; d < DEGREE; ++d) {
 		coords[d] = (coords[d] - m_min[d]) / (m_max[d] - m_min[d]);
@@ -72,6 +76,14 @@ void BSpline<DEGREE>::visit(const std::array<double, DEGREE>& _coords, const FN&
 		offset[d] = rounded;
 		coords[d] = coords[d] - rounded;
 	}
+}
+
+template <unsigned DEGREE>
+template <typename FN>
+void BSpline<DEGREE>::visit(const std::array<double, DEGREE>& _coords, const FN& fn) const {
+	std::array<double, DEGREE> coords;
+	std::array<unsigned, DEGREE> offset;
+	locate(_coords, offset, coords);
 
 	const unsigned end = pow(4, DEGREE);
 	for(unsigned i = 0; i < end; ++i) {
@@ -81,7 +93,7 @@ void BSpline<DEGREE>::visit(const std::array<double, DEGREE>& _coords, const FN&
 
 		for(unsigned d = 0; d < DEGREE; ++d) {
 			weight *= B(coords[d], j % 4);
-			index = index * m_subdiv + j % 4 + offset[d];
+			index = index * (m_subdiv + 3) + j % 4 + offset[d];
 
 			j /= 4;
 		}
@@ -110,6 +122,139 @@ double BSpline<DEGREE>::sample(const std::array<double, DEGREE>& coords) const {
 	return result;
 }
 
+template <unsigned DEGREE>
+template <typename FN>
+void BSpline<DEGREE>::addSamples(std::size_t count, const FN& fn) {
+	// tiles of control cells along the first (up to) two dimensions - each sample writes to 4 control points per
+	// dimension starting at its cell offset, so tiles of 4 cells with the same parity in each dimension don't share
+	// any control points
+	const unsigned tileSize = 4;
+	const unsigned tiledDims = std::min(DEGREE, 2u);
+	const std::size_t tileCount = (m_subdiv + tileSize - 1) / tileSize;
+
+	const std::array<std::size_t, 2> tiles{{tileCount, tiledDims > 1 ? tileCount : 1}};
+	auto tileIndex = [&](const std::array<unsigned, DEGREE>& offset) {
+		return (offset[0] / tileSize) * tiles[1] + (tiledDims > 1 ? offset[tiledDims - 1] / tileSize : 0);
+	};
+
+	// bin the samples by their tile (sample indices in each bin stay sorted, making the result deterministic)
+	if(count >= std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("Too many samples for a single B-spline fit.");
+
+	const uint32_t noTile = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> sampleTiles(count);
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count), [&](const tbb::blocked_range<std::size_t>& range) {
+		std::array<double, DEGREE> coords, local;
+		std::array<unsigned, DEGREE> offset;
+		double value = 0.0;
+
+		for(std::size_t i = range.begin(); i != range.end(); ++i) {
+			if(fn(i, coords, value)) {
+				locate(coords, offset, local);
+				sampleTiles[i] = tileIndex(offset);
+			}
+			else
+				sampleTiles[i] = noTile;
+		}
+	});
+
+	std::vector<std::size_t> binStart(tiles[0] * tiles[1] + 1, 0);
+	for(auto& t : sampleTiles)
+		if(t != noTile)
+			++binStart[t + 1];
+	for(std::size_t t = 1; t < binStart.size(); ++t)
+		binStart[t] += binStart[t - 1];
+
+	std::vector<uint32_t> bins(binStart.back());
+	{
+		std::vector<std::size_t> pos(binStart.begin(), binStart.end() - 1);
+		for(std::size_t i = 0; i < count; ++i)
+			if(sampleTiles[i] != noTile)
+				bins[pos[sampleTiles[i]]++] = i;
+	}
+
+	// accumulate each group of independent tiles in parallel
+	for(std::size_t parity = 0; parity < 4; ++parity)
+		tbb::parallel_for(std::size_t(0), tiles[0] * tiles[1], [&](std::size_t tile) {
+			if((tile / tiles[1]) % 2 + ((tile % tiles[1]) % 2) * 2 != parity)
+				return;
+
+			std::array<double, DEGREE> coords;
+			double value = 0.0;
+
+			for(std::size_t b = binStart[tile]; b < binStart[tile + 1]; ++b) {
+				fn(bins[b], coords, value);
+
+				visit(coords, [&](unsigned index, double weight) {
+					m_controls[index].first += weight * value;
+					m_controls[index].second += weight;
+				});
+			}
+		});
+}
+
+template <unsigned DEGREE>
+void BSpline<DEGREE>::addGrid(std::size_t width, std::size_t height, double* result) const {
+	static_assert(DEGREE == 2, "Grid evaluation is only supported for 2D splines");
+
+	const std::size_t stride = m_subdiv + 3;
+
+	// normalized control point values
+	std::vector<double> controls(m_controls.size());
+	for(std::size_t i = 0; i < controls.size(); ++i)
+		if(m_controls[i].second > 0.0)
+			controls[i] = m_controls[i].first / m_controls[i].second;
+
+	// cell offsets and basis weights of each column / row
+	struct Weights {
+		unsigned offset;
+		std::array<double, 4> weights;
+	};
+
+	auto makeWeights = [&](std::size_t count, unsigned dim) {
+		std::vector<Weights> result(count);
+		for(std::size_t i = 0; i < count; ++i) {
+			std::array<double, DEGREE> coords = m_min, local;
+			coords[dim] = count > 1 ? (double)i / (double)(count - 1) * (m_max[dim] - m_min[dim]) + m_min[dim]
+			                        : m_min[dim];
+			coords[dim] = std::min(coords[dim], m_max[dim]);
+
+			std::array<unsigned, DEGREE> offset;
+			locate(coords, offset, local);
+
+			result[i].offset = offset[dim];
+			for(unsigned k = 0; k < 4; ++k)
+				result[i].weights[k] = B(local[dim], k);
+		}
+		return result;
+	};
+
+	const std::vector<Weights> columns = makeWeights(width, 0);
+	const std::vector<Weights> rows = makeWeights(height, 1);
+
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, height), [&](const tbb::blocked_range<std::size_t>& range) {
+		// controls interpolated along the Y axis for the current row
+		std::vector<double> row(stride);
+
+		for(std::size_t y = range.begin(); y != range.end(); ++y) {
+			const Weights& wy = rows[y];
+
+			for(std::size_t cx = 0; cx < stride; ++cx) {
+				const double* c = &controls[cx * stride + wy.offset];
+				row[cx] = c[0] * wy.weights[0] + c[1] * wy.weights[1] + c[2] * wy.weights[2] + c[3] * wy.weights[3];
+			}
+
+			double* target = result + y * width;
+			for(std::size_t x = 0; x < width; ++x) {
+				const Weights& wx = columns[x];
+				const double* r = &row[wx.offset];
+
+				target[x] += r[0] * wx.weights[0] + r[1] * wx.weights[1] + r[2] * wx.weights[2] + r[3] * wx.weights[3];
+			}
+		}
+	});
+}
+
 template <unsigned DEGREE>
 bool BSpline<DEGREE>::operator==(const BSpline& b) const {
 	return m_subdiv == b.m_subdiv && m_controls == b.m_controls && m_min == b.m_min && m_max == b.m_max;
@@ -25,5 +25,12 @@ double BSplineHierarchy::sample(double x, double y) const {
 	return result;
 }
 
+std::vector<double> BSplineHierarchy::sample(std::size_t width, std::size_t height) const {
+	std::vector<double> result(width * height, 0.0);
+	for(auto& l : m_levels)
+		l.addGrid(width, height, result.data());
+	return result;
+}
+
 }  // namespace opencv
 }  // namespace possumwood
@@ -13,6 +13,10 @@ class BSplineHierarchy {
 
 	double sample(double x, double y) const;
 
+	/// evaluates the hierarchy on a regular grid spanning 0..1 in both dimensions (i.e., sample(x / (width-1),
+	/// y / (height-1))), returning a row-major array of width * height values
+	std::vector<double> sample(std::size_t width, std::size_t height) const;
+
   private:
 	std::vector<BSpline<2>> m_levels;
 };
@@ -0,0 +1,39 @@
+#include <possumwood_sdk/file_writer.h>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame.h"
+#include "sequence.h"
+
+namespace possumwood {
+namespace opencv {
+
+namespace {
+
+void writeImage(const boost::filesystem::path& path, const cv::Mat& mat) {
+	if(mat.empty())
+		throw std::runtime_error("Cannot write an empty image to " + path.string());
+
+	if(!cv::imwrite(path.string(), mat))
+		throw std::runtime_error("Error writing image " + path.string());
+}
+
+FileWriter<Frame> s_frameWriter([](const boost::filesystem::path& path, const Frame& frame) {
+	writeImage(path, *frame);
+});
+
+// each frame of a sequence is written into a separate file, with its index appended to the filename
+FileWriter<Sequence> s_sequenceWriter([](const boost::filesystem::path& path, const Sequence& sequence) {
+	for(auto& frame : sequence) {
+		boost::filesystem::path framePath = path.parent_path() / path.stem();
+		framePath += "_" + std::to_string(frame.first.x) + "_" + std::to_string(frame.first.y);
+		framePath += path.extension();
+
+		writeImage(framePath, frame.second);
+	}
+});
+
+}  // namespace
+
+}  // namespace opencv
+}  // namespace possumwood
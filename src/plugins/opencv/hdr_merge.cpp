@@ -0,0 +1,155 @@
+#include "hdr_merge.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <cfloat>
+#include <cmath>
+
+#include "tools.h"
+
+namespace possumwood {
+namespace opencv {
+
+namespace {
+
+// number of values of an 8-bit input image
+const int s_ldrSize = 256;
+
+/// hat function weights, same as used by cv::MergeDebevec
+float debevecWeight(int z) {
+	return z < s_ldrSize / 2 ? (float)z + 1.0f : (float)(s_ldrSize - z);
+}
+
+/// gaussian-like weights, same as used by cv::MergeRobertson
+float robertsonWeight(int z) {
+	const float q = (float)(s_ldrSize - 1) / 4.0f;
+	const float e4 = std::exp(4.0f);
+	const float scale = e4 / (e4 - 1.0f);
+	const float shift = 1.0f / (1.0f - e4);
+
+	const float value = (float)z / q - 2.0f;
+	return scale * std::exp(-value * value) + shift;
+}
+
+}  // namespace
+
+HDRMerge::HDRMerge(const CameraResponse& response, Method method)
+    : m_method(method), m_channels(response.matrix().channels()), m_exposureCount(response.exposures().size()) {
+	const cv::Mat& curve = response.matrix();
+
+	if(curve.empty())
+		throw std::runtime_error("Camera response curve is empty - please calibrate it first.");
+	if(curve.depth() != CV_32F || curve.total() != (std::size_t)s_ldrSize || !curve.isContinuous())
+		throw std::runtime_error("Camera response curve should be a continuous 32-bit float table with " +
+		                         std::to_string(s_ldrSize) + " rows, " + type2str(curve.type()) + " with " +
+		                         std::to_string(curve.total()) + " elements found instead.");
+
+	const float* values = curve.ptr<float>();
+
+	m_values.resize(m_exposureCount * s_ldrSize * m_channels);
+	m_weights.resize(m_exposureCount * s_ldrSize * m_channels);
+
+	for(std::size_t e = 0; e < m_exposureCount; ++e) {
+		const float time = response.exposures()[e];
+
+		for(int z = 0; z < s_ldrSize; ++z)
+			for(int c = 0; c < m_channels; ++c) {
+				const std::size_t index = (e * s_ldrSize + z) * m_channels + c;
+				const float value = values[z * m_channels + c];
+
+				if(m_method == kDebevec) {
+					// log-radiance, with weight shared between channels (each channel contributes its average)
+					m_values[index] = std::log(value) - std::log(time);
+					m_weights[index] = debevecWeight(z) / (float)m_channels;
+				}
+				else {
+					// radiance estimate numerator and denominator terms, per channel
+					m_values[index] = time * robertsonWeight(z) * value;
+					m_weights[index] = time * time * robertsonWeight(z);
+				}
+			}
+	}
+}
+
+std::size_t HDRMerge::exposureCount() const {
+	return m_exposureCount;
+}
+
+cv::Mat HDRMerge::process(const std::vector<cv::Mat>& brackets) const {
+	if(brackets.size() != m_exposureCount)
+		throw std::runtime_error("Bracket count (" + std::to_string(brackets.size()) +
+		                         ") and camera response exposure count (" + std::to_string(m_exposureCount) +
+		                         ") need to match!");
+
+	if(brackets.empty())
+		return cv::Mat();
+
+	for(auto& b : brackets)
+		if(b.type() != CV_MAKETYPE(CV_8U, m_channels) || b.rows != brackets[0].rows || b.cols != brackets[0].cols)
+			throw std::runtime_error("All brackets need to be 8-bit images with " + std::to_string(m_channels) +
+			                         " channels and of the same size, " + type2str(b.type()) + " found.");
+
+	cv::Mat result = cv::Mat::zeros(brackets[0].rows, brackets[0].cols, CV_MAKETYPE(CV_32F, m_channels));
+
+	tbb::parallel_for(tbb::blocked_range<int>(0, result.rows), [&](const tbb::blocked_range<int>& range) {
+		for(int row = range.begin(); row != range.end(); ++row) {
+			if(m_method == kDebevec)
+				mergeDebevec(brackets, row, result.ptr<float>(row));
+			else
+				mergeRobertson(brackets, row, result.ptr<float>(row));
+		}
+	});
+
+	return result;
+}
+
+void HDRMerge::mergeDebevec(const std::vector<cv::Mat>& brackets, int row, float* result) const {
+	const int cols = brackets[0].cols;
+	std::vector<float> weightSum(cols, 0.0f);
+
+	for(std::size_t e = 0; e < m_exposureCount; ++e) {
+		const unsigned char* in = brackets[e].ptr<unsigned char>(row);
+		const float* values = &m_values[e * s_ldrSize * m_channels];
+		const float* weights = &m_weights[e * s_ldrSize * m_channels];
+
+		for(int x = 0; x < cols; ++x) {
+			float w = 0.0f;
+			for(int c = 0; c < m_channels; ++c)
+				w += weights[in[x * m_channels + c] * m_channels + c];
+
+			for(int c = 0; c < m_channels; ++c)
+				result[x * m_channels + c] += w * values[in[x * m_channels + c] * m_channels + c];
+			weightSum[x] += w;
+		}
+	}
+
+	for(int x = 0; x < cols; ++x)
+		for(int c = 0; c < m_channels; ++c)
+			result[x * m_channels + c] = std::exp(result[x * m_channels + c] / weightSum[x]);
+}
+
+void HDRMerge::mergeRobertson(const std::vector<cv::Mat>& brackets, int row, float* result) const {
+	const int cols = brackets[0].cols;
+	std::vector<float> weightSum(cols * m_channels, 0.0f);
+
+	for(std::size_t e = 0; e < m_exposureCount; ++e) {
+		const unsigned char* in = brackets[e].ptr<unsigned char>(row);
+		const float* values = &m_values[e * s_ldrSize * m_channels];
+		const float* weights = &m_weights[e * s_ldrSize * m_channels];
+
+		for(int i = 0; i < cols * m_channels; ++i) {
+			const int index = in[i] * m_channels + i % m_channels;
+
+			result[i] += values[index];
+			weightSum[i] += weights[index];
+		}
+	}
+
+	// epsilon avoids division by zero for pixels clipped in all exposures (zero weight), same as cv::MergeRobertson
+	for(int i = 0; i < cols * m_channels; ++i)
+		result[i] /= weightSum[i] + DBL_EPSILON;
+}
+
+}  // namespace opencv
+}  // namespace possumwood
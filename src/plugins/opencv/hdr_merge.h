@@ -0,0 +1,43 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "camera_response.h"
+
+namespace possumwood {
+namespace opencv {
+
+/// Merging of 8-bit exposure brackets into a 32-bit float radiance map, using a calibrated camera response.
+///
+/// Produces the same results as cv::MergeDebevec and cv::MergeRobertson (up to floating point rounding), but
+/// with the per-exposure response and weight tables computed only once in the constructor - a single instance
+/// can be used to merge any number of bracket sets (e.g., a timelapse sequence) with the same exposures. The
+/// process() method is const and can be called from multiple threads concurrently; each call is parallelised
+/// over tiles of rows.
+class HDRMerge {
+  public:
+	enum Method { kDebevec = 1, kRobertson = 2 };
+
+	HDRMerge(const CameraResponse& response, Method method);
+
+	/// number of brackets expected by process() (determined by the exposures of the camera response)
+	std::size_t exposureCount() const;
+
+	/// merges one set of brackets (in the order of the camera response exposures) into a radiance map
+	cv::Mat process(const std::vector<cv::Mat>& brackets) const;
+
+  private:
+	void mergeDebevec(const std::vector<cv::Mat>& brackets, int row, float* result) const;
+	void mergeRobertson(const std::vector<cv::Mat>& brackets, int row, float* result) const;
+
+	Method m_method;
+	int m_channels;
+	std::size_t m_exposureCount;
+
+	// per-exposure tables, each with 256 * m_channels entries
+	std::vector<float> m_values, m_weights;
+};
+
+}  // namespace opencv
+}  // namespace possumwood
@@ -1,7 +1,11 @@
 #include "lightfield_vignetting.h"
 
+#include <lightfields/future_cache.h>
+#include <lightfields/pattern_lut.h>
 #include <tbb/parallel_for.h>
 
+#include <utility>
+
 #include "bspline.inl"
 
 namespace possumwood {
@@ -19,23 +23,73 @@ LightfieldVignetting::LightfieldVignetting(std::size_t subdiv, const lightfields
 	if(image.rows != pattern.sensorResolution()[1] || image.cols != pattern.sensorResolution()[0])
 		throw std::runtime_error("Pattern and image resolution doesn't match!");
 
-	tbb::parallel_for(0, image.rows, [&](int y) {
-		for(int x = 0; x < image.cols; ++x) {
-			const lightfields::Pattern::Sample& coord = pattern.sample(Imath::V2i{x, y});
+	const std::shared_ptr<const lightfields::PatternLUT> lut = lightfields::PatternLUT::get(pattern);
+
+	m_bspline.addSamples(image.rows * image.cols, [&](std::size_t i, std::array<double, 4>& coords, double& value) {
+		const int x = i % image.cols;
+		const int y = i / image.cols;
+
+		const lightfields::Pattern::Sample coord = lut->sample(x, y);
+
+		const double uv_magnitude_2 = coord.offset[0] * coord.offset[0] + coord.offset[1] * coord.offset[1];
+		if(uv_magnitude_2 >= 1.0)
+			return false;
+
+		const double xf = (double)x / (double)(image.cols - 1);
+		const double yf = (double)y / (double)(image.rows - 1);
+
+		coords = {{xf, yf, coord.offset[0], coord.offset[1]}};
+		value = image.at<float>(y, x);
+
+		return true;
+	});
+}
+
+double LightfieldVignetting::sample(const cv::Vec4f& coord) const {
+	return m_bspline.sample({{coord[0], coord[1], coord[2], coord[3]}});
+}
+
+namespace {
+
+// number of sensor images kept in memory - each is a full-resolution float image
+const std::size_t s_cacheSize = 2;
+
+/// sensor images are cached per vignetting and pattern
+typedef std::pair<BSpline<4>, lightfields::Pattern> CacheKey;
+
+lightfields::FutureCache<CacheKey, cv::Mat> s_cache(s_cacheSize);
+
+cv::Mat evaluate(const BSpline<4>& bspline, const lightfields::PatternLUT& lut) {
+	const int cols = lut.pattern().sensorResolution()[0];
+	const int rows = lut.pattern().sensorResolution()[1];
+
+	cv::Mat result = cv::Mat::zeros(rows, cols, CV_32FC1);
+
+	// the same coordinates as used for fitting the bspline in the constructor
+	tbb::parallel_for(0, rows, [&](int y) {
+		float* out = result.ptr<float>(y);
+
+		for(int x = 0; x < cols; ++x) {
+			const lightfields::Pattern::Sample coord = lut.sample(x, y);
 
 			const double uv_magnitude_2 = coord.offset[0] * coord.offset[0] + coord.offset[1] * coord.offset[1];
 			if(uv_magnitude_2 < 1.0) {
-				const double xf = (double)x / (double)(image.cols - 1);
-				const double yf = (double)y / (double)(image.rows - 1);
+				const double xf = (double)x / (double)(cols - 1);
+				const double yf = (double)y / (double)(rows - 1);
 
-				m_bspline.addSample({{xf, yf, coord.offset[0], coord.offset[1]}}, image.at<float>(y, x));
+				out[x] = bspline.sample({{xf, yf, coord.offset[0], coord.offset[1]}});
 			}
 		}
 	});
+
+	return result;
 }
 
-double LightfieldVignetting::sample(const cv::Vec4f& coord) const {
-	return m_bspline.sample({{coord[0], coord[1], coord[2], coord[3]}});
+}  // namespace
+
+std::shared_ptr<const cv::Mat> LightfieldVignetting::sensorImage(const lightfields::PatternLUT& lut) const {
+	return s_cache.get(CacheKey(m_bspline, lut.pattern()),
+	                   [&]() { return std::make_shared<const cv::Mat>(evaluate(m_bspline, lut)); });
 }
 
 bool LightfieldVignetting::operator==(const LightfieldVignetting& f) const {
@@ -9,6 +9,10 @@
 #include "bspline.h"
 #include "lightfields.h"
 
+namespace lightfields {
+class PatternLUT;
+}
+
 namespace possumwood {
 namespace opencv {
 
@@ -19,6 +23,12 @@ class LightfieldVignetting {
 
 	double sample(const cv::Vec4f& coord) const;
 
+	/// evaluates the vignetting for each pixel of the sensor, using the per-pixel coordinates of a pattern LUT.
+	/// Returns a CV_32FC1 image of sensor resolution; pixels outside of their lens (|uv| >= 1) are set to 0.
+	/// The image is cached for a small number of recently used (vignetting, pattern) pairs, and shared between
+	/// callers (e.g., all raw files of a batch ingest using the same camera).
+	std::shared_ptr<const cv::Mat> sensorImage(const lightfields::PatternLUT& lut) const;
+
 	bool operator==(const LightfieldVignetting& f) const;
 	bool operator!=(const LightfieldVignetting& f) const;
 
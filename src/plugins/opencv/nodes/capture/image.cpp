@@ -5,6 +5,7 @@
 
 #include "frame.h"
 #include "image_loading.h"
+#include "proxy.h"
 
 namespace {
 
@@ -21,7 +22,7 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	auto img = possumwood::opencv::load(filename.filename());
 
 	data.set(a_exif, img.second);
-	data.set(a_frame, possumwood::opencv::Frame(img.first));
+	data.set(a_frame, possumwood::opencv::Frame(possumwood::opencv::proxy(img.first, data.proxyScale())));
 
 	return dependency_graph::State();
 }
@@ -38,6 +39,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_filename, a_exif);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/capture/image", init);
@@ -4,6 +4,7 @@
 #include <tbb/parallel_for.h>
 
 #include "image_loading.h"
+#include "proxy.h"
 #include "sequence.h"
 
 namespace {
@@ -18,7 +19,7 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 
 	tbb::parallel_for(std::size_t(0), filenames.size(), [&](std::size_t i) {
 		auto img = possumwood::opencv::load(filenames[i].toPath());
-		seq(i, 0) = std::move(img.first);
+		seq(i, 0) = possumwood::opencv::proxy(img.first, data.proxyScale());
 	});
 
 	data.set(a_seq, seq);
@@ -36,6 +37,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_filenames, a_seq);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/capture/image_sequence", init);
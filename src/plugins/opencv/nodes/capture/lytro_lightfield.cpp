@@ -1,6 +1,3 @@
-#include <fstream>
-#include <sstream>
-
 #include <boost/filesystem.hpp>
 
 #include <tbb/parallel_for.h>
@@ -54,9 +51,7 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	possumwood::MozaicType mozaic;
 
 	if(!filename.filename().empty() && boost::filesystem::exists(filename.filename())) {
-		std::ifstream file(filename.filename().string(), std::ios::binary);
-		lightfields::Raw raw;
-		file >> raw;
+		const lightfields::Raw raw = lightfields::Raw::fromFile(filename.filename().string());
 
 		lightfields::Bayer bayer(raw.metadata().metadata());
 
@@ -5,6 +5,7 @@
 #include <opencv2/opencv.hpp>
 
 #include "frame.h"
+#include "proxy.h"
 
 namespace {
 
@@ -28,7 +29,7 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	cv::Mat frame;
 	cap >> frame;
 
-	data.set(a_frame, possumwood::opencv::Frame(frame));
+	data.set(a_frame, possumwood::opencv::Frame(possumwood::opencv::proxy(frame, data.proxyScale())));
 
 	return dependency_graph::State();
 }
@@ -45,6 +46,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_offset, a_frame);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/capture/video_frame", init);
@@ -4,6 +4,7 @@
 
 #include <opencv2/opencv.hpp>
 
+#include "proxy.h"
 #include "sequence.h"
 
 namespace {
@@ -32,7 +33,7 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 
 		cap >> frame;
 
-		result(f, 0) = std::move(frame);
+		result(f, 0) = possumwood::opencv::proxy(frame, data.proxyScale());
 	}
 
 	data.set(a_sequence, result);
@@ -54,6 +55,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_count, a_sequence);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/capture/video_sequence", init);
@@ -6,6 +6,7 @@
 #include <opencv2/opencv.hpp>
 
 #include "frame.h"
+#include "proxy.h"
 
 namespace {
 
@@ -55,9 +56,10 @@ template <typename FN>
 dependency_graph::State compute(dependency_graph::Values& data, FN fn, Params& params) {
 	cv::Mat result;
 
-	const cv::Mat kernel =
-	    cv::getStructuringElement(shapeToEnum(data.get(params.a_kernelShape).value()),
-	                              cv::Size(data.get(params.a_kernelSize), data.get(params.a_kernelSize)));
+	const int kernelSize = possumwood::opencv::proxyKernelSize(data.get(params.a_kernelSize), data.proxyScale());
+
+	const cv::Mat kernel = cv::getStructuringElement(shapeToEnum(data.get(params.a_kernelShape).value()),
+	                                                 cv::Size(kernelSize, kernelSize));
 
 	fn(*data.get(params.a_inFrame), result, kernel, cv::Point(-1, -1), data.get(params.a_iterations),
 	   borderToEnum(data.get(params.a_borderType).value()), data.get(params.a_borderValue));
@@ -91,6 +93,7 @@ void init(possumwood::Metadata& meta, FN fn, Params& params) {
 	meta.addInfluence(params.a_kernelSize, params.a_outFrame);
 
 	meta.setCompute([fn, &params](dependency_graph::Values& data) { return compute(data, fn, params); });
+	meta.setBackgroundCompute(true);
 }
 
 static Params s_dilateParams;
@@ -5,6 +5,7 @@
 #include <opencv2/opencv.hpp>
 
 #include "frame.h"
+#include "proxy.h"
 
 namespace {
 
@@ -46,7 +47,13 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	int method = methodToEnum(data.get(a_method).value());
 	int type = typeToEnum(data.get(a_type).value());
 
-	cv::adaptiveThreshold(*data.get(a_inFrame), result, data.get(a_maxVal), method, type, data.get(a_blockSize),
+	// the block size has to be odd and at least 3 - a scaled-down size is clamped (full-resolution
+	// evaluation passes the user value through unchanged)
+	unsigned blockSize = possumwood::opencv::proxyKernelSize(data.get(a_blockSize), data.proxyScale());
+	if(data.proxyScale() < 1.0f)
+		blockSize = std::max(blockSize, 3u);
+
+	cv::adaptiveThreshold(*data.get(a_inFrame), result, data.get(a_maxVal), method, type, blockSize,
 	                      data.get(a_const));
 
 	data.set(a_outFrame, possumwood::opencv::Frame(result));
@@ -76,6 +83,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_blockSize, a_outFrame);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/filter/adaptive_threshold", init);
@@ -5,6 +5,7 @@
 #include <opencv2/opencv.hpp>
 
 #include "frame.h"
+#include "proxy.h"
 
 namespace {
 
@@ -41,7 +42,10 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 
 	int border = borderToEnum(data.get(a_borderType).value());
 
-	cv::GaussianBlur(*data.get(a_inFrame), result, cv::Size(), data.get(a_sigmaX), data.get(a_sigmaY), border);
+	// sigma is in pixels - needs to match the resolution of a proxy input
+	cv::GaussianBlur(*data.get(a_inFrame), result, cv::Size(),
+	                 possumwood::opencv::proxySize(data.get(a_sigmaX), data.proxyScale()),
+	                 possumwood::opencv::proxySize(data.get(a_sigmaY), data.proxyScale()), border);
 
 	data.set(a_outFrame, possumwood::opencv::Frame(result));
 
@@ -64,6 +68,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_borderType, a_outFrame);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/filter/gaussian_blur", init);
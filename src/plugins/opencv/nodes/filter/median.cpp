@@ -4,6 +4,7 @@
 #include <opencv2/opencv.hpp>
 
 #include "frame.h"
+#include "proxy.h"
 
 namespace {
 
@@ -14,7 +15,8 @@ dependency_graph::OutAttr<possumwood::opencv::Frame> a_outFrame;
 dependency_graph::State compute(dependency_graph::Values& data) {
 	cv::Mat result = (*data.get(a_inFrame)).clone();
 
-	cv::medianBlur(*data.get(a_inFrame), result, data.get(a_kernelSize));
+	cv::medianBlur(*data.get(a_inFrame), result,
+	               possumwood::opencv::proxyKernelSize(data.get(a_kernelSize), data.proxyScale()));
 
 	data.set(a_outFrame, possumwood::opencv::Frame(result));
 
@@ -30,6 +32,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_kernelSize, a_outFrame);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/filter/median", init);
@@ -0,0 +1,171 @@
+#include <actions/traits.h>
+#include <possumwood_sdk/datatypes/enum.h>
+#include <possumwood_sdk/node_implementation.h>
+
+#include <opencv2/photo.hpp>
+
+#include <tbb/parallel_for.h>
+
+#include <map>
+
+#include "camera_response.h"
+#include "hdr_merge.h"
+#include "sequence.h"
+#include "tools.h"
+
+namespace {
+
+// Merges and tonemaps a whole sequence of bracket sets (e.g., an HDR timelapse) in one go. Each row of the input
+// sequence (its Y index) is one set of brackets, with the X index determining the order of exposures. The result
+// is a sequence with one tonemapped frame per set, indexed by the set's row.
+//
+// Sets are processed in parallel, each one merged and immediately tonemapped - only the radiance maps of the sets
+// being processed at the same time are kept in memory.
+
+enum Methods { kDebevec = 1, kRobertson = 2, kMertens = 3 };
+enum Tonemaps { kNone = 0, kDrago = 1, kReinhard = 2, kMantiuk = 3 };
+
+dependency_graph::InAttr<possumwood::opencv::Sequence> a_in;
+dependency_graph::InAttr<possumwood::opencv::CameraResponse> a_response;
+dependency_graph::InAttr<possumwood::Enum> a_method, a_tonemap;
+dependency_graph::InAttr<float> a_gamma;
+dependency_graph::InAttr<float> a_dragoBias, a_dragoSaturation;
+dependency_graph::InAttr<float> a_reinhardIntensity, a_reinhardLightAdaptation, a_reinhardColorAdaptation;
+dependency_graph::InAttr<float> a_mantiukScale, a_mantiukSaturation;
+dependency_graph::InAttr<bool> a_8bit;
+dependency_graph::OutAttr<possumwood::opencv::Sequence> a_out;
+
+cv::Ptr<cv::Tonemap> makeTonemap(dependency_graph::Values& data) {
+	switch(data.get(a_tonemap).intValue()) {
+		case kDrago: {
+			cv::Ptr<cv::TonemapDrago> tonemap = cv::createTonemapDrago(data.get(a_gamma));
+			tonemap->setBias(data.get(a_dragoBias));
+			tonemap->setSaturation(data.get(a_dragoSaturation));
+			return tonemap;
+		}
+
+		case kReinhard: {
+			cv::Ptr<cv::TonemapReinhard> tonemap = cv::createTonemapReinhard(data.get(a_gamma));
+			tonemap->setIntensity(data.get(a_reinhardIntensity));
+			tonemap->setLightAdaptation(data.get(a_reinhardLightAdaptation));
+			tonemap->setColorAdaptation(data.get(a_reinhardColorAdaptation));
+			return tonemap;
+		}
+
+		case kMantiuk: {
+			cv::Ptr<cv::TonemapMantiuk> tonemap = cv::createTonemapMantiuk(data.get(a_gamma));
+			tonemap->setScale(data.get(a_mantiukScale));
+			tonemap->setSaturation(data.get(a_mantiukSaturation));
+			return tonemap;
+		}
+
+		default:
+			return cv::Ptr<cv::Tonemap>();
+	}
+}
+
+dependency_graph::State compute(dependency_graph::Values& data) {
+	const possumwood::opencv::Sequence& sequence = data.get(a_in);
+	const int method = data.get(a_method).intValue();
+
+	// collect the bracket sets - doesn't copy, just uses shared references
+	std::map<int, std::vector<cv::Mat>> rows;
+	for(auto& in : sequence)
+		rows[in.first.y].push_back(in.second);
+	const std::vector<std::pair<int, std::vector<cv::Mat>>> sets(rows.begin(), rows.end());
+
+	// response tables are computed once, and shared by all sets
+	std::unique_ptr<possumwood::opencv::HDRMerge> merge;
+	if(method != kMertens && !sets.empty())
+		merge.reset(
+		    new possumwood::opencv::HDRMerge(data.get(a_response), possumwood::opencv::HDRMerge::Method(method)));
+
+	// tonemapper instances are not thread-safe - each set uses its own (they are cheap to create)
+	std::vector<cv::Ptr<cv::Tonemap>> tonemaps;
+	for(std::size_t i = 0; i < sets.size(); ++i)
+		tonemaps.push_back(makeTonemap(data));
+
+	const bool convert8bit = data.get(a_8bit);
+
+	std::vector<cv::Mat> results(sets.size());
+	tbb::parallel_for(std::size_t(0), sets.size(), [&](std::size_t i) {
+		cv::Mat result;
+
+		if(method == kMertens)
+			// exposure fusion produces a displayable result directly, no tonemapping needed
+			cv::createMergeMertens()->process(sets[i].second, result);
+
+		else {
+			result = merge->process(sets[i].second);
+
+			if(!tonemaps[i].empty()) {
+				cv::Mat tonemapped;
+				tonemaps[i]->process(result, tonemapped);
+				result = tonemapped;
+			}
+		}
+
+		if(convert8bit) {
+			cv::Mat converted;
+			result.convertTo(converted, CV_MAKETYPE(CV_8U, result.channels()), 255.0);
+			result = converted;
+		}
+
+		results[i] = result;
+	});
+
+	possumwood::opencv::Sequence out;
+	for(std::size_t i = 0; i < sets.size(); ++i)
+		out(0, sets[i].first) = std::move(results[i]);
+
+	data.set(a_out, out);
+
+	return dependency_graph::State();
+}
+
+void init(possumwood::Metadata& meta) {
+	cv::Ptr<cv::TonemapDrago> drago = cv::createTonemapDrago();
+	cv::Ptr<cv::TonemapReinhard> reinhard = cv::createTonemapReinhard();
+	cv::Ptr<cv::TonemapMantiuk> mantiuk = cv::createTonemapMantiuk();
+
+	meta.addAttribute(a_in, "sequence", possumwood::opencv::Sequence());
+	meta.addAttribute(a_response, "camera_response");
+	meta.addAttribute(a_method, "method",
+	                  possumwood::Enum({std::make_pair("Debevec", kDebevec), std::make_pair("Robertson", kRobertson),
+	                                    std::make_pair("Mertens", kMertens)}));
+	meta.addAttribute(a_tonemap, "tonemap",
+	                  possumwood::Enum({std::make_pair("None", kNone), std::make_pair("Drago", kDrago),
+	                                    std::make_pair("Reinhard", kReinhard), std::make_pair("Mantiuk", kMantiuk)},
+	                                   kReinhard));
+	meta.addAttribute(a_gamma, "tonemap/gamma", reinhard->getGamma());
+	meta.addAttribute(a_dragoBias, "drago/bias", drago->getBias());
+	meta.addAttribute(a_dragoSaturation, "drago/saturation", drago->getSaturation());
+	meta.addAttribute(a_reinhardIntensity, "reinhard/intensity", reinhard->getIntensity());
+	meta.addAttribute(a_reinhardLightAdaptation, "reinhard/light_adaptation", reinhard->getLightAdaptation());
+	meta.addAttribute(a_reinhardColorAdaptation, "reinhard/color_adaptation", reinhard->getColorAdaptation());
+	meta.addAttribute(a_mantiukScale, "mantiuk/scale", mantiuk->getScale());
+	meta.addAttribute(a_mantiukSaturation, "mantiuk/saturation", mantiuk->getSaturation());
+	meta.addAttribute(a_8bit, "8bit_output", true);
+	meta.addAttribute(a_out, "out_sequence", possumwood::opencv::Sequence());
+
+	meta.addInfluence(a_in, a_out);
+	meta.addInfluence(a_response, a_out);
+	meta.addInfluence(a_method, a_out);
+	meta.addInfluence(a_tonemap, a_out);
+	meta.addInfluence(a_gamma, a_out);
+	meta.addInfluence(a_dragoBias, a_out);
+	meta.addInfluence(a_dragoSaturation, a_out);
+	meta.addInfluence(a_reinhardIntensity, a_out);
+	meta.addInfluence(a_reinhardLightAdaptation, a_out);
+	meta.addInfluence(a_reinhardColorAdaptation, a_out);
+	meta.addInfluence(a_mantiukScale, a_out);
+	meta.addInfluence(a_mantiukSaturation, a_out);
+	meta.addInfluence(a_8bit, a_out);
+
+	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
+}
+
+possumwood::NodeImplementation s_impl("opencv/hdr/merge_sequence", init);
+
+}  // namespace
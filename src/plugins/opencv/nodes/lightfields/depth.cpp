@@ -41,6 +41,9 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 
 		if(data.get(a_method).intValue() == 0) {
 			group.run([&samples, &corresp, &out, a, &data, d]() {
+				if(data.isCancelled())
+					return;
+
 				auto tmp = lightfields::nearest::integrate(samples, data.get(a_res), d);
 				corresp(a, 0) = lightfields::nearest::correspondence(samples, tmp, d);
 
@@ -49,6 +52,9 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 		}
 		else {
 			group.run([&samples, &corresp, &out, a, &data, d]() {
+				if(data.isCancelled())
+					return;
+
 				auto tmp = lightfields::gaussian::integrate(samples, data.get(a_res), data.get(a_sigma), d);
 				corresp(a, 0) = lightfields::gaussian::correspondence(samples, tmp, data.get(a_sigma), d);
 
@@ -59,6 +65,10 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 
 	group.wait();
 
+	// inputs changed while evaluating in the background - the result would be thrown away anyway
+	if(data.isCancelled())
+		return dependency_graph::State();
+
 	data.set(a_out, out);
 	data.set(a_corresp, corresp);
 
@@ -93,6 +103,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_sigma, a_out);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/lightfields/depth", init);
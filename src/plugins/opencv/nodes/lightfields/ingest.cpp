@@ -0,0 +1,115 @@
+#include <actions/traits.h>
+#include <lightfields/bayer.h>
+#include <lightfields/metadata.h>
+#include <lightfields/pattern.h>
+#include <lightfields/pattern_lut.h>
+#include <lightfields/raw.h>
+#include <lightfields/samples.h>
+#include <possumwood_sdk/datatypes/filename.h>
+#include <possumwood_sdk/node_implementation.h>
+
+#include <boost/filesystem.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "lightfield_vignetting.h"
+#include "lightfields.h"
+
+namespace {
+
+// Fused equivalent of lytro_lightfield, samples_from_metadata and samples_refocus nodes (with an optional
+// vignetting correction, using the output of vignetting_create evaluated for each sensor pixel), reading a raw
+// file directly into filtered samples without intermediate images.
+
+dependency_graph::InAttr<possumwood::Filename> a_filename;
+dependency_graph::InAttr<possumwood::opencv::LightfieldVignetting> a_vignetting;
+dependency_graph::InAttr<float> a_scaleCompensation;
+dependency_graph::InAttr<bool> a_correctGain;
+dependency_graph::InAttr<float> a_uvOffset, a_uvThreshold, a_xyScale;
+dependency_graph::InAttr<bool> a_persistentLUT;
+dependency_graph::OutAttr<lightfields::Samples> a_samples;
+dependency_graph::OutAttr<lightfields::Metadata> a_metadata;
+dependency_graph::OutAttr<float> a_lensPitch;
+
+dependency_graph::State compute(dependency_graph::Values& data) {
+	const possumwood::Filename filename = data.get(a_filename);
+
+	lightfields::Samples samples;
+	lightfields::Metadata meta;
+	float lensPitch = 0.0f;
+
+	if(!filename.filename().empty() && boost::filesystem::exists(filename.filename())) {
+		const lightfields::Raw raw = lightfields::Raw::fromFile(filename.filename().string());
+
+		// compensate for metadata scale (user parameter)
+		lightfields::Pattern pattern = lightfields::Pattern::fromMetadata(raw.metadata());
+		pattern.scale(data.get(a_scaleCompensation));
+
+		const std::shared_ptr<const lightfields::PatternLUT> lut =
+		    data.get(a_persistentLUT)
+		        ? lightfields::PatternLUT::get(pattern,
+		                                       boost::filesystem::temp_directory_path() / "possumwood_lightfields")
+		        : lightfields::PatternLUT::get(pattern);
+
+		// default (unconnected) vignetting input means no vignetting correction
+		std::shared_ptr<const cv::Mat> vignetting = std::make_shared<const cv::Mat>();
+		if(data.get(a_vignetting) != possumwood::opencv::LightfieldVignetting())
+			vignetting = data.get(a_vignetting).sensorImage(*lut);
+
+		lightfields::Samples::Filter filter;
+		filter.uvOffset = data.get(a_uvOffset);
+		filter.uvThreshold = data.get(a_uvThreshold);
+		filter.xyScale = data.get(a_xyScale);
+
+		samples = lightfields::Samples::fromRaw(
+		    raw, *lut, data.get(a_correctGain) ? lightfields::Bayer::kCorrectGain : lightfields::Bayer::kNone,
+		    *vignetting, filter);
+
+		meta = raw.metadata();
+		lensPitch = pattern.lensPitch();
+	}
+
+	data.set(a_samples, std::move(samples));
+	data.set(a_metadata, meta);
+	data.set(a_lensPitch, lensPitch);
+
+	return dependency_graph::State();
+}
+
+void init(possumwood::Metadata& meta) {
+	meta.addAttribute(a_filename, "filename",
+	                  possumwood::Filename({
+	                      "Lytro files (*.lfr *.RAW)",
+	                  }));
+	meta.addAttribute(a_vignetting, "vignetting", possumwood::opencv::LightfieldVignetting(),
+	                  possumwood::AttrFlags::kVertical);
+	meta.addAttribute(a_scaleCompensation, "scale_compensation", 1.0f);
+	meta.addAttribute(a_correctGain, "correct_gain", true);
+	meta.addAttribute(a_uvOffset, "uv_offset", 0.0f);
+	meta.addAttribute(a_uvThreshold, "uv_threshold", 1.0f);
+	meta.addAttribute(a_xyScale, "xy_scale", 1.0f);
+	meta.addAttribute(a_persistentLUT, "persistent_lut", false);
+	meta.addAttribute(a_samples, "samples", lightfields::Samples(), possumwood::AttrFlags::kVertical);
+	meta.addAttribute(a_metadata, "metadata", lightfields::Metadata(), possumwood::AttrFlags::kVertical);
+	meta.addAttribute(a_lensPitch, "lens_pitch");
+
+	meta.addInfluence(a_filename, a_samples);
+	meta.addInfluence(a_vignetting, a_samples);
+	meta.addInfluence(a_scaleCompensation, a_samples);
+	meta.addInfluence(a_correctGain, a_samples);
+	meta.addInfluence(a_uvOffset, a_samples);
+	meta.addInfluence(a_uvThreshold, a_samples);
+	meta.addInfluence(a_xyScale, a_samples);
+	meta.addInfluence(a_persistentLUT, a_samples);
+
+	meta.addInfluence(a_filename, a_lensPitch);
+	meta.addInfluence(a_scaleCompensation, a_lensPitch);
+
+	meta.addInfluence(a_filename, a_metadata);
+
+	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
+}
+
+possumwood::NodeImplementation s_impl("opencv/lightfields/ingest", init);
+
+}  // namespace
@@ -56,9 +56,11 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 		for(std::size_t a = 0; a < levels; ++a) {
 			auto& spline = splines[c].level(a);
 
-			tbb::parallel_for(std::size_t(0), cache[c].size(), [&](std::size_t a) {
+			spline.addSamples(cache[c].size(), [&](std::size_t a, std::array<double, 2>& coords, double& value) {
 				auto& s = cache[c][a];
-				spline.addSample({{s.target[0], s.target[1]}}, s.value);
+				coords = {{s.target[0], s.target[1]}};
+				value = s.value;
+				return true;
 			});
 
 			if(a < levels - 1)
@@ -70,13 +72,15 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	}
 
 	cv::Mat mat = cv::Mat::zeros(height, width, CV_32FC3);
-	for(int a = 0; a < 3; ++a)
+	for(int a = 0; a < 3; ++a) {
+		// separable evaluation of the whole image
+		const std::vector<double> values = splines[a].sample(width, height);
+
 		tbb::parallel_for(0, mat.rows, [&](int y) {
 			for(int x = 0; x < mat.cols; ++x)
-				// mat.ptr<float>(y,x)[a] = splines[a].level(levels-1).sample(
-				mat.ptr<float>(y, x)[a] =
-				    splines[a].sample((float)x / (float)(mat.cols - 1), (float)y / (float)(mat.rows - 1));
+				mat.ptr<float>(y, x)[a] = values[y * width + x];
 		});
+	}
 
 	data.set(a_out, possumwood::opencv::Frame(mat));
 
@@ -96,6 +100,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_offset, a_out);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/lightfields/integrate_bezier", init);
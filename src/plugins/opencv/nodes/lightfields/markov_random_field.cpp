@@ -12,7 +12,7 @@
 namespace {
 
 dependency_graph::InAttr<possumwood::opencv::Frame> a_in, a_confidence;
-dependency_graph::InAttr<float> a_inputsWeight, a_flatnessWeight, a_smoothnessWeight;
+dependency_graph::InAttr<float> a_inputsWeight, a_flatnessWeight, a_smoothnessWeight, a_truncation;
 dependency_graph::InAttr<unsigned> a_iterationLimit;
 dependency_graph::InAttr<possumwood::Enum> a_method;
 dependency_graph::OutAttr<possumwood::opencv::Frame> a_out;
@@ -29,6 +29,11 @@ const std::vector<std::pair<std::string, int>>& methods() {
 
 		for(auto& m : lightfields::Neighbours::types())
 			s_methods.push_back(std::make_pair("Gaussian PDF propagation, " + m.first, m.second + 40));
+
+		s_methods.push_back(std::make_pair("Loopy belief propagation, truncated linear",
+		                                   60 + lightfields::MRF::kTruncatedLinear));
+		s_methods.push_back(std::make_pair("Loopy belief propagation, truncated quadratic",
+		                                   60 + lightfields::MRF::kTruncatedQuadratic));
 	}
 
 	return s_methods;
@@ -57,20 +62,31 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 		}
 	});
 
-	std::unique_ptr<lightfields::Neighbours> neighbours = lightfields::Neighbours::create(
-	    lightfields::Neighbours::Type(data.get(a_method).intValue() % 20), lightfields::V2i(in.cols, in.rows));
+	const int method = data.get(a_method).intValue();
 
 	cv::Mat result;
-	if(data.get(a_method).intValue() < 20)
-		result = lightfields::MRF::solveICM(mrf, data.get(a_inputsWeight), data.get(a_flatnessWeight),
-		                                    data.get(a_smoothnessWeight), data.get(a_iterationLimit), *neighbours);
-	else if(data.get(a_method).intValue() < 40)
-		result =
-		    lightfields::MRF::solvePropagation(mrf, data.get(a_inputsWeight), data.get(a_flatnessWeight),
-		                                       data.get(a_smoothnessWeight), data.get(a_iterationLimit), *neighbours);
-	else
-		result = lightfields::MRF::solvePDF(mrf, data.get(a_inputsWeight), data.get(a_flatnessWeight),
-		                                    data.get(a_smoothnessWeight), data.get(a_iterationLimit), *neighbours);
+	if(method >= 60)
+		// belief propagation uses the flatness weight for its pairwise term (second derivative can't be represented
+		// as a pairwise term)
+		result = lightfields::MRF::solveBP(mrf, data.get(a_inputsWeight), data.get(a_flatnessWeight),
+		                                   data.get(a_truncation), data.get(a_iterationLimit),
+		                                   lightfields::MRF::Distance(method - 60));
+
+	else {
+		std::unique_ptr<lightfields::Neighbours> neighbours = lightfields::Neighbours::create(
+		    lightfields::Neighbours::Type(method % 20), lightfields::V2i(in.cols, in.rows));
+
+		if(method < 20)
+			result = lightfields::MRF::solveICM(mrf, data.get(a_inputsWeight), data.get(a_flatnessWeight),
+			                                    data.get(a_smoothnessWeight), data.get(a_iterationLimit), *neighbours);
+		else if(method < 40)
+			result = lightfields::MRF::solvePropagation(mrf, data.get(a_inputsWeight), data.get(a_flatnessWeight),
+			                                            data.get(a_smoothnessWeight), data.get(a_iterationLimit),
+			                                            *neighbours);
+		else
+			result = lightfields::MRF::solvePDF(mrf, data.get(a_inputsWeight), data.get(a_flatnessWeight),
+			                                    data.get(a_smoothnessWeight), data.get(a_iterationLimit), *neighbours);
+	}
 
 	data.set(a_out, possumwood::opencv::Frame(result));
 
@@ -83,6 +99,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addAttribute(a_inputsWeight, "weights/inputs", 1.0f);
 	meta.addAttribute(a_flatnessWeight, "weights/flatness", 2.0f);
 	meta.addAttribute(a_smoothnessWeight, "weights/smoothness", 2.0f);
+	meta.addAttribute(a_truncation, "weights/truncation", 20.0f);
 	meta.addAttribute(a_iterationLimit, "iterations_limit", 10u);
 	meta.addAttribute(a_method, "method", possumwood::Enum(methods().begin(), methods().end()));
 	meta.addAttribute(a_out, "out", possumwood::opencv::Frame(), possumwood::AttrFlags::kVertical);
@@ -92,10 +109,12 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_inputsWeight, a_out);
 	meta.addInfluence(a_flatnessWeight, a_out);
 	meta.addInfluence(a_smoothnessWeight, a_out);
+	meta.addInfluence(a_truncation, a_out);
 	meta.addInfluence(a_iterationLimit, a_out);
 	meta.addInfluence(a_method, a_out);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/lightfields/markov_random_field", init);
@@ -1,9 +1,11 @@
 #include <actions/traits.h>
 #include <lightfields/metadata.h>
 #include <lightfields/pattern.h>
+#include <lightfields/pattern_lut.h>
 #include <lightfields/samples.h>
 #include <possumwood_sdk/node_implementation.h>
 
+#include <boost/filesystem.hpp>
 #include <opencv2/opencv.hpp>
 
 #include "frame.h"
@@ -17,6 +19,7 @@ dependency_graph::InAttr<possumwood::opencv::Frame> a_in;
 dependency_graph::InAttr<lightfields::Metadata> a_meta;
 dependency_graph::InAttr<float> a_scaleCompensation;
 dependency_graph::InAttr<bool> a_correctGain;
+dependency_graph::InAttr<bool> a_persistentLUT;
 dependency_graph::OutAttr<lightfields::Samples> a_samples;
 dependency_graph::OutAttr<float> a_lensPitch;
 
@@ -50,8 +53,14 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	const cv::Mat fm = bayer.uint16ToFloatMat(
 	    input, data.get(a_correctGain) ? lightfields::Bayer::kCorrectGain : lightfields::Bayer::kNone);
 
+	// per-pattern lookup table, cached in memory and optionally on disk between sessions
+	const std::shared_ptr<const lightfields::PatternLUT> lut =
+	    data.get(a_persistentLUT)
+	        ? lightfields::PatternLUT::get(pattern, boost::filesystem::temp_directory_path() / "possumwood_lightfields")
+	        : lightfields::PatternLUT::get(pattern);
+
 	// convert the pattern to the samples instance
-	data.set(a_samples, lightfields::Samples::fromPattern(pattern, fm));
+	data.set(a_samples, lightfields::Samples::fromPattern(*lut, fm));
 	data.set(a_lensPitch, pattern.lensPitch());
 
 	return dependency_graph::State();
@@ -62,6 +71,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addAttribute(a_meta, "metadata", lightfields::Metadata(), possumwood::AttrFlags::kVertical);
 	meta.addAttribute(a_scaleCompensation, "scale_compensation", 1.0f);
 	meta.addAttribute(a_correctGain, "correct_gain", true);
+	meta.addAttribute(a_persistentLUT, "persistent_lut", false);
 	meta.addAttribute(a_samples, "samples", lightfields::Samples(), possumwood::AttrFlags::kVertical);
 	meta.addAttribute(a_lensPitch, "lens_pitch");
 
@@ -69,6 +79,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_meta, a_samples);
 	meta.addInfluence(a_scaleCompensation, a_samples);
 	meta.addInfluence(a_correctGain, a_samples);
+	meta.addInfluence(a_persistentLUT, a_samples);
 
 	meta.addInfluence(a_in, a_lensPitch);
 	meta.addInfluence(a_meta, a_lensPitch);
@@ -76,6 +87,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_correctGain, a_lensPitch);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/lightfields/samples_from_metadata", init);
@@ -18,6 +18,7 @@ dependency_graph::InAttr<possumwood::opencv::Frame> a_inFrame;
 dependency_graph::InAttr<unsigned> a_targetPixelCount;
 dependency_graph::InAttr<float> a_spatialBias;
 dependency_graph::InAttr<unsigned> a_iterations;
+dependency_graph::InAttr<float> a_convergence;
 dependency_graph::InAttr<possumwood::Enum> a_filter;
 dependency_graph::OutAttr<possumwood::opencv::Frame> a_outFrame;
 
@@ -56,24 +57,29 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 
 	lightfields::Grid<lightfields::SlicSuperpixels::Label> labels(in.rows, in.cols);
 
-	// make sure labelling happens even with 0 iteration count
-	bool firstStep = true;
-	lightfields::SlicSuperpixels::label(in, labels, pixels, metric);
-
-	for(unsigned i = 0; i < data.get(a_iterations); ++i) {
-		// using the metric instance, label all pixels
-		if(!firstStep)
-			lightfields::SlicSuperpixels::label(in, labels, pixels, metric);
-		else
-			firstStep = false;
-
-		// perform the filtering, if selected
-		if(data.get(a_filter).intValue() == kComponentsEachIteration)
+	// planar copy of the input, shared by all iterations
+	const lightfields::SlicSuperpixels::Image image(in);
+
+	if(data.get(a_filter).intValue() == kComponentsEachIteration) {
+		// filtering needs to happen between labelling and recomputing the centres
+		for(unsigned i = 0; i < data.get(a_iterations); ++i) {
+			lightfields::SlicSuperpixels::label(image, labels, pixels, metric);
 			lightfields::SlicSuperpixels::connectedComponents(labels, pixels);
 
-		// recompute centres as means of all labelled pixels
-		lightfields::SlicSuperpixels::findCenters(in, labels, pixels);
+			// recompute centres as means of all labelled pixels, stop when they don't move anymore
+			if(lightfields::SlicSuperpixels::findCenters(image, labels, pixels) < data.get(a_convergence))
+				break;
+		}
 	}
+	else
+		for(unsigned i = 0; i < data.get(a_iterations); ++i)
+			// label all pixels and recompute the centres in a single pass, stop when they don't move anymore
+			if(lightfields::SlicSuperpixels::iterate(image, labels, pixels, metric) < data.get(a_convergence))
+				break;
+
+	// make sure labelling happens even with 0 iteration count
+	if(data.get(a_iterations) == 0)
+		lightfields::SlicSuperpixels::label(image, labels, pixels, metric);
 
 	// address all disconnected components
 	if(data.get(a_filter).intValue() == kComponentsFinalize)
@@ -95,6 +101,8 @@ void init(possumwood::Metadata& meta) {
 	meta.addAttribute(a_targetPixelCount, "target_pixel_count", 2000u);
 	meta.addAttribute(a_spatialBias, "spatial_bias", 1.0f);
 	meta.addAttribute(a_iterations, "iterations", 10u);
+	// early stopping is opt-in - 0 always runs all iterations
+	meta.addAttribute(a_convergence, "convergence_threshold", 0.0f);
 	meta.addAttribute(a_filter, "filter",
 	                  possumwood::Enum(s_filterMode.begin(), s_filterMode.end(), kComponentsFinalize));
 	meta.addAttribute(a_outFrame, "superpixels", possumwood::opencv::Frame(), possumwood::AttrFlags::kVertical);
@@ -103,9 +111,11 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_targetPixelCount, a_outFrame);
 	meta.addInfluence(a_spatialBias, a_outFrame);
 	meta.addInfluence(a_iterations, a_outFrame);
+	meta.addInfluence(a_convergence, a_outFrame);
 	meta.addInfluence(a_filter, a_outFrame);
 
 	meta.setCompute(compute);
+	meta.setBackgroundCompute(true);
 }
 
 possumwood::NodeImplementation s_impl("opencv/superpixels/slic", init);
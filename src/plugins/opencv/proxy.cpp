@@ -0,0 +1,37 @@
+#include "proxy.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace possumwood {
+namespace opencv {
+
+cv::Mat proxy(const cv::Mat& image, float scale) {
+	if(scale >= 1.0f || image.empty())
+		return image;
+
+	cv::Mat result;
+	cv::resize(image, result, cv::Size(std::max((int)std::round(image.cols * scale), 1),
+	                                   std::max((int)std::round(image.rows * scale), 1)),
+	           0, 0, cv::INTER_AREA);
+
+	return result;
+}
+
+float proxySize(float size, float scale) {
+	return size * std::min(scale, 1.0f);
+}
+
+unsigned proxyKernelSize(unsigned size, float scale) {
+	if(scale >= 1.0f)
+		return size;
+
+	unsigned result = std::max((unsigned)std::round((float)size * scale), 1u);
+	if(size % 2 == 1 && result % 2 == 0)
+		++result;
+
+	return result;
+}
+
+}  // namespace opencv
+}  // namespace possumwood
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace possumwood {
+namespace opencv {
+
+/// Downscales an image to the proxy scale of an evaluation (see dependency_graph::Values::proxyScale()).
+/// Returns the input image unchanged for full-resolution evaluation.
+cv::Mat proxy(const cv::Mat& image, float scale);
+
+/// Scales a size-dependent parameter (in pixels) to match a proxy-resolution input
+float proxySize(float size, float scale);
+/// Scales a kernel size to match a proxy-resolution input. Odd sizes stay odd, and the result is never
+/// smaller than 1.
+unsigned proxyKernelSize(unsigned size, float scale);
+
+}  // namespace opencv
+}  // namespace possumwood
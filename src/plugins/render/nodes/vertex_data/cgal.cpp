@@ -84,21 +84,25 @@ void addPerPointVBO(possumwood::VertexData& vd,
 		             std::size_t index = 0;
 
 		             for(auto& m : mesh) {
-			             // vertex props, handled by polygon-triangle
-			             if(m.vertexProperties().hasProperty(propertyName)) {
-				             auto& vertProp = m.vertexProperties().property<T>(propertyName);
+			             // typed property handles are resolved once per mesh, and then used directly
+			             // for all items
+			             const possumwood::Property<T>* vertProp = m.vertexProperties().handle<T>(propertyName);
+			             const possumwood::Property<T>* faceProp = m.faceProperties().handle<T>(propertyName);
+			             const possumwood::Property<T>* heProp = m.halfedgeProperties().handle<T>(propertyName);
 
+			             // vertex props, handled by polygon-triangle
+			             if(vertProp != nullptr) {
 				             for(auto fit = m.polyhedron().facets_begin(); fit != m.polyhedron().facets_end(); ++fit) {
 					             if(fit->facet_degree() > 2) {
 						             auto it = fit->facet_begin();
 
-						             const auto& val0 = extract(vertProp.get(it->vertex()->property_key()));
+						             const auto& val0 = extract(vertProp->get(it->vertex()->property_key()));
 						             ++it;
 
 						             for(unsigned ctr = 2; ctr < fit->facet_degree(); ++ctr) {
-							             const auto& val1 = extract(vertProp.get(it->vertex()->property_key()));
+							             const auto& val1 = extract(vertProp->get(it->vertex()->property_key()));
 							             ++it;
-							             const auto& val2 = extract(vertProp.get(it->vertex()->property_key()));
+							             const auto& val2 = extract(vertProp->get(it->vertex()->property_key()));
 
 							             buffer.element(index++) = val0;
 							             buffer.element(index++) = val1;
@@ -109,12 +113,10 @@ void addPerPointVBO(possumwood::VertexData& vd,
 			             }
 
 			             // face props, constant for all triangles of a face
-			             else if(m.faceProperties().hasProperty(propertyName)) {
-				             auto& faceProp = m.faceProperties().property<T>(propertyName);
-
+			             else if(faceProp != nullptr) {
 				             for(auto fit = m.polyhedron().facets_begin(); fit != m.polyhedron().facets_end(); ++fit) {
 					             if(fit->facet_degree() > 2) {
-						             auto n = extract(faceProp.get(fit->property_key()));
+						             auto n = extract(faceProp->get(fit->property_key()));
 
 						             for(unsigned i = 2; i < fit->facet_degree(); ++i)
 							             for(unsigned a = 0; a < 3; ++a)
@@ -124,20 +126,18 @@ void addPerPointVBO(possumwood::VertexData& vd,
 			             }
 
 			             // halfedge props
-			             else if(m.halfedgeProperties().hasProperty(propertyName)) {
-				             auto& heProp = m.halfedgeProperties().property<T>(propertyName);
-
+			             else if(heProp != nullptr) {
 				             for(auto fit = m.polyhedron().facets_begin(); fit != m.polyhedron().facets_end(); ++fit) {
 					             if(fit->facet_degree() > 2) {
 						             auto it = fit->facet_begin();
 
-						             const auto& val0 = extract(heProp.get(it->property_key()));
+						             const auto& val0 = extract(heProp->get(it->property_key()));
 						             ++it;
 
 						             for(unsigned ctr = 2; ctr < fit->facet_degree(); ++ctr) {
-							             const auto& val1 = extract(heProp.get(it->property_key()));
+							             const auto& val1 = extract(heProp->get(it->property_key()));
 							             ++it;
-							             const auto& val2 = extract(heProp.get(it->property_key()));
+							             const auto& val2 = extract(heProp->get(it->property_key()));
 
 							             buffer.element(index++) = val0;
 							             buffer.element(index++) = val1;
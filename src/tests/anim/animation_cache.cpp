@@ -0,0 +1,165 @@
+#include <anim/animation_cache.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+/// a temporary directory with a source file, used as the cache directory
+struct CacheFixture {
+	CacheFixture() : dir(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()) {
+		boost::filesystem::create_directories(dir);
+		setenv("POSSUMWOOD_ANIM_CACHE", dir.string().c_str(), 1);
+
+		source = dir / "test.bvh";
+		std::ofstream(source.string()) << "source file content";
+
+		skeleton.addRoot("hips", anim::Transform(Imath::V3f(0, 1, 0)));
+		const std::size_t spine = skeleton.addChild(skeleton[0], anim::Transform(Imath::V3f(0, 2, 0)), "spine");
+		skeleton.addChild(skeleton[0], anim::Transform(Imath::Quatf(0, 1, 0, 0), Imath::V3f(1, 0, 0)), "leg");
+		skeleton.addChild(skeleton[spine], anim::Transform(Imath::V3f(0, 3, 0)), "head");
+
+		skeleton.attributes()["type"] = std::string("asf");
+		skeleton[1].attributes()["dof"] = std::vector<std::string>{"rx", "ry", "rz"};
+
+		anim.setFps(30.0f);
+		for(unsigned f = 0; f < 3; ++f) {
+			anim::Skeleton frame = skeleton;
+			for(unsigned j = 0; j < frame.size(); ++j)
+				frame[j].tr() = anim::Transform(Imath::Quatf(0.5f, 0.5f, -0.5f, 0.5f), Imath::V3f(f, j, 0.25f));
+			anim.addFrame(frame);
+		}
+	}
+
+	~CacheFixture() {
+		unsetenv("POSSUMWOOD_ANIM_CACHE");
+		boost::filesystem::remove_all(dir);
+	}
+
+	boost::filesystem::path dir, source;
+	anim::Skeleton skeleton;
+	anim::Animation anim;
+};
+
+}  // namespace
+
+BOOST_FIXTURE_TEST_CASE(animation_cache_roundtrip, CacheFixture) {
+	BOOST_CHECK_EQUAL(anim::cache::path(source).parent_path(), dir);
+
+	anim::Skeleton skel;
+	anim::Animation result;
+	BOOST_CHECK(!anim::cache::read(source, 0, skel, result));
+
+	anim::cache::write(source, 0, skeleton, anim);
+	BOOST_REQUIRE(anim::cache::read(source, 0, skel, result));
+
+	// the hierarchy, including the attributes
+	BOOST_REQUIRE_EQUAL(skel.size(), skeleton.size());
+	for(unsigned j = 0; j < skel.size(); ++j) {
+		BOOST_CHECK_EQUAL(skel[j].name(), skeleton[j].name());
+		BOOST_CHECK_EQUAL(skel[j].hasParent(), skeleton[j].hasParent());
+		if(skel[j].hasParent())
+			BOOST_CHECK_EQUAL(skel[j].parent().index(), skeleton[j].parent().index());
+		BOOST_CHECK(skel[j].tr() == skeleton[j].tr());
+	}
+
+	BOOST_CHECK_EQUAL(skel.attributes()["type"].as<std::string>(), "asf");
+	BOOST_CHECK(skel[1].attributes()["dof"].as<std::vector<std::string>>() ==
+	            (std::vector<std::string>{"rx", "ry", "rz"}));
+	BOOST_CHECK(skel.isCompatibleWith(skeleton));
+
+	// and the frames
+	BOOST_CHECK_EQUAL(result.fps(), 30.0f);
+	BOOST_REQUIRE_EQUAL(result.size(), anim.size());
+	for(unsigned f = 0; f < result.size(); ++f)
+		for(unsigned j = 0; j < skel.size(); ++j)
+			BOOST_CHECK(result.frame(f)[j].tr() == anim.frame(f)[j].tr());
+}
+
+BOOST_FIXTURE_TEST_CASE(animation_cache_invalidation, CacheFixture) {
+	anim::cache::write(source, 42, skeleton, anim);
+
+	anim::Skeleton skel;
+	anim::Animation result;
+	BOOST_CHECK(anim::cache::read(source, 42, skel, result));
+
+	// different context
+	BOOST_CHECK(!anim::cache::read(source, 43, skel, result));
+
+	// corrupted cache content
+	{
+		std::fstream cache(anim::cache::path(source).string(), std::ios::in | std::ios::out | std::ios::binary);
+		cache.seekp(-3, std::ios::end);
+		cache.put('x');
+	}
+	BOOST_CHECK(!anim::cache::read(source, 42, skel, result));
+
+	// changed source file
+	anim::cache::write(source, 42, skeleton, anim);
+	BOOST_CHECK(anim::cache::read(source, 42, skel, result));
+
+	std::ofstream(source.string(), std::ios::app) << " - modified";
+	BOOST_CHECK(!anim::cache::read(source, 42, skel, result));
+}
+
+BOOST_FIXTURE_TEST_CASE(animation_cache_disabled, CacheFixture) {
+	setenv("POSSUMWOOD_ANIM_CACHE", "", 1);
+	BOOST_CHECK(anim::cache::path(source).empty());
+
+	anim::cache::write(source, 0, skeleton, anim);
+
+	anim::Skeleton skel;
+	anim::Animation result;
+	BOOST_CHECK(!anim::cache::read(source, 0, skel, result));
+}
+
+BOOST_FIXTURE_TEST_CASE(animation_cache_default_directory, CacheFixture) {
+	// without an explicit directory, the cache goes to the user's cache directory, not next to the source
+	unsetenv("POSSUMWOOD_ANIM_CACHE");
+
+	const char* xdgCache = getenv("XDG_CACHE_HOME");
+	const std::string previous = xdgCache != nullptr ? xdgCache : "";
+
+	setenv("XDG_CACHE_HOME", dir.string().c_str(), 1);
+	BOOST_CHECK_EQUAL(anim::cache::path(source).parent_path(), dir / "possumwood" / "anim");
+
+	if(xdgCache != nullptr)
+		setenv("XDG_CACHE_HOME", previous.c_str(), 1);
+	else
+		unsetenv("XDG_CACHE_HOME");
+}
+
+BOOST_FIXTURE_TEST_CASE(animation_cache_skeleton_hash, CacheFixture) {
+	anim::Skeleton other = skeleton;
+	BOOST_CHECK_EQUAL(anim::cache::hash(other), anim::cache::hash(skeleton));
+
+	// only the rest pose is modified, without changing the hierarchy
+	other[2].tr().translation.x = 5.0f;
+	BOOST_CHECK(anim::cache::hash(other) != anim::cache::hash(skeleton));
+}
+
+BOOST_FIXTURE_TEST_CASE(animation_cache_read_frames, CacheFixture) {
+	anim::cache::write(source, 0, skeleton, anim);
+
+	// the frames are poses of the target skeleton, keeping its attributes
+	anim::Skeleton target = skeleton;
+	target.attributes()["type"] = std::string("target");
+
+	anim::Animation result;
+	BOOST_REQUIRE(anim::cache::readFrames(source, 0, target, result));
+
+	BOOST_CHECK_EQUAL(result.fps(), 30.0f);
+	BOOST_REQUIRE_EQUAL(result.size(), anim.size());
+	for(unsigned f = 0; f < result.size(); ++f) {
+		BOOST_CHECK_EQUAL(result.frame(f).attributes()["type"].as<std::string>(), "target");
+		for(unsigned j = 0; j < target.size(); ++j)
+			BOOST_CHECK(result.frame(f)[j].tr() == anim.frame(f)[j].tr());
+	}
+
+	// a skeleton with a different number of joints can't be used
+	anim::Skeleton smaller;
+	smaller.addRoot("hips", anim::Transform());
+	BOOST_CHECK(!anim::cache::readFrames(source, 0, smaller, result));
+}
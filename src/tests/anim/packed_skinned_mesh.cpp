@@ -0,0 +1,122 @@
+#include <anim/datatypes/packed_skinned_mesh.h>
+#include <anim/datatypes/skinned_mesh.h>
+#include <anim/datatypes/skinning_weights.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+anim::SkinnedMesh makeMesh() {
+	anim::SkinnedMesh mesh;
+	mesh.setName("mesh");
+
+	// 6 influences, the two smallest (bones 4 and 1) are dropped when packing
+	anim::Skinning skin;
+	skin.addWeight(3, 4.0f);
+	skin.addWeight(1, 1.0f);
+	skin.addWeight(7, 2.0f);
+	skin.addWeight(4, 0.5f);
+	skin.addWeight(0, 3.0f);
+	skin.addWeight(2, 1.0f);
+	mesh.vertices().add(Imath::V3f(1, 2, 3), skin);
+
+	anim::Skinning single;
+	single.addWeight(5, 2.0f);
+	mesh.vertices().add(Imath::V3f(4, 5, 6), single);
+
+	mesh.vertices().add(Imath::V3f(7, 8, 9));
+
+	mesh.polygons().add(0, 1, 2);
+	mesh.polygons().add(2, 1, 0);
+
+	for(unsigned n = 0; n < 6; ++n)
+		mesh.normals().push_back(Imath::V3f(0, 0, n));
+
+	return mesh;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(packed_skinned_mesh_conversion) {
+	const anim::SkinnedMesh mesh = makeMesh();
+	const anim::PackedSkinnedMesh packed(mesh, 4);
+
+	BOOST_CHECK_EQUAL(packed.name(), "mesh");
+	BOOST_CHECK_EQUAL(packed.vertexCount(), 3u);
+	BOOST_CHECK_EQUAL(packed.polygonCount(), 2u);
+	BOOST_CHECK_EQUAL(packed.maxInfluences(), 4u);
+
+	BOOST_CHECK(packed.indices() == (std::vector<uint32_t>{0, 1, 2, 2, 1, 0}));
+	BOOST_CHECK(packed.normals() == mesh.normals());
+	BOOST_REQUIRE_EQUAL(packed.bones().size(), 12u);
+	BOOST_REQUIRE_EQUAL(packed.weights().size(), 12u);
+
+	// the 4 largest weights, normalized
+	BOOST_CHECK(packed.bones() == (std::vector<uint16_t>{3, 7, 0, 2, 5, 0, 0, 0, 0, 0, 0, 0}));
+	const std::vector<float> weights{0.4f, 0.2f, 0.3f, 0.1f, 1.0f, 0, 0, 0, 0, 0, 0, 0};
+	for(unsigned w = 0; w < weights.size(); ++w)
+		BOOST_CHECK_CLOSE(packed.weights()[w], weights[w], 1e-4f);
+
+	// and back
+	const anim::SkinnedMesh unpacked = packed.unpack();
+
+	BOOST_CHECK_EQUAL(unpacked.name(), "mesh");
+	BOOST_REQUIRE_EQUAL(unpacked.vertices().size(), 3u);
+	BOOST_CHECK_EQUAL(unpacked.vertices()[0].skinning().size(), 4u);
+	BOOST_CHECK_EQUAL(unpacked.vertices()[1].skinning().size(), 1u);
+	BOOST_CHECK(unpacked.vertices()[2].skinning().empty());
+
+	for(unsigned v = 0; v < 3; ++v)
+		BOOST_CHECK(unpacked.vertices()[v].pos() == mesh.vertices()[v].pos());
+
+	BOOST_REQUIRE_EQUAL(unpacked.polygons().size(), 2u);
+	for(unsigned p = 0; p < 2; ++p)
+		BOOST_CHECK(unpacked.polygons()[p] == mesh.polygons()[p]);
+	BOOST_CHECK(unpacked.normals() == mesh.normals());
+
+	// 8 influences keep all the weights
+	const anim::PackedSkinnedMesh packed8(mesh, 8);
+	BOOST_CHECK_EQUAL(packed8.unpack().vertices()[0].skinning().size(), 6u);
+}
+
+BOOST_AUTO_TEST_CASE(packed_skinned_mesh_errors) {
+	anim::SkinnedMesh mesh = makeMesh();
+
+	BOOST_CHECK_THROW(anim::PackedSkinnedMesh(mesh, 3), std::runtime_error);
+
+	// bone index doesn't fit 16 bits
+	anim::Skinning skin;
+	skin.addWeight(70000, 1.0f);
+	mesh.vertices()[1].setSkinning(skin);
+	BOOST_CHECK_THROW(anim::PackedSkinnedMesh(mesh, 4), std::runtime_error);
+
+	// vertex index out of range
+	mesh = makeMesh();
+	mesh.polygons().add(0, 1, 3);
+	BOOST_CHECK_THROW(anim::PackedSkinnedMesh(mesh, 4), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(packed_skinned_mesh_skinning_weights) {
+	const anim::SkinnedMesh mesh = makeMesh();
+	const anim::SkinningWeights weights(anim::PackedSkinnedMesh(mesh, 4));
+
+	BOOST_CHECK_EQUAL(weights.vertexCount(), 3u);
+	BOOST_CHECK_EQUAL(weights.normalCount(), 6u);
+	BOOST_CHECK_EQUAL(weights.boneCount(), 8u);
+
+	// translations only - each skinned vertex moves by the weighted sum of its bones' offsets
+	std::vector<anim::Transform> transforms;
+	for(unsigned b = 0; b < 8; ++b)
+		transforms.push_back(anim::Transform(Imath::V3f(float(b), 0, 0)));
+
+	anim::SkinnedMesh result = mesh;
+	weights.apply(transforms, anim::SkinningWeights::kLinear, result);
+
+	// bones 3, 7, 0 and 2 with weights 0.4, 0.2, 0.3 and 0.1 (the dropped bones 4 and 1 don't contribute)
+	BOOST_CHECK_CLOSE(result.vertices()[0].pos().x, 1.0f + 3.0f * 0.4f + 7.0f * 0.2f + 2.0f * 0.1f, 1e-4f);
+	BOOST_CHECK_CLOSE(result.vertices()[1].pos().x, 4.0f + 5.0f, 1e-4f);
+	BOOST_CHECK_CLOSE(result.vertices()[2].pos().x, 7.0f, 1e-4f);
+
+	// building from the unpacked mesh keeps all influences
+	BOOST_CHECK_EQUAL(anim::SkinningWeights(mesh).boneCount(), 8u);
+}
@@ -0,0 +1,80 @@
+#include <anim/scanner.h>
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+BOOST_AUTO_TEST_CASE(scanner_tokens) {
+	const std::string data = "  HIERARCHY\tROOT  hip\r\n{\n\n  OFFSET 0.0 -1.5 2e3  \n}";
+
+	anim::Scanner scanner(data.c_str(), data.c_str() + data.size());
+
+	BOOST_CHECK(!scanner.eof());
+	BOOST_CHECK_EQUAL(scanner.next(), "HIERARCHY");
+	BOOST_CHECK_EQUAL(scanner.next(), "ROOT");
+	BOOST_CHECK_EQUAL(scanner.next(), "hip");
+	BOOST_CHECK_EQUAL(scanner.next(), "{");
+	BOOST_CHECK_EQUAL(scanner.next(), "OFFSET");
+	BOOST_CHECK_EQUAL(scanner.nextFloat(), 0.0f);
+	BOOST_CHECK_EQUAL(scanner.nextFloat(), -1.5f);
+	BOOST_CHECK_EQUAL(scanner.nextFloat(), 2000.0f);
+	BOOST_CHECK_EQUAL(scanner.next(), "}");
+
+	BOOST_CHECK(scanner.eof());
+	BOOST_CHECK_EQUAL(scanner.next(), "");
+	BOOST_CHECK_THROW(scanner.nextFloat(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(scanner_lines) {
+	const std::string data = "1\n  root 1 2 3 # comment\n\n# only a comment\n   \nlhipjoint 4\n2";
+
+	const std::vector<boost::string_view> lines = anim::Scanner::lines(data.c_str(), data.c_str() + data.size(), '#');
+
+	BOOST_REQUIRE_EQUAL(lines.size(), 4u);
+	BOOST_CHECK_EQUAL(lines[0], "1");
+	BOOST_CHECK_EQUAL(lines[1], "  root 1 2 3 ");
+	BOOST_CHECK_EQUAL(lines[2], "lhipjoint 4");
+	BOOST_CHECK_EQUAL(lines[3], "2");
+
+	// without a comment character, comments are part of the lines
+	BOOST_CHECK_EQUAL(anim::Scanner::lines(data.c_str(), data.c_str() + data.size()).size(), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(scanner_parse_float) {
+	// the result has to match the standard library parsing for all common notations
+	const std::vector<std::string> values = {"0",         "1",      "-1",       "+2.5",     "0.1",
+	                                         "-0.000123", "123.456", "1e-5",    "-3.25E+2", ".5",
+	                                         "5.",        "0.008333", "-179.999", "1234567.891"};
+
+	for(auto& v : values)
+		BOOST_CHECK_EQUAL(anim::parseFloat(v), std::strtof(v.c_str(), nullptr));
+
+	// random values in the usual range of mocap data
+	std::srand(1);
+	for(unsigned a = 0; a < 10000; ++a) {
+		const std::string v = std::to_string((float)(std::rand() % 2000000) / 1000.0f - 1000.0f);
+		BOOST_CHECK_EQUAL(anim::parseFloat(v), std::strtof(v.c_str(), nullptr));
+	}
+
+	// special values via the slow path
+	BOOST_CHECK(std::isinf(anim::parseFloat("inf")));
+
+	// invalid values
+	BOOST_CHECK_THROW(anim::parseFloat(""), std::runtime_error);
+	BOOST_CHECK_THROW(anim::parseFloat("-"), std::runtime_error);
+	BOOST_CHECK_THROW(anim::parseFloat("1.5x"), std::runtime_error);
+	BOOST_CHECK_THROW(anim::parseFloat("1e"), std::runtime_error);
+	BOOST_CHECK_THROW(anim::parseFloat("abc"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(scanner_parse_unsigned) {
+	BOOST_CHECK_EQUAL(anim::parseUnsigned("0"), 0u);
+	BOOST_CHECK_EQUAL(anim::parseUnsigned("120"), 120u);
+	BOOST_CHECK_EQUAL(anim::parseUnsigned("4294967295"), 4294967295u);
+
+	BOOST_CHECK_THROW(anim::parseUnsigned(""), std::runtime_error);
+	BOOST_CHECK_THROW(anim::parseUnsigned("-1"), std::runtime_error);
+	BOOST_CHECK_THROW(anim::parseUnsigned("1.0"), std::runtime_error);
+	BOOST_CHECK_THROW(anim::parseUnsigned("4294967296"), std::runtime_error);
+}
@@ -0,0 +1,222 @@
+#include <anim/datatypes/skinned_mesh.h>
+#include <anim/datatypes/skinning_weights.h>
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+namespace {
+
+Imath::Quatf axisAngle(const Imath::V3f& axis, float angle) {
+	const Imath::V3f v = axis.normalized() * std::sin(angle / 2.0f);
+	return Imath::Quatf(std::cos(angle / 2.0f), v.x, v.y, v.z);
+}
+
+/// a single triangle - one vertex with a single influence, one with two and one without skinning
+anim::SkinnedMesh makeTriangle() {
+	anim::SkinnedMesh mesh;
+
+	anim::Skinning skin0;
+	skin0.addWeight(0, 1.0f);
+	mesh.vertices().add(Imath::V3f(1, 0, 0), skin0);
+
+	// unnormalized weights (0.25 and 0.75 after normalization)
+	anim::Skinning skin1;
+	skin1.addWeight(0, 1.0f);
+	skin1.addWeight(1, 3.0f);
+	mesh.vertices().add(Imath::V3f(0, 1, 0), skin1);
+
+	mesh.vertices().add(Imath::V3f(0, 0, 1));
+
+	mesh.polygons().add(0, 1, 2);
+
+	mesh.normals().push_back(Imath::V3f(0, 0, 1));
+	mesh.normals().push_back(Imath::V3f(0, 1, 0));
+	mesh.normals().push_back(Imath::V3f(1, 0, 0));
+
+	return mesh;
+}
+
+/// applies a rigid transformation to a point
+Imath::V3f transform(const anim::Transform& tr, const Imath::V3f& p) {
+	return tr.translation + p * tr.rotation;
+}
+
+void checkClose(const Imath::V3f& v1, const Imath::V3f& v2) {
+	BOOST_CHECK_SMALL((v1 - v2).length(), 1e-5f);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(skinning_weights_linear) {
+	const anim::SkinnedMesh mesh = makeTriangle();
+
+	const anim::SkinningWeights weights(mesh);
+	BOOST_CHECK_EQUAL(weights.vertexCount(), 3u);
+	BOOST_CHECK_EQUAL(weights.normalCount(), 3u);
+	BOOST_CHECK_EQUAL(weights.boneCount(), 2u);
+
+	const std::vector<anim::Transform> transforms{
+	    anim::Transform(axisAngle(Imath::V3f(0, 0, 1), M_PI / 2.0f), Imath::V3f(1, 2, 3)),
+	    anim::Transform(axisAngle(Imath::V3f(1, 0, 0), M_PI / 4.0f), Imath::V3f(0, -1, 0))};
+
+	anim::SkinnedMesh result = mesh;
+	weights.apply(transforms, anim::SkinningWeights::kLinear, result);
+
+	checkClose(result.vertices()[0].pos(), transform(transforms[0], mesh.vertices()[0].pos()));
+	checkClose(result.vertices()[1].pos(), transform(transforms[0], mesh.vertices()[1].pos()) * 0.25f +
+	                                           transform(transforms[1], mesh.vertices()[1].pos()) * 0.75f);
+	checkClose(result.vertices()[2].pos(), mesh.vertices()[2].pos());
+
+	checkClose(result.normals()[0], mesh.normals()[0] * transforms[0].rotation);
+	checkClose(result.normals()[1], (mesh.normals()[1] * transforms[0].rotation * 0.25f +
+	                                 mesh.normals()[1] * transforms[1].rotation * 0.75f)
+	                                    .normalized());
+	checkClose(result.normals()[2], mesh.normals()[2]);
+}
+
+BOOST_AUTO_TEST_CASE(skinning_weights_dual_quaternion) {
+	const anim::SkinnedMesh mesh = makeTriangle();
+	const anim::SkinningWeights weights(mesh);
+
+	// a single influence is a rigid transformation
+	const Imath::Quatf rotation = axisAngle(Imath::V3f(1, 1, 0), 0.7f);
+	std::vector<anim::Transform> transforms{anim::Transform(rotation, Imath::V3f(1, 2, 3)),
+	                                        anim::Transform(rotation, Imath::V3f(-3, 0, 1))};
+
+	anim::SkinnedMesh result = mesh;
+	weights.apply(transforms, anim::SkinningWeights::kDualQuaternion, result);
+
+	checkClose(result.vertices()[0].pos(), transform(transforms[0], mesh.vertices()[0].pos()));
+	checkClose(result.normals()[0], mesh.normals()[0] * rotation);
+
+	// same rotation on both bones - translations are blended linearly
+	checkClose(result.vertices()[1].pos(), mesh.vertices()[1].pos() * rotation +
+	                                           Imath::V3f(1, 2, 3) * 0.25f + Imath::V3f(-3, 0, 1) * 0.75f);
+	checkClose(result.vertices()[2].pos(), mesh.vertices()[2].pos());
+
+	// a negated quaternion represents the same rotation, and should not change the result
+	transforms[1].rotation = Imath::Quatf(-rotation.r, -rotation.v.x, -rotation.v.y, -rotation.v.z);
+
+	anim::SkinnedMesh negated = mesh;
+	weights.apply(transforms, anim::SkinningWeights::kDualQuaternion, negated);
+
+	for(unsigned v = 0; v < 3; ++v)
+		checkClose(negated.vertices()[v].pos(), result.vertices()[v].pos());
+}
+
+BOOST_AUTO_TEST_CASE(skinning_weights_errors) {
+	const anim::SkinnedMesh mesh = makeTriangle();
+	const anim::SkinningWeights weights(mesh);
+
+	// bone 1 is missing
+	anim::SkinnedMesh result = mesh;
+	BOOST_CHECK_THROW(weights.apply(std::vector<anim::Transform>(1), anim::SkinningWeights::kLinear, result),
+	                  std::runtime_error);
+
+	// different topology
+	anim::SkinnedMesh empty;
+	BOOST_CHECK_THROW(weights.apply(std::vector<anim::Transform>(2), anim::SkinningWeights::kLinear, empty),
+	                  std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(skinning_weights_unlimited_influences) {
+	// 12 influences with bone indices that don't fit 16 bits - all of them are used
+	const std::size_t firstBone = 70000;
+
+	anim::SkinnedMesh mesh;
+
+	anim::Skinning skin;
+	for(std::size_t b = 0; b < 12; ++b)
+		skin.addWeight(firstBone + b, float(b + 1));
+	mesh.vertices().add(Imath::V3f(0, 0, 0), skin);
+
+	const std::shared_ptr<const anim::SkinningWeights> weights = mesh.skinningWeights();
+	BOOST_CHECK_EQUAL(weights->vertexCount(), 1u);
+	BOOST_CHECK_EQUAL(weights->boneCount(), firstBone + 12);
+
+	// translations only - the vertex moves by the weighted average of its bones' offsets
+	std::vector<anim::Transform> transforms(firstBone + 12);
+	float expected = 0.0f;
+	for(std::size_t b = 0; b < 12; ++b) {
+		transforms[firstBone + b] = anim::Transform(Imath::V3f(float(b), 0, 0));
+		expected += float(b) * float(b + 1) / 78.0f;
+	}
+
+	anim::SkinnedMesh result = mesh;
+	weights->apply(transforms, anim::SkinningWeights::kLinear, result);
+
+	checkClose(result.vertices()[0].pos(), Imath::V3f(expected, 0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(skinning_weights_cache) {
+	anim::SkinnedMesh mesh = makeTriangle();
+
+	const anim::SkinnedMesh& constMesh = mesh;
+	const std::shared_ptr<const anim::SkinningWeights> weights = constMesh.skinningWeights();
+	BOOST_CHECK_EQUAL(constMesh.skinningWeights(), weights);
+
+	// copies share the cached data
+	const anim::SkinnedMesh copy = mesh;
+	BOOST_CHECK_EQUAL(copy.skinningWeights(), weights);
+
+	// non-const access invalidates the cache
+	mesh.vertices()[0].setPos(Imath::V3f(5, 0, 0));
+	BOOST_CHECK(constMesh.skinningWeights() != weights);
+	BOOST_CHECK_EQUAL(copy.skinningWeights(), weights);
+}
+
+BOOST_AUTO_TEST_CASE(skinning_weights_posed_copy) {
+	const anim::SkinnedMesh mesh = makeTriangle();
+
+	// a posed copy shares the skinning and polygons of the rest mesh
+	anim::SkinnedMesh posed = mesh;
+	mesh.skinningWeights()->apply(std::vector<anim::Transform>(2, anim::Transform(Imath::V3f(0, 1, 0))),
+	                              anim::SkinningWeights::kLinear, posed);
+
+	const anim::SkinnedMesh& constPosed = posed;
+	for(unsigned v = 0; v < 2; ++v)
+		BOOST_CHECK_EQUAL(&*constPosed.vertices()[v].skinning().begin(), &*mesh.vertices()[v].skinning().begin());
+	BOOST_CHECK_EQUAL(&constPosed.polygons()[0], &mesh.polygons()[0]);
+
+	checkClose(posed.vertices()[0].pos(), mesh.vertices()[0].pos() + Imath::V3f(0, 1, 0));
+
+	// modifying the copy doesn't change the original
+	anim::Skinning skin = posed.vertices()[1].skinning();
+	skin.addWeight(2, 1.0f);
+	posed.vertices()[1].setSkinning(skin);
+	posed.polygons()[0][0] = 2;
+
+	BOOST_CHECK_EQUAL(mesh.vertices()[1].skinning().size(), 2u);
+	BOOST_CHECK_EQUAL(posed.vertices()[1].skinning().size(), 3u);
+	BOOST_CHECK_EQUAL(mesh.polygons()[0][0], 0u);
+	BOOST_CHECK_EQUAL(posed.polygons()[0][0], 2u);
+
+	// copies of the weights are independent as well
+	anim::Skinning limited = mesh.vertices()[1].skinning();
+	limited.limitInfluenceCount(1);
+	BOOST_CHECK_EQUAL(limited.size(), 1u);
+	BOOST_CHECK_EQUAL(mesh.vertices()[1].skinning().size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(skinning_limit_influences) {
+	// 6 influences, the two smallest (bones 4 and 1) are dropped
+	anim::Skinning skin;
+	skin.addWeight(3, 4.0f);
+	skin.addWeight(1, 1.0f);
+	skin.addWeight(7, 2.0f);
+	skin.addWeight(4, 0.5f);
+	skin.addWeight(0, 3.0f);
+	skin.addWeight(2, 1.0f);
+
+	skin.limitInfluenceCount(4);
+	BOOST_REQUIRE_EQUAL(skin.size(), 4u);
+
+	// the order of the remaining weights is kept, and they are normalized
+	const std::vector<std::pair<std::size_t, float>> expected{{3, 0.4f}, {7, 0.2f}, {0, 0.3f}, {2, 0.1f}};
+	auto it = skin.begin();
+	for(auto& e : expected) {
+		BOOST_CHECK_EQUAL(it->bone, e.first);
+		BOOST_CHECK_CLOSE(it->weight, e.second, 1e-4f);
+		++it;
+	}
+}
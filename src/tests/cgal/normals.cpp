@@ -0,0 +1,209 @@
+#include <cgal/adjacency.h>
+#include <cgal/builder.h>
+#include <cgal/normals.h>
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+using namespace possumwood;
+
+namespace {
+
+/// vertex index is x + 2y + 4z
+const std::vector<std::array<float, 3>> s_cubePoints{{{0, 0, 0}}, {{1, 0, 0}}, {{0, 1, 0}}, {{1, 1, 0}},
+                                                     {{0, 0, 1}}, {{1, 0, 1}}, {{0, 1, 1}}, {{1, 1, 1}}};
+
+/// outward-facing quads, in the order -z, +z, -y, +y, -x, +x
+const std::vector<std::vector<std::size_t>> s_cubeFaces{{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+                                                        {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+
+const std::vector<normals::Normal> s_cubeFaceNormals{{{0, 0, -1}}, {{0, 0, 1}},  {{0, -1, 0}},
+                                                     {{0, 1, 0}},  {{-1, 0, 0}}, {{1, 0, 0}}};
+
+Mesh makeCube(const std::array<float, 3>& scale = std::array<float, 3>{{1, 1, 1}}) {
+	Mesh result("cube");
+
+	std::vector<std::array<float, 3>> points = s_cubePoints;
+	for(auto& p : points)
+		for(unsigned a = 0; a < 3; ++a)
+			p[a] *= scale[a];
+
+	CGALBuilder<CGALPolyhedron::HalfedgeDS, std::vector<std::array<float, 3>>, std::vector<std::vector<std::size_t>>>
+	    builder(&points, &s_cubeFaces);
+	result.edit().polyhedron().delegate(builder);
+
+	return result;
+}
+
+/// normal of a cube's corner vertex, pointing away from its center
+normals::Normal cornerNormal(std::size_t vertex) {
+	const float len = std::sqrt(3.0f);
+	const auto& p = s_cubePoints[vertex];
+
+	return normals::Normal{{(p[0] * 2.0f - 1.0f) / len, (p[1] * 2.0f - 1.0f) / len, (p[2] * 2.0f - 1.0f) / len}};
+}
+
+void checkClose(const normals::Normal& n1, const normals::Normal& n2) {
+	for(unsigned a = 0; a < 3; ++a)
+		BOOST_CHECK_SMALL(n1[a] - n2[a], 1e-5f);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(cgal_adjacency) {
+	const Mesh cube = makeCube();
+	const std::shared_ptr<const MeshAdjacency> adj = cube.adjacency();
+
+	BOOST_REQUIRE_EQUAL(adj->vertexCount(), 8u);
+	BOOST_REQUIRE_EQUAL(adj->faceCount(), 6u);
+	BOOST_REQUIRE_EQUAL(adj->cornerCount(), 24u);
+
+	// vertices and faces follow the polyhedron iteration (i.e., insertion) order
+	for(std::size_t v = 0; v < 8; ++v)
+		BOOST_CHECK(adj->positions()[v] == s_cubePoints[v]);
+
+	for(std::size_t f = 0; f < 6; ++f) {
+		BOOST_REQUIRE_EQUAL(adj->faceEnd(f) - adj->faceBegin(f), 4u);
+
+		for(std::size_t c = adj->faceBegin(f); c != adj->faceEnd(f); ++c) {
+			BOOST_CHECK_EQUAL(adj->cornerFace(c), f);
+			BOOST_CHECK_EQUAL(adj->cornerNext(adj->cornerPrev(c)), c);
+			BOOST_CHECK_EQUAL(adj->cornerPrev(adj->cornerNext(c)), c);
+
+			// the face's vertices, in order (starting at any of them)
+			const std::size_t start = adj->cornerVertex(adj->faceBegin(f));
+			const std::size_t offset =
+			    std::find(s_cubeFaces[f].begin(), s_cubeFaces[f].end(), start) - s_cubeFaces[f].begin();
+			BOOST_REQUIRE(offset < 4);
+			BOOST_CHECK_EQUAL(adj->cornerVertex(c), s_cubeFaces[f][(offset + c - adj->faceBegin(f)) % 4]);
+		}
+	}
+
+	// each vertex of a cube is shared by 3 faces
+	for(std::size_t v = 0; v < 8; ++v) {
+		BOOST_REQUIRE_EQUAL(adj->vertexEnd(v) - adj->vertexBegin(v), 3u);
+		for(std::size_t i = adj->vertexBegin(v); i != adj->vertexEnd(v); ++i)
+			BOOST_CHECK_EQUAL(adj->cornerVertex(adj->vertexCorner(i)), v);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(cgal_adjacency_cache) {
+	Mesh cube = makeCube();
+
+	const std::shared_ptr<const MeshAdjacency> adj = cube.adjacency();
+	BOOST_CHECK_EQUAL(cube.adjacency(), adj);
+
+	// shallow copies share the index
+	const Mesh copy = cube;
+	BOOST_CHECK_EQUAL(copy.adjacency(), adj);
+
+	// editing resets it
+	cube.edit();
+	BOOST_CHECK(cube.adjacency() != adj);
+	BOOST_CHECK_EQUAL(copy.adjacency(), adj);
+}
+
+BOOST_AUTO_TEST_CASE(cgal_face_normals) {
+	const Mesh cube = makeCube();
+	const MeshAdjacency& adj = *cube.adjacency();
+
+	const std::vector<normals::Normal> faceNormals = normals::faceNormals(adj);
+	BOOST_REQUIRE_EQUAL(faceNormals.size(), 6u);
+	for(std::size_t f = 0; f < 6; ++f)
+		checkClose(faceNormals[f], s_cubeFaceNormals[f]);
+
+	// unnormalized normals have a length of twice the face area
+	const std::vector<normals::Normal> unnormalized = normals::faceNormals(adj, false);
+	for(std::size_t f = 0; f < 6; ++f)
+		checkClose(unnormalized[f], normals::Normal{{s_cubeFaceNormals[f][0] * 2.0f, s_cubeFaceNormals[f][1] * 2.0f,
+		                                             s_cubeFaceNormals[f][2] * 2.0f}});
+
+	for(auto& a : normals::cornerAngles(adj))
+		BOOST_CHECK_CLOSE(a, M_PI / 2.0, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(cgal_vertex_normals) {
+	const Mesh cube = makeCube();
+	const MeshAdjacency& adj = *cube.adjacency();
+
+	for(auto weighting : {normals::kUniform, normals::kAreaWeighted, normals::kAngleWeighted}) {
+		const std::vector<normals::Normal> vertexNormals = normals::vertexNormals(adj, weighting);
+		BOOST_REQUIRE_EQUAL(vertexNormals.size(), 8u);
+
+		for(std::size_t v = 0; v < 8; ++v)
+			checkClose(vertexNormals[v], cornerNormal(v));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(cgal_vertex_normals_weighting) {
+	// a box with faces of different areas - the x faces are twice as large as the others
+	const Mesh box = makeCube(std::array<float, 3>{{1, 2, 2}});
+	const MeshAdjacency& adj = *box.adjacency();
+
+	// uniform weighting ignores the face areas (i.e., the same result as CGAL's compute_vertex_normals())
+	const std::vector<normals::Normal> uniform = normals::vertexNormals(adj, normals::kUniform);
+	for(std::size_t v = 0; v < 8; ++v)
+		checkClose(uniform[v], cornerNormal(v));
+
+	// area weighting tilts the normals towards the x axis
+	const std::vector<normals::Normal> area = normals::vertexNormals(adj, normals::kAreaWeighted);
+	for(std::size_t v = 0; v < 8; ++v) {
+		const float scale = std::sqrt(3.0f) / std::sqrt(6.0f);
+		const normals::Normal n = cornerNormal(v);
+
+		checkClose(area[v], normals::Normal{{n[0] * 2.0f * scale, n[1] * scale, n[2] * scale}});
+	}
+}
+
+BOOST_AUTO_TEST_CASE(cgal_adjacency_cache) {
+	Mesh cube = makeCube();
+	const std::shared_ptr<const MeshAdjacency> index = cube.adjacency();
+
+	// editing properties keeps the cached index, including in a copy-on-write duplicate
+	Mesh copy = cube;
+	copy.edit(Mesh::kEditProperties).vertexProperties().addProperty("N", normals::Normal{{0, 0, 0}});
+	BOOST_CHECK_EQUAL(copy.adjacency(), index);
+	BOOST_CHECK_EQUAL(cube.adjacency(), index);
+
+	// any other edit releases it
+	cube.edit();
+	BOOST_CHECK(cube.adjacency() != index);
+	BOOST_CHECK_EQUAL(copy.adjacency(), index);
+}
+
+BOOST_AUTO_TEST_CASE(cgal_halfedge_normals) {
+	Mesh cube = makeCube();
+
+	// editing the mesh below releases the cached index
+	const std::shared_ptr<const MeshAdjacency> index = cube.adjacency();
+	const MeshAdjacency& adj = *index;
+
+	// all edges of a cube are sharper than the crease angle - hard edges
+	const std::vector<normals::Normal> hard = normals::halfedgeNormals(adj, normals::kAngleWeighted, M_PI / 3.0);
+	BOOST_REQUIRE_EQUAL(hard.size(), 24u);
+	for(std::size_t c = 0; c < 24; ++c)
+		checkClose(hard[c], s_cubeFaceNormals[adj.cornerFace(c)]);
+
+	// smooth edges - the same as vertex normals
+	const std::vector<normals::Normal> smooth = normals::halfedgeNormals(adj, normals::kAreaWeighted, M_PI * 0.6);
+	for(std::size_t c = 0; c < 24; ++c)
+		checkClose(smooth[c], cornerNormal(adj.cornerVertex(c)));
+
+	// written to a property in face, then circulator order
+	Mesh::MeshData& data = cube.edit();
+	Property<normals::Normal>& prop = data.halfedgeProperties().addProperty("N", normals::Normal{{0, 0, 0}});
+	normals::writeHalfedgeProperty(data, prop, hard);
+
+	std::size_t corner = 0;
+	for(auto fit = cube.polyhedron().facets_begin(); fit != cube.polyhedron().facets_end(); ++fit) {
+		auto hit = fit->facet_begin();
+		for(std::size_t i = 0; i < fit->facet_degree(); ++i) {
+			checkClose(prop.get(hit->property_key()), hard[corner]);
+
+			++hit;
+			++corner;
+		}
+	}
+	BOOST_CHECK_EQUAL(corner, 24u);
+}
@@ -0,0 +1,117 @@
+#include <cgal/properties.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace possumwood;
+
+BOOST_AUTO_TEST_CASE(cgal_properties_handle) {
+	Properties props;
+
+	Property<float>& f = props.addProperty("f", 1.0f);
+	Property<int>& i = props.addProperty("i", 2);
+
+	// typed handles point to the same property instances as the references returned on creation
+	BOOST_CHECK_EQUAL(props.handle<float>("f"), &f);
+	BOOST_CHECK_EQUAL(props.handle<int>("i"), &i);
+	BOOST_CHECK_EQUAL(&props.property<float>("f"), &f);
+
+	// wrong type or a missing property return nullptr
+	BOOST_CHECK(props.handle<int>("f") == nullptr);
+	BOOST_CHECK(props.handle<float>("i") == nullptr);
+	BOOST_CHECK(props.handle<float>("x") == nullptr);
+
+	const Properties& constProps = props;
+	BOOST_CHECK_EQUAL(constProps.handle<float>("f"), &f);
+	BOOST_CHECK(constProps.handle<int>("f") == nullptr);
+
+	// handles stay valid when other properties are added or removed
+	props.addProperty("a", 3.0);
+	props.addProperty("z", std::string("z"));
+	BOOST_CHECK_EQUAL(props.handle<float>("f"), &f);
+	BOOST_CHECK_EQUAL(props.handle<int>("i"), &i);
+
+	props.removeProperty("a");
+	BOOST_CHECK_EQUAL(props.handle<float>("f"), &f);
+	BOOST_CHECK(props.handle<double>("a") == nullptr);
+
+	// properties are iterated sorted by name
+	std::vector<std::string> names;
+	for(auto& p : props)
+		names.push_back(p.name());
+	BOOST_CHECK(names == (std::vector<std::string>{"f", "i", "z"}));
+
+	// a copy has its own property instances
+	Properties copy = props;
+	BOOST_REQUIRE(copy.handle<float>("f") != nullptr);
+	BOOST_CHECK(copy.handle<float>("f") != &f);
+}
+
+BOOST_AUTO_TEST_CASE(cgal_properties_shared_items) {
+	Properties props;
+
+	Property<float>& f = props.addProperty("f", 1.0f);
+	Property<int>& i = props.addProperty("i", 2);
+	BOOST_CHECK_EQUAL(props.itemCount(), 0u);
+
+	// setting a default key allocates an item in all properties
+	PropertyKey k1, k2;
+	f.set(k1, 10.0f);
+	BOOST_REQUIRE(!k1.isDefault());
+	BOOST_CHECK_EQUAL(k1.index(), 0u);
+	BOOST_CHECK_EQUAL(props.itemCount(), 1u);
+	BOOST_CHECK_EQUAL(f.size(), 1u);
+	BOOST_CHECK_EQUAL(i.size(), 1u);
+
+	// the same key indexes all properties - the other property holds its default value
+	BOOST_CHECK_EQUAL(f.get(k1), 10.0f);
+	BOOST_CHECK_EQUAL(i.get(k1), 2);
+
+	i.set(k2, 20);
+	BOOST_CHECK_EQUAL(k2.index(), 1u);
+	BOOST_CHECK_EQUAL(props.itemCount(), 2u);
+	BOOST_CHECK_EQUAL(f.get(k2), 1.0f);
+	BOOST_CHECK_EQUAL(i.get(k2), 20);
+
+	// default keys return the default value without allocating anything
+	BOOST_CHECK_EQUAL(f.get(PropertyKey()), 1.0f);
+	BOOST_CHECK_EQUAL(props.itemCount(), 2u);
+
+	// a property added later is allocated for all existing items
+	Property<double>& d = props.addProperty("d", 5.0);
+	BOOST_CHECK_EQUAL(d.size(), 2u);
+	BOOST_CHECK_EQUAL(d.get(k1), 5.0);
+	BOOST_CHECK_EQUAL(d.get(k2), 5.0);
+
+	// bulk access is indexed by the key index
+	PropertySpan<float> values = f.values();
+	BOOST_REQUIRE_EQUAL(values.size(), 2u);
+	BOOST_CHECK_EQUAL(values[k1.index()], 10.0f);
+	BOOST_CHECK_EQUAL(values[k2.index()], 1.0f);
+
+	// copies keep the item count
+	const Properties copy = props;
+	BOOST_CHECK_EQUAL(copy.itemCount(), 2u);
+	BOOST_CHECK_EQUAL(copy.property<float>("f").get(k1), 10.0f);
+}
+
+BOOST_AUTO_TEST_CASE(cgal_properties_set_overwrites) {
+	Properties props;
+	Property<int>& i = props.addProperty("i", 0);
+
+	PropertyKey key;
+	i.set(key, 1);
+	const std::size_t index = key.index();
+
+	// setting an allocated key overwrites its value, using both the non-const and const key overloads
+	i.set(key, 2);
+	BOOST_CHECK_EQUAL(key.index(), index);
+	BOOST_CHECK_EQUAL(i.get(key), 2);
+
+	const PropertyKey& constKey = key;
+	i.set(constKey, 3);
+	BOOST_CHECK_EQUAL(i.get(key), 3);
+
+	// no new items were allocated
+	BOOST_CHECK_EQUAL(props.itemCount(), 1u);
+	BOOST_CHECK_EQUAL(i.size(), 1u);
+}
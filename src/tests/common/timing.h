@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+
+namespace possumwood {
+namespace tests {
+
+/// runs a function, and returns its runtime in milliseconds
+template <typename FN>
+float measure(FN fn) {
+	const auto start = std::chrono::steady_clock::now();
+	fn();
+	const auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+}  // namespace tests
+}  // namespace possumwood
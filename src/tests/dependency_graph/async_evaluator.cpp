@@ -0,0 +1,372 @@
+#include <dependency_graph/async_evaluator.h>
+#include <dependency_graph/frame_cache.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/metadata_register.h>
+#include <dependency_graph/node.h>
+
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <thread>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+std::atomic<unsigned> s_startedCount(0);
+std::atomic<unsigned> s_computeCount(0);
+std::atomic<unsigned> s_cancelledCount(0);
+std::atomic<bool> s_block(false);
+
+/// a node multiplying its input by 2. If s_block is set, its compute blocks until cancelled.
+template <unsigned ID>
+std::unique_ptr<MetadataHandle> makeNode(const std::string& type, bool background) {
+	std::unique_ptr<Metadata> meta(new Metadata(type));
+
+	static InAttr<float> input;
+	static OutAttr<float> output;
+
+	meta->addAttribute(input, "input");
+	meta->addAttribute(output, "output");
+
+	meta->addInfluence(input, output);
+
+	meta->setCompute([](Values& vals) {
+		++s_startedCount;
+
+		while(s_block && !vals.isCancelled())
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		if(vals.isCancelled()) {
+			++s_cancelledCount;
+			return State();
+		}
+
+		++s_computeCount;
+		vals.set(output, vals.get(input) * 2.0f);
+
+		return State();
+	});
+
+	meta->setBackgroundCompute(background);
+
+	std::unique_ptr<MetadataHandle> handle(new MetadataHandle(std::move(meta)));
+	dependency_graph::MetadataRegister::singleton().add(*handle);
+
+	return handle;
+}
+
+const MetadataHandle& backgroundNode() {
+	static std::unique_ptr<MetadataHandle> s_handle = makeNode<0>("async_background", true);
+	return *s_handle;
+}
+
+const MetadataHandle& mainThreadNode() {
+	static std::unique_ptr<MetadataHandle> s_handle = makeNode<1>("async_main_thread", false);
+	return *s_handle;
+}
+
+/// a node multiplying its input by the proxy scale of the evaluation
+const MetadataHandle& proxyNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("async_proxy"));
+
+		static InAttr<float> input;
+		static OutAttr<float> output;
+
+		meta->addAttribute(input, "input");
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount;
+			vals.set(output, vals.get(input) * vals.proxyScale());
+
+			return State();
+		});
+		meta->setBackgroundCompute(true);
+
+		s_handle = std::unique_ptr<MetadataHandle>(new MetadataHandle(std::move(meta)));
+		dependency_graph::MetadataRegister::singleton().add(*s_handle);
+	}
+
+	return *s_handle;
+}
+
+/// waits for all evaluations to finish, and applies their results
+bool wait(AsyncEvaluator& eval) {
+	bool result = false;
+
+	while(eval.isBusy()) {
+		result |= eval.processResults();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return result;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(async_evaluation) {
+	Graph g;
+	AsyncEvaluator eval(g, 2);
+
+	std::atomic<unsigned> finished(0);
+	eval.onFinished([&finished]() { ++finished; });
+
+	// source -> add (+ param) -> result
+	NodeBase& source = g.nodes().add(backgroundNode(), "source");
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+	NodeBase& result = g.nodes().add(backgroundNode(), "result");
+
+	BOOST_REQUIRE_NO_THROW(source.port(1).connect(add.port(0)));
+	BOOST_REQUIRE_NO_THROW(add.port(2).connect(result.port(0)));
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(1.0f));
+
+	s_computeCount = 0;
+
+	// non-dirty port doesn't need any evaluation
+	BOOST_CHECK(!eval.request(add.port(1)));
+
+	// evaluation in the background doesn't change the graph until the results are processed
+	BOOST_CHECK(eval.request(result.port(1)));
+	BOOST_CHECK(eval.request(result.port(1)));
+
+	while(finished == 0)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	BOOST_CHECK(result.port(1).isDirty());
+	BOOST_CHECK_EQUAL(static_cast<const NodeBase&>(result).datablock().get<float>(1), 0.0f);
+
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK_EQUAL(finished, 1u);
+	BOOST_CHECK_EQUAL(s_computeCount, 2u);
+
+	// the results are applied as if evaluated in the main thread
+	BOOST_CHECK(!result.port(1).isDirty());
+	BOOST_CHECK(!result.port(0).isDirty());
+	BOOST_CHECK(!add.port(2).isDirty());
+	BOOST_CHECK(!add.port(0).isDirty());
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 6.0f);
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 3.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 2u);
+
+	// nothing left to evaluate
+	BOOST_CHECK(!eval.request(result.port(1)));
+}
+
+BOOST_AUTO_TEST_CASE(async_cancellation) {
+	Graph g;
+	AsyncEvaluator eval(g, 2);
+
+	NodeBase& source = g.nodes().add(backgroundNode(), "source");
+	NodeBase& result = g.nodes().add(backgroundNode(), "result");
+
+	BOOST_REQUIRE_NO_THROW(source.port(1).connect(result.port(0)));
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(1.0f));
+
+	s_startedCount = 0;
+	s_computeCount = 0;
+	s_cancelledCount = 0;
+
+	// the compute blocks until cancelled
+	s_block = true;
+	BOOST_CHECK(eval.request(result.port(1)));
+
+	while(s_startedCount == 0)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	// changing the input cancels the evaluation, and its results are thrown away
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(2.0f));
+	BOOST_CHECK(!wait(eval));
+	BOOST_CHECK_EQUAL(s_cancelledCount, 1u);
+	BOOST_CHECK_EQUAL(s_computeCount, 0u);
+	BOOST_CHECK(result.port(1).isDirty());
+	BOOST_CHECK(source.port(1).isDirty());
+
+	// new request evaluates the new values
+	s_block = false;
+	BOOST_CHECK(eval.request(result.port(1)));
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK(!result.port(1).isDirty());
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 8.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(async_main_thread) {
+	Graph g;
+	AsyncEvaluator eval(g, 2);
+
+	// background -> main thread only -> background
+	NodeBase& source = g.nodes().add(backgroundNode(), "source");
+	NodeBase& main = g.nodes().add(mainThreadNode(), "main");
+	NodeBase& result = g.nodes().add(backgroundNode(), "result");
+
+	BOOST_REQUIRE_NO_THROW(source.port(1).connect(main.port(0)));
+	BOOST_REQUIRE_NO_THROW(main.port(1).connect(result.port(0)));
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(1.0f));
+
+	s_computeCount = 0;
+
+	// only the part upstream of the main-thread node is evaluated in the background
+	BOOST_CHECK(eval.request(result.port(1)));
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK_EQUAL(s_computeCount, 1u);
+	BOOST_CHECK(!source.port(1).isDirty());
+	BOOST_CHECK(main.port(1).isDirty());
+	BOOST_CHECK(result.port(1).isDirty());
+
+	// the rest has to be pulled on the main thread
+	BOOST_CHECK(!eval.request(result.port(1)));
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 8.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(stale_values) {
+	Graph g;
+
+	NodeBase& source = g.nodes().add(backgroundNode(), "source");
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(1.0f));
+	BOOST_CHECK_EQUAL(source.port(1).get<float>(), 2.0f);
+
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(2.0f));
+	BOOST_CHECK(source.port(1).isDirty());
+
+	// stale values don't trigger any evaluation
+	Values vals(source);
+	vals.setStale(true);
+	BOOST_CHECK_EQUAL(vals.data(1).get<float>(), 2.0f);
+	BOOST_CHECK(source.port(1).isDirty());
+
+	vals.setStale(false);
+	BOOST_CHECK_EQUAL(vals.data(1).get<float>(), 4.0f);
+	BOOST_CHECK(!source.port(1).isDirty());
+}
+
+BOOST_AUTO_TEST_CASE(async_proxy) {
+	Graph g;
+	AsyncEvaluator eval(g, 2);
+	eval.setProxyScale(0.5f);
+
+	// source -> add (+ param)
+	NodeBase& source = g.nodes().add(proxyNode(), "source");
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+
+	BOOST_REQUIRE_NO_THROW(source.port(1).connect(add.port(0)));
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(4.0f));
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(1.0f));
+
+	s_computeCount = 0;
+
+	// the first evaluation provides proxy values
+	BOOST_CHECK(eval.request(add.port(2)));
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK(!add.port(2).isDirty());
+	BOOST_CHECK(eval.isProxy(add.port(2)));
+	BOOST_CHECK(eval.isProxy(source.port(1)));
+	BOOST_CHECK(!eval.isProxy(add.port(1)));
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 3.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 1u);
+
+	// requesting a proxy value schedules its full-resolution evaluation
+	BOOST_CHECK(!eval.request(add.port(2)));
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK(!eval.isProxy(add.port(2)));
+	BOOST_CHECK(!eval.isProxy(source.port(1)));
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 5.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 2u);
+
+	// a change downstream reuses the upstream proxy values
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(2.0f));
+	BOOST_CHECK(eval.request(add.port(2)));
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK(eval.isProxy(add.port(2)));
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 4.0f);
+	BOOST_CHECK_EQUAL(source.port(1).get<float>(), 4.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 2u);
+
+	eval.refine();
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK(!eval.isProxy(add.port(2)));
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 6.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 2u);
+
+	// changing the scale invalidates all proxy values
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(1.0f));
+	BOOST_CHECK(eval.request(add.port(2)));
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK(eval.isProxy(add.port(2)));
+
+	eval.setProxyScale(0.25f);
+	BOOST_CHECK(add.port(2).isDirty());
+	BOOST_CHECK(eval.request(add.port(2)));
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 2.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(async_proxy_frame_cache) {
+	Graph g;
+	AsyncEvaluator eval(g, 2);
+	eval.setProxyScale(0.5f);
+
+	FrameCache cache(g);
+	cache.setFilter([&eval](const Port& p) { return !eval.isProxy(p); });
+
+	// source (time) -> add (+ param)
+	NodeBase& source = g.nodes().add(proxyNode(), "source");
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+
+	BOOST_REQUIRE_NO_THROW(source.port(1).connect(add.port(0)));
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(4.0f));
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(1.0f));
+
+	const std::vector<std::reference_wrapper<Port>> sources{source.port(0)};
+	auto setTime = [&](float t) { return [&source, t]() { source.port(0).set(t); }; };
+
+	BOOST_CHECK(eval.request(add.port(2)));
+	BOOST_CHECK(wait(eval));
+	BOOST_REQUIRE(eval.isProxy(add.port(2)));
+
+	// proxy values are not stored in the frame cache - switching back needs a new evaluation
+	BOOST_CHECK_NO_THROW(cache.switchFrame(4.0f, 8.0f, sources, setTime(8.0f)));
+	BOOST_CHECK_NO_THROW(cache.switchFrame(8.0f, 4.0f, sources, setTime(4.0f)));
+	BOOST_CHECK(add.port(2).isDirty());
+
+	BOOST_CHECK(eval.request(add.port(2)));
+	BOOST_CHECK(wait(eval));
+	BOOST_REQUIRE(eval.isProxy(add.port(2)));
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 3.0f);
+
+	const std::size_t cached = cache.size();
+	BOOST_CHECK(cached > 0u);
+
+	// refinement replaces the proxy values without invalidating the graph (i.e., without
+	// cancelling evaluations or clearing the frame cache)
+	unsigned dirtyCount = 0;
+	boost::signals2::connection c = g.onDirty([&dirtyCount]() { ++dirtyCount; });
+
+	eval.refine();
+	BOOST_CHECK(wait(eval));
+	BOOST_CHECK(!eval.isProxy(add.port(2)));
+	BOOST_CHECK(!add.port(2).isDirty());
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 5.0f);
+
+	BOOST_CHECK_EQUAL(dirtyCount, 0u);
+	BOOST_CHECK_EQUAL(cache.size(), cached);
+
+	c.disconnect();
+}
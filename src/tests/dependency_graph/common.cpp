@@ -103,6 +103,7 @@ const MetadataHandle& additionNode() {
 			return State();
 		};
 		meta->setCompute(additionCompute);
+		meta->setBackgroundCompute(true);
 
 		s_handle = std::unique_ptr<MetadataHandle>(new MetadataHandle(std::move(meta)));
 
@@ -137,6 +138,7 @@ const MetadataHandle& multiplicationNode() {
 		meta->addInfluence(multiplicationInput2, multiplicationOutput);
 
 		meta->setCompute(multiplicationCompute);
+		meta->setBackgroundCompute(true);
 
 		s_handle = std::unique_ptr<MetadataHandle>(new MetadataHandle(std::move(meta)));
 
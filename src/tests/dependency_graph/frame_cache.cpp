@@ -0,0 +1,120 @@
+#include <dependency_graph/frame_cache.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/metadata_register.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+unsigned s_computeCount = 0;
+
+/// a node multiplying its input by 2, counting the number of its evaluations
+const dependency_graph::MetadataHandle& countingNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("counting"));
+
+		static InAttr<float> input;
+		static OutAttr<float> output;
+
+		meta->addAttribute(input, "input");
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount;
+			vals.set(output, vals.get(input) * 2.0f);
+
+			return State();
+		});
+
+		s_handle = std::unique_ptr<MetadataHandle>(new MetadataHandle(std::move(meta)));
+
+		dependency_graph::MetadataRegister::singleton().add(*s_handle);
+	}
+
+	return *s_handle;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(frame_cache) {
+	Graph g;
+	FrameCache cache(g);
+
+	// time -> counting -> addition (+ param) -> counting
+	NodeBase& time = g.nodes().add(countingNode(), "time");
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+	NodeBase& result = g.nodes().add(countingNode(), "result");
+
+	BOOST_REQUIRE_NO_THROW(time.port(1).connect(add.port(0)));
+	BOOST_REQUIRE_NO_THROW(add.port(2).connect(result.port(0)));
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(1.0f));
+
+	const std::vector<std::reference_wrapper<Port>> sources{time.port(0)};
+	auto setTime = [&](float t) { return [&time, t]() { time.port(0).set(t); }; };
+
+	// initial evaluation
+	s_computeCount = 0;
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 2.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 2u);
+
+	// switching to a new frame dirties the time-dependent ports, and requires evaluation
+	BOOST_CHECK_NO_THROW(cache.switchFrame(0.0f, 1.0f, sources, setTime(1.0f)));
+	BOOST_CHECK(result.port(1).isDirty());
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 6.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 4u);
+	BOOST_CHECK(cache.contains(0.0f));
+	BOOST_CHECK(!cache.contains(1.0f));
+
+	// switching back restores the previously evaluated values, without any evaluation
+	BOOST_CHECK_NO_THROW(cache.switchFrame(1.0f, 0.0f, sources, setTime(0.0f)));
+	BOOST_CHECK(!result.port(1).isDirty());
+	BOOST_CHECK(!add.port(2).isDirty());
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 2.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 4u);
+	BOOST_CHECK_EQUAL(cache.size(), 2u);
+
+	BOOST_CHECK_NO_THROW(cache.switchFrame(0.0f, 1.0f, sources, setTime(1.0f)));
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 6.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 4u);
+
+	// changing a non-time input invalidates the cache
+	BOOST_CHECK_NO_THROW(add.port(1).set(2.0f));
+	BOOST_CHECK_EQUAL(cache.size(), 0u);
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 8.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 5u);
+
+	BOOST_CHECK_NO_THROW(cache.switchFrame(1.0f, 0.0f, sources, setTime(0.0f)));
+	BOOST_CHECK(result.port(1).isDirty());
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 4.0f);
+	BOOST_CHECK_EQUAL(s_computeCount, 7u);
+
+	// as does any topology change
+	BOOST_CHECK_NO_THROW(cache.switchFrame(0.0f, 1.0f, sources, setTime(1.0f)));
+	BOOST_CHECK_EQUAL(cache.size(), 2u);
+	BOOST_CHECK_NO_THROW(add.port(2).disconnect(result.port(0)));
+	BOOST_CHECK_EQUAL(cache.size(), 0u);
+
+	// zero capacity disables caching
+	BOOST_REQUIRE_NO_THROW(add.port(2).connect(result.port(0)));
+	cache.setCapacity(0);
+	BOOST_CHECK_EQUAL(result.port(1).get<float>(), 8.0f);
+	BOOST_CHECK_NO_THROW(cache.switchFrame(1.0f, 0.0f, sources, setTime(0.0f)));
+	BOOST_CHECK_EQUAL(cache.size(), 0u);
+	BOOST_CHECK(result.port(1).isDirty());
+}
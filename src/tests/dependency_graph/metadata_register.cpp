@@ -0,0 +1,62 @@
+#include <dependency_graph/metadata_register.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/metadata.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+std::unique_ptr<MetadataHandle> makeHandle(const std::string& type) {
+	std::unique_ptr<Metadata> meta(new Metadata(type));
+	meta->setCompute([](Values& vals) { return State(); });
+
+	return std::unique_ptr<MetadataHandle>(new MetadataHandle(std::move(meta)));
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(metadata_register_loader) {
+	MetadataRegister& reg = MetadataRegister::singleton();
+
+	// unknown types are not found without a loader
+	BOOST_CHECK(reg.find("lazy_type") == reg.end());
+
+	// the loader is called for unknown types only, and can register them on demand
+	std::vector<std::string> requested;
+	std::unique_ptr<MetadataHandle> handle;
+
+	reg.setLoader([&](const std::string& type) {
+		requested.push_back(type);
+
+		if(type == "lazy_type") {
+			handle = makeHandle(type);
+			MetadataRegister::singleton().add(*handle);
+		}
+	});
+
+	auto it = reg.find("lazy_type");
+	BOOST_REQUIRE(it != reg.end());
+	BOOST_CHECK_EQUAL(it->metadata().type(), "lazy_type");
+	BOOST_REQUIRE_EQUAL(requested.size(), 1u);
+
+	// already registered - no loader call
+	BOOST_CHECK(reg.find("lazy_type") != reg.end());
+	BOOST_CHECK_EQUAL(requested.size(), 1u);
+
+	// the loader doesn't know the type - still not found
+	BOOST_CHECK(reg.find("unknown_type") == reg.end());
+	BOOST_REQUIRE_EQUAL(requested.size(), 2u);
+	BOOST_CHECK_EQUAL(requested[1], "unknown_type");
+
+	// removing the loader
+	reg.setLoader(std::function<void(const std::string&)>());
+	BOOST_CHECK(reg.find("another_type") == reg.end());
+	BOOST_CHECK_EQUAL(requested.size(), 2u);
+
+	reg.remove(*handle);
+	BOOST_CHECK(reg.find("lazy_type") == reg.end());
+}
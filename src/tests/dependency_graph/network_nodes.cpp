@@ -7,6 +7,7 @@
 #include <dependency_graph/node_base.inl>
 #include <dependency_graph/nodes.inl>
 #include <dependency_graph/port.inl>
+#include <algorithm>
 #include <iostream>
 
 #include "common.h"
@@ -194,3 +195,119 @@ BOOST_AUTO_TEST_CASE(network_node_iterator_2) {
 	BOOST_REQUIRE(g.nodes().find(n1.index(), Nodes::kRecursive) != g.nodes().end());
 	BOOST_CHECK_EQUAL(&(*g.nodes().find(n1.index(), Nodes::kRecursive)), &n1);
 }
+
+BOOST_AUTO_TEST_CASE(network_nodes_find) {
+	Graph g;
+
+	auto networkFactoryIterator = MetadataRegister::singleton().find("network");
+	BOOST_REQUIRE(networkFactoryIterator != MetadataRegister::singleton().end());
+
+	NodeBase& networkBase = g.nodes().add(*networkFactoryIterator, "network");
+	Network& network = networkBase.as<Network>();
+	NodeBase& nestedBase = network.nodes().add(*networkFactoryIterator, "nested");
+	Network& nested = nestedBase.as<Network>();
+
+	NodeBase& na1 = g.nodes().add(additionNode(), "add_1");
+	NodeBase& nb1 = network.nodes().add(additionNode(), "add_2");
+	NodeBase& nc1 = nested.nodes().add(additionNode(), "add_3");
+	NodeBase& nc2 = nested.nodes().add(additionNode(), "add_4");
+
+	// non-recursive search only finds direct children
+	BOOST_CHECK(g.nodes().find(na1.index()) != g.nodes().end());
+	BOOST_CHECK(g.nodes().find(nb1.index()) == g.nodes().end());
+
+	// recursive search finds nodes at any level
+	BOOST_REQUIRE(g.nodes().find(nc1.index(), Nodes::kRecursive) != g.nodes().end());
+	BOOST_CHECK_EQUAL(&*g.nodes().find(nc1.index(), Nodes::kRecursive), &nc1);
+	BOOST_CHECK_EQUAL(&*g.nodes().find(nb1.index(), Nodes::kRecursive), &nb1);
+	BOOST_CHECK_EQUAL(&*network.nodes().find(nc2.index(), Nodes::kRecursive), &nc2);
+	BOOST_CHECK(network.nodes().find(na1.index(), Nodes::kRecursive) == network.nodes().end());
+
+	// the resulting iterator continues the recursive iteration
+	std::vector<const NodeBase*> found, expected;
+	for(auto it = g.nodes().find(nestedBase.index(), Nodes::kRecursive); it != g.nodes().end(); ++it)
+		found.push_back(&*it);
+	for(auto it = g.nodes().begin(Nodes::kRecursive); it != g.nodes().end(); ++it)
+		expected.push_back(&*it);
+	expected.erase(expected.begin(), std::find(expected.begin(), expected.end(), &nestedBase));
+	BOOST_CHECK(found == expected);
+
+	// removed nodes are not found
+	const UniqueId id = nc1.index();
+	nested.nodes().erase(nested.nodes().find(id));
+	BOOST_CHECK(g.nodes().find(id, Nodes::kRecursive) == g.nodes().end());
+
+	g.nodes().erase(g.nodes().find(networkBase.index()));
+	BOOST_CHECK(g.nodes().find(nc2.index(), Nodes::kRecursive) == g.nodes().end());
+	BOOST_CHECK(g.nodes().find(na1.index(), Nodes::kRecursive) != g.nodes().end());
+}
+
+BOOST_AUTO_TEST_CASE(network_nodes_batch) {
+	Graph g;
+
+	unsigned dirtyCount = 0;
+	g.onDirty([&dirtyCount]() { ++dirtyCount; });
+
+	// dirtiness callbacks are deferred until the end of a batch
+	g.beginBatch();
+	NodeBase& n1 = g.nodes().add(additionNode(), "add_1");
+	NodeBase& n2 = g.nodes().add(additionNode(), "add_2");
+	BOOST_REQUIRE_NO_THROW(n1.port(2).connect(n2.port(0)));
+	BOOST_REQUIRE_NO_THROW(n1.port(0).set(1.0f));
+	BOOST_CHECK_EQUAL(dirtyCount, 0u);
+	g.endBatch();
+
+	BOOST_CHECK_EQUAL(dirtyCount, 1u);
+	BOOST_CHECK(n2.port(2).isDirty());
+	BOOST_CHECK_EQUAL(n2.port(2).get<float>(), 1.0f);
+
+	// removing a node removes all its connections
+	g.nodes().erase(g.nodes().find(n1.index()));
+	BOOST_CHECK_EQUAL(g.connections().size(), 0u);
+	BOOST_CHECK(!n2.port(0).isConnected());
+}
+
+BOOST_AUTO_TEST_CASE(network_nodes_batch_deferred_dirtiness) {
+	Graph g;
+
+	NodeBase& n1 = g.nodes().add(additionNode(), "add_1");
+	NodeBase& n2 = g.nodes().add(additionNode(), "add_2");
+	NodeBase& n3 = g.nodes().add(additionNode(), "add_3");
+	BOOST_REQUIRE_NO_THROW(n1.port(2).connect(n2.port(0)));
+	BOOST_REQUIRE_NO_THROW(n2.port(2).connect(n3.port(0)));
+
+	// evaluating the chain makes all ports clean
+	BOOST_CHECK_EQUAL(n3.port(2).get<float>(), 0.0f);
+	BOOST_CHECK(!n3.port(2).isDirty());
+
+	unsigned dirtyCount = 0;
+	g.onDirty([&dirtyCount]() { ++dirtyCount; });
+
+	// within a batch, only the changed port is affected - the propagation to its dependants is deferred
+	g.beginBatch();
+	n1.port(0).set(1.0f);
+	n1.port(1).set(2.0f);
+	BOOST_CHECK(!n1.port(2).isDirty());
+	BOOST_CHECK(!n3.port(2).isDirty());
+
+	// nested batches propagate only at the end of the outermost one
+	g.beginBatch();
+	n2.port(1).set(3.0f);
+	g.endBatch();
+	BOOST_CHECK(!n3.port(2).isDirty());
+	BOOST_CHECK_EQUAL(dirtyCount, 0u);
+	g.endBatch();
+
+	BOOST_CHECK_EQUAL(dirtyCount, 1u);
+	BOOST_CHECK(n1.port(2).isDirty());
+	BOOST_CHECK(n2.port(2).isDirty());
+	BOOST_CHECK(n3.port(2).isDirty());
+	BOOST_CHECK_EQUAL(n3.port(2).get<float>(), 6.0f);
+
+	// changes of nodes removed within a batch are dropped
+	g.beginBatch();
+	n2.port(1).set(4.0f);
+	g.nodes().erase(g.nodes().find(n2.index()));
+	BOOST_CHECK_NO_THROW(g.endBatch());
+	BOOST_CHECK(n3.port(0).isDirty());
+}
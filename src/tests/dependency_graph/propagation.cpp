@@ -0,0 +1,86 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+
+#include "common.h"
+#include "common/timing.h"
+
+using namespace dependency_graph;
+using possumwood::tests::measure;
+
+namespace {
+
+const std::size_t s_nodeCount = 10000;
+
+}  // namespace
+
+// dirty propagation and evaluation of long chains and wide fans of nodes - traversal of connections
+// should not depend on the size of the graph
+BOOST_AUTO_TEST_CASE(propagation_chain) {
+	Graph g;
+
+	std::vector<NodeBase*> nodes;
+	for(std::size_t n = 0; n < s_nodeCount; ++n) {
+		nodes.push_back(&g.nodes().add(additionNode(), "add_" + std::to_string(n)));
+
+		if(n > 0)
+			BOOST_REQUIRE_NO_THROW(nodes[n - 1]->port(2).connect(nodes[n]->port(0)));
+		BOOST_REQUIRE_NO_THROW(nodes[n]->port(1).set(1.0f));
+	}
+	BOOST_REQUIRE_EQUAL(g.connections().size(), s_nodeCount - 1);
+
+	// evaluated front-to-back, to avoid deep recursion of the pull
+	const float evaluation = measure([&]() {
+		for(auto& n : nodes)
+			n->port(2).get<float>();
+	});
+	BOOST_CHECK_EQUAL(nodes.back()->port(2).get<float>(), (float)s_nodeCount);
+	BOOST_CHECK(!nodes.back()->port(2).isDirty());
+
+	const float dirty = measure([&]() { nodes.front()->port(1).set(2.0f); });
+	BOOST_CHECK(nodes.back()->port(2).isDirty());
+
+	for(auto& n : nodes)
+		n->port(2).get<float>();
+	BOOST_CHECK_EQUAL(nodes.back()->port(2).get<float>(), (float)s_nodeCount + 1.0f);
+
+	BOOST_TEST_MESSAGE("chain of " << s_nodeCount << " nodes - evaluation " << evaluation << "ms, dirty propagation "
+	                               << dirty << "ms");
+}
+
+BOOST_AUTO_TEST_CASE(propagation_fan) {
+	Graph g;
+
+	NodeBase& source = g.nodes().add(additionNode(), "source");
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(1.0f));
+
+	std::vector<NodeBase*> nodes;
+	for(std::size_t n = 0; n < s_nodeCount; ++n) {
+		nodes.push_back(&g.nodes().add(additionNode(), "add_" + std::to_string(n)));
+
+		BOOST_REQUIRE_NO_THROW(source.port(2).connect(nodes[n]->port(0)));
+		BOOST_REQUIRE_NO_THROW(nodes[n]->port(1).set((float)n));
+	}
+	BOOST_REQUIRE_EQUAL(g.connections().size(), s_nodeCount);
+	BOOST_REQUIRE_EQUAL(g.connections().connectedTo(source.port(2)).size(), s_nodeCount);
+
+	const float evaluation = measure([&]() {
+		for(auto& n : nodes)
+			n->port(2).get<float>();
+	});
+	BOOST_CHECK_EQUAL(nodes.back()->port(2).get<float>(), (float)s_nodeCount);
+
+	const float dirty = measure([&]() { source.port(1).set(1.0f); });
+	for(auto& n : nodes)
+		BOOST_REQUIRE(n->port(2).isDirty());
+
+	for(std::size_t n = 0; n < s_nodeCount; ++n)
+		BOOST_REQUIRE_EQUAL(nodes[n]->port(2).get<float>(), (float)n + 2.0f);
+
+	BOOST_TEST_MESSAGE("fan of " << s_nodeCount << " nodes - evaluation " << evaluation << "ms, dirty propagation "
+	                             << dirty << "ms");
+}
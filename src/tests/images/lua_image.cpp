@@ -0,0 +1,181 @@
+#include <images/lua/module.h>
+#include <images/lua/opencv_image.h>
+#include <lua/datatypes/context.h>
+#include <lua/datatypes/state.h>
+
+#include <boost/test/unit_test.hpp>
+#include <lauxlib.h>
+#include <lualib.h>
+
+using possumwood::images::OpencvMatWrapper;
+
+namespace {
+
+/// a state with the standard libraries and the images module
+possumwood::lua::State makeState() {
+	possumwood::lua::Context context;
+	context.addModule(possumwood::images::Module::name(), possumwood::images::Module::init);
+
+	possumwood::lua::State state(context);
+	luaL_openlibs(state);
+
+	return state;
+}
+
+/// runs a source, returning its error message (empty on success)
+std::string run(possumwood::lua::State& state, const std::string& src) {
+	if(luaL_dostring(state, src.c_str()) == 0)
+		return "";
+
+	const char* msg = lua_tostring(state, -1);
+	const std::string result = msg != nullptr ? msg : "(no message)";
+	lua_pop(state, 1);
+
+	return result;
+}
+
+cv::Mat result(possumwood::lua::State& state) {
+	return luabind::object_cast<OpencvMatWrapper>(state.globals()["result"]).mat();
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(lua_image_map) {
+	possumwood::lua::State state = makeState();
+
+	cv::Mat input(3, 4, CV_8UC3, cv::Scalar(10, 20, 200));
+	OpencvMatWrapper image;
+	image = input;
+	state.globals()["img"] = image;
+
+	// nil keeps the channel value, and the results are saturated
+	BOOST_REQUIRE_EQUAL(run(state, "img:map(function(x, y, b, g, r) return x + y * 10, nil, r * 2 end)\n"
+	                               "result = img"),
+	                    "");
+
+	const cv::Mat mapped = result(state);
+	BOOST_REQUIRE_EQUAL(mapped.type(), CV_8UC3);
+	for(int y = 0; y < mapped.rows; ++y)
+		for(int x = 0; x < mapped.cols; ++x)
+			BOOST_CHECK(mapped.at<cv::Vec3b>(y, x) == cv::Vec3b(x + y * 10, 20, 255));
+
+	// the original image is copied on first write
+	BOOST_CHECK(input.at<cv::Vec3b>(1, 1) == cv::Vec3b(10, 20, 200));
+}
+
+BOOST_AUTO_TEST_CASE(lua_image_map_rows) {
+	possumwood::lua::State state = makeState();
+
+	const std::shared_ptr<cv::Mat> mat(new cv::Mat(2, 3, CV_32FC2, cv::Scalar(0.5f, 1.5f)));
+	state.globals()["img"] = OpencvMatWrapper(mat);
+
+	BOOST_REQUIRE_EQUAL(run(state, "count = 0\n"
+	                               "img:mapRows(function(y, row)\n"
+	                               "  for i = 0, row:size() - 1 do row:set(i, row:get(i) + y * 10 + i) end\n"
+	                               "  count = count + 1\n"
+	                               "end)\n"
+	                               "img:row(1):set(0, -1)"),
+	                    "");
+
+	BOOST_CHECK_EQUAL(luabind::object_cast<int>(state.globals()["count"]), 2);
+
+	// a wrapped writable image is modified in-place
+	for(int y = 0; y < 2; ++y)
+		for(int x = 0; x < 3; ++x) {
+			const cv::Vec2f v = mat->at<cv::Vec2f>(y, x);
+			BOOST_CHECK_EQUAL(v[0], (x == 0 && y == 1) ? -1.0f : 0.5f + y * 10 + x * 2);
+			BOOST_CHECK_EQUAL(v[1], 1.5f + y * 10 + x * 2 + 1);
+		}
+
+	BOOST_CHECK(run(state, "img:row(2)") != "");
+	BOOST_CHECK(run(state, "img:row(0):get(6)") != "");
+}
+
+BOOST_AUTO_TEST_CASE(lua_image_copy) {
+	const std::shared_ptr<cv::Mat> mat(new cv::Mat(1, 2, CV_8UC1, cv::Scalar(0)));
+
+	// copies of a wrapped writable image keep writing to the same data
+	OpencvMatWrapper copy;
+	copy = OpencvMatWrapper(mat);
+	copy.row(0).set(1, 7);
+	BOOST_CHECK_EQUAL((int)mat->at<unsigned char>(0, 1), 7);
+	BOOST_CHECK(copy.mat().data == mat->data);
+
+	// assigning a read-only image drops the writable data - the next write copies the new image
+	const cv::Mat other(1, 2, CV_8UC1, cv::Scalar(3));
+	copy = other;
+	copy.row(0).set(0, 9);
+	BOOST_CHECK_EQUAL((int)other.at<unsigned char>(0, 0), 3);
+	BOOST_CHECK_EQUAL((int)mat->at<unsigned char>(0, 0), 0);
+	BOOST_CHECK_EQUAL((int)copy.mat().at<unsigned char>(0, 0), 9);
+}
+
+BOOST_AUTO_TEST_CASE(lua_image_convert) {
+	possumwood::lua::State state = makeState();
+
+	cv::Mat input(2, 2, CV_8UC1);
+	input.at<unsigned char>(0, 0) = 0;
+	input.at<unsigned char>(0, 1) = 51;
+	input.at<unsigned char>(1, 0) = 102;
+	input.at<unsigned char>(1, 1) = 255;
+
+	OpencvMatWrapper image;
+	image = input;
+	state.globals()["img"] = image;
+
+	BOOST_REQUIRE_EQUAL(run(state, "result = img:convert(images.image.float32, 1.0 / 255.0)"), "");
+
+	cv::Mat converted = result(state);
+	BOOST_REQUIRE_EQUAL(converted.type(), CV_32FC1);
+	BOOST_CHECK_CLOSE(converted.at<float>(0, 1), 0.2f, 1e-4f);
+	BOOST_CHECK_CLOSE(converted.at<float>(1, 1), 1.0f, 1e-4f);
+
+	// and back, with saturation
+	BOOST_REQUIRE_EQUAL(run(state, "result = result:convert(images.image.uint8, 510)"), "");
+
+	converted = result(state);
+	BOOST_REQUIRE_EQUAL(converted.type(), CV_8UC1);
+	BOOST_CHECK_EQUAL((int)converted.at<unsigned char>(0, 0), 0);
+	BOOST_CHECK_EQUAL((int)converted.at<unsigned char>(0, 1), 102);
+	BOOST_CHECK_EQUAL((int)converted.at<unsigned char>(1, 1), 255);
+
+	BOOST_CHECK(run(state, "img:convert(7, 1.0)") != "");
+}
+
+BOOST_AUTO_TEST_CASE(lua_image_arithmetic) {
+	possumwood::lua::State state = makeState();
+
+	OpencvMatWrapper a, b;
+	a = cv::Mat(2, 2, CV_32FC1, cv::Scalar(6.0f));
+	b = cv::Mat(2, 2, CV_32FC1, cv::Scalar(2.0f));
+	state.globals()["a"] = a;
+	state.globals()["b"] = b;
+
+	BOOST_REQUIRE_EQUAL(run(state, "result = (a + b) * (a - b) / b - 1"), "");
+	BOOST_CHECK_EQUAL(cv::countNonZero(result(state) != 15.0f), 0);
+
+	state.globals()["c"] = OpencvMatWrapper(3, 2, CV_32F, 1);
+	BOOST_CHECK(run(state, "result = a + c") != "");
+}
+
+BOOST_AUTO_TEST_CASE(lua_image_map_errors) {
+	possumwood::lua::State state = makeState();
+
+	OpencvMatWrapper image;
+	image = cv::Mat(2, 2, CV_8UC1, cv::Scalar(0));
+	state.globals()["img"] = image;
+
+	BOOST_CHECK(run(state, "img:map(5)") != "");
+	BOOST_CHECK(run(state, "img:mapRows({})") != "");
+
+	// errors raised by the mapping function are reported, including error objects without a message
+	BOOST_CHECK(run(state, "img:map(function(x, y, v) error('mapping failed') end)").find("mapping failed") !=
+	            std::string::npos);
+	BOOST_CHECK(run(state, "img:map(function(x, y, v) error({}) end)").find("non-string error object") !=
+	            std::string::npos);
+
+	// the stack is left balanced after an error
+	const int top = lua_gettop(state);
+	run(state, "img:map(function(x, y, v) error('again') end)");
+	BOOST_CHECK_EQUAL(lua_gettop(state), top);
+}
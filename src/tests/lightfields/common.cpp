@@ -0,0 +1,96 @@
+#include "common.h"
+
+#include <fstream>
+#include <random>
+
+namespace {
+
+/// writes a single block of a lytro raw file, including its header and padding
+void writeBlock(std::ostream& out, char id, const std::string& name, const std::string& data) {
+	const unsigned char header[12] = {0x89, 'L', 'F', (unsigned char)id, 0x0d, 0x0a, 0x1a, 0x0a, 0, 0, 0, 1};
+	out.write((const char*)header, 12);
+
+	for(int a = 3; a >= 0; --a)
+		out.put((char)((data.size() >> (a * 8)) & 0xff));
+
+	if(id != 'P') {
+		std::string paddedName = name;
+		paddedName.resize(80, '\0');
+		out.write(paddedName.data(), 80);
+
+		out.write(data.data(), data.size());
+
+		while(out.tellp() % 16 != 0)
+			out.put('\0');
+	}
+}
+
+}  // namespace
+
+nlohmann::json makeMetadata(int width, int height) {
+	nlohmann::json meta;
+
+	meta["image"]["width"] = width;
+	meta["image"]["height"] = height;
+	meta["image"]["orientation"] = 1;
+	meta["image"]["representation"] = "rawPacked";
+	meta["image"]["rawDetails"]["pixelFormat"]["rightShift"] = 0;
+	meta["image"]["rawDetails"]["pixelFormat"]["black"] = {{"b", 168}, {"gb", 168}, {"gr", 168}, {"r", 168}};
+	meta["image"]["rawDetails"]["pixelFormat"]["white"] = {{"b", 4095}, {"gb", 4095}, {"gr", 4095}, {"r", 4095}};
+	meta["image"]["rawDetails"]["pixelPacking"]["endianness"] = "big";
+	meta["image"]["rawDetails"]["pixelPacking"]["bitsPerPixel"] = 12;
+	meta["image"]["rawDetails"]["mosaic"]["tile"] = "r,gr:gb,b";
+	meta["image"]["rawDetails"]["mosaic"]["upperLeftPixel"] = "b";
+
+	meta["devices"]["sensor"]["mosaic"]["upperLeftPixel"] = "b";
+	meta["devices"]["sensor"]["bitsPerPixel"] = 12;
+	meta["devices"]["sensor"]["analogGain"] = {{"b", 1.6}, {"gb", 1.0}, {"gr", 1.0}, {"r", 2.1}};
+	meta["devices"]["sensor"]["pixelPitch"] = 1.4e-6;
+
+	// a slightly rotated and offset microlens array, with a lens pitch of about 14.3 pixels
+	meta["devices"]["mla"]["lensPitch"] = 2.0e-5;
+	meta["devices"]["mla"]["rotation"] = 0.0021;
+	meta["devices"]["mla"]["scaleFactor"] = {{"x", 1.0}, {"y", 1.0004}};
+	meta["devices"]["mla"]["sensorOffset"] = {{"x", -6.3e-6}, {"y", 2.1e-6}, {"z", 2.5e-5}};
+
+	return meta;
+}
+
+std::vector<uint16_t> writeRaw(const std::string& filename, const nlohmann::json& metadata) {
+	const int width = metadata["image"]["width"].get<int>();
+	const int height = metadata["image"]["height"].get<int>();
+
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> dist(0, 4095);
+
+	std::vector<uint16_t> values(width * height);
+	for(auto& v : values)
+		v = dist(gen);
+
+	std::string packed((values.size() * 3 + 1) / 2, '\0');
+	for(std::size_t i = 0; i < values.size(); ++i) {
+		unsigned char* ptr = (unsigned char*)&packed[i / 2 * 3];
+		if(i % 2 == 0) {
+			ptr[0] = values[i] >> 4;
+			ptr[1] |= (values[i] & 0x0f) << 4;
+		}
+		else {
+			ptr[1] |= values[i] >> 8;
+			ptr[2] = values[i] & 0xff;
+		}
+	}
+
+	nlohmann::json header;
+	header["frames"][0]["frame"]["metadataRef"] = "sha1-metadata";
+	header["frames"][0]["frame"]["privateMetadataRef"] = "sha1-private";
+	header["frames"][0]["frame"]["imageRef"] = "sha1-image";
+
+	std::ofstream file(filename, std::ios::binary);
+	writeBlock(file, 'P', "", "");
+	writeBlock(file, 'M', "", header.dump());
+	writeBlock(file, 'C', "sha1-metadata", metadata.dump());
+	writeBlock(file, 'C', "sha1-private", "{\"camera\":{\"serialNumber\":\"A123\"}}");
+	writeBlock(file, 'C', "sha1-image", packed);
+
+	return values;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/timing.h"
+
+/// metadata of a synthetic lytro raw image, including the sensor and microlens array description
+nlohmann::json makeMetadata(int width, int height);
+
+/// writes a synthetic lytro raw file with random 12-bit pixel values, returning the unpacked values
+std::vector<uint16_t> writeRaw(const std::string& filename, const nlohmann::json& metadata);
+
+using possumwood::tests::measure;
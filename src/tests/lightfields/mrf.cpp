@@ -0,0 +1,255 @@
+#include <lightfields/mrf.h>
+#include <tbb/parallel_for.h>
+
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <tuple>
+
+#include "common.h"
+
+using namespace lightfields;
+
+namespace {
+
+/// a synthetic depth map with noisy values and random confidence
+MRF makeDepthMap(const V2i& size) {
+	MRF result(size);
+
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> noise(0, 3);
+	std::uniform_real_distribution<float> confidence(0.0f, 1.0f);
+
+	for(int y = 0; y < size.y; ++y)
+		for(int x = 0; x < size.x; ++x) {
+			result[V2i(x, y)].value = (x / 64 + y / 64) % 16 + noise(gen);
+			result[V2i(x, y)].confidence = confidence(gen);
+		}
+
+	return result;
+}
+
+/// reference single-pixel ICM evaluation, using the runtime-polymorphic Neighbours::eval()
+int evalICM(const MRF& source,
+            const cv::Mat& state,
+            const V2i& pos,
+            float inputsWeight,
+            float flatnessWeight,
+            float smoothnessWeight,
+            const Neighbours& neighbours) {
+	int min = std::min(source[pos].value, (int)state.at<unsigned char>(pos.y, pos.x));
+	int max = std::max(source[pos].value, (int)state.at<unsigned char>(pos.y, pos.x));
+	neighbours.eval(pos, [&](const V2i& n, float weight) {
+		min = std::min(min, (int)state.at<unsigned char>(n.y, n.x));
+		max = std::max(max, (int)state.at<unsigned char>(n.y, n.x));
+	});
+
+	float energy = std::numeric_limits<float>::max();
+	int label = state.at<unsigned char>(pos.y, pos.x);
+	for(int val = min; val <= max; ++val) {
+		const int e_inputs = std::abs(source[pos].value - val);
+
+		float e_flat = 0, e_flat_norm = 0;
+		neighbours.eval(pos, [&](const V2i& n, float weight) {
+			e_flat += std::abs(val - state.at<unsigned char>(n.y, n.x)) * weight;
+			e_flat_norm += weight;
+		});
+
+		float e_smooth = 0, e_smooth_norm = 0;
+		neighbours.eval(pos, [&](const V2i& n, float weight) {
+			e_smooth += (val - state.at<unsigned char>(n.y, n.x)) * weight;
+			e_smooth_norm += 1.0f + weight;
+		});
+
+		const float e = source[pos].confidence * inputsWeight * (float)e_inputs +
+		                flatnessWeight * (e_flat / e_flat_norm) +
+		                smoothnessWeight * (std::abs(e_smooth) / e_smooth_norm);
+
+		if(e < energy) {
+			energy = e;
+			label = val;
+		}
+	}
+
+	return label;
+}
+
+cv::Mat solveICM(const MRF& source,
+                 float inputsWeight,
+                 float flatnessWeight,
+                 float smoothnessWeight,
+                 std::size_t iterationLimit,
+                 const Neighbours& neighbourhood) {
+	cv::Mat state;
+	cv::Mat result = cv::Mat::zeros(source.size().y, source.size().x, CV_8UC1);
+	for(int y = 0; y < result.rows; ++y)
+		for(int x = 0; x < result.cols; ++x)
+			result.at<unsigned char>(y, x) = source[V2i(x, y)].value;
+
+	for(std::size_t it = 0; it < iterationLimit; ++it) {
+		state = result.clone();
+
+		tbb::parallel_for(0, result.rows, [&](int y) {
+			for(int x = 0; x < result.cols; ++x)
+				result.at<unsigned char>(y, x) = evalICM(source, state, V2i(x, y), inputsWeight, flatnessWeight,
+				                                         smoothnessWeight, neighbourhood);
+		});
+	}
+
+	return result;
+}
+
+}  // namespace
+
+// ICM solver with compile-time neighbourhood stencils, compared to a reference implementation using
+// Neighbours::eval() - results have to be identical, and the runtime on a 4K depth map is reported
+BOOST_AUTO_TEST_CASE(mrf_icm_stencils) {
+	const V2i size(3840, 2160);
+	const MRF source = makeDepthMap(size);
+
+	for(auto& type : Neighbours::types()) {
+		std::unique_ptr<Neighbours> neighbours = Neighbours::create(type.second, size);
+		BOOST_CHECK_EQUAL(neighbours->type(), type.second);
+
+		cv::Mat reference, result;
+		const float referenceTime = measure([&]() { reference = solveICM(source, 1.0f, 2.0f, 2.0f, 1, *neighbours); });
+		const float resultTime =
+		    measure([&]() { result = MRF::solveICM(source, 1.0f, 2.0f, 2.0f, 1, *neighbours); });
+
+		BOOST_REQUIRE_EQUAL(result.rows, size.y);
+		BOOST_REQUIRE_EQUAL(result.cols, size.x);
+		BOOST_CHECK_EQUAL(cv::countNonZero(result != reference), 0);
+
+		BOOST_TEST_MESSAGE("ICM, " << type.first << " on " << size.x << "x" << size.y << " - reference "
+		                           << referenceTime << "ms, stencil " << resultTime << "ms");
+	}
+}
+
+// stencils have to visit the same neighbours with the same weights as the Neighbours::eval() implementation,
+// and the unchecked variant has to match the checked one inside the grid
+BOOST_AUTO_TEST_CASE(mrf_stencil_neighbours) {
+	const V2i size(5, 4);
+
+	for(auto& type : Neighbours::types()) {
+		std::unique_ptr<Neighbours> neighbours = Neighbours::create(type.second, size);
+
+		for(int y = 0; y < size.y; ++y)
+			for(int x = 0; x < size.x; ++x) {
+				std::vector<std::tuple<int, int, float>> expected, checked, unchecked;
+				neighbours->eval(V2i(x, y),
+				                 [&](const V2i& n, float w) { expected.push_back(std::make_tuple(n.x, n.y, w)); });
+
+				dispatch(type.second, [&](auto stencil) {
+					decltype(stencil)::template eval<true>(V2i(x, y), size, [&](const V2i& n, float w) {
+						checked.push_back(std::make_tuple(n.x, n.y, w));
+					});
+
+					if(x > 0 && y > 0 && x < size.x - 1 && y < size.y - 1)
+						decltype(stencil)::template eval<false>(V2i(x, y), size, [&](const V2i& n, float w) {
+							unchecked.push_back(std::make_tuple(n.x, n.y, w));
+						});
+					else
+						unchecked = checked;
+				});
+
+				BOOST_CHECK(expected == checked);
+				BOOST_CHECK(expected == unchecked);
+			}
+	}
+}
+
+namespace {
+
+/// a piecewise-constant depth map with 256 labels, and its noisy observation with a fraction of outliers
+std::pair<cv::Mat, MRF> makeNoisyDepthMap(const V2i& size) {
+	cv::Mat truth = cv::Mat::zeros(size.y, size.x, CV_8UC1);
+	MRF observed(size);
+
+	std::mt19937 gen(1);
+	std::normal_distribution<float> noise(0.0f, 8.0f);
+	std::uniform_int_distribution<int> outlier(0, 255);
+	std::uniform_real_distribution<float> random(0.0f, 1.0f);
+
+	for(int y = 0; y < size.y; ++y)
+		for(int x = 0; x < size.x; ++x) {
+			const int value = ((x / 48) * 37 + (y / 32) * 91) % 200 + 28;
+			truth.at<unsigned char>(y, x) = value;
+
+			if(random(gen) < 0.1f)
+				observed[V2i(x, y)] = MRF::Value(outlier(gen), 0.2f);
+			else
+				observed[V2i(x, y)] =
+				    MRF::Value(std::max(0, std::min(255, (int)std::round(value + noise(gen)))), 0.8f);
+		}
+
+	// make sure the full label range is present
+	observed[V2i(0, 0)] = MRF::Value(255, 0.0f);
+
+	return std::make_pair(truth, observed);
+}
+
+float meanError(const cv::Mat& result, const cv::Mat& truth) {
+	float error = 0.0f;
+	for(int y = 0; y < truth.rows; ++y)
+		for(int x = 0; x < truth.cols; ++x)
+			error += std::abs((int)result.at<unsigned char>(y, x) - (int)truth.at<unsigned char>(y, x));
+
+	return error / (float)(truth.rows * truth.cols);
+}
+
+}  // namespace
+
+// without a smoothness term, belief propagation just picks the observed values
+BOOST_AUTO_TEST_CASE(mrf_bp_data_only) {
+	const V2i size(37, 23);
+	MRF source(size);
+	for(int y = 0; y < size.y; ++y)
+		for(int x = 0; x < size.x; ++x)
+			source[V2i(x, y)] = MRF::Value((x * 7 + y * 13) % 256, 0.5f);
+
+	for(auto distance : {MRF::kTruncatedLinear, MRF::kTruncatedQuadratic}) {
+		const cv::Mat result = MRF::solveBP(source, 1.0f, 0.0f, 10.0f, 5, distance);
+
+		for(int y = 0; y < size.y; ++y)
+			for(int x = 0; x < size.x; ++x)
+				BOOST_REQUIRE_EQUAL((int)result.at<unsigned char>(y, x), source[V2i(x, y)].value);
+	}
+}
+
+// denoising of a 256-label piecewise-constant depth map, solved as a whole and in tiles
+BOOST_AUTO_TEST_CASE(mrf_bp_denoising) {
+	const std::vector<std::pair<V2i, MRF::Distance>> cases{
+	    {V2i(96, 64), MRF::kTruncatedLinear},
+	    {V2i(96, 64), MRF::kTruncatedQuadratic},
+	    {V2i(320, 240), MRF::kTruncatedLinear},
+	};
+
+	for(auto& c : cases) {
+		const V2i& size = c.first;
+		const auto input = makeNoisyDepthMap(size);
+
+		cv::Mat observed = cv::Mat::zeros(size.y, size.x, CV_8UC1);
+		for(int y = 0; y < size.y; ++y)
+			for(int x = 0; x < size.x; ++x)
+				observed.at<unsigned char>(y, x) = input.second[V2i(x, y)].value;
+
+		std::unique_ptr<Neighbours> neighbours = Neighbours::create(Neighbours::k4, size);
+		const cv::Mat icm = MRF::solveICM(input.second, 1.0f, 2.0f, 2.0f, 10, *neighbours);
+
+		cv::Mat result;
+		const float time = measure([&]() {
+			result = MRF::solveBP(input.second, 1.0f, c.second == MRF::kTruncatedLinear ? 0.5f : 0.05f, 20.0f, 10,
+			                      c.second);
+		});
+
+		const float observedError = meanError(observed, input.first);
+		const float icmError = meanError(icm, input.first);
+		const float error = meanError(result, input.first);
+
+		BOOST_CHECK_LT(error, observedError * 0.5f);
+		BOOST_CHECK_LT(error, icmError);
+
+		BOOST_TEST_MESSAGE("BP, " << (c.second == MRF::kTruncatedLinear ? "linear" : "quadratic") << " on " << size.x
+		                          << "x" << size.y << " - mean error " << error << " (observed " << observedError
+		                          << ", ICM " << icmError << "), " << time << "ms");
+	}
+}
@@ -0,0 +1,162 @@
+#include <lightfields/metadata.h>
+#include <lightfields/pattern.h>
+#include <lightfields/pattern_lut.h>
+#include <lightfields/raw.h>
+#include <lightfields/samples.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <tbb/parallel_for.h>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "common.h"
+
+using namespace lightfields;
+
+namespace {
+
+/// reads the pattern of a synthetic raw file
+Pattern makePattern(int width, int height) {
+	const boost::filesystem::path filename =
+	    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.lfr");
+	writeRaw(filename.string(), makeMetadata(width, height));
+
+	Pattern result = Pattern::fromMetadata(Raw::fromFile(filename.string()).metadata());
+
+	boost::filesystem::remove(filename);
+	return result;
+}
+
+bool matches(const PatternLUT& lut) {
+	const Pattern& pattern = lut.pattern();
+
+	bool result = true;
+	for(int y = 0; y < pattern.sensorResolution()[1]; ++y)
+		for(int x = 0; x < pattern.sensorResolution()[0]; ++x) {
+			const Pattern::Sample s1 = pattern.sample(Imath::V2i(x, y));
+			const Pattern::Sample s2 = lut.sample(x, y);
+
+			result &= s1.lensCenter == s2.lensCenter && s1.offset == s2.offset;
+		}
+
+	return result;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(pattern_lut_samples) {
+	Pattern pattern = makePattern(1920, 1080);
+
+	for(float scale : {1.0f, 1.02f}) {
+		pattern.scale(scale);
+
+		const PatternLUT lut(pattern);
+		BOOST_CHECK(matches(lut));
+
+		// the lens table covers the sensor, with a lens area of about 180 pixels
+		BOOST_CHECK_GT(lut.lensCount(), 1920u * 1080u / 200u);
+		BOOST_CHECK_LT(lut.lensCount(), 1920u * 1080u / 50u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(pattern_lut_sample_generation) {
+	const Pattern pattern = makePattern(1920, 1080);
+
+	cv::Mat image = cv::Mat::zeros(1080, 1920, CV_32FC1);
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+	for(int y = 0; y < image.rows; ++y)
+		for(int x = 0; x < image.cols; ++x)
+			image.at<float>(y, x) = dist(gen);
+
+	// reference samples, evaluating the pattern for each pixel
+	std::vector<Pattern::Sample> reference(image.rows * image.cols);
+	const float referenceTime = measure([&]() {
+		for(int y = 0; y < image.rows; ++y)
+			for(int x = 0; x < image.cols; ++x)
+				reference[y * image.cols + x] = pattern.sample(Imath::V2i(x, y));
+	});
+
+	// the first call creates the LUT, subsequent calls with the same pattern reuse it
+	Samples samples;
+	const float firstTime = measure([&]() { samples = Samples::fromPattern(pattern, image); });
+	const float cachedTime = measure([&]() { samples = Samples::fromPattern(pattern, image); });
+
+	BOOST_CHECK_EQUAL(PatternLUT::get(pattern).get(), PatternLUT::get(pattern).get());
+
+	BOOST_REQUIRE_EQUAL(samples.size(), reference.size());
+	bool match = true;
+	auto it = samples.begin();
+	for(int y = 0; y < image.rows; ++y)
+		for(int x = 0; x < image.cols; ++x, ++it) {
+			const Pattern::Sample& ref = reference[y * image.cols + x];
+
+			match &= it->xy == ref.lensCenter && it->uv == ref.offset;
+			match &= it->color == Samples::Color((x % 2) + (y % 2));
+			match &= it->value[it->color] == image.at<float>(y, x);
+		}
+	BOOST_CHECK(match);
+
+	BOOST_TEST_MESSAGE("samples of 1920x1080 image - pattern evaluation " << referenceTime << "ms, first call "
+	                                                                      << firstTime << "ms, cached LUT "
+	                                                                      << cachedTime << "ms");
+}
+
+BOOST_AUTO_TEST_CASE(pattern_lut_persistence) {
+	Pattern pattern = makePattern(640, 480);
+	const PatternLUT lut(pattern);
+
+	// in-memory round trip
+	std::stringstream data;
+	lut.save(data);
+
+	std::unique_ptr<PatternLUT> loaded = PatternLUT::load(data, pattern);
+	BOOST_REQUIRE(loaded != nullptr);
+	BOOST_CHECK_EQUAL(loaded->lensCount(), lut.lensCount());
+	BOOST_CHECK(matches(*loaded));
+
+	// a LUT can't be loaded for a different pattern, or from truncated data
+	Pattern scaled = pattern;
+	scaled.scale(1.01f);
+	BOOST_CHECK_NE(PatternLUT::filename(pattern), PatternLUT::filename(scaled));
+
+	data.clear();
+	data.seekg(0);
+	BOOST_CHECK(PatternLUT::load(data, scaled) == nullptr);
+
+	std::stringstream truncated(data.str().substr(0, data.str().size() - 10));
+	BOOST_CHECK(PatternLUT::load(truncated, pattern) == nullptr);
+
+	// on-disk cache
+	const boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	scaled.scale(1.01f);
+
+	std::shared_ptr<const PatternLUT> cached = PatternLUT::get(scaled, dir);
+	BOOST_REQUIRE(boost::filesystem::exists(dir / PatternLUT::filename(scaled)));
+
+	{
+		std::ifstream file((dir / PatternLUT::filename(scaled)).string(), std::ios::binary);
+		loaded = PatternLUT::load(file, scaled);
+	}
+	BOOST_REQUIRE(loaded != nullptr);
+	BOOST_CHECK(matches(*loaded));
+
+	boost::filesystem::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(pattern_lut_concurrent_get) {
+	// a pattern not used by any other test, to make sure the LUT is built here
+	Pattern pattern = makePattern(640, 480);
+	pattern.scale(0.97f);
+
+	// concurrent requests from inside a parallel_for (the LUT construction itself runs a nested parallel_for)
+	std::vector<std::shared_ptr<const PatternLUT>> luts(64);
+	tbb::parallel_for(std::size_t(0), luts.size(), [&](std::size_t i) { luts[i] = PatternLUT::get(pattern); });
+
+	// all requests share a single instance
+	for(auto& lut : luts)
+		BOOST_CHECK_EQUAL(lut.get(), luts[0].get());
+	BOOST_CHECK(matches(*luts[0]));
+}
@@ -0,0 +1,102 @@
+#include <lightfields/bayer.h>
+#include <lightfields/metadata.h>
+#include <lightfields/raw.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+#include "common.h"
+
+using namespace lightfields;
+
+BOOST_AUTO_TEST_CASE(raw_mapped_reader) {
+	const boost::filesystem::path filename =
+	    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.lfr");
+
+	// odd width, to test unpacking of rows starting in the middle of a triplet
+	const int width = 1001;
+	const int height = 800;
+	const std::vector<uint16_t> values = writeRaw(filename.string(), makeMetadata(width, height));
+
+	// the stream reader
+	Raw streamed;
+	const float streamTime = measure([&]() {
+		std::ifstream file(filename.string(), std::ios::binary);
+		file >> streamed;
+	});
+
+	// the memory-mapped reader
+	Raw mapped;
+	const float mappedTime = measure([&]() { mapped = Raw::fromFile(filename.string()); });
+
+	BOOST_REQUIRE(streamed.image() != nullptr);
+	BOOST_REQUIRE(mapped.image() != nullptr);
+	BOOST_REQUIRE_EQUAL(streamed.imageSize(), mapped.imageSize());
+	BOOST_CHECK(std::equal(streamed.image(), streamed.image() + streamed.imageSize(), mapped.image()));
+
+	BOOST_CHECK_EQUAL(streamed.metadata().header(), mapped.metadata().header());
+	BOOST_CHECK_EQUAL(streamed.metadata().metadata(), mapped.metadata().metadata());
+	BOOST_CHECK_EQUAL(mapped.metadata().privateMetadata()["camera"]["serialNumber"].get<std::string>(), "A123");
+
+	// the 16-bit decode
+	const Bayer bayer(mapped.metadata().metadata());
+	cv::Mat decoded;
+	const float decodeTime = measure([&]() { decoded = bayer.decode(mapped.image()); });
+
+	BOOST_REQUIRE_EQUAL(decoded.rows, height);
+	BOOST_REQUIRE_EQUAL(decoded.cols, width);
+	bool match = true;
+	for(int y = 0; y < height; ++y)
+		for(int x = 0; x < width; ++x)
+			match &= decoded.at<uint16_t>(y, x) == values[y * width + x];
+	BOOST_CHECK(match);
+
+	// the fused float decode should match the two-pass conversion exactly
+	for(auto flags : {Bayer::kNone, Bayer::kCorrectGain}) {
+		cv::Mat reference, fused;
+		const float twoPassTime =
+		    measure([&]() { reference = bayer.uint16ToFloatMat(bayer.decode(mapped.image()), flags); });
+		const float fusedTime = measure([&]() { fused = bayer.decode(mapped.image(), flags); });
+
+		BOOST_REQUIRE_EQUAL(fused.rows, height);
+		BOOST_REQUIRE_EQUAL(fused.cols, width);
+
+		match = true;
+		for(int y = 0; y < height; ++y)
+			for(int x = 0; x < width; ++x)
+				match &= fused.at<float>(y, x) == reference.at<float>(y, x);
+		BOOST_CHECK(match);
+
+		BOOST_TEST_MESSAGE("float conversion (flags " << flags << ") - two pass " << twoPassTime << "ms, fused "
+		                                              << fusedTime << "ms");
+	}
+
+	BOOST_TEST_MESSAGE("raw reading - stream " << streamTime << "ms, memory-mapped " << mappedTime << "ms, decode "
+	                                           << decodeTime << "ms");
+
+	// release the mapping before removing the file
+	mapped = Raw();
+	boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(raw_mapped_reader_errors) {
+	const boost::filesystem::path filename =
+	    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.lfr");
+
+	writeRaw(filename.string(), makeMetadata(64, 32));
+
+	// truncate the image block
+	boost::filesystem::resize_file(filename, boost::filesystem::file_size(filename) - 100);
+	BOOST_CHECK_THROW(Raw::fromFile(filename.string()), std::runtime_error);
+
+	// not a lytro file
+	{
+		std::ofstream file(filename.string(), std::ios::binary);
+		file << "this is not a raw file, but it is long enough to be read as a block header";
+	}
+	BOOST_CHECK_THROW(Raw::fromFile(filename.string()), std::runtime_error);
+
+	boost::filesystem::remove(filename);
+	BOOST_CHECK_THROW(Raw::fromFile(filename.string()), std::runtime_error);
+}
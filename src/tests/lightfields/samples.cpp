@@ -0,0 +1,105 @@
+#include <lightfields/bayer.h>
+#include <lightfields/metadata.h>
+#include <lightfields/pattern.h>
+#include <lightfields/pattern_lut.h>
+#include <lightfields/raw.h>
+#include <lightfields/samples.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+#include "common.h"
+
+using namespace lightfields;
+
+namespace {
+
+/// radial falloff, reaching zero in the corners of the sensor
+cv::Mat makeVignetting(int rows, int cols) {
+	cv::Mat result = cv::Mat::zeros(rows, cols, CV_32FC1);
+
+	for(int y = 0; y < rows; ++y)
+		for(int x = 0; x < cols; ++x) {
+			const float dx = (float)x / (float)cols - 0.5f;
+			const float dy = (float)y / (float)rows - 0.5f;
+
+			result.at<float>(y, x) = std::max(0.0f, 1.0f - (dx * dx + dy * dy) * 2.2f);
+		}
+
+	return result;
+}
+
+bool equal(const Samples::Sample& s1, const Samples::Sample& s2) {
+	return s1.xy == s2.xy && s1.uv == s2.uv && s1.color == s2.color && s1.value == s2.value;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(samples_from_raw) {
+	const boost::filesystem::path filename =
+	    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.lfr");
+	writeRaw(filename.string(), makeMetadata(1920, 1080));
+
+	const Raw raw = Raw::fromFile(filename.string());
+	const Bayer bayer(raw.metadata().metadata());
+
+	Pattern pattern = Pattern::fromMetadata(raw.metadata());
+	pattern.scale(1.01f);
+	const std::shared_ptr<const PatternLUT> lut = PatternLUT::get(pattern);
+
+	const cv::Mat vignetting = makeVignetting(1080, 1920);
+
+	Samples::Filter filter;
+	filter.uvOffset = 0.3f;
+	filter.xyScale = 1.1f;
+	filter.uvThreshold = 0.8f;
+
+	for(bool correctVignetting : {false, true}) {
+		// the individual steps, as done by the separate nodes
+		Samples reference;
+		const float referenceTime = measure([&]() {
+			cv::Mat image = bayer.decode(raw.image(), Bayer::kCorrectGain);
+
+			if(correctVignetting)
+				for(int y = 0; y < image.rows; ++y)
+					for(int x = 0; x < image.cols; ++x)
+						image.at<float>(y, x) /= vignetting.at<float>(y, x);
+
+			reference = Samples::fromPattern(*lut, image);
+			reference.offset(filter.uvOffset);
+			reference.scale(filter.xyScale);
+			reference.threshold(filter.uvThreshold);
+			reference.filterInvalid();
+		});
+
+		// and the fused conversion
+		Samples fused;
+		const float fusedTime = measure([&]() {
+			fused = Samples::fromRaw(raw, *lut, Bayer::kCorrectGain, correctVignetting ? vignetting : cv::Mat(),
+			                         filter);
+		});
+
+		BOOST_CHECK_EQUAL(fused.sensorSize(), reference.sensorSize());
+
+		// zero vignetting values produce infinite (or NaN) values in the reference, which are discarded by the fused
+		// conversion
+		std::vector<Samples::Sample> expected;
+		for(auto& s : reference)
+			if(std::isfinite(s.value[s.color]))
+				expected.push_back(s);
+
+		BOOST_REQUIRE_EQUAL(fused.size(), expected.size());
+		BOOST_CHECK(std::equal(fused.begin(), fused.end(), expected.begin(), equal));
+		BOOST_CHECK_LT(fused.size(), 1920u * 1080u);
+
+		BOOST_TEST_MESSAGE("raw to samples " << (correctVignetting ? "with" : "without")
+		                                     << " vignetting correction - separate steps " << referenceTime
+		                                     << "ms, fused " << fusedTime << "ms");
+	}
+
+	BOOST_CHECK_THROW(Samples::fromRaw(raw, *lut, Bayer::kNone, makeVignetting(100, 100), filter),
+	                  std::runtime_error);
+
+	boost::filesystem::remove(filename);
+}
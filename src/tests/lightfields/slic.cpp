@@ -0,0 +1,144 @@
+#include <lightfields/slic_superpixels.h>
+#include <tbb/blocked_range2d.h>
+#include <tbb/parallel_for.h>
+
+#include <boost/test/unit_test.hpp>
+#include <random>
+
+#include "common.h"
+
+using namespace lightfields;
+
+namespace {
+
+/// a synthetic image with regions of different colours, smooth gradients and noise
+cv::Mat makeImage(int rows, int cols) {
+	cv::Mat result = cv::Mat::zeros(rows, cols, CV_8UC3);
+
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> noise(-10, 10);
+
+	for(int y = 0; y < rows; ++y)
+		for(int x = 0; x < cols; ++x) {
+			const int region = ((x * x) / 7000 + (y / 97) * 3) % 5;
+
+			unsigned char* ptr = result.ptr<unsigned char>(y, x);
+			for(int a = 0; a < 3; ++a)
+				ptr[a] = std::max(0, std::min(255, region * 40 + a * 20 + (x + y) / 50 % 30 + noise(gen)));
+		}
+
+	return result;
+}
+
+/// reference labelling - all centres evaluated for each block of the image
+void referenceLabel(const cv::Mat& in, Grid<SlicSuperpixels::Label>& labels,
+                    const Grid<SlicSuperpixels::Center>& centers, const SlicSuperpixels::Metric& metric) {
+	for(auto& l : labels.container())
+		l = SlicSuperpixels::Label();
+
+	tbb::parallel_for(tbb::blocked_range2d<int>(0, in.rows, 0, in.cols), [&](const tbb::blocked_range2d<int>& range) {
+		for(std::size_t id = 0; id < centers.container().size(); ++id) {
+			const SlicSuperpixels::Center& center = centers.container()[id];
+
+			for(int y = std::max(range.rows().begin(), center.row - metric.S());
+			    y < std::min(range.rows().end(), center.row + metric.S() + 1); ++y)
+				for(int x = std::max(range.cols().begin(), center.col - metric.S());
+				    x < std::min(range.cols().end(), center.col + metric.S() + 1); ++x) {
+					const float dist = metric(center, in, y, x);
+					if(labels(y, x).metric > dist)
+						labels(y, x) = SlicSuperpixels::Label(id, dist);
+				}
+		}
+	});
+}
+
+/// reference centre update - a serial pass over all pixels
+void referenceFindCenters(const cv::Mat& in, const Grid<SlicSuperpixels::Label>& labels,
+                          Grid<SlicSuperpixels::Center>& centers) {
+	std::vector<SlicSuperpixels::Center> sum(centers.container().size());
+	std::vector<int> count(centers.container().size(), 0);
+
+	for(int row = 0; row < in.rows; ++row)
+		for(int col = 0; col < in.cols; ++col) {
+			sum[labels(row, col).id] += SlicSuperpixels::Center(in, row, col);
+			count[labels(row, col).id]++;
+		}
+
+	for(std::size_t a = 0; a < sum.size(); ++a)
+		if(count[a] > 0) {
+			sum[a] /= count[a];
+			centers.container()[a] = sum[a];
+		}
+}
+
+bool equal(const Grid<SlicSuperpixels::Label>& l1, const Grid<SlicSuperpixels::Label>& l2) {
+	for(std::size_t a = 0; a < l1.container().size(); ++a)
+		if(l1.container()[a].id != l2.container()[a].id)
+			return false;
+	return true;
+}
+
+bool equal(const Grid<SlicSuperpixels::Center>& c1, const Grid<SlicSuperpixels::Center>& c2) {
+	for(std::size_t a = 0; a < c1.container().size(); ++a) {
+		const SlicSuperpixels::Center& i1 = c1.container()[a];
+		const SlicSuperpixels::Center& i2 = c2.container()[a];
+
+		if(i1.row != i2.row || i1.col != i2.col || i1.color != i2.color)
+			return false;
+	}
+	return true;
+}
+
+}  // namespace
+
+// the fused iteration has to give the same results as the separate labelling and centre update passes,
+// and the average movement of the centres has to drop below a threshold before the iteration limit
+BOOST_AUTO_TEST_CASE(slic_fused_iteration) {
+	const cv::Mat in = makeImage(900, 1200);
+	const SlicSuperpixels::Image image(in);
+
+	const int S = SlicSuperpixels::initS(in.rows, in.cols, 1000);
+	const SlicSuperpixels::Metric metric(S, 10.0f);
+
+	Grid<SlicSuperpixels::Center> referenceCenters = SlicSuperpixels::initPixels(in, S);
+	Grid<SlicSuperpixels::Center> centers = referenceCenters;
+
+	Grid<SlicSuperpixels::Label> referenceLabels(in.rows, in.cols);
+	Grid<SlicSuperpixels::Label> labels(in.rows, in.cols);
+
+	const unsigned iterationLimit = 50;
+	const float threshold = 1.0f;
+
+	float referenceTime = 0.0f, time = 0.0f;
+	unsigned iteration = 0;
+	float movement = std::numeric_limits<float>::max();
+	while(iteration < iterationLimit && movement >= threshold) {
+		referenceTime += measure([&]() {
+			referenceLabel(in, referenceLabels, referenceCenters, metric);
+			referenceFindCenters(in, referenceLabels, referenceCenters);
+		});
+
+		time += measure([&]() { movement = SlicSuperpixels::iterate(image, labels, centers, metric); });
+
+		BOOST_REQUIRE(equal(labels, referenceLabels));
+		BOOST_REQUIRE(equal(centers, referenceCenters));
+
+		++iteration;
+	}
+
+	BOOST_CHECK_LT(iteration, iterationLimit);
+
+	// separate passes on the planar image give the same results as the fused iteration
+	Grid<SlicSuperpixels::Center> separateCenters = centers;
+	Grid<SlicSuperpixels::Label> separateLabels(in.rows, in.cols);
+
+	SlicSuperpixels::label(image, separateLabels, separateCenters, metric);
+	const float separateMovement = SlicSuperpixels::findCenters(image, separateLabels, separateCenters);
+
+	BOOST_CHECK_EQUAL(SlicSuperpixels::iterate(image, labels, centers, metric), separateMovement);
+	BOOST_CHECK(equal(labels, separateLabels));
+	BOOST_CHECK(equal(centers, separateCenters));
+
+	BOOST_TEST_MESSAGE("SLIC on " << in.cols << "x" << in.rows << ", converged after " << iteration
+	                              << " iterations - reference " << referenceTime << "ms, fused " << time << "ms");
+}
@@ -0,0 +1,74 @@
+#include <lua/datatypes/chunk_cache.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <lauxlib.h>
+#include <lualib.h>
+
+using possumwood::lua::ChunkCache;
+
+namespace {
+
+/// runs a source in a new state, returning the value of the global "result"
+double run(const std::string& src) {
+	lua_State* state = luaL_newstate();
+	luaL_openlibs(state);
+
+	double result = 0.0;
+	try {
+		ChunkCache::instance().run(state, src);
+
+		lua_getglobal(state, "result");
+		result = lua_tonumber(state, -1);
+	}
+	catch(...) {
+		lua_close(state);
+		throw;
+	}
+
+	lua_close(state);
+	return result;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(lua_chunk_cache) {
+	BOOST_CHECK_EQUAL(run("result = 1 + 2"), 3.0);
+	BOOST_CHECK_EQUAL(run("result = 1 + 2"), 3.0);
+
+	// syntax and runtime errors are reported as exceptions
+	BOOST_CHECK_THROW(run("result = = 1"), std::runtime_error);
+	BOOST_CHECK_THROW(run("error('failed')"), std::runtime_error);
+	// including errors without a message
+	BOOST_CHECK_THROW(run("error({})"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(lua_chunk_cache_persistence) {
+	const boost::filesystem::path dir =
+	    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("possumwood_lua_%%%%-%%%%");
+	const boost::filesystem::path original = ChunkCache::instance().directory();
+	ChunkCache::instance().setDirectory(dir);
+
+	const std::string src = "result = 6 * 7 -- persistence";
+	BOOST_CHECK_EQUAL(run(src), 42.0);
+
+	BOOST_REQUIRE(boost::filesystem::is_directory(dir));
+	BOOST_REQUIRE(boost::filesystem::directory_iterator(dir) != boost::filesystem::directory_iterator());
+	const boost::filesystem::path file = boost::filesystem::directory_iterator(dir)->path();
+	const uintmax_t size = boost::filesystem::file_size(file);
+
+	// evict the chunk from the in-memory cache
+	for(unsigned i = 0; i < 100; ++i)
+		BOOST_CHECK_EQUAL(run("result = " + std::to_string(i)), (double)i);
+
+	// truncate the bytecode, keeping the header intact
+	boost::filesystem::resize_file(file, size - 16);
+
+	// the corrupted bytecode is dropped, and the source compiled (and stored) again
+	BOOST_CHECK_EQUAL(run(src), 42.0);
+	BOOST_CHECK_EQUAL(run(src), 42.0);
+	BOOST_CHECK_EQUAL(boost::filesystem::file_size(file), size);
+
+	ChunkCache::instance().setDirectory(original);
+	boost::filesystem::remove_all(dir);
+}
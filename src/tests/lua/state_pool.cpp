@@ -0,0 +1,47 @@
+#include <lua/datatypes/context.h>
+#include <lua/datatypes/state_pool.h>
+
+#include <boost/test/unit_test.hpp>
+#include <lauxlib.h>
+
+using possumwood::lua::StatePool;
+
+namespace {
+
+void run(possumwood::lua::State& state, const std::string& src) {
+	const int err = luaL_dostring(state, src.c_str());
+	if(err != 0)
+		BOOST_ERROR(lua_tostring(state, -1));
+	BOOST_REQUIRE_EQUAL(err, 0);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(lua_state_pool_reset) {
+	const possumwood::lua::Context context;
+
+	{
+		possumwood::lua::State state = StatePool::instance().acquire(context);
+
+		// modify the globals, library tables and package.loaded
+		run(state,
+		    "value = 1\n"
+		    "string.upper = nil\n"
+		    "math.extra = 5\n"
+		    "package.loaded.injected = {}\n"
+		    "setmetatable(_G, {__index = function() return 10 end})\n");
+	}
+
+	// the state is returned to the pool on destruction
+	BOOST_REQUIRE_GE(StatePool::instance().size(), 1u);
+
+	possumwood::lua::State state = StatePool::instance().acquire(context);
+
+	// all modifications are reverted
+	run(state,
+	    "assert(getmetatable(_G) == nil)\n"
+	    "assert(value == nil)\n"
+	    "assert(string.upper('a') == 'A')\n"
+	    "assert(math.extra == nil)\n"
+	    "assert(package.loaded.injected == nil)\n");
+}
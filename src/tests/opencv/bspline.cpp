@@ -0,0 +1,205 @@
+#include <opencv/bspline.inl>
+#include <tbb/task_arena.h>
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <random>
+
+using possumwood::opencv::BSpline;
+
+namespace {
+
+double basis(double t, unsigned k) {
+	switch(k) {
+		case 0:
+			return (1.0 - t) * (1.0 - t) * (1.0 - t) / 6.0;
+		case 1:
+			return (3.0 * t * t * t - 6.0 * t * t + 4.0) / 6.0;
+		case 2:
+			return (-3.0 * t * t * t + 3.0 * t * t + 3.0 * t + 1.0) / 6.0;
+		default:
+			return t * t * t / 6.0;
+	}
+}
+
+/// The original per-sample accumulation of a 2D spline on the 0..1 range, on an explicit grid of
+/// (subdiv + 3) x (subdiv + 3) control points (i.e., without any aliasing between control rows).
+class Reference {
+  public:
+	Reference(unsigned subdiv) : m_subdiv(subdiv), m_controls((subdiv + 3) * (subdiv + 3)) {
+	}
+
+	void addSample(double x, double y, double value) {
+		visit(x, y, [&](std::size_t index, double weight) {
+			m_controls[index].first += weight * value;
+			m_controls[index].second += weight;
+		});
+	}
+
+	double sample(double x, double y) const {
+		double result = 0.0;
+		visit(x, y, [&](std::size_t index, double weight) {
+			if(m_controls[index].second > 0.0)
+				result += m_controls[index].first / m_controls[index].second * weight;
+		});
+
+		return result;
+	}
+
+  private:
+	template <typename FN>
+	void visit(double x, double y, const FN& fn) const {
+		const double coords[2] = {x * m_subdiv, y * m_subdiv};
+
+		unsigned offset[2];
+		double local[2];
+		for(unsigned d = 0; d < 2; ++d) {
+			offset[d] = std::min(std::floor(coords[d]), (double)(m_subdiv - 1));
+			local[d] = coords[d] - offset[d];
+		}
+
+		for(unsigned kx = 0; kx < 4; ++kx)
+			for(unsigned ky = 0; ky < 4; ++ky)
+				fn((offset[0] + kx) * (m_subdiv + 3) + offset[1] + ky, basis(local[0], kx) * basis(local[1], ky));
+	}
+
+	unsigned m_subdiv;
+	std::vector<std::pair<float, float>> m_controls;  // same precision as BSpline
+};
+
+struct Sample {
+	std::array<double, 2> coords;
+	double value;
+};
+
+/// random samples of a smooth function with noise, including samples on the boundaries of the range
+std::vector<Sample> makeSamples(std::size_t count) {
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> coord(0.0, 1.0);
+	std::uniform_real_distribution<double> noise(-0.1, 0.1);
+
+	std::vector<Sample> result(count);
+	for(std::size_t i = 0; i < count; ++i) {
+		result[i].coords = {{coord(gen), coord(gen)}};
+		if(i % 10 == 0)
+			result[i].coords[i % 20 == 0 ? 0 : 1] = (i % 40 < 20) ? 0.0 : 1.0;
+
+		result[i].value =
+		    std::sin(result[i].coords[0] * 5.0) * std::cos(result[i].coords[1] * 3.0) + 2.0 + noise(gen);
+	}
+
+	return result;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(bspline_fit_reference) {
+	const std::vector<Sample> samples = makeSamples(3000);
+
+	for(unsigned subdiv : {1u, 2u, 3u, 5u, 8u, 13u}) {
+		Reference reference(subdiv);
+		BSpline<2> serial(subdiv);
+		for(auto& s : samples) {
+			reference.addSample(s.coords[0], s.coords[1], s.value);
+			serial.addSample(s.coords, s.value);
+		}
+
+		// every second sample is skipped by the functor
+		BSpline<2> tiled(subdiv);
+		tiled.addSamples(samples.size() * 2, [&](std::size_t i, std::array<double, 2>& coords, double& value) {
+			if(i % 2 == 1)
+				return false;
+
+			coords = samples[i / 2].coords;
+			value = samples[i / 2].value;
+			return true;
+		});
+
+		std::mt19937 gen(2);
+		std::uniform_real_distribution<double> coord(0.0, 1.0);
+		for(unsigned i = 0; i < 200; ++i) {
+			const std::array<double, 2> coords{{coord(gen), coord(gen)}};
+			const double ref = reference.sample(coords[0], coords[1]);
+
+			BOOST_CHECK_CLOSE(serial.sample(coords), ref, 1e-3);
+			BOOST_CHECK_CLOSE(tiled.sample(coords), ref, 1e-3);
+		}
+
+		// separable evaluation on a grid, added to the existing values
+		const std::size_t width = 37, height = 23;
+		std::vector<double> grid(width * height, 1.0);
+		tiled.addGrid(width, height, grid.data());
+
+		for(std::size_t y = 0; y < height; ++y)
+			for(std::size_t x = 0; x < width; ++x)
+				BOOST_CHECK_CLOSE(grid[y * width + x],
+				                  reference.sample((double)x / (width - 1), (double)y / (height - 1)) + 1.0, 1e-3);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(bspline_fit_deterministic) {
+	const std::vector<Sample> samples = makeSamples(5000);
+
+	auto fit = [&]() {
+		BSpline<2> result(7);
+		result.addSamples(samples.size(), [&](std::size_t i, std::array<double, 2>& coords, double& value) {
+			coords = samples[i].coords;
+			value = samples[i].value;
+			return true;
+		});
+
+		return result;
+	};
+
+	const BSpline<2> parallel = fit();
+
+	tbb::task_arena single(1);
+	BSpline<2> serial(7);
+	single.execute([&]() { serial = fit(); });
+
+	BOOST_CHECK(parallel == serial);
+	BOOST_CHECK(parallel == fit());
+}
+
+BOOST_AUTO_TEST_CASE(bspline_fit_4d) {
+	std::mt19937 gen(3);
+	std::uniform_real_distribution<double> coord(-1.0, 1.0);
+
+	std::vector<std::pair<std::array<double, 4>, double>> samples(2000);
+	for(auto& s : samples) {
+		s.first = {{coord(gen), coord(gen), coord(gen), coord(gen)}};
+		s.second = s.first[0] * s.first[1] + s.first[2] - s.first[3] * s.first[3];
+	}
+
+	const std::array<double, 4> min{{-1, -1, -1, -1}}, max{{1, 1, 1, 1}};
+
+	BSpline<4> serial(3, min, max);
+	for(auto& s : samples)
+		serial.addSample(s.first, s.second);
+
+	BSpline<4> tiled(3, min, max);
+	tiled.addSamples(samples.size(), [&](std::size_t i, std::array<double, 4>& coords, double& value) {
+		coords = samples[i].first;
+		value = samples[i].second;
+		return true;
+	});
+
+	for(unsigned i = 0; i < 200; ++i) {
+		const std::array<double, 4> coords{{coord(gen), coord(gen), coord(gen), coord(gen)}};
+		BOOST_CHECK_SMALL(tiled.sample(coords) - serial.sample(coords), 1e-9);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(bspline_errors) {
+	BSpline<2> spline(4);
+
+	BOOST_CHECK_THROW(spline.addSample({{1.5, 0.5}}, 1.0), std::runtime_error);
+	BOOST_CHECK_THROW(spline.sample({{0.5, -0.1}}), std::runtime_error);
+	BOOST_CHECK_THROW(spline.addSamples(1,
+	                                    [](std::size_t, std::array<double, 2>& coords, double& value) {
+		                                    coords = {{0.5, 2.0}};
+		                                    value = 1.0;
+		                                    return true;
+	                                    }),
+	                  std::runtime_error);
+}
@@ -0,0 +1,90 @@
+#include <opencv/hdr_merge.h>
+
+#include <boost/test/unit_test.hpp>
+#include <opencv2/photo.hpp>
+
+namespace {
+
+const std::vector<float> s_exposures{1.0f / 30.0f, 1.0f / 8.0f, 0.5f};
+
+/// a monotonic (and strictly positive) response curve, different for each channel
+cv::Mat makeResponse() {
+	cv::Mat result(256, 1, CV_32FC3);
+	for(int z = 0; z < 256; ++z)
+		result.at<cv::Vec3f>(z) = cv::Vec3f((z + 1) / 128.0f, (z + 1) / 100.0f, std::pow((z + 1) / 128.0f, 1.2f));
+
+	return result;
+}
+
+/// random brackets, with a fully clipped black and white pixel, and a pixel clipped only in some exposures
+std::vector<cv::Mat> makeBrackets() {
+	cv::RNG rng(1);
+
+	std::vector<cv::Mat> result;
+	for(std::size_t e = 0; e < s_exposures.size(); ++e) {
+		cv::Mat bracket(12, 16, CV_8UC3);
+		rng.fill(bracket, cv::RNG::UNIFORM, 0, 256);
+
+		bracket.at<cv::Vec3b>(0, 0) = cv::Vec3b(0, 0, 0);
+		bracket.at<cv::Vec3b>(1, 0) = cv::Vec3b(255, 255, 255);
+		bracket.at<cv::Vec3b>(2, 0) = e == 0 ? cv::Vec3b(0, 0, 0) : cv::Vec3b(255, 255, 255);
+
+		result.push_back(bracket);
+	}
+
+	return result;
+}
+
+void checkEqual(const cv::Mat& result, const cv::Mat& reference) {
+	BOOST_REQUIRE_EQUAL(result.type(), reference.type());
+	BOOST_REQUIRE(result.size() == reference.size());
+
+	// no NaNs or infinities, even for clipped pixels
+	BOOST_CHECK(cv::checkRange(result));
+
+	// identical up to floating point rounding
+	BOOST_CHECK_LE(cv::norm(result, reference, cv::NORM_INF), cv::norm(reference, cv::NORM_INF) * 1e-4);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(hdr_merge_debevec) {
+	const possumwood::opencv::CameraResponse response(makeResponse(), s_exposures);
+	const std::vector<cv::Mat> brackets = makeBrackets();
+
+	const possumwood::opencv::HDRMerge merge(response, possumwood::opencv::HDRMerge::kDebevec);
+	BOOST_CHECK_EQUAL(merge.exposureCount(), s_exposures.size());
+
+	cv::Mat reference;
+	cv::createMergeDebevec()->process(brackets, reference, s_exposures, response.matrix());
+
+	checkEqual(merge.process(brackets), reference);
+}
+
+BOOST_AUTO_TEST_CASE(hdr_merge_robertson) {
+	const possumwood::opencv::CameraResponse response(makeResponse(), s_exposures);
+	const std::vector<cv::Mat> brackets = makeBrackets();
+
+	const possumwood::opencv::HDRMerge merge(response, possumwood::opencv::HDRMerge::kRobertson);
+
+	cv::Mat reference;
+	cv::createMergeRobertson()->process(brackets, reference, s_exposures, response.matrix());
+
+	// fully clipped pixels have zero weight in all exposures
+	checkEqual(merge.process(brackets), reference);
+}
+
+BOOST_AUTO_TEST_CASE(hdr_merge_errors) {
+	const possumwood::opencv::CameraResponse response(makeResponse(), s_exposures);
+	const possumwood::opencv::HDRMerge merge(response, possumwood::opencv::HDRMerge::kDebevec);
+
+	// wrong number of brackets
+	std::vector<cv::Mat> brackets = makeBrackets();
+	brackets.pop_back();
+	BOOST_CHECK_THROW(merge.process(brackets), std::runtime_error);
+
+	// wrong type
+	brackets = makeBrackets();
+	brackets[1].convertTo(brackets[1], CV_32F);
+	BOOST_CHECK_THROW(merge.process(brackets), std::runtime_error);
+}
@@ -164,3 +164,120 @@ BOOST_AUTO_TEST_CASE(actions_single_node_value) {
 }
 
 /// TODO: connections and evaluation tests
+
+BOOST_AUTO_TEST_CASE(actions_bulk_loading) {
+	possumwood::AppCore app;
+
+	// make sure the static handle is initialised
+	additionNode();
+
+	// a long chain of nodes
+	const std::size_t count = 10000;
+
+	nlohmann::json scene;
+	scene["nodes"] = nlohmann::json::object();
+	scene["connections"] = nlohmann::json::array();
+	for(std::size_t n = 0; n < count; ++n) {
+		const std::string name = "add_" + std::to_string(n);
+		scene["nodes"][name] = {{"name", name}, {"type", "addition"}};
+
+		if(n > 0)
+			scene["connections"].push_back({{"out_node", "add_" + std::to_string(n - 1)},
+			                                {"out_port", "output"},
+			                                {"in_node", name},
+			                                {"in_port", "input_1"}});
+	}
+
+	unsigned dirtyCount = 0;
+	app.graph().onDirty([&dirtyCount]() { ++dirtyCount; });
+
+	dependency_graph::Selection selection;
+	BOOST_REQUIRE_NO_THROW(possumwood::actions::fromJson(app.graph(), selection, scene));
+
+	BOOST_CHECK_EQUAL(app.graph().nodes().size(), count);
+	BOOST_CHECK_EQUAL(app.graph().connections().size(), count - 1);
+	BOOST_CHECK_EQUAL(selection.nodes().size(), count);
+
+	// the whole scene is loaded as a single undoable action, notifying about dirtiness only once
+	BOOST_CHECK_EQUAL(app.undoStack().undoActionCount(), 1u);
+	BOOST_CHECK_EQUAL(dirtyCount, 1u);
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().undo());
+	BOOST_CHECK(app.graph().nodes().empty());
+	BOOST_CHECK(app.graph().connections().empty());
+	BOOST_CHECK_EQUAL(dirtyCount, 2u);
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().redo());
+	BOOST_CHECK_EQUAL(app.graph().nodes().size(), count);
+	BOOST_CHECK_EQUAL(app.graph().connections().size(), count - 1);
+	BOOST_CHECK_EQUAL(dirtyCount, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(actions_bulk_loading_values) {
+	possumwood::AppCore app;
+
+	// make sure the static handle is initialised
+	additionNode();
+
+	// a chain of nodes, each adding 1 to the output of the previous one
+	const std::size_t count = 100;
+
+	nlohmann::json scene;
+	scene["nodes"] = nlohmann::json::object();
+	scene["connections"] = nlohmann::json::array();
+	for(std::size_t n = 0; n < count; ++n) {
+		const std::string name = "add_" + std::to_string(n);
+		scene["nodes"][name] = {{"name", name}, {"type", "addition"}, {"ports", {{"input_2", 1.0f}}}};
+
+		if(n > 0)
+			scene["connections"].push_back({{"out_node", "add_" + std::to_string(n - 1)},
+			                                {"out_port", "output"},
+			                                {"in_node", name},
+			                                {"in_port", "input_1"}});
+	}
+
+	auto lastOutput = [&app]() -> float {
+		for(auto& n : app.graph().nodes())
+			if(n.name() == "add_99")
+				return n.port(2).get<float>();
+
+		BOOST_FAIL("node add_99 not found");
+		return 0.0f;
+	};
+
+	dependency_graph::Selection selection;
+	BOOST_REQUIRE_NO_THROW(possumwood::actions::fromJson(app.graph(), selection, scene));
+	BOOST_CHECK_EQUAL(app.undoStack().undoActionCount(), 1u);
+	BOOST_CHECK_EQUAL(lastOutput(), (float)count);
+
+	// the values are set again on redo
+	BOOST_REQUIRE_NO_THROW(app.undoStack().undo());
+	BOOST_CHECK(app.graph().nodes().empty());
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().redo());
+	BOOST_CHECK_EQUAL(lastOutput(), (float)count);
+
+	// a failing connection stops the whole loading, and leaves the graph and the undo stack unchanged
+	nlohmann::json broken = scene;
+	broken["connections"][10]["in_port"] = "missing";
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().undo());
+	BOOST_CHECK_THROW(possumwood::actions::fromJson(app.graph(), selection, broken), std::runtime_error);
+	BOOST_CHECK(app.graph().nodes().empty());
+	BOOST_CHECK_EQUAL(app.undoStack().undoActionCount(), 0u);
+
+	// unless the loading is asked to continue, reporting the error and skipping the failed connection
+	dependency_graph::State state;
+	BOOST_REQUIRE_NO_THROW(state = possumwood::actions::fromJson(app.graph(), selection, broken, false));
+	BOOST_CHECK(state.errored());
+	BOOST_CHECK_EQUAL(app.graph().nodes().size(), count);
+	BOOST_CHECK_EQUAL(app.graph().connections().size(), count - 2);
+	BOOST_CHECK_EQUAL(app.undoStack().undoActionCount(), 1u);
+	BOOST_CHECK_EQUAL(lastOutput(), (float)(count - 11));
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().undo());
+	BOOST_CHECK(app.graph().nodes().empty());
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().redo());
+	BOOST_CHECK_EQUAL(app.graph().connections().size(), count - 2);
+}
@@ -0,0 +1,116 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/metadata_register.h>
+#include <possumwood_sdk/app.h>
+#include <possumwood_sdk/node_implementation.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+dependency_graph::InAttr<float> a_drawnInput;
+
+float s_drawnValue = -1.0f;
+
+void init(possumwood::Metadata& meta) {
+	meta.addAttribute(a_drawnInput, "input");
+
+	meta.setDrawable([](const dependency_graph::Values& vals, const possumwood::ViewportState& viewport) {
+		s_drawnValue = vals.get(a_drawnInput);
+		return dependency_graph::State();
+	});
+}
+
+possumwood::NodeImplementation s_impl("app_draw_test", init);
+
+dependency_graph::InAttr<unsigned> a_drawnFrame;
+
+unsigned s_drawnFrame = 0;
+
+void initFrame(possumwood::Metadata& meta) {
+	meta.addAttribute(a_drawnFrame, "frame");
+
+	meta.setDrawable([](const dependency_graph::Values& vals, const possumwood::ViewportState& viewport) {
+		s_drawnFrame = vals.get(a_drawnFrame);
+		return dependency_graph::State();
+	});
+}
+
+possumwood::NodeImplementation s_frameImpl("app_draw_frame_test", initFrame);
+
+const dependency_graph::MetadataHandle& metadata(const std::string& type) {
+	auto it = dependency_graph::MetadataRegister::singleton().find(type);
+	BOOST_REQUIRE(it != dependency_graph::MetadataRegister::singleton().end());
+
+	return *it;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(app_draw_after_set_time) {
+	possumwood::App app;
+
+	// headless rendering relies on synchronous evaluation during draw()
+	BOOST_CHECK_EQUAL(app.sceneConfig()["background_evaluation"].as<int>(), 0);
+
+	dependency_graph::NodeBase& time = app.graph().nodes().add(metadata("time"), "time");
+	dependency_graph::NodeBase& drawn = app.graph().nodes().add(metadata("app_draw_test"), "drawn");
+	BOOST_REQUIRE_NO_THROW(time.port(0).connect(drawn.port(0)));
+
+	app.draw(possumwood::ViewportState());
+	BOOST_CHECK_EQUAL(s_drawnValue, 0.0f);
+
+	// each draw after a time change sees the new value (i.e., a render of a frame range)
+	for(float t : {2.0f, 3.5f, 1.0f}) {
+		app.setTime(t);
+		app.draw(possumwood::ViewportState());
+
+		BOOST_CHECK_EQUAL(s_drawnValue, t);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(app_time_source_metadata_change) {
+	possumwood::App app;
+
+	dependency_graph::NodeBase& source = app.graph().nodes().add(metadata("app_draw_test"), "source");
+	dependency_graph::NodeBase& drawn = app.graph().nodes().add(metadata("app_draw_test"), "drawn");
+
+	// changing the type of a node to a time source makes it follow the scene time
+	source.setMetadata(metadata("time"));
+	BOOST_REQUIRE_NO_THROW(source.port(0).connect(drawn.port(0)));
+
+	app.setTime(2.0f);
+	app.draw(possumwood::ViewportState());
+	BOOST_CHECK_EQUAL(s_drawnValue, 2.0f);
+
+	// and changing it back removes it from the time sources (its port 0 no longer holds time)
+	BOOST_REQUIRE_NO_THROW(source.port(0).disconnect(drawn.port(0)));
+	source.setMetadata(metadata("app_draw_test"));
+
+	BOOST_CHECK_NO_THROW(app.setTime(3.0f));
+	BOOST_CHECK_EQUAL(source.port(0).get<float>(), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(app_frame_fps_change) {
+	possumwood::App app;
+	app.sceneConfig()["frame_cache"] = 24;
+
+	dependency_graph::NodeBase& frame = app.graph().nodes().add(metadata("frame"), "frame");
+	dependency_graph::NodeBase& drawn = app.graph().nodes().add(metadata("app_draw_frame_test"), "drawn");
+	BOOST_REQUIRE_NO_THROW(frame.port(0).connect(drawn.port(0)));
+
+	// evaluate two frames, to populate the frame cache
+	for(float t : {1.0f, 2.0f}) {
+		app.setTime(t);
+		app.draw(possumwood::ViewportState());
+	}
+	BOOST_CHECK_EQUAL(s_drawnFrame, 48u);
+
+	// changing the fps updates the current frame, and drops the frames cached with the previous fps
+	app.sceneConfig()["fps"] = 25.0f;
+	app.draw(possumwood::ViewportState());
+	BOOST_CHECK_EQUAL(s_drawnFrame, 50u);
+
+	app.setTime(1.0f);
+	app.draw(possumwood::ViewportState());
+	BOOST_CHECK_EQUAL(s_drawnFrame, 25u);
+}